@@ -0,0 +1,5 @@
+-- AlterTable
+ALTER TABLE `customers` ADD COLUMN `deleted_at` DATETIME(3) NULL;
+
+-- CreateIndex
+CREATE INDEX `customers_updated_at_id_idx` ON `customers`(`updated_at`, `id`);
@@ -8,17 +8,22 @@ const express = require('express');
 const swaggerUi = require('swagger-ui-express');
 const swaggerSpec = require('./src/config/swagger');
 const corsMiddleware = require('./src/middleware/cors');
+const compression = require('./src/middleware/compression');
+const contentNegotiation = require('./src/middleware/contentNegotiation');
 const { apiLimiter } = require('./src/middleware/rateLimiter');
 const errorHandler = require('./src/middleware/errorHandler');
 const customerRoutes = require('./src/routes/customerRoutes');
+const customerService = require('./src/services/customerService');
 
 const app = express();
 const PORT = process.env.PORT || 3000;
 
 // Middleware
 app.use(corsMiddleware);
+app.use(compression); // gzip / br for bodies >= 1 KB
+app.use(contentNegotiation); // res.json() sends CBOR on Accept: application/cbor
 app.use(apiLimiter); // Rate limiting
-app.use(express.json());
+app.use(express.json({ limit: '1mb' })); // Room for 1000-row batch imports
 app.use(express.urlencoded({ extended: true }));
 
 // Request logging (development)
@@ -82,6 +87,7 @@ app.use(errorHandler);
 
 // Start server only if this file is run directly (not imported for testing)
 if (require.main === module) {
+  customerService.schedulePurge(); // Drop tombstones past the delta sync retention
   app.listen(PORT, () => {
     console.log(`🚀 Server running on http://localhost:${PORT}`);
     console.log(`📚 API Documentation: http://localhost:${PORT}/api-docs`);
@@ -77,6 +77,12 @@ const options = {
               type: 'string',
               format: 'date-time',
               description: 'Timestamp when customer was last updated'
+            },
+            deletedAt: {
+              type: 'string',
+              format: 'date-time',
+              nullable: true,
+              description: 'Delta responses only: when the customer was deleted (null while it exists)'
             }
           }
         },
@@ -127,6 +133,12 @@ const options = {
             count: {
               type: 'integer',
               example: 10
+            },
+            nextCursor: {
+              type: 'integer',
+              nullable: true,
+              description: 'Paged lists only: cursor for the next page (null on the last page)',
+              example: 250
             }
           }
         },
@@ -2,22 +2,191 @@
 // Business logic for customer operations
 
 const customerService = require('../services/customerService');
+const customerEvents = require('../services/customerEvents');
+
+const MAX_PAGE_SIZE = 1000;
+const MAX_BATCH_SIZE = 1000;
+const MAX_IDS = 1000; // Ids per ?ids= lookup
+const EVENT_RETRY_MS = 3000; // Client reconnect delay after a dropped stream
+const EVENT_PING_MS = 30 * 1000; // Comment line, keeps proxies from closing an idle stream
 
 class CustomerController {
   // GET /api/customers
+  // GET /api/customers?limit=100&cursor=250 (paged)
+  // GET /api/customers?updatedSince=2026-01-01T00:00:00.000Z&includeDeleted=true (delta)
+  // GET /api/customers?ids=1,2,3 (batched lookup)
   async getAllCustomers(req, res, next) {
     try {
-      const customers = await customerService.getAllCustomers();
-      res.json({
+      if (req.query.updatedSince !== undefined) {
+        return await this.getChangedCustomers(req, res);
+      }
+      if (req.query.ids !== undefined) {
+        return await this.getCustomersByIds(req, res);
+      }
+
+      const limit = req.query.limit !== undefined ? parseInt(req.query.limit) : undefined;
+      const cursor = req.query.cursor !== undefined ? parseInt(req.query.cursor) : undefined;
+
+      if (limit !== undefined && !(limit >= 1 && limit <= MAX_PAGE_SIZE)) {
+        return res.status(400).json({
+          success: false,
+          message: `limit must be between 1 and ${MAX_PAGE_SIZE}`
+        });
+      }
+      if (cursor !== undefined && !(cursor >= 0)) {
+        return res.status(400).json({
+          success: false,
+          message: 'cursor must be a non-negative customer id'
+        });
+      }
+
+      const customers = await customerService.getAllCustomers({ limit, cursor });
+
+      // Validators for client-side snapshots: Express derives a weak ETag
+      // from the body and answers a matching If-None-Match with 304
+      const lastModified = customers.reduce(
+        (latest, customer) => (customer.updatedAt > latest ? customer.updatedAt : latest),
+        new Date(0)
+      );
+      res.set('Cache-Control', 'no-cache');
+      if (customers.length > 0) {
+        res.set('Last-Modified', lastModified.toUTCString());
+      }
+
+      const response = {
         success: true,
         data: customers,
         count: customers.length
-      });
+      };
+
+      // Paged request: id to pass as cursor for the next page (null = last page)
+      if (limit !== undefined) {
+        response.nextCursor = customers.length === limit ? customers[customers.length - 1].id : null;
+      }
+
+      res.json(response);
     } catch (error) {
       next(error);
     }
   }
 
+  // GET /api/customers?updatedSince=... - customers changed after a timestamp
+  async getChangedCustomers(req, res) {
+    const since = new Date(req.query.updatedSince);
+
+    if (isNaN(since.getTime())) {
+      return res.status(400).json({
+        success: false,
+        message: 'updatedSince must be an ISO 8601 timestamp'
+      });
+    }
+    if (req.query.limit !== undefined || req.query.cursor !== undefined || req.query.ids !== undefined) {
+      return res.status(400).json({
+        success: false,
+        message: 'updatedSince cannot be combined with limit, cursor or ids'
+      });
+    }
+
+    const includeDeleted = req.query.includeDeleted === 'true';
+
+    // Tombstones older than the retention period are gone, so deletes since
+    // then cannot be reported: the client has to start over with a full sync
+    const oldestSince = customerService.oldestSyncCursor();
+    if (includeDeleted && since < oldestSince) {
+      return res.status(410).json({
+        success: false,
+        message: 'updatedSince is older than the tombstone retention period; run a full sync',
+        oldestSince
+      });
+    }
+
+    const customers = await customerService.getChangedCustomers({ since, includeDeleted });
+
+    // Watermark for the next call: newest change returned (unchanged if none)
+    const watermark = customers.length > 0 ? customers[customers.length - 1].updatedAt : since;
+
+    res.set('Cache-Control', 'no-cache');
+    res.json({
+      success: true,
+      data: customers,
+      count: customers.length,
+      watermark
+    });
+  }
+
+  // GET /api/customers?ids=1,2,3 - several customers in one query
+  // Found customers come back ordered by id; the ids that do not exist
+  // (or are deleted) are listed in `missing`
+  async getCustomersByIds(req, res) {
+    if (req.query.limit !== undefined || req.query.cursor !== undefined) {
+      return res.status(400).json({
+        success: false,
+        message: 'ids cannot be combined with limit or cursor'
+      });
+    }
+
+    const parts = String(req.query.ids).split(',');
+    const ids = [...new Set(parts.map((part) => Number(part)))];
+    if (!ids.every((id) => Number.isSafeInteger(id) && id >= 1) || parts.some((part) => part.trim() === '')) {
+      return res.status(400).json({
+        success: false,
+        message: 'ids must be a comma-separated list of customer ids'
+      });
+    }
+    if (ids.length > MAX_IDS) {
+      return res.status(400).json({
+        success: false,
+        message: `At most ${MAX_IDS} ids per request`
+      });
+    }
+
+    const customers = await customerService.getCustomersByIds(ids);
+    const found = new Set(customers.map((customer) => customer.id));
+
+    res.set('Cache-Control', 'no-cache');
+    res.json({
+      success: true,
+      data: customers,
+      count: customers.length,
+      missing: ids.filter((id) => !found.has(id))
+    });
+  }
+
+  // GET /api/customers/events - Server-Sent Events stream of customer changes
+  // Resumes after the Last-Event-ID header (or ?lastEventId=); a client that
+  // cannot be resumed gets a resync event and should run a delta sync
+  streamEvents(req, res) {
+    res.status(200).set({
+      'Content-Type': 'text/event-stream',
+      'Cache-Control': 'no-cache, no-transform',
+      Connection: 'keep-alive',
+      'X-Accel-Buffering': 'no'
+    });
+    res.flushHeaders();
+
+    const write = (event) => {
+      res.write(`id: ${event.id}\nevent: ${event.type}\ndata: ${JSON.stringify(event.data)}\n\n`);
+    };
+
+    // Replay and subscribe in one synchronous step, so no event falls between
+    res.write(`retry: ${EVENT_RETRY_MS}\n\n`);
+    const lastEventId = req.get('Last-Event-ID') || req.query.lastEventId;
+    const missed = lastEventId ? customerEvents.since(lastEventId) : [];
+    if (missed === null) {
+      write({ id: customerEvents.lastEventId(), type: 'resync', data: {} });
+    } else {
+      missed.forEach(write);
+      write({ id: customerEvents.lastEventId(), type: 'ready', data: {} });
+    }
+    customerEvents.on('event', write);
+
+    const ping = setInterval(() => res.write(': ping\n\n'), EVENT_PING_MS);
+    req.on('close', () => {
+      clearInterval(ping);
+      customerEvents.off('event', write);
+    });
+  }
+
   // GET /api/customers/:id
   async getCustomerById(req, res, next) {
     try {
@@ -64,6 +233,45 @@ class CustomerController {
     }
   }
 
+  // POST /api/customers/batch
+  async createCustomersBatch(req, res, next) {
+    try {
+      const { customers } = req.body;
+
+      if (!Array.isArray(customers) || customers.length === 0 || customers.length > MAX_BATCH_SIZE) {
+        return res.status(400).json({
+          success: false,
+          message: `customers must be an array of 1 to ${MAX_BATCH_SIZE} items`
+        });
+      }
+
+      // Validate every row first so a bad row never leaves a partial import
+      const errors = [];
+      customers.forEach((customer, index) => {
+        if (!customer || !customer.firstName || !customer.lastName || !customer.address) {
+          errors.push({ index, message: 'Missing required fields: firstName, lastName, address' });
+        }
+      });
+      if (errors.length > 0) {
+        return res.status(400).json({
+          success: false,
+          message: `${errors.length} of ${customers.length} customers are invalid`,
+          errors
+        });
+      }
+
+      const result = await customerService.createCustomers(customers);
+
+      res.status(201).json({
+        success: true,
+        count: result.count,
+        message: `${result.count} customers created successfully`
+      });
+    } catch (error) {
+      next(error);
+    }
+  }
+
   // PUT /api/customers/:id
   async updateCustomer(req, res, next) {
     try {
@@ -0,0 +1,26 @@
+// Content Negotiation Middleware
+// res.json() answers with CBOR when the client prefers application/cbor
+// (Accept: application/cbor, application/json;q=0.9); JSON stays the
+// default and the fallback for every other client.
+
+const cbor = require('../utils/cbor');
+
+const CBOR_TYPE = 'application/cbor';
+
+function contentNegotiation(req, res, next) {
+  const json = res.json.bind(res);
+
+  res.json = (body) => {
+    res.vary('Accept');
+    // JSON first: it wins when both are equally acceptable
+    if (req.accepts(['application/json', CBOR_TYPE]) !== CBOR_TYPE) {
+      return json(body);
+    }
+    res.type(CBOR_TYPE);
+    return res.send(cbor.encode(body));
+  };
+
+  next();
+}
+
+module.exports = contentNegotiation;
@@ -3,6 +3,11 @@
 
 const rateLimit = require('express-rate-limit');
 
+// Load tests against a local backend (frontend-loadgen) set
+// RATE_LIMIT_DISABLED=true together with NODE_ENV=test; honoured only
+// then, so a deploy without NODE_ENV cannot switch the limiter off
+const rateLimitDisabled = process.env.RATE_LIMIT_DISABLED === 'true' && process.env.NODE_ENV === 'test';
+
 // General API rate limiter
 const apiLimiter = rateLimit({
   windowMs: 15 * 60 * 1000, // 15 minutes
@@ -14,7 +19,7 @@ const apiLimiter = rateLimit({
   standardHeaders: true, // Return rate limit info in headers
   legacyHeaders: false,
   // Skip rate limiting for health check
-  skip: (req) => req.path === '/health'
+  skip: (req) => rateLimitDisabled || req.path === '/health'
 });
 
 // Stricter limiter for write operations (POST, PUT, DELETE)
@@ -26,7 +31,8 @@ const writeOperationsLimiter = rateLimit({
     message: 'Too many create/update/delete requests, please try again later.'
   },
   standardHeaders: true,
-  legacyHeaders: false
+  legacyHeaders: false,
+  skip: () => rateLimitDisabled
 });
 
 module.exports = {
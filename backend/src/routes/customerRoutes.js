@@ -11,14 +11,77 @@ const customerController = require('../controllers/customerController');
  *   get:
  *     summary: Get all customers
  *     tags: [Customers]
- *     description: Retrieve a list of all customers from the database
+ *     description: |
+ *       Retrieve a list of all customers from the database.
+ *       Responses carry ETag and Last-Modified headers; send them back as
+ *       If-None-Match / If-Modified-Since to get 304 when nothing changed.
+ *       With updatedSince only customers changed after that time are
+ *       returned (oldest change first), plus a watermark for the next call.
+ *       With ids only those customers are returned (one query instead of
+ *       one request per id), plus the ids that were not found.
+ *     parameters:
+ *       - in: query
+ *         name: limit
+ *         schema:
+ *           type: integer
+ *           minimum: 1
+ *           maximum: 1000
+ *         description: Page size. When set, the response includes nextCursor
+ *       - in: query
+ *         name: cursor
+ *         schema:
+ *           type: integer
+ *         description: Return customers with an id greater than this (nextCursor of the previous page)
+ *       - in: query
+ *         name: updatedSince
+ *         schema:
+ *           type: string
+ *           format: date-time
+ *         description: Delta sync - return customers updated after this time. Cannot be combined with limit/cursor
+ *       - in: query
+ *         name: includeDeleted
+ *         schema:
+ *           type: boolean
+ *         description: With updatedSince, also return deleted customers as tombstones (deletedAt set)
+ *       - in: query
+ *         name: ids
+ *         schema:
+ *           type: string
+ *           example: 1,2,3
+ *         description: Batched lookup - comma-separated customer ids (at most 1000). Cannot be combined with limit/cursor
+ *       - in: header
+ *         name: If-None-Match
+ *         schema:
+ *           type: string
+ *         description: ETag of a previously received list
  *     responses:
  *       200:
  *         description: List of customers retrieved successfully
+ *         headers:
+ *           ETag:
+ *             schema:
+ *               type: string
+ *           Last-Modified:
+ *             schema:
+ *               type: string
  *         content:
  *           application/json:
  *             schema:
  *               $ref: '#/components/schemas/SuccessResponse'
+ *       304:
+ *         description: Customer list unchanged since the given ETag
+ *       400:
+ *         description: Invalid limit, cursor, updatedSince or ids
+ *         content:
+ *           application/json:
+ *             schema:
+ *               $ref: '#/components/schemas/ErrorResponse'
+ *       410:
+ *         description: updatedSince with includeDeleted is older than the tombstone retention period (30 days); run a full sync
+ *         content:
+ *           application/json:
+ *             schema:
+ *               $ref: '#/components/schemas/ErrorResponse'
  *       500:
  *         description: Server error
  *         content:
@@ -28,6 +91,42 @@ const customerController = require('../controllers/customerController');
  */
 router.get('/', customerController.getAllCustomers.bind(customerController));
 
+/**
+ * @swagger
+ * /api/customers/events:
+ *   get:
+ *     summary: Stream customer changes
+ *     tags: [Customers]
+ *     description: |
+ *       Server-Sent Events stream with one event per customer change:
+ *       customerCreated and customerUpdated carry the customer,
+ *       customerDeleted its id and deletedAt. After connecting (or
+ *       resuming) a ready event marks the current position. A resync event
+ *       means changes cannot be described one by one (batch import, or a
+ *       Last-Event-ID that is no longer known) and the client should run a
+ *       delta sync. Idle streams get a comment line every 30 seconds.
+ *     parameters:
+ *       - in: header
+ *         name: Last-Event-ID
+ *         schema:
+ *           type: string
+ *         description: Id of the last event received; missed events are replayed first
+ *       - in: query
+ *         name: lastEventId
+ *         schema:
+ *           type: string
+ *         description: Same as Last-Event-ID, for clients that cannot set headers
+ *     responses:
+ *       200:
+ *         description: Event stream (stays open)
+ *         content:
+ *           text/event-stream:
+ *             schema:
+ *               type: string
+ *               example: "id: lq2x9k-42\nevent: customerUpdated\ndata: {\"id\":7,\"firstName\":\"Matti\"}\n\n"
+ */
+router.get('/events', customerController.streamEvents.bind(customerController));
+
 /**
  * @swagger
  * /api/customers/{id}:
@@ -99,6 +198,76 @@ router.get('/:id', customerController.getCustomerById.bind(customerController));
  */
 router.post('/', customerController.createCustomer.bind(customerController));
 
+/**
+ * @swagger
+ * /api/customers/batch:
+ *   post:
+ *     summary: Create many customers
+ *     tags: [Customers]
+ *     description: |
+ *       Create up to 1000 customers in a single INSERT. Every row is
+ *       validated first; if any row is invalid nothing is created and the
+ *       response lists the invalid rows by index.
+ *     requestBody:
+ *       required: true
+ *       content:
+ *         application/json:
+ *           schema:
+ *             type: object
+ *             required: [customers]
+ *             properties:
+ *               customers:
+ *                 type: array
+ *                 minItems: 1
+ *                 maxItems: 1000
+ *                 items:
+ *                   $ref: '#/components/schemas/CustomerInput'
+ *     responses:
+ *       201:
+ *         description: Customers created successfully
+ *         content:
+ *           application/json:
+ *             schema:
+ *               type: object
+ *               properties:
+ *                 success:
+ *                   type: boolean
+ *                   example: true
+ *                 count:
+ *                   type: integer
+ *                   example: 500
+ *                 message:
+ *                   type: string
+ *       400:
+ *         description: Invalid batch - nothing was created
+ *         content:
+ *           application/json:
+ *             schema:
+ *               type: object
+ *               properties:
+ *                 success:
+ *                   type: boolean
+ *                   example: false
+ *                 message:
+ *                   type: string
+ *                 errors:
+ *                   type: array
+ *                   items:
+ *                     type: object
+ *                     properties:
+ *                       index:
+ *                         type: integer
+ *                       message:
+ *                         type: string
+ *       500:
+ *         description: Server error
+ *         content:
+ *           application/json:
+ *             schema:
+ *               $ref: '#/components/schemas/ErrorResponse'
+ */
+router.post('/batch', customerController.createCustomersBatch.bind(customerController));
+
 /**
  * @swagger
  * /api/customers/{id}:
@@ -0,0 +1,71 @@
+// Customer Events
+// In-process broadcast of customer changes for the Server-Sent Events stream
+// (GET /api/customers/events). customerService publishes every create,
+// update and delete here; subscribers get them in order.
+//
+// Event ids are "<boot>-<sequence>": the boot part changes when the process
+// restarts, so a client resuming with an id from an earlier process (or one
+// older than the replay buffer) is told to resync instead of silently
+// missing changes. Changes are only seen by the process that made them;
+// running several instances needs a shared bus behind publish().
+
+const { EventEmitter } = require('node:events');
+
+const HISTORY_SIZE = 1000; // Events kept for Last-Event-ID resume
+
+class CustomerEvents extends EventEmitter {
+  constructor({ historySize = HISTORY_SIZE } = {}) {
+    super();
+    this.setMaxListeners(0); // One listener per connected client
+    this.boot = Date.now().toString(36);
+    this.sequence = 0;
+    this.historySize = historySize;
+    this.history = [];
+  }
+
+  // Id of the newest event (a client starting now resumes from here)
+  lastEventId() {
+    return `${this.boot}-${this.sequence}`;
+  }
+
+  // Broadcast a change: type is customerCreated, customerUpdated,
+  // customerDeleted or resync (changes too large to describe one by one)
+  publish(type, data) {
+    this.sequence += 1;
+    const event = { id: this.lastEventId(), type, data };
+
+    this.history.push(event);
+    if (this.history.length > this.historySize) {
+      this.history.shift();
+    }
+
+    this.emit('event', event);
+    return event;
+  }
+
+  // Events after lastEventId, oldest first; null if they are no longer
+  // known (other process, or fallen out of the buffer)
+  since(lastEventId) {
+    const match = /^([0-9a-z]+)-(\d+)$/.exec(String(lastEventId));
+    if (!match || match[1] !== this.boot) {
+      return null;
+    }
+
+    const sequence = parseInt(match[2]);
+    if (sequence > this.sequence) {
+      return null;
+    }
+    if (sequence === this.sequence) {
+      return [];
+    }
+
+    const oldest = this.sequence - this.history.length + 1;
+    if (sequence + 1 < oldest) {
+      return null;
+    }
+    return this.history.slice(sequence + 1 - oldest);
+  }
+}
+
+module.exports = new CustomerEvents();
+module.exports.CustomerEvents = CustomerEvents;
@@ -2,50 +2,147 @@
 // Database operations for Customer model using Prisma
 
 const prisma = require('../config/database');
+const customerEvents = require('./customerEvents');
+
+// Deleted customers stay in the table as tombstones (deletedAt set) so delta
+// sync clients learn about deletes; regular reads never return them
+const CUSTOMER_FIELDS = {
+  id: true,
+  firstName: true,
+  lastName: true,
+  address: true,
+  createdAt: true,
+  updatedAt: true
+};
+const LIVE = { deletedAt: null };
+
+// Tombstones are purged once older than this, so a delta sync may start at
+// most this far back; older cursors must run a full sync instead
+const TOMBSTONE_RETENTION_MS = (parseInt(process.env.TOMBSTONE_RETENTION_DAYS) || 30) * 24 * 60 * 60 * 1000;
+const PURGE_INTERVAL_MS = 60 * 60 * 1000;
 
 class CustomerService {
-  // Get all customers
-  async getAllCustomers() {
+  // Get all customers, optionally one page at a time
+  // (keyset pagination: `cursor` is the last id of the previous page)
+  async getAllCustomers({ limit, cursor } = {}) {
     return await prisma.customer.findMany({
-      orderBy: { id: 'asc' }
+      select: CUSTOMER_FIELDS,
+      where: cursor ? { ...LIVE, id: { gt: cursor } } : LIVE,
+      orderBy: { id: 'asc' },
+      ...(limit && { take: limit })
+    });
+  }
+
+  // Get customers changed after `since` (served from the updated_at index),
+  // oldest change first; with includeDeleted, tombstones come along too
+  async getChangedCustomers({ since, includeDeleted = false }) {
+    return await prisma.customer.findMany({
+      select: { ...CUSTOMER_FIELDS, deletedAt: true },
+      where: {
+        updatedAt: { gt: since },
+        ...(!includeDeleted && LIVE)
+      },
+      orderBy: [{ updatedAt: 'asc' }, { id: 'asc' }]
     });
   }
 
+  // Oldest updatedSince a delta with tombstones can be answered from
+  oldestSyncCursor(now = new Date()) {
+    return new Date(now.getTime() - TOMBSTONE_RETENTION_MS);
+  }
+
+  // Delete tombstones older than the retention period
+  // A tombstone's updatedAt is its delete time, so the updated_at index finds them
+  async purgeTombstones(now = new Date()) {
+    return await prisma.customer.deleteMany({
+      where: {
+        deletedAt: { not: null },
+        updatedAt: { lt: this.oldestSyncCursor(now) }
+      }
+    });
+  }
+
+  // Purge now and then hourly; the timer does not keep the process alive
+  schedulePurge() {
+    const purge = () => this.purgeTombstones().catch((error) => {
+      console.error('Tombstone purge failed:', error.message);
+    });
+    purge();
+    setInterval(purge, PURGE_INTERVAL_MS).unref();
+  }
+
   // Get customer by ID
   async getCustomerById(id) {
-    return await prisma.customer.findUnique({
-      where: { id: parseInt(id) }
+    return await prisma.customer.findFirst({
+      select: CUSTOMER_FIELDS,
+      where: { ...LIVE, id: parseInt(id) }
+    });
+  }
+
+  // Get several customers by ID in one query (deleted and unknown ids are
+  // left out)
+  async getCustomersByIds(ids) {
+    return await prisma.customer.findMany({
+      select: CUSTOMER_FIELDS,
+      where: { ...LIVE, id: { in: ids } },
+      orderBy: { id: 'asc' }
     });
   }
 
   // Create new customer
   async createCustomer(data) {
-    return await prisma.customer.create({
+    const customer = await prisma.customer.create({
+      select: CUSTOMER_FIELDS,
       data: {
         firstName: data.firstName,
         lastName: data.lastName,
         address: data.address
       }
     });
+    customerEvents.publish('customerCreated', customer);
+    return customer;
+  }
+
+  // Create many customers in one INSERT (all rows or none)
+  // Returns { count } - MySQL cannot return the generated ids
+  // Subscribers are told to resync: there are no rows to send
+  async createCustomers(list) {
+    const result = await prisma.customer.createMany({
+      data: list.map((data) => ({
+        firstName: data.firstName,
+        lastName: data.lastName,
+        address: data.address
+      }))
+    });
+    customerEvents.publish('resync', { count: result.count });
+    return result;
   }
 
   // Update customer
   async updateCustomer(id, data) {
-    return await prisma.customer.update({
-      where: { id: parseInt(id) },
+    const customer = await prisma.customer.update({
+      select: CUSTOMER_FIELDS,
+      where: { ...LIVE, id: parseInt(id) },
       data: {
         firstName: data.firstName,
         lastName: data.lastName,
         address: data.address
       }
     });
+    customerEvents.publish('customerUpdated', customer);
+    return customer;
   }
 
-  // Delete customer
+  // Delete customer (soft: @updatedAt moves too, so the delete shows up in deltas)
+  // Throws P2025 when the customer does not exist or is already deleted
   async deleteCustomer(id) {
-    return await prisma.customer.delete({
-      where: { id: parseInt(id) }
+    const customer = await prisma.customer.update({
+      select: { ...CUSTOMER_FIELDS, deletedAt: true },
+      where: { ...LIVE, id: parseInt(id) },
+      data: { deletedAt: new Date() }
     });
+    customerEvents.publish('customerDeleted', { id: customer.id, deletedAt: customer.deletedAt });
+    return customer;
   }
 }
 
@@ -0,0 +1,141 @@
+// CBOR Encoder (RFC 8949)
+// Encodes the same values res.json() serializes, for clients that send
+// Accept: application/cbor. Dates become tag 0 (date/time string) with
+// the same ISO 8601 text as JSON, so both formats carry identical data.
+
+const TAG_DATE_TIME_STRING = 0;
+
+// Major types
+const UNSIGNED = 0;
+const NEGATIVE = 1;
+const BYTES = 2;
+const TEXT = 3;
+const ARRAY = 4;
+const MAP = 5;
+const TAG = 6;
+
+class Encoder {
+  constructor() {
+    this.buffer = Buffer.allocUnsafe(4096);
+    this.length = 0;
+  }
+
+  reserve(bytes) {
+    if (this.length + bytes <= this.buffer.length) {
+      return;
+    }
+    const grown = Buffer.allocUnsafe(Math.max(this.buffer.length * 2, this.length + bytes));
+    this.buffer.copy(grown, 0, 0, this.length);
+    this.buffer = grown;
+  }
+
+  // Initial byte plus the shortest argument encoding
+  head(major, value) {
+    this.reserve(9);
+    const type = major << 5;
+    if (value < 24) {
+      this.buffer[this.length++] = type | value;
+    } else if (value < 0x100) {
+      this.buffer[this.length++] = type | 24;
+      this.buffer[this.length++] = value;
+    } else if (value < 0x10000) {
+      this.buffer[this.length++] = type | 25;
+      this.length = this.buffer.writeUInt16BE(value, this.length);
+    } else if (value < 0x100000000) {
+      this.buffer[this.length++] = type | 26;
+      this.length = this.buffer.writeUInt32BE(value, this.length);
+    } else {
+      this.buffer[this.length++] = type | 27;
+      this.length = this.buffer.writeBigUInt64BE(BigInt(value), this.length);
+    }
+  }
+
+  text(value) {
+    const bytes = Buffer.byteLength(value, 'utf8');
+    this.head(TEXT, bytes);
+    this.reserve(bytes);
+    this.length += this.buffer.write(value, this.length, 'utf8');
+  }
+
+  number(value) {
+    if (Number.isSafeInteger(value)) {
+      if (value >= 0) {
+        this.head(UNSIGNED, value);
+      } else {
+        this.head(NEGATIVE, -1 - value);
+      }
+      return;
+    }
+    if (!Number.isFinite(value)) {
+      this.simple(22); // null, as JSON.stringify writes it
+      return;
+    }
+    this.reserve(9);
+    this.buffer[this.length++] = 0xfb;
+    this.length = this.buffer.writeDoubleBE(value, this.length);
+  }
+
+  simple(value) {
+    this.reserve(1);
+    this.buffer[this.length++] = 0xe0 | value;
+  }
+
+  value(value) {
+    if (value === null) {
+      this.simple(22);
+    } else if (value === false || value === true) {
+      this.simple(value ? 21 : 20);
+    } else if (typeof value === 'number') {
+      this.number(value);
+    } else if (typeof value === 'string') {
+      this.text(value);
+    } else if (value instanceof Date) {
+      if (Number.isNaN(value.getTime())) {
+        this.simple(22);
+      } else {
+        this.head(TAG, TAG_DATE_TIME_STRING);
+        this.text(value.toISOString());
+      }
+    } else if (Buffer.isBuffer(value)) {
+      this.head(BYTES, value.length);
+      this.reserve(value.length);
+      this.length += value.copy(this.buffer, this.length);
+    } else if (Array.isArray(value)) {
+      this.head(ARRAY, value.length);
+      for (const item of value) {
+        // JSON.stringify writes null for array holes and functions
+        this.value(item === undefined || typeof item === 'function' ? null : item);
+      }
+    } else if (typeof value === 'object') {
+      if (typeof value.toJSON === 'function') {
+        this.value(value.toJSON());
+        return;
+      }
+      const entries = Object.entries(value).filter(
+        ([, item]) => item !== undefined && typeof item !== 'function'
+      );
+      this.head(MAP, entries.length);
+      for (const [key, item] of entries) {
+        this.text(key);
+        this.value(item);
+      }
+    } else if (typeof value === 'bigint') {
+      throw new TypeError('Do not know how to serialize a BigInt');
+    } else {
+      this.simple(22);
+    }
+  }
+}
+
+/**
+ * Encode a JSON-compatible value as CBOR
+ * @param {*} value - Response body as passed to res.json()
+ * @returns {Buffer}
+ */
+function encode(value) {
+  const encoder = new Encoder();
+  encoder.value(value === undefined ? null : value);
+  return encoder.buffer.subarray(0, encoder.length);
+}
+
+module.exports = { encode };
@@ -0,0 +1,36 @@
+const { describe, it } = require('node:test');
+const assert = require('node:assert');
+const request = require('supertest');
+
+const app = require('../server.js');
+
+// Only the validation paths; they answer before touching the database
+describe('Customer batched lookup', () => {
+  it('should reject ids that are not customer ids', async () => {
+    const response = await request(app)
+      .get('/api/customers?ids=1,two,3')
+      .expect('Content-Type', /json/)
+      .expect(400);
+
+    assert.strictEqual(response.body.success, false);
+    assert.match(response.body.message, /ids/);
+  });
+
+  it('should reject an empty id', async () => {
+    await request(app).get('/api/customers?ids=1,,3').expect(400);
+    await request(app).get('/api/customers?ids=').expect(400);
+  });
+
+  it('should reject too many ids', async () => {
+    const ids = Array.from({ length: 1001 }, (_, i) => i + 1).join(',');
+    const response = await request(app)
+      .get(`/api/customers?ids=${ids}`)
+      .expect(400);
+
+    assert.match(response.body.message, /1000/);
+  });
+
+  it('should reject ids combined with paging', async () => {
+    await request(app).get('/api/customers?ids=1,2&limit=10').expect(400);
+  });
+});
@@ -0,0 +1,42 @@
+const { describe, it } = require('node:test');
+const assert = require('node:assert');
+
+const { CustomerEvents } = require('../src/services/customerEvents');
+
+describe('Customer change events', () => {
+  it('should broadcast published events in order', () => {
+    const events = new CustomerEvents();
+    const received = [];
+    events.on('event', (event) => received.push(event.type));
+
+    events.publish('customerCreated', { id: 1 });
+    events.publish('customerDeleted', { id: 1 });
+
+    assert.deepStrictEqual(received, ['customerCreated', 'customerDeleted']);
+    assert.strictEqual(events.lastEventId(), `${events.boot}-2`);
+  });
+
+  it('should replay the events after a known id', () => {
+    const events = new CustomerEvents();
+    const first = events.publish('customerCreated', { id: 1 });
+    events.publish('customerUpdated', { id: 1 });
+    events.publish('customerUpdated', { id: 2 });
+
+    const missed = events.since(first.id);
+    assert.deepStrictEqual(missed.map((event) => event.data.id), [1, 2]);
+    assert.deepStrictEqual(events.since(events.lastEventId()), []);
+  });
+
+  it('should ask for a resync when the id cannot be resumed', () => {
+    const events = new CustomerEvents({ historySize: 2 });
+    const first = events.publish('customerCreated', { id: 1 });
+    events.publish('customerCreated', { id: 2 });
+    events.publish('customerCreated', { id: 3 });
+    events.publish('customerCreated', { id: 4 });
+
+    assert.strictEqual(events.since(first.id), null);          // Fell out of the buffer
+    assert.strictEqual(events.since('0-1'), null);             // Earlier process
+    assert.strictEqual(events.since(`${events.boot}-9`), null); // Not issued yet
+    assert.strictEqual(events.since('garbage'), null);
+  });
+});
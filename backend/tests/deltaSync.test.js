@@ -0,0 +1,202 @@
+const { describe, it, beforeEach } = require('node:test');
+const assert = require('node:assert');
+const request = require('supertest');
+
+// In-memory stand-in for the Prisma client, installed before the app loads
+// it; understands the where/select/orderBy shapes customerService uses
+const DAY_MS = 24 * 60 * 60 * 1000;
+let rows = [];
+let nextId = 1;
+let lastMs = 0;
+
+// Every write gets a later timestamp than the one before, like updated_at
+function now() {
+  lastMs = Math.max(Date.now(), lastMs + 1);
+  return new Date(lastMs);
+}
+
+function matches(row, where = {}) {
+  return Object.entries(where).every(([field, condition]) => {
+    const value = row[field];
+    if (condition === null || typeof condition !== 'object' || condition instanceof Date) {
+      return condition === null ? value === null : value === condition;
+    }
+    return Object.entries(condition).every(([op, operand]) => {
+      switch (op) {
+        case 'gt': return value > operand;
+        case 'lt': return value < operand;
+        case 'in': return operand.includes(value);
+        case 'not': return operand === null ? value !== null : value !== operand;
+        default: throw new Error(`Unsupported operator ${op}`);
+      }
+    });
+  });
+}
+
+function pick(row, select) {
+  return select ? Object.fromEntries(Object.keys(select).map((field) => [field, row[field]])) : { ...row };
+}
+
+function sorted(list, orderBy) {
+  const keys = [orderBy || []].flat().flatMap(Object.entries);
+  return [...list].sort((a, b) => {
+    for (const [field, direction] of keys) {
+      if (a[field] < b[field]) return direction === 'asc' ? -1 : 1;
+      if (a[field] > b[field]) return direction === 'asc' ? 1 : -1;
+    }
+    return 0;
+  });
+}
+
+function insert(data, timestamp = now()) {
+  const row = { id: nextId++, createdAt: timestamp, updatedAt: timestamp, deletedAt: null, ...data };
+  rows.push(row);
+  return row;
+}
+
+const fakePrisma = {
+  customer: {
+    async findMany({ select, where, orderBy, take }) {
+      const found = sorted(rows.filter((row) => matches(row, where)), orderBy);
+      return found.slice(0, take ?? found.length).map((row) => pick(row, select));
+    },
+    async findFirst({ select, where }) {
+      const row = rows.find((candidate) => matches(candidate, where));
+      return row ? pick(row, select) : null;
+    },
+    async create({ select, data }) {
+      return pick(insert(data), select);
+    },
+    async createMany({ data }) {
+      data.forEach((item) => insert(item));
+      return { count: data.length };
+    },
+    async update({ select, where, data }) {
+      const row = rows.find((candidate) => matches(candidate, where));
+      if (!row) {
+        throw Object.assign(new Error('Record to update not found'), { code: 'P2025' });
+      }
+      Object.assign(row, data, { updatedAt: now() });
+      return pick(row, select);
+    },
+    async deleteMany({ where }) {
+      const before = rows.length;
+      rows = rows.filter((row) => !matches(row, where));
+      return { count: before - rows.length };
+    }
+  }
+};
+
+const databasePath = require.resolve('../src/config/database');
+require.cache[databasePath] = { id: databasePath, filename: databasePath, loaded: true, exports: fakePrisma };
+
+const app = require('../server.js');
+const customerService = require('../src/services/customerService');
+
+const ids = (response) => response.body.data.map((customer) => customer.id);
+
+describe('Customer delta sync', () => {
+  beforeEach(() => {
+    rows = [];
+    nextId = 1;
+  });
+
+  it('should reject an invalid updatedSince', async () => {
+    const response = await request(app)
+      .get('/api/customers?updatedSince=yesterday')
+      .expect('Content-Type', /json/)
+      .expect(400);
+
+    assert.strictEqual(response.body.success, false);
+    assert.match(response.body.message, /updatedSince/);
+  });
+
+  it('should reject updatedSince combined with paging', async () => {
+    const response = await request(app)
+      .get('/api/customers?updatedSince=2026-01-01T00:00:00.000Z&limit=10')
+      .expect(400);
+
+    assert.strictEqual(response.body.success, false);
+  });
+
+  it('should return creates, updates and deletes made after updatedSince', async () => {
+    const before = new Date(Date.now() - 60 * 60 * 1000);
+    const unchanged = insert({ firstName: 'Aino', lastName: 'Virtanen', address: 'Isokatu 1' }, before);
+    const edited = insert({ firstName: 'Eero', lastName: 'Korhonen', address: 'Isokatu 2' }, before);
+    const removed = insert({ firstName: 'Helmi', lastName: 'Mäkinen', address: 'Isokatu 3' }, before);
+    const since = now().toISOString();
+
+    const created = await request(app)
+      .post('/api/customers')
+      .send({ firstName: 'Onni', lastName: 'Laine', address: 'Isokatu 4' })
+      .expect(201);
+    await request(app)
+      .put(`/api/customers/${edited.id}`)
+      .send({ firstName: 'Eero', lastName: 'Heikkinen', address: 'Isokatu 2' })
+      .expect(200);
+    await request(app).delete(`/api/customers/${removed.id}`).expect(200);
+
+    const delta = await request(app)
+      .get(`/api/customers?updatedSince=${since}&includeDeleted=true`)
+      .expect(200);
+
+    assert.deepStrictEqual(ids(delta), [created.body.data.id, edited.id, removed.id]); // Oldest change first
+    assert.strictEqual(delta.body.data[1].lastName, 'Heikkinen');
+    assert.strictEqual(delta.body.data[0].deletedAt, null);
+    assert.ok(delta.body.data[2].deletedAt);
+    assert.strictEqual(delta.body.watermark, delta.body.data[2].updatedAt);
+    assert.ok(!ids(delta).includes(unchanged.id));
+
+    // Without includeDeleted the tombstone is left out
+    const live = await request(app).get(`/api/customers?updatedSince=${since}`).expect(200);
+    assert.deepStrictEqual(ids(live), [created.body.data.id, edited.id]);
+  });
+
+  it('should hide deleted customers from the regular endpoints', async () => {
+    const kept = insert({ firstName: 'Aino', lastName: 'Virtanen', address: 'Isokatu 1' });
+    const removed = insert({ firstName: 'Helmi', lastName: 'Mäkinen', address: 'Isokatu 3' });
+    await request(app).delete(`/api/customers/${removed.id}`).expect(200);
+
+    const list = await request(app).get('/api/customers').expect(200);
+    assert.deepStrictEqual(ids(list), [kept.id]);
+    assert.strictEqual(list.body.data[0].deletedAt, undefined);
+
+    const page = await request(app).get('/api/customers?limit=10').expect(200);
+    assert.deepStrictEqual(ids(page), [kept.id]);
+
+    const lookup = await request(app).get(`/api/customers?ids=${kept.id},${removed.id}`).expect(200);
+    assert.deepStrictEqual(lookup.body.missing, [removed.id]);
+
+    await request(app).get(`/api/customers/${removed.id}`).expect(404);
+    await request(app).put(`/api/customers/${removed.id}`)
+      .send({ firstName: 'Helmi', lastName: 'Mäkinen', address: 'Isokatu 3' })
+      .expect(404);
+    await request(app).delete(`/api/customers/${removed.id}`).expect(404);
+  });
+
+  it('should answer a cursor older than the tombstone retention with 410', async () => {
+    const since = new Date(Date.now() - 31 * DAY_MS).toISOString();
+    const response = await request(app)
+      .get(`/api/customers?updatedSince=${since}&includeDeleted=true`)
+      .expect(410);
+
+    assert.strictEqual(response.body.success, false);
+    assert.ok(new Date(response.body.oldestSince) > new Date(since));
+
+    // A full sync asks for live rows only, so any cursor will do
+    await request(app).get('/api/customers?updatedSince=1970-01-01T00:00:00.000Z').expect(200);
+  });
+
+  it('should purge only tombstones older than the retention period', async () => {
+    const old = new Date(Date.now() - 40 * DAY_MS);
+    const oldLive = insert({ firstName: 'Aino', lastName: 'Virtanen', address: 'Isokatu 1' }, old);
+    insert({ firstName: 'Eero', lastName: 'Korhonen', address: 'Isokatu 2', deletedAt: old }, old);
+    const recent = insert({ firstName: 'Helmi', lastName: 'Mäkinen', address: 'Isokatu 3' });
+    await customerService.deleteCustomer(recent.id);
+
+    const result = await customerService.purgeTombstones();
+
+    assert.strictEqual(result.count, 1);
+    assert.deepStrictEqual(rows.map((row) => row.id), [oldLive.id, recent.id]);
+  });
+});
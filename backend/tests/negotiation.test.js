@@ -0,0 +1,69 @@
+const { describe, it } = require('node:test');
+const assert = require('node:assert');
+const request = require('supertest');
+
+const app = require('../server.js');
+
+// Collect the raw body instead of letting supertest parse it
+function raw(res, callback) {
+  const chunks = [];
+  res.on('data', (chunk) => chunks.push(chunk));
+  res.on('end', () => callback(null, Buffer.concat(chunks)));
+}
+
+describe('Response formats', () => {
+  it('should keep JSON as the default', async () => {
+    const response = await request(app)
+      .get('/health')
+      .expect('Content-Type', /json/)
+      .expect('Vary', /Accept/)
+      .expect(200);
+
+    assert.strictEqual(response.body.status, 'OK');
+  });
+
+  it('should send CBOR when the client prefers it', async () => {
+    const response = await request(app)
+      .get('/health')
+      .set('Accept', 'application/cbor, application/json;q=0.9')
+      .buffer(true)
+      .parse(raw)
+      .expect('Content-Type', /application\/cbor/)
+      .expect(200);
+
+    // Map of two pairs, first key "status"
+    assert.strictEqual(response.body[0], 0xa2);
+    assert.ok(response.body.includes(Buffer.from('status')));
+  });
+
+  it('should prefer JSON when both are equally acceptable', async () => {
+    await request(app)
+      .get('/health')
+      .set('Accept', 'application/json, application/cbor')
+      .expect('Content-Type', /json/)
+      .expect(200);
+  });
+
+  it('should compress large bodies', async () => {
+    await request(app)
+      .get('/api-docs.json')
+      .set('Accept-Encoding', 'gzip')
+      .expect('Content-Encoding', 'gzip')
+      .expect(200);
+
+    await request(app)
+      .get('/api-docs.json')
+      .set('Accept-Encoding', 'br, gzip')
+      .expect('Content-Encoding', 'br')
+      .expect(200);
+  });
+
+  it('should not compress small bodies', async () => {
+    const response = await request(app)
+      .get('/health')
+      .set('Accept-Encoding', 'gzip')
+      .expect(200);
+
+    assert.strictEqual(response.headers['content-encoding'], undefined);
+  });
+});
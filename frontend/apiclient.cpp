@@ -1,273 +1,3236 @@
 #include "apiclient.h"
+#include "customerstreamparser.h"
+#include "customerimportreader.h"
+#include "servereventparser.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QCborValue>
+#include <QCborMap>
 #include <QNetworkRequest>
 #include <QUrl>
 #include <QTimer>
+#include <QSet>
+#include <QMap>
+#include <QStringList>
+#include <QMetaMethod>
+#include <QPointer>
+#include <QTimeZone>
 #include <QDebug>
+#include <limits>
+
+namespace {
+
+const QLatin1String SyncEndpoint("/api/customers?updatedSince=");
+const QLatin1String LookupEndpoint("/api/customers?ids=");
+const int LookupBatchSize = 100;        // Ids per batched lookup (keeps the URL short)
+
+const qsizetype CustomerCacheBytes = 8 * 1024 * 1024;
+const int CustomerCacheMaxAgeMs = 30000;
+
+const qint64 SyncOverlapMs = 5000;  // Changes re-read per delta sync (late commits, clock skew)
+
+const int DefaultHostConcurrency = 6;   // QNetworkAccessManager's HTTP/1.1 connections per host
+
+const int RateLimitReserveDivisor = 10; // Share of the window kept for interactive requests
+const int RateLimitRetryMs = 1000;      // 429 without Retry-After or RateLimit-Reset
+
+const int JournalSyncMs = 10;           // Group commit: one fsync per burst of writes
+const int JournalSettleMs = 50;         // Gather a burst before replaying it
+const int JournalRetryMs = 1000;        // First retry while the backend is unreachable
+const int JournalMaxRetryMs = 60000;
+const int JournalWindow = 4;            // Replays in flight (different customers)
+
+const int EventRetryMs = 3000;          // Reconnect delay until the server sends retry:
+const int EventMaxReconnectMs = 60000;
+const int EventIdleTimeoutMs = 90000;   // Three missed server pings: the connection is gone
+
+/**
+ * Parse a Retry-After header: delay in seconds or an HTTP date
+ *
+ * @return qint64 - Delay in nanoseconds, -1 if missing or malformed
+ */
+qint64 retryAfterNs(const QByteArray &value)
+{
+    bool ok = false;
+    const qint64 seconds = value.trimmed().toLongLong(&ok);
+    if (ok) {
+        return qMax<qint64>(0, seconds) * 1000000000;
+    }
+    
+    const QDateTime date = QDateTime::fromString(QString::fromLatin1(value.trimmed()), Qt::RFC2822Date);
+    if (!date.isValid()) {
+        return -1;
+    }
+    return qMax<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date)) * 1000000;
+}
+
+/**
+ * Nanoseconds to a timer interval, rounded up
+ */
+int timerMs(qint64 ns)
+{
+    return int(qMin<qint64>((ns + 999999) / 1000000, std::numeric_limits<int>::max()));
+}
+
+} // namespace
+
+/**
+ * Endpoint registry, indexed by Route: what each request sends and which
+ * handler its reply goes to. Adding an endpoint means a Route, an entry
+ * here and a handler; replies are never routed by their URL.
+ */
+constexpr std::array<ApiClient::RouteSpec, ApiClient::RouteCount> ApiClient::Routes = {{
+    { CustomersRoute,     "GET",    "/api/customers",       CustomerListResponse, &ApiClient::handleCustomersResponse },
+    { CustomersPageRoute, "GET",    "/api/customers",       CustomerListResponse, &ApiClient::handleCustomersResponse },
+    { SyncRoute,          "GET",    "/api/customers",       CustomerListResponse, &ApiClient::handleCustomersResponse },
+    { LookupRoute,        "GET",    "/api/customers",       LookupResponse,       &ApiClient::handleLookupResponse },
+    { CustomerRoute,      "GET",    "/api/customers/{id}",  JsonResponse,         &ApiClient::handleCustomerResponse },
+    { CreateRoute,        "POST",   "/api/customers",       JsonResponse,         &ApiClient::handleCreateResponse },
+    { UpdateRoute,        "PUT",    "/api/customers/{id}",  JsonResponse,         &ApiClient::handleUpdateResponse },
+    { DeleteRoute,        "DELETE", "/api/customers/{id}",  JsonResponse,         &ApiClient::handleDeleteResponse },
+    { JournalCreateRoute, "POST",   "/api/customers",       ReplyResponse,        &ApiClient::handleJournalReply },
+    { JournalUpdateRoute, "PUT",    "/api/customers/{id}",  ReplyResponse,        &ApiClient::handleJournalReply },
+    { JournalDeleteRoute, "DELETE", "/api/customers/{id}",  ReplyResponse,        &ApiClient::handleJournalReply },
+    { ImportRoute,        "POST",   "/api/customers",       ReplyResponse,        &ApiClient::handleImportReply },
+    { BatchCreateRoute,   "POST",   "/api/customers/batch", ReplyResponse,        &ApiClient::handleImportReply },
+    { HealthRoute,        "GET",    "/health",              JsonResponse,         &ApiClient::handleHealthResponse },
+    { ProbeRoute,         "GET",    "/health",              ReplyResponse,        &ApiClient::handleProbeReply },
+}};
+
+const ApiClient::RouteSpec &ApiClient::routeSpec(Route route)
+{
+    static_assert([] {
+        for (int i = 0; i < RouteCount; ++i) {
+            if (Routes[i].route != i || !Routes[i].handler) {
+                return false;
+            }
+        }
+        return true;
+    }(), "Routes must list every Route in declaration order, each with a handler");
+    return Routes[route];
+}
+
+/**
+ * Whether requests to a route spend the server's rate limit
+ * (the backend's limiter skips /health)
+ */
+bool ApiClient::isRateLimited(Route route)
+{
+    return route != HealthRoute && route != ProbeRoute;
+}
+
+/**
+ * Whether a route's requests are imports or journal replays, which keep
+ * their own bookkeeping and are only aborted by cancelImport() and
+ * closeJournal()
+ */
+bool ApiClient::isBulkRoute(Route route)
+{
+    return route == JournalCreateRoute || route == JournalUpdateRoute || route == JournalDeleteRoute
+        || route == ImportRoute || route == BatchCreateRoute;
+}
+
+/**
+ * Context of a request for one customer: /api/customers/{id}
+ */
+ApiClient::RequestContext ApiClient::customerRequest(Route route, int id)
+{
+    return { .route = route, .endpoint = QString("/api/customers/%1").arg(id), .customerId = id };
+}
+
+/**
+ * Customer list decoded off the GUI thread, with what the decoder needs
+ */
+struct ApiClient::DecodedCustomers
+{
+    bool fullList = true;              // GET /api/customers (else a page)
+    int cursor = 0;                    // Page requested
+    bool materialize = false;          // Build QList<Customer> for the old signals
+    bool cbor = false;                 // application/cbor body
+    bool sync = false;                 // Delta sync response (fullList is false)
+    bool deltaSync = false;            // Sync with tombstones (else a complete one)
+    QString snapshotPath;              // Empty = no snapshot
+    QByteArray etag;
+    QByteArray lastModified;
+    
+    CustomerView::ParseResult result;
+    QList<Customer> customers;
+    bool snapshotSaved = false;
+    qint64 decodeNs = 0;
+};
+
+/**
+ * State of the running bulk import
+ */
+struct ApiClient::ImportJob
+{
+    struct Batch {
+        QList<Customer> customers;
+        QList<int> items;        // List index or file line of each customer
+        bool batchRequest;       // Sent to /api/customers/batch
+    };
+    
+    QList<Customer> queue;       // Rows not sent yet (list import, or resent rows)
+    QList<int> queueItems;
+    QSharedPointer<CustomerImportReader> reader;
+    QHash<QNetworkReply*, Batch> inFlight;
+    int itemsRead = 0;           // Rows taken from the file so far
+    int succeeded = 0;
+    int failed = 0;
+    int total = -1;              // -1 until the whole file has been read
+};
+
+/**
+ * Suspends a coroutine until its request has a result
+ * Lives in the coroutine's frame; the client keeps a pointer to it only
+ * while it is suspended, keyed by request id
+ */
+class ApiClient::RequestAwaiter
+{
+public:
+    RequestAwaiter(ApiClient *client, quint64 requestId, const CancellationToken &token)
+        : m_client(client)
+        , m_requestId(requestId)
+        , m_token(token)
+        , m_suspended(false)
+    {
+    }
+    RequestAwaiter(const RequestAwaiter &) = delete;
+    RequestAwaiter &operator=(const RequestAwaiter &) = delete;
+    
+    // Destroyed while suspended: the task was dropped (whenAny, or its owner)
+    ~RequestAwaiter()
+    {
+        if (m_suspended && m_client) {
+            detach();
+        }
+    }
+    
+    bool await_ready() const { return false; }
+    
+    bool await_suspend(std::coroutine_handle<> continuation)
+    {
+        if (m_token.isCancelled()) {
+            m_completion.error = ApiError::cancelled();
+            if (!m_client->m_awaiting.contains(m_requestId)) {
+                m_client->abortRequest(m_requestId);
+            }
+            return false;
+        }
+        
+        m_continuation = continuation;
+        m_suspended = true;
+        m_client->m_awaiting.insert(m_requestId, this);
+        m_client->watchRequest(m_requestId);
+        m_registration = m_token.onCancel([this]() { cancel(); });
+        return true;
+    }
+    
+    Completion await_resume() { return std::move(m_completion); }
+    
+    void resume(const Completion &completion)
+    {
+        m_suspended = false;
+        m_registration.reset();
+        m_completion = completion;
+        m_continuation.resume();
+    }
+    
+    // The client is being destroyed; the coroutine stays suspended
+    void orphan() { m_client = nullptr; }
+    
+private:
+    void cancel()
+    {
+        if (m_client) {
+            detach();
+        }
+        m_suspended = false;
+        m_completion.error = ApiError::cancelled();
+        m_continuation.resume();
+    }
+    
+    // Stop waiting; the request goes too unless another coroutine awaits it
+    void detach()
+    {
+        m_client->m_awaiting.remove(m_requestId, this);
+        if (!m_client->m_awaiting.contains(m_requestId)) {
+            m_client->abortRequest(m_requestId);
+        }
+    }
+    
+    ApiClient *m_client;
+    quint64 m_requestId;
+    CancellationToken m_token;
+    CancellationToken::Registration m_registration;
+    bool m_suspended;
+    Completion m_completion;
+    std::coroutine_handle<> m_continuation;
+};
 
 ApiClient::ApiClient(QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_networkManager(nullptr)
     , m_baseUrl("https://pankki-api-dcb8eubhg5c5eya6.swedencentral-01.azurewebsites.net")
+    , m_streamingEnabled(false)
+    , m_streamChunkSize(500)
+    , m_snapshotEnabled(false)
+    , m_coalescingEnabled(true)
+    , m_importMode(BatchImport)
+    , m_importWindow(4)
+    , m_importBatchSize(500)
+    , m_prewarmEnabled(true)
+    , m_prewarmScheduled(false)
+    , m_sessionActive(false)
+    , m_heartbeatBaseInterval(2 * 60 * 1000)   // Below Azure's 4 min idle connection timeout
+    , m_heartbeatMaxInterval(15 * 60 * 1000)   // Below App Service's 20 min sleep
+    , m_heartbeatTimer(new QTimer(this))
+    , m_metricsTimer(new QTimer(this))
+    , m_lastRequestId(0)
+    , m_asyncDecodeEnabled(true)
+    , m_asyncDecodeThreshold(64 * 1024)
+    , m_cborEnabled(true)
+    , m_decodePool(nullptr)
+    , m_syncWatermark(CustomerView::NoTimestamp)
+    , m_lookupBatchingEnabled(true)
+    , m_lookupTimer(new QTimer(this))
+    , m_customerCacheSize(CustomerCacheBytes)
+    , m_customerCacheMaxAge(CustomerCacheMaxAgeMs)
+    , m_customerCache(CustomerCacheBytes, CustomerCacheMaxAgeMs)
+    , m_concurrencyLimits{ { DefaultHostConcurrency, 4, 4 } }
+    , m_hostConcurrencyLimit(DefaultHostConcurrency)
+    , m_activeCounts{ { 0, 0, 0 } }
+    , m_dispatchScheduled(false)
+    , m_assignedPriority(NormalPriority)
+    , m_assignedQueuedNs(-1)
+    , m_rateLimitPacingEnabled(true)
+    , m_rateLimitTimer(new QTimer(this))
+    , m_writeBehindEnabled(false)
+    , m_journalSyncTimer(new QTimer(this))
+    , m_journalFlushTimer(new QTimer(this))
+    , m_journalRetryDelay(0)
+    , m_provisionalIdCounter(0)
+    , m_provisionalIds(&m_provisionalIdCounter)
+    , m_pushEnabled(false)
+    , m_eventStream(nullptr)
+    , m_eventStreamConnected(false)
+    , m_eventRetryMs(EventRetryMs)
+    , m_eventReconnectDelay(0)
+    , m_eventReconnectTimer(new QTimer(this))
+    , m_transport(nullptr)
+    , m_facade(nullptr)
+    , m_networkThread(nullptr)
+    , m_transportImporting(false)
+    , m_requestIdCounter(0)
+    , m_requestIds(&m_requestIdCounter)
+    , m_assignedRequestId(0)
 {
-    // Don't connect to finished signal here - we'll connect per-reply
     qDebug() << "ApiClient initialized with base URL:" << m_baseUrl;
+    
+    // Metrics are recorded by index; routes sharing a method and pattern share an entry
+    for (const RouteSpec &spec : Routes) {
+        m_routeMetrics[spec.route] = m_metrics.addEndpoint(QLatin1String(spec.method), QLatin1String(spec.pattern));
+    }
+    m_eventStreamMetrics = m_metrics.addEndpoint(QStringLiteral("GET"), QStringLiteral("/api/customers/events"));
+    
+    connect(m_metricsTimer, &QTimer::timeout, this, &ApiClient::requestMetrics);
+    
+    m_clock.start();
+    m_heartbeatTimer->setSingleShot(true);
+    connect(m_heartbeatTimer, &QTimer::timeout, this, &ApiClient::onHeartbeat);
+    
+    m_journalSyncTimer->setSingleShot(true);
+    m_journalSyncTimer->setInterval(JournalSyncMs);
+    connect(m_journalSyncTimer, &QTimer::timeout, this, [this]() {
+        if (m_journal) {
+            m_journal->sync();
+        }
+    });
+    m_journalFlushTimer->setSingleShot(true);
+    connect(m_journalFlushTimer, &QTimer::timeout, this, &ApiClient::flushJournal);
+    
+    // The cache follows every change this client reports (in network
+    // thread mode the transport has the cache and keeps it current)
+    connect(this, &ApiClient::customerCreated, this, [this](const Customer &customer) {
+        if (!m_transport) {
+            m_customerCache.insert(customer, m_clock.elapsed());
+        }
+    });
+    connect(this, &ApiClient::customerUpdated, this, [this](const Customer &customer) {
+        if (!m_transport) {
+            m_customerCache.insert(customer, m_clock.elapsed());
+        }
+    });
+    connect(this, &ApiClient::customerIdAssigned, this, [this](int provisionalId, const Customer &customer) {
+        if (!m_transport) {
+            m_customerCache.remove(provisionalId);
+            m_customerCache.insert(customer, m_clock.elapsed());
+        }
+    });
+    connect(this, &ApiClient::customerDeleted, this, [this](int id) {
+        if (!m_transport) {
+            m_customerCache.remove(id);
+        }
+    });
+    
+    m_lookupTimer->setSingleShot(true);
+    m_lookupTimer->setInterval(0);
+    connect(m_lookupTimer, &QTimer::timeout, this, &ApiClient::flushLookups);
+    
+    m_rateLimitTimer->setSingleShot(true);
+    connect(m_rateLimitTimer, &QTimer::timeout, this, &ApiClient::scheduleDispatch);
+    
+    m_eventReconnectTimer->setSingleShot(true);
+    connect(m_eventReconnectTimer, &QTimer::timeout, this, &ApiClient::openEventStream);
+    
+    // Network thread mode: importFinished arrives from the transport
+    connect(this, &ApiClient::importFinished, this, [this]() {
+        m_transportImporting = false;
+    });
+    
+    // Deferred so the owner can still call setBaseUrl() / setPrewarmEnabled()
+    schedulePrewarm();
 }
 
 ApiClient::~ApiClient()
 {
+    setNetworkThreadEnabled(false);
+    
+    // Decode tasks post their results to this object
+    if (m_decodePool) {
+        m_decodePool->waitForDone();
+    }
+    
+    // Tasks still waiting must not be resumed or destroyed through this client
+    for (RequestAwaiter *awaiter : std::as_const(m_awaiting)) {
+        awaiter->orphan();
+    }
 }
 
-void ApiClient::setBaseUrl(const QString &url)
+/**
+ * Start or stop network thread mode
+ * Enabling creates the transport client with this client's settings
+ * (base URL, snapshot validators, heartbeat), customer cache and metrics
+ * and moves it to a new thread; disabling stops the thread, which hands
+ * them back and deletes the transport
+ *
+ * @param enabled - true to run the transport on its own thread
+ */
+void ApiClient::setNetworkThreadEnabled(bool enabled)
 {
-    m_baseUrl = url;
-    qDebug() << "Base URL changed to:" << m_baseUrl;
+    if (enabled == isNetworkThreadEnabled()) {
+        return;
+    }
+    
+    if (!enabled) {
+        // Waits only for the event being handled there; the transport's
+        // state comes back as the thread finishes
+        m_networkThread->quit();
+        m_networkThread->wait();
+        delete m_networkThread;
+        m_networkThread = nullptr;
+        m_transport = nullptr;
+        m_transportImporting = false;
+        m_transportMetrics = ApiMetrics();
+        qDebug() << "Network thread stopped";
+        
+        // Awaited requests went down with the transport (results it
+        // posted before stopping are still delivered first)
+        for (quint64 requestId : m_awaiting.uniqueKeys()) {
+            QMetaObject::invokeMethod(this, [this, requestId]() {
+                resumeAwaiting(requestId, { ApiError::cancelled(), {} });
+            }, Qt::QueuedConnection);
+        }
+        
+        // The transport closed its journal when it was deleted
+        if (m_writeBehindEnabled) {
+            openJournal();
+        }
+        if (m_sessionActive) {
+            m_heartbeatTimer->start(m_heartbeatBaseInterval);
+        }
+        if (m_pushEnabled) {
+            openEventStream();
+        }
+        if (m_metricsTimer->interval() > 0) {
+            m_metricsTimer->start();
+        }
+        return;
+    }
+    
+    // One journal file, one owner: it moves to the transport
+    closeJournal();
+    closeEventStream();
+    
+    // Still owned by this thread until moveToThread(), so set up directly
+    ApiClient *transport = new ApiClient();
+    transport->m_prewarmScheduled = false;  // Rescheduled below with our settings
+    transport->m_facade = this;
+    transport->m_requestIds = &m_requestIdCounter;
+    transport->m_provisionalIds = &m_provisionalIdCounter;
+    transport->m_writeBehindEnabled = m_writeBehindEnabled;
+    transport->m_pushEnabled = m_pushEnabled;
+    transport->m_lastEventId = m_lastEventId;
+    transport->m_baseUrl = m_baseUrl;
+    transport->m_snapshotEtag = m_snapshotEtag;
+    transport->m_snapshotLastModified = m_snapshotLastModified;
+    transport->m_heartbeatBaseInterval = m_heartbeatBaseInterval;
+    transport->m_heartbeatMaxInterval = m_heartbeatMaxInterval;
+    transport->m_metrics = m_metrics;
+    transport->m_customerCache = std::move(m_customerCache);
+    m_customerCache.clear();
+    m_transportMetrics = m_metrics;
+    m_transport = transport;
+    
+    m_networkThread = new QThread(this);
+    m_networkThread->setObjectName("ApiClient network");
+    
+    // Runs on the network thread as it finishes, while disabling waits for
+    // it: the push stream resumes, and cache and metrics carry on, here
+    connect(m_networkThread, &QThread::finished, transport, [this, transport]() {
+        m_lastEventId = transport->m_lastEventId;
+        m_customerCache = std::move(transport->m_customerCache);
+        m_metrics = transport->m_metrics;
+    }, Qt::DirectConnection);
+    connect(m_networkThread, &QThread::finished, transport, &QObject::deleteLater);
+    
+    // Snapshots taken there; metrics() returns the latest
+    connect(transport, &ApiClient::metricsUpdated, this, [this](const ApiMetrics &metrics) {
+        m_transportMetrics = metrics;
+    });
+    
+    // Re-emit the transport's signals that already have receivers here;
+    // connectNotify() adds the rest as they get connected
+    const QMetaObject &meta = staticMetaObject;
+    for (int i = meta.methodOffset(); i < meta.methodCount(); ++i) {
+        const QMetaMethod method = meta.method(i);
+        if (method.methodType() == QMetaMethod::Signal && isSignalConnected(method)) {
+            forwardSignal(method);
+        }
+    }
+    
+    // Queued calls run in order once the thread starts
+    syncTransport();
+    forwardToTransport([](ApiClient *transport) {
+        transport->schedulePrewarm();
+    });
+    m_prewarmScheduled = false;
+    if (m_writeBehindEnabled) {
+        forwardToTransport([](ApiClient *transport) {
+            transport->openJournal();
+        });
+    }
+    if (m_sessionActive) {
+        m_heartbeatTimer->stop();
+        forwardToTransport([](ApiClient *transport) {
+            transport->setSessionActive(true);
+        });
+    }
+    if (m_pushEnabled) {
+        forwardToTransport([](ApiClient *transport) {
+            transport->openEventStream();
+        });
+    }
+    if (m_metricsTimer->interval() > 0) {
+        m_metricsTimer->stop();
+        forwardToTransport([intervalMs = m_metricsTimer->interval()](ApiClient *transport) {
+            transport->setMetricsInterval(intervalMs);
+        });
+    }
+    
+    transport->moveToThread(m_networkThread);
+    m_networkThread->start();
+    qDebug() << "Network thread started";
 }
 
-// Customer endpoints implementation
-void ApiClient::getAllCustomers()
+/**
+ * Network thread mode: connect the transport's signal to the same signal
+ * here on first use, so the transport still sees which signals have
+ * receivers (e.g. Customer lists are only built when someone wants them)
+ */
+void ApiClient::connectNotify(const QMetaMethod &signal)
 {
-    qDebug() << "getAllCustomers() called";
-    sendGetRequest("/api/customers");
+    if (m_transport && signal.enclosingMetaObject() == &staticMetaObject) {
+        forwardSignal(signal);
+    }
 }
 
-void ApiClient::getCustomerById(int id)
+void ApiClient::forwardSignal(const QMetaMethod &signal)
 {
-    qDebug() << "getCustomerById() called with id:" << id;
-    sendGetRequest(QString("/api/customers/%1").arg(id));
+    connect(m_transport, signal, this, signal, Qt::UniqueConnection);
 }
 
-void ApiClient::createCustomer(const Customer &customer)
+/**
+ * Network thread mode: run a call on the transport's thread
+ *
+ * @return bool - false in normal mode (the caller does the work itself)
+ */
+template<typename Call>
+bool ApiClient::forwardToTransport(Call call)
 {
-    qDebug() << "createCustomer() called";
-    QJsonObject json = customer.toJson();
-    json.remove("id");
-    json.remove("createdAt");
-    json.remove("updatedAt");
-    sendPostRequest("/api/customers", json);
+    if (!m_transport) {
+        return false;
+    }
+    
+    ApiClient *transport = m_transport;
+    QMetaObject::invokeMethod(transport, [transport, call]() {
+        call(transport);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+/**
+ * Network thread mode: forward a call that sends one request
+ * The request id is reserved here, so lastRequestId() is valid as soon
+ * as the call returns
+ */
+template<typename Call>
+bool ApiClient::forwardRequest(Call call)
+{
+    if (!m_transport) {
+        return false;
+    }
+    
+    const quint64 requestId = nextRequestId();
+    m_lastRequestId = requestId;
+    return forwardToTransport([requestId, call](ApiClient *transport) {
+        transport->m_assignedRequestId = requestId;
+        call(transport);
+        transport->m_assignedRequestId = 0;
+    });
+}
+
+/**
+ * Network manager, created on first use (a facade never sends anything)
+ * Every reply finishes through it; instrumentReply() only connects the
+ * per-phase signals the manager does not forward
+ */
+QNetworkAccessManager *ApiClient::networkManager()
+{
+    if (!m_networkManager) {
+        m_networkManager = new QNetworkAccessManager(this);
+        connect(m_networkManager, &QNetworkAccessManager::finished, this, &ApiClient::onReplyFinished);
+        connect(m_networkManager, &QNetworkAccessManager::encrypted, this, &ApiClient::onReplyEncrypted);
+    }
+    return m_networkManager;
+}
+
+/**
+ * Worker pool for off-thread decoding, created on first use
+ */
+QThreadPool *ApiClient::decodePool()
+{
+    if (!m_decodePool) {
+        m_decodePool = new QThreadPool(this);
+    }
+    return m_decodePool;
+}
+
+/**
+ * Allocate a provisional (negative) customer id for a write-behind create;
+ * the facade and its transport share the counter
+ */
+int ApiClient::nextProvisionalId()
+{
+    return m_provisionalIds->fetchAndAddRelaxed(-1) - 1;
+}
+
+/**
+ * Network thread mode: copy the plain settings to the transport
+ * Called by the inline setters; does nothing in normal mode
+ */
+void ApiClient::syncTransport()
+{
+    forwardToTransport([streaming = m_streamingEnabled, chunkSize = m_streamChunkSize,
+                        coalescing = m_coalescingEnabled, asyncDecode = m_asyncDecodeEnabled,
+                        asyncThreshold = m_asyncDecodeThreshold, snapshot = m_snapshotEnabled,
+                        importMode = m_importMode, importWindow = m_importWindow,
+                        importBatchSize = m_importBatchSize, prewarm = m_prewarmEnabled,
+                        cbor = m_cborEnabled, limits = m_concurrencyLimits,
+                        hostLimit = m_hostConcurrencyLimit, lookupBatching = m_lookupBatchingEnabled,
+                        rateLimitPacing = m_rateLimitPacingEnabled](ApiClient *transport) {
+        transport->m_streamingEnabled = streaming;
+        transport->m_streamChunkSize = chunkSize;
+        transport->m_coalescingEnabled = coalescing;
+        transport->m_asyncDecodeEnabled = asyncDecode;
+        transport->m_asyncDecodeThreshold = asyncThreshold;
+        transport->m_snapshotEnabled = snapshot;
+        transport->m_importMode = importMode;
+        transport->m_importWindow = importWindow;
+        transport->m_importBatchSize = importBatchSize;
+        transport->m_prewarmEnabled = prewarm;
+        transport->m_cborEnabled = cbor;
+        transport->m_concurrencyLimits = limits;
+        transport->m_hostConcurrencyLimit = hostLimit;
+        transport->m_lookupBatchingEnabled = lookupBatching;
+        transport->m_rateLimitPacingEnabled = rateLimitPacing;
+        transport->scheduleDispatch();
+    });
+}
+
+/**
+ * Allocate a request id; the facade and its transport share the counter
+ */
+quint64 ApiClient::nextRequestId()
+{
+    return m_requestIds->fetchAndAddRelaxed(1) + 1;
+}
+
+/**
+ * Concurrency limit of a priority class
+ *
+ * @param priority - Class to limit
+ * @param requests - Requests of the class in flight at once (at least 1)
+ */
+void ApiClient::setConcurrencyLimit(RequestPriority priority, int requests)
+{
+    m_concurrencyLimits[priority] = qMax(1, requests);
+    syncTransport();
+    scheduleDispatch();
+}
+
+/**
+ * Requests in flight per host, all classes together
+ * Normal and background requests use at most one less (at least one)
+ */
+void ApiClient::setHostConcurrencyLimit(int requests)
+{
+    m_hostConcurrencyLimit = qMax(1, requests);
+    syncTransport();
+    scheduleDispatch();
+}
+
+/**
+ * Start or stop spending the server's rate limit budget by class
+ * Disabled, requests only wait for a free slot (the budget is still tracked)
+ *
+ * @param enabled - true to defer requests the server would reject
+ */
+void ApiClient::setRateLimitPacingEnabled(bool enabled)
+{
+    m_rateLimitPacingEnabled = enabled;
+    syncTransport();
+    scheduleDispatch();
+}
+
+void ApiClient::abortRequests(RequestPriority priority)
+{
+    if (forwardToTransport([priority](ApiClient *transport) { transport->abortRequests(priority); })) {
+        return;
+    }
+    
+    QList<ScheduledRequest> dropped;
+    for (auto it = m_scheduledRequests.begin(); it != m_scheduledRequests.end(); ) {
+        if (it->priority == priority) {
+            dropped.append(*it);
+            it = m_scheduledRequests.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    QList<QNetworkReply*> running;
+    for (auto it = m_requests.cbegin(); it != m_requests.cend(); ++it) {
+        if (it->priority == priority && !isBulkRoute(it->context.route)) {
+            running.append(it.key());
+        }
+    }
+    
+    qDebug() << "Aborting" << dropped.count() << "queued and" << running.count() << "running requests, class" << priority;
+    for (const ScheduledRequest &request : dropped) {
+        cancelScheduled(request);
+    }
+    
+    for (QNetworkReply *reply : running) {
+        abortReply(reply);
+    }
+}
+
+/**
+ * Drop or abort the request behind one call
+ * Only requests nobody else is waiting for are touched: a caller merged
+ * into another request is detached from it, a request with merged
+ * callers keeps going. Callers sharing a reply's own id (coalesced GETs
+ * without an id of their own) are counted by its RequestState::waiters.
+ *
+ * @param requestId - Id from lastRequestId()
+ */
+void ApiClient::abortRequest(quint64 requestId)
+{
+    if (forwardToTransport([requestId](ApiClient *transport) { transport->abortRequest(requestId); })) {
+        return;
+    }
+    
+    // Lookup not batched yet
+    for (qsizetype i = 0; i < m_pendingLookups.count(); ++i) {
+        if (m_pendingLookups.at(i).second == requestId) {
+            m_pendingLookups.removeAt(i);
+            emit requestFinished(requestId, 0, QNetworkReply::OperationCanceledError);
+            completeAwaited(requestId, { ApiError::cancelled(), {} });
+            return;
+        }
+    }
+    
+    for (qsizetype i = 0; i < m_scheduledRequests.count(); ++i) {
+        ScheduledRequest &request = m_scheduledRequests[i];
+        if (request.aliasIds.removeOne(requestId)) {
+            emit requestFinished(requestId, 0, QNetworkReply::OperationCanceledError);
+            completeAwaited(requestId, { ApiError::cancelled(), {} });
+            return;
+        }
+        if (request.requestId == requestId) {
+            if (request.aliasIds.isEmpty()) {
+                cancelScheduled(m_scheduledRequests.takeAt(i));
+            }
+            return;
+        }
+    }
+    
+    // In flight: the caller stops waiting; the last one aborts the reply
+    QNetworkReply *reply = m_replies.value(requestId);
+    if (!reply) {
+        return;
+    }
+    RequestState &state = m_requests[reply];
+    const bool alias = state.aliasIds.removeOne(requestId);
+    if (alias) {
+        m_replies.remove(requestId);
+    } else {
+        --state.waiters;
+    }
+    const bool unwanted = state.aliasIds.isEmpty() && state.waiters <= 0 && !isBulkRoute(state.context.route);
+    
+    if (alias) {
+        emit requestFinished(requestId, 0, QNetworkReply::OperationCanceledError);
+        completeAwaited(requestId, { ApiError::cancelled(), {} });
+    }
+    if (unwanted) {
+        qDebug() << "Aborting request" << requestId;
+        abortReply(reply);
+    }
+}
+
+/**
+ * Abort a reply on purpose: it finishes right away and onReplyFinished()
+ * drops it instead of reporting an error
+ */
+void ApiClient::abortReply(QNetworkReply *reply)
+{
+    const auto it = m_requests.find(reply);
+    if (it != m_requests.end()) {
+        it->cancelled = true;
+    }
+    reply->abort();
+}
+
+QString ApiClient::hostKey(const QUrl &url)
+{
+    return url.host() + ':' + QString::number(url.port(url.scheme() == "https" ? 443 : 80));
+}
+
+/**
+ * Whether a request of a class may start on a host now
+ * Besides the class and host limits, normal and background requests
+ * leave the host's last slot free and wait while a more urgent request
+ * is queued for the same host
+ *
+ * @param rateLimited - false for requests the server's rate limit skips
+ */
+bool ApiClient::canStart(RequestPriority priority, const QString &host, bool rateLimited) const
+{
+    if (m_activeCounts[priority] >= m_concurrencyLimits[priority]) {
+        return false;
+    }
+    if (rateLimited && rateLimitDelay(priority, host) > 0) {
+        return false;
+    }
+    
+    const int hostLimit = priority == InteractivePriority ? m_hostConcurrencyLimit
+                                                          : qMax(1, m_hostConcurrencyLimit - 1);
+    if (m_activeHostCounts.value(host) >= hostLimit) {
+        return false;
+    }
+    
+    for (const ScheduledRequest &queued : m_scheduledRequests) {
+        if (queued.priority < priority && queued.host == host) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Windowed jobs (import, journal replay): may another request go out now?
+ */
+bool ApiClient::hasRequestSlot(RequestPriority priority) const
+{
+    return canStart(priority, hostKey(QUrl(m_baseUrl)));
+}
+
+/**
+ * Send a request now if its class and host have a free slot, else queue it
+ * The request id is reserved here, so lastRequestId() is valid right away
+ *
+ * @param priority - Priority class
+ * @param send     - Issues the request (one send*Request call)
+ * @param key      - "GET <endpoint>" to merge with an identical queued GET
+ * @param rateLimited - false for requests the server's rate limit skips
+ * @param aliasIds - Callers already merged into this request (batched lookups)
+ */
+void ApiClient::schedule(RequestPriority priority, std::function<void()> send, const QString &key,
+                         bool rateLimited, const QList<quint64> &aliasIds)
+{
+    const quint64 requestId = m_assignedRequestId ? m_assignedRequestId : nextRequestId();
+    m_assignedRequestId = 0;
+    m_lastRequestId = requestId;
+    
+    // Join an identical queued GET; a more urgent caller moves it up
+    if (m_coalescingEnabled && !key.isEmpty()) {
+        for (qsizetype i = 0; i < m_scheduledRequests.count(); ++i) {
+            if (m_scheduledRequests.at(i).key != key) {
+                continue;
+            }
+            ScheduledRequest request = m_scheduledRequests.takeAt(i);
+            request.aliasIds.append(requestId);
+            request.aliasIds.append(aliasIds);
+            if (priority < request.priority) {
+                request.priority = priority;
+                m_scheduledRequests.append(request);
+                scheduleDispatch();
+            } else {
+                m_scheduledRequests.insert(i, request);
+            }
+            qDebug() << "Joined queued" << key;
+            return;
+        }
+    }
+    
+    ScheduledRequest request { priority, hostKey(QUrl(m_baseUrl)), key, requestId, aliasIds,
+                               m_clock.nsecsElapsed(), std::move(send), rateLimited };
+    if (canStart(priority, request.host, rateLimited)) {
+        startScheduled(request);
+        return;
+    }
+    
+    m_scheduledRequests.append(request);
+    armRateLimitTimer();
+    qDebug() << "Request queued, class" << priority << "-" << m_scheduledRequests.count() << "waiting";
+}
+
+/**
+ * GETs that can join an identical request in flight take no slot
+ */
+void ApiClient::scheduleGet(RequestPriority priority, const RequestContext &context)
+{
+    const QString key = "GET " + context.endpoint;
+    if (m_coalescingEnabled && m_inFlightGets.contains(key)) {
+        sendGetRequest(context);
+        return;
+    }
+    schedule(priority, [this, context]() { sendGetRequest(context); }, key, context.route != HealthRoute);
+}
+
+void ApiClient::startScheduled(const ScheduledRequest &request)
+{
+    // GETs merged while queued are reported with the reply that answers them
+    m_assignedRequestId = request.requestId;
+    m_assignedAliasIds = request.aliasIds;
+    m_assignedPriority = request.priority;
+    m_assignedQueuedNs = request.queuedNs;
+    request.send();
+    m_assignedRequestId = 0;
+    m_assignedAliasIds.clear();
+    m_assignedPriority = NormalPriority;
+    m_assignedQueuedNs = -1;
+}
+
+/**
+ * A slot was freed (or a limit raised): dispatch from the event loop,
+ * after the finished reply has been handled
+ */
+void ApiClient::scheduleDispatch()
+{
+    if (!m_dispatchScheduled) {
+        m_dispatchScheduled = true;
+        QMetaObject::invokeMethod(this, &ApiClient::dispatchScheduled, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * Start queued requests, most urgent class first, while slots are free;
+ * then let the windowed background jobs fill what is left
+ */
+void ApiClient::dispatchScheduled()
+{
+    m_dispatchScheduled = false;
+    
+    for (int priority = InteractivePriority; priority < PriorityCount; ++priority) {
+        for (qsizetype i = 0; i < m_scheduledRequests.count(); ) {
+            const ScheduledRequest &queued = m_scheduledRequests.at(i);
+            if (queued.priority != priority || !canStart(queued.priority, queued.host, queued.rateLimited)) {
+                ++i;
+                continue;
+            }
+            startScheduled(m_scheduledRequests.takeAt(i));
+        }
+    }
+    
+    if (m_import) {
+        pumpImport();
+    }
+    if (m_journal && !m_journalFlushTimer->isActive()) {
+        flushJournal();
+    }
+    armRateLimitTimer();
+}
+
+/**
+ * A queued request will not be sent; report it like an aborted one
+ */
+void ApiClient::cancelScheduled(const ScheduledRequest &request)
+{
+    emit requestFinished(request.requestId, 0, QNetworkReply::OperationCanceledError);
+    completeAwaited(request.requestId, { ApiError::cancelled(), {} });
+    for (quint64 aliasId : request.aliasIds) {
+        emit requestFinished(aliasId, 0, QNetworkReply::OperationCanceledError);
+        completeAwaited(aliasId, { ApiError::cancelled(), {} });
+    }
+}
+
+/**
+ * How long a request of a class has to wait for the host's rate limit
+ * Interactive requests may spend the whole budget, the others leave a
+ * reserve, and background ones start no faster than the rest of their
+ * budget lasts until the window resets
+ *
+ * @return qint64 - Nanoseconds, 0 if the request may start now
+ */
+qint64 ApiClient::rateLimitDelay(RequestPriority priority, const QString &host) const
+{
+    const auto it = m_rateLimits.constFind(host);
+    if (!m_rateLimitPacingEnabled || it == m_rateLimits.cend()) {
+        return 0;
+    }
+    
+    const RateLimitBucket &bucket = *it;
+    const qint64 now = m_clock.nsecsElapsed();
+    if (now < bucket.blockedUntilNs) {
+        return bucket.blockedUntilNs - now;
+    }
+    if (bucket.limit < 0 || now >= bucket.resetNs) {
+        return 0;  // No budget reported yet, or a fresh window
+    }
+    
+    const int reserve = priority == InteractivePriority ? 0 : qMax(1, bucket.limit / RateLimitReserveDivisor);
+    if (bucket.remaining <= reserve) {
+        return bucket.resetNs - now;
+    }
+    if (priority == BackgroundPriority && now < bucket.nextBackgroundNs) {
+        return bucket.nextBackgroundNs - now;
+    }
+    return 0;
+}
+
+/**
+ * A rate limited request was sent: take it from the host's budget
+ * (a lapsed window starts over with the full limit) and pace the next
+ * background request
+ */
+void ApiClient::rateLimitStarted(RequestPriority priority, const QString &host)
+{
+    RateLimitBucket &bucket = m_rateLimits[host];
+    ++bucket.inFlight;
+    if (bucket.limit < 0) {
+        return;
+    }
+    
+    const qint64 now = m_clock.nsecsElapsed();
+    if (now >= bucket.resetNs && bucket.windowNs > 0) {
+        bucket.remaining = bucket.limit;
+        bucket.resetNs = now + bucket.windowNs;
+    }
+    if (now < bucket.resetNs && priority == BackgroundPriority) {
+        const int budget = bucket.remaining - qMax(1, bucket.limit / RateLimitReserveDivisor);
+        bucket.nextBackgroundNs = now + (bucket.resetNs - now) / qMax(1, budget);
+    }
+    bucket.remaining = qMax(0, bucket.remaining - 1);
+}
+
+/**
+ * Take the host's budget from a response (RateLimit-* headers; the
+ * requests still in flight are deducted) and honour Retry-After
+ * Called when the headers arrive and again when the reply finishes;
+ * only the first call counts
+ */
+void ApiClient::updateRateLimit(QNetworkReply *reply, RequestState &state)
+{
+    if (!state.rateLimitPending) {
+        return;
+    }
+    state.rateLimitPending = false;
+    
+    RateLimitBucket &bucket = m_rateLimits[hostKey(reply->url())];
+    bucket.inFlight = qMax(0, bucket.inFlight - 1);
+    const qint64 now = m_clock.nsecsElapsed();
+    
+    bool limitOk = false;
+    bool remainingOk = false;
+    bool resetOk = false;
+    const int limit = reply->rawHeader("RateLimit-Limit").toInt(&limitOk);
+    const int remaining = reply->rawHeader("RateLimit-Remaining").toInt(&remainingOk);
+    const qint64 resetNs = now + reply->rawHeader("RateLimit-Reset").toLongLong(&resetOk) * 1000000000;
+    if (limitOk && remainingOk && resetOk) {
+        // Responses of one window may arrive out of order: keep the lowest
+        // count (the reset is rounded to whole seconds)
+        const int available = qMax(0, remaining - bucket.inFlight);
+        const bool sameWindow = bucket.limit >= 0 && now < bucket.resetNs && resetNs < bucket.resetNs + 1000000000;
+        bucket.remaining = sameWindow ? qMin(bucket.remaining, available) : available;
+        bucket.limit = limit;
+        bucket.resetNs = resetNs;
+        
+        // "100;w=900"
+        for (const QByteArray &parameter : reply->rawHeader("RateLimit-Policy").split(';')) {
+            if (parameter.trimmed().startsWith("w=")) {
+                bucket.windowNs = parameter.trimmed().mid(2).toLongLong() * 1000000000;
+            }
+        }
+    }
+    
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus != 429 && httpStatus != 503) {
+        return;
+    }
+    
+    qint64 waitNs = retryAfterNs(reply->rawHeader("Retry-After"));
+    if (httpStatus == 429) {
+        bucket.remaining = 0;
+        if (waitNs < 0) {
+            waitNs = bucket.resetNs > now ? bucket.resetNs - now : qint64(RateLimitRetryMs) * 1000000;
+        }
+    }
+    if (waitNs > 0 && now + waitNs > bucket.blockedUntilNs) {
+        bucket.blockedUntilNs = now + waitNs;
+        qDebug() << "Rate limited by" << reply->url().host() << "- holding requests for" << waitNs / 1000000 << "ms";
+        emit rateLimited(timerMs(waitNs));
+        armRateLimitTimer();
+    }
+}
+
+/**
+ * Wake the dispatcher when the first request held back by a rate limit
+ * may start (queued requests, import and journal replay)
+ */
+void ApiClient::armRateLimitTimer()
+{
+    qint64 waitNs = 0;
+    auto consider = [this, &waitNs](RequestPriority priority, const QString &host) {
+        const qint64 delay = rateLimitDelay(priority, host);
+        if (delay > 0 && (waitNs == 0 || delay < waitNs)) {
+            waitNs = delay;
+        }
+    };
+    
+    for (const ScheduledRequest &queued : std::as_const(m_scheduledRequests)) {
+        if (queued.rateLimited) {
+            consider(queued.priority, queued.host);
+        }
+    }
+    if (m_import || (m_journal && m_journal->pendingCount() > 0)) {
+        consider(BackgroundPriority, hostKey(QUrl(m_baseUrl)));
+    }
+    
+    if (waitNs > 0) {
+        m_rateLimitTimer->start(timerMs(waitNs));
+    }
+}
+
+ApiMetrics ApiClient::metrics() const
+{
+    if (m_transport) {
+        return m_transportMetrics;
+    }
+    
+    ApiMetrics snapshot = m_metrics;
+    snapshot.setCacheStats(m_customerCache.stats());
+    return snapshot;
+}
+
+/**
+ * Emit a metrics snapshot through metricsUpdated (taken on the network
+ * thread in network thread mode, the signal comes back queued)
+ */
+void ApiClient::requestMetrics()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->requestMetrics(); })) {
+        return;
+    }
+    emit metricsUpdated(metrics());
+}
+
+/**
+ * Publish a metrics snapshot periodically
+ *
+ * @param intervalMs - Interval in milliseconds, 0 to stop
+ */
+void ApiClient::setMetricsInterval(int intervalMs)
+{
+    m_metricsTimer->setInterval(qMax(0, intervalMs));  // Kept here too for switching modes
+    m_metricsTimer->stop();
+    if (forwardToTransport([intervalMs](ApiClient *transport) { transport->setMetricsInterval(intervalMs); })) {
+        return;
+    }
+    if (intervalMs > 0) {
+        m_metricsTimer->start();
+    }
+}
+
+void ApiClient::resetMetrics()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->resetMetrics(); })) {
+        return;
+    }
+    m_metrics.clear();
+    m_customerCache.resetStats();
+}
+
+/**
+ * Memory bound of the customer cache; least recently used customers are
+ * evicted to meet it
+ *
+ * @param bytes - Bound in bytes, 0 to disable the cache
+ */
+void ApiClient::setCustomerCacheSize(qsizetype bytes)
+{
+    m_customerCacheSize = qMax<qsizetype>(0, bytes);
+    if (forwardToTransport([bytes](ApiClient *transport) { transport->setCustomerCacheSize(bytes); })) {
+        return;
+    }
+    m_customerCache.setMaxBytes(m_customerCacheSize);
+}
+
+/**
+ * Age after which a cached customer is revalidated when served
+ *
+ * @param ms - Max age in milliseconds
+ */
+void ApiClient::setCustomerCacheMaxAge(int ms)
+{
+    m_customerCacheMaxAge = qMax(0, ms);
+    if (forwardToTransport([ms](ApiClient *transport) { transport->setCustomerCacheMaxAge(ms); })) {
+        return;
+    }
+    m_customerCache.setMaxAge(m_customerCacheMaxAge);
+}
+
+void ApiClient::clearCustomerCache()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->clearCustomerCache(); })) {
+        return;
+    }
+    m_customerCache.clear();
+}
+
+void ApiClient::setBaseUrl(const QString &url)
+{
+    m_baseUrl = url;
+    
+    // Validators belong to the snapshot of the previous base URL,
+    // and delta sync starts over against the new server
+    m_snapshotEtag.clear();
+    m_snapshotLastModified.clear();
+    m_syncWatermark = CustomerView::NoTimestamp;
+    m_syncRecent.clear();
+    qDebug() << "Base URL changed to:" << m_baseUrl;
+    
+    if (forwardToTransport([url](ApiClient *transport) { transport->setBaseUrl(url); })) {
+        return;
+    }
+    
+    // Customers of the previous server
+    m_customerCache.clear();
+    
+    // GETs still in flight answer for the previous server; new ones must
+    // not attach to them (the coalescing key has no host)
+    m_inFlightGets.clear();
+    
+    // Queued requests were meant for the previous server
+    const QList<ScheduledRequest> dropped = std::exchange(m_scheduledRequests, QList<ScheduledRequest>());
+    for (const ScheduledRequest &request : dropped) {
+        cancelScheduled(request);
+    }
+    
+    // Unsent mutations stay in the old server's journal
+    if (m_writeBehindEnabled) {
+        closeJournal();
+        openJournal();
+    }
+    
+    // Event ids are only meaningful to the server that issued them
+    m_lastEventId.clear();
+    if (m_pushEnabled) {
+        closeEventStream();
+        openEventStream();
+    }
+    schedulePrewarm();
+}
+
+/**
+ * Open the connection to the backend and wake it up
+ * Starts the TLS handshake (including DNS lookup) and sends a silent
+ * /health probe; the result is reported through prewarmFinished
+ */
+void ApiClient::prewarm()
+{
+    m_prewarmScheduled = false;
+    if (forwardToTransport([](ApiClient *transport) { transport->prewarm(); })) {
+        return;
+    }
+    
+    QUrl url(m_baseUrl);
+    qDebug() << "Pre-warming connection to" << url.host();
+    
+    if (url.scheme() == "https") {
+        networkManager()->connectToHostEncrypted(url.host(), url.port(443));
+    } else {
+        networkManager()->connectToHost(url.host(), url.port(80));
+    }
+    
+    schedule(NormalPriority, [this]() { sendProbe(true); }, QString(), false);
+}
+
+/**
+ * Start or stop the keep-alive heartbeat
+ * An ATM session starts when a customer begins using the machine;
+ * starting one pre-warms immediately so the first query is fast
+ *
+ * @param active - true while a session is in progress
+ */
+void ApiClient::setSessionActive(bool active)
+{
+    if (active == m_sessionActive) {
+        return;
+    }
+    
+    m_sessionActive = active;
+    qDebug() << "Session" << (active ? "started" : "ended");
+    
+    if (forwardToTransport([active](ApiClient *transport) { transport->setSessionActive(active); })) {
+        return;
+    }
+    if (active) {
+        if (m_prewarmEnabled) {
+            prewarm();
+        }
+        m_heartbeatTimer->start(m_heartbeatBaseInterval);
+    } else {
+        m_heartbeatTimer->stop();
+    }
+}
+
+/**
+ * Heartbeat timing
+ *
+ * @param baseMs - Probe interval after a request
+ * @param maxMs  - Longest interval while idle (keep below the server's sleep timeout)
+ */
+void ApiClient::setHeartbeatInterval(int baseMs, int maxMs)
+{
+    m_heartbeatBaseInterval = qMax(1000, baseMs);
+    m_heartbeatMaxInterval = qMax(m_heartbeatBaseInterval, maxMs);
+    
+    if (forwardToTransport([baseMs, maxMs](ApiClient *transport) { transport->setHeartbeatInterval(baseMs, maxMs); })) {
+        return;
+    }
+    if (m_heartbeatTimer->isActive()) {
+        m_heartbeatTimer->start(m_heartbeatBaseInterval);
+    }
+}
+
+/**
+ * Load the customer snapshot saved for the current base URL
+ * Emits snapshotLoaded (nothing if there is no snapshot) and remembers
+ * the validators used to revalidate the list on the next
+ * getAllCustomers() call
+ */
+void ApiClient::loadSnapshot()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->loadSnapshot(); })) {
+        return;
+    }
+    
+    CustomerSnapshot snapshot(CustomerSnapshot::pathForBaseUrl(m_baseUrl));
+    if (!snapshot.load()) {
+        qDebug() << "No customer snapshot for" << m_baseUrl;
+        return;
+    }
+    
+    m_snapshotEtag = snapshot.etag();
+    m_snapshotLastModified = snapshot.lastModified();
+    
+    qDebug() << "Loaded customer snapshot:" << snapshot.customers().count()
+             << "customers, saved" << snapshot.savedAt().toString(Qt::ISODate);
+    emit snapshotLoaded(snapshot.customers(), snapshot.savedAt());
+}
+
+// Customer endpoints implementation
+void ApiClient::getAllCustomers(RequestPriority priority)
+{
+    qDebug() << "getAllCustomers() called";
+    if (forwardRequest([priority](ApiClient *transport) { transport->getAllCustomers(priority); })) {
+        return;
+    }
+    scheduleGet(priority, { CustomersRoute, "/api/customers" });
+}
+
+void ApiClient::getCustomersPage(int limit, int cursor)
+{
+    qDebug() << "getCustomersPage() called with limit:" << limit << "cursor:" << cursor;
+    if (forwardRequest([limit, cursor](ApiClient *transport) { transport->getCustomersPage(limit, cursor); })) {
+        return;
+    }
+    scheduleGet(InteractivePriority, { .route = CustomersPageRoute,
+                                       .endpoint = QString("/api/customers?limit=%1&cursor=%2").arg(limit).arg(cursor),
+                                       .cursor = cursor });
+}
+
+/**
+ * Fetch the customers changed since the last sync (all of them the
+ * first time); the result is reported through customersSynced
+ */
+void ApiClient::syncCustomers(RequestPriority priority)
+{
+    qDebug() << "syncCustomers() called";
+    if (forwardRequest([priority](ApiClient *transport) { transport->syncCustomers(priority); })) {
+        return;
+    }
+    
+    // First sync: every live customer, no tombstones
+    if (m_syncWatermark == CustomerView::NoTimestamp) {
+        scheduleGet(priority, { SyncRoute, SyncEndpoint + QString("1970-01-01T00:00:00.000Z") });
+        return;
+    }
+    
+    const QDateTime since = QDateTime::fromMSecsSinceEpoch(m_syncWatermark - SyncOverlapMs, QTimeZone::UTC);
+    scheduleGet(priority, { .route = SyncRoute,
+                            .endpoint = SyncEndpoint + since.toString(Qt::ISODateWithMs) + "&includeDeleted=true",
+                            .deltaSync = true });
+}
+
+void ApiClient::resetSync()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->resetSync(); })) {
+        return;
+    }
+    m_syncWatermark = CustomerView::NoTimestamp;
+    m_syncRecent.clear();
+}
+
+void ApiClient::getCustomerById(int id)
+{
+    qDebug() << "getCustomerById() called with id:" << id;
+    if (forwardRequest([id](ApiClient *transport) { transport->getCustomerById(id); })) {
+        return;
+    }
+    
+    Customer cached;
+    const CustomerCache::Lookup lookup = m_customerCache.find(id, m_clock.elapsed(), &cached);
+    if (lookup != CustomerCache::Miss) {
+        const quint64 requestId = m_assignedRequestId ? m_assignedRequestId : nextRequestId();
+        m_assignedRequestId = 0;
+        m_lastRequestId = requestId;
+        QMetaObject::invokeMethod(this, [this, cached, requestId]() {
+            emit customerReceived(cached);
+            emit requestFinished(requestId, 0, QNetworkReply::NoError);
+            completeAwaited(requestId, { {}, { cached } });
+        }, Qt::QueuedConnection);
+        
+        // Stale-while-revalidate; lastRequestId() stays the caller's
+        if (lookup == CustomerCache::Stale && id > 0) {
+            qDebug() << "Revalidating cached customer" << id;
+            scheduleGet(BackgroundPriority, customerRequest(CustomerRoute, id));
+            m_lastRequestId = requestId;
+        }
+        return;
+    }
+    
+    // Provisional ids (write-behind) are not valid in ?ids=
+    if (!m_lookupBatchingEnabled || id < 1) {
+        scheduleGet(InteractivePriority, customerRequest(CustomerRoute, id));
+        return;
+    }
+    
+    // Collected until the end of this event loop pass
+    const quint64 requestId = m_assignedRequestId ? m_assignedRequestId : nextRequestId();
+    m_assignedRequestId = 0;
+    m_lastRequestId = requestId;
+    m_pendingLookups.append({ id, requestId });
+    if (!m_lookupTimer->isActive()) {
+        m_lookupTimer->start();
+    }
+}
+
+/**
+ * Send the getCustomerById() calls collected in one event loop pass
+ * A lone id keeps its own endpoint (and its 404); more go out in id order
+ * as batched lookups, each answering all of its callers' request ids
+ */
+void ApiClient::flushLookups()
+{
+    QMap<int, QList<quint64>> requestIds;
+    for (const auto &lookup : std::exchange(m_pendingLookups, {})) {
+        requestIds[lookup.first].append(lookup.second);
+    }
+    
+    if (requestIds.count() == 1) {
+        const RequestContext context = customerRequest(CustomerRoute, requestIds.firstKey());
+        for (quint64 requestId : requestIds.first()) {
+            m_assignedRequestId = requestId;
+            scheduleGet(InteractivePriority, context);
+        }
+        return;
+    }
+    
+    const QList<int> ids = requestIds.keys();
+    for (qsizetype start = 0; start < ids.count(); start += LookupBatchSize) {
+        const QList<int> batchIds = ids.mid(start, LookupBatchSize);
+        QStringList parts;
+        QList<quint64> aliasIds;
+        quint64 requestId = 0;
+        for (int id : batchIds) {
+            parts.append(QString::number(id));
+            for (quint64 callerId : requestIds.value(id)) {
+                if (!requestId) {
+                    requestId = callerId;
+                } else {
+                    aliasIds.append(callerId);
+                }
+            }
+        }
+        
+        const RequestContext context { .route = LookupRoute, .endpoint = LookupEndpoint + parts.join(','),
+                                       .customerIds = batchIds };
+        qDebug() << "Batched lookup of" << parts.count() << "customers";
+        m_assignedRequestId = requestId;
+        schedule(InteractivePriority, [this, context]() { sendGetRequest(context); }, QString(), true, aliasIds);
+    }
+}
+
+/**
+ * Awaitable getCustomerById()
+ *
+ * @param id    - Customer id
+ * @param token - Cancels the wait (and the request, unless shared)
+ * @return Task - The customer, or why there is none
+ */
+Task<ApiResult<Customer>> ApiClient::fetchCustomer(int id, CancellationToken token)
+{
+    if (token.isCancelled()) {
+        co_return ApiError::cancelled();
+    }
+    
+    getCustomerById(id);
+    RequestAwaiter awaiter(this, m_lastRequestId, token);
+    const Completion completion = co_await awaiter;
+    if (completion.error.isError()) {
+        co_return completion.error;
+    }
+    
+    // A batched lookup carries the other callers' customers too
+    for (const Customer &customer : completion.customers) {
+        if (customer.getId() == id) {
+            co_return customer;
+        }
+    }
+    co_return ApiError{ 404, QNetworkReply::ContentNotFoundError, QString("Customer %1 not found").arg(id) };
+}
+
+/**
+ * Awaitable lookup of several customers
+ * The lookups start together, so uncached ids share batched requests
+ *
+ * @param ids   - Customer ids (taken by value: the task may outlive the caller's list)
+ * @param token - Cancels every lookup
+ * @return Task - Customers found, in the order of ids; the first error
+ *                other than a missing customer
+ */
+Task<ApiResult<QList<Customer>>> ApiClient::fetchCustomers(QList<int> ids, CancellationToken token)
+{
+    std::vector<Task<ApiResult<Customer>>> lookups;
+    lookups.reserve(ids.count());
+    for (int id : std::as_const(ids)) {
+        lookups.push_back(fetchCustomer(id, token));
+    }
+    
+    Task<std::vector<ApiResult<Customer>>> all = whenAll(std::move(lookups));
+    const std::vector<ApiResult<Customer>> results = co_await all;
+    
+    QList<Customer> customers;
+    customers.reserve(ids.count());
+    for (const ApiResult<Customer> &result : results) {
+        if (result.isOk()) {
+            customers.append(result.value());
+        } else if (result.error().httpStatus != 404) {
+            co_return result.error();
+        }
+    }
+    co_return customers;
+}
+
+/**
+ * Hand the result of a request back once it is known
+ * Called right after the request has been made; results are produced
+ * later, from the event loop
+ */
+void ApiClient::watchRequest(quint64 requestId)
+{
+    if (forwardToTransport([requestId](ApiClient *transport) { transport->watchRequest(requestId); })) {
+        return;
+    }
+    m_awaitedRequests.insert(requestId);
+}
+
+/**
+ * Deliver the result of an awaited request to the client its caller
+ * awaits on (the facade in network thread mode); the coroutine resumes
+ * from the event loop, not inside the response handler
+ */
+void ApiClient::completeAwaited(quint64 requestId, const Completion &completion)
+{
+    if (!m_awaitedRequests.remove(requestId)) {
+        return;
+    }
+    
+    ApiClient *client = m_facade ? m_facade : this;
+    QMetaObject::invokeMethod(client, [client, requestId, completion]() {
+        client->resumeAwaiting(requestId, completion);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * Same result for every caller a reply answers
+ */
+void ApiClient::completeAwaited(QNetworkReply *reply, const Completion &completion)
+{
+    if (m_awaitedRequests.isEmpty()) {
+        return;
+    }
+    
+    const auto it = m_requests.constFind(reply);
+    if (it == m_requests.cend()) {
+        return;
+    }
+    const RequestState &state = *it;
+    completeAwaited(state.requestId, completion);
+    for (quint64 aliasId : state.aliasIds) {
+        completeAwaited(aliasId, completion);
+    }
+}
+
+void ApiClient::failAwaited(QNetworkReply *reply, const QString &message)
+{
+    if (m_awaitedRequests.isEmpty()) {
+        return;
+    }
+    
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    completeAwaited(reply, { { httpStatus, reply->error(), message }, {} });
+}
+
+/**
+ * Resume the coroutines waiting for a request
+ * A coroutine may destroy this client when it resumes
+ */
+void ApiClient::resumeAwaiting(quint64 requestId, const Completion &completion)
+{
+    QPointer<ApiClient> guard(this);
+    while (guard) {
+        RequestAwaiter *awaiter = m_awaiting.take(requestId);
+        if (!awaiter) {
+            break;
+        }
+        awaiter->resume(completion);
+    }
+}
+
+int ApiClient::createCustomer(const Customer &customer)
+{
+    qDebug() << "createCustomer() called";
+    if (m_writeBehindEnabled) {
+        const int provisionalId = nextProvisionalId();
+        if (!forwardToTransport([provisionalId, customer](ApiClient *transport) {
+                transport->journalMutation(CustomerJournal::CreateOperation, provisionalId, customer);
+            })) {
+            journalMutation(CustomerJournal::CreateOperation, provisionalId, customer);
+        }
+        return provisionalId;
+    }
+    
+    if (forwardRequest([customer](ApiClient *transport) { transport->createCustomer(customer); })) {
+        return 0;
+    }
+    const QJsonObject data = customerInput(customer);
+    schedule(InteractivePriority, [this, data]() { sendPostRequest({ CreateRoute, "/api/customers" }, data); });
+    return 0;
+}
+
+/**
+ * Create many customers
+ * Results arrive through importProgress / importItemFailed / importFinished
+ * (and customerCreated per row in SingleRowImport mode)
+ *
+ * @param customers - Customers to create; item numbers are list indexes
+ */
+void ApiClient::createCustomers(const QList<Customer> &customers)
+{
+    qDebug() << "createCustomers() called with" << customers.count() << "customers";
+    if (isImporting()) {
+        emit errorOccurred("An import is already running");
+        return;
+    }
+    if (forwardToTransport([customers](ApiClient *transport) { transport->createCustomers(customers); })) {
+        m_transportImporting = true;
+        return;
+    }
+    
+    QSharedPointer<ImportJob> job = QSharedPointer<ImportJob>::create();
+    job->queue = customers;
+    job->queueItems.reserve(customers.count());
+    for (int i = 0; i < customers.count(); ++i) {
+        job->queueItems.append(i);
+    }
+    job->total = customers.count();
+    startImport(job);
+}
+
+/**
+ * Import customers from a CSV or NDJSON file
+ * The file is read as requests complete, so only the rows in flight are
+ * held in memory; rows that cannot be read are reported as failed items
+ *
+ * @param filePath - File to import (see CustomerImportReader for formats)
+ * @return bool - false if an import is running or the file cannot be opened
+ */
+bool ApiClient::importCustomers(const QString &filePath)
+{
+    qDebug() << "importCustomers() called with file:" << filePath;
+    if (isImporting()) {
+        emit errorOccurred("An import is already running");
+        return false;
+    }
+    
+    QSharedPointer<CustomerImportReader> reader = QSharedPointer<CustomerImportReader>::create(filePath);
+    if (!reader->open()) {
+        emit errorOccurred(QString("Cannot open %1: %2").arg(filePath, reader->errorString()));
+        return false;
+    }
+    
+    // Network thread mode: opened here, read on the network thread
+    QSharedPointer<ImportJob> job = QSharedPointer<ImportJob>::create();
+    job->reader = reader;
+    if (forwardToTransport([job](ApiClient *transport) {
+            if (transport->isImporting()) {
+                emit transport->errorOccurred("An import is already running");
+                return;
+            }
+            transport->startImport(job);
+        })) {
+        m_transportImporting = true;
+        return true;
+    }
+    startImport(job);
+    return true;
+}
+
+/**
+ * Abort the running import
+ * Requests in flight are aborted (their rows may or may not have been
+ * created); importFinished reports the results received so far
+ */
+void ApiClient::cancelImport()
+{
+    if (forwardToTransport([](ApiClient *transport) { transport->cancelImport(); })) {
+        return;
+    }
+    if (!m_import) {
+        return;
+    }
+    
+    QSharedPointer<ImportJob> job = m_import;
+    m_import.reset();
+    
+    // Aborting finishes the replies right away; onReplyFinished drops them
+    for (auto it = job->inFlight.begin(); it != job->inFlight.end(); ++it) {
+        abortReply(it.key());
+    }
+    
+    qDebug() << "Import cancelled:" << job->succeeded << "created," << job->failed << "failed";
+    emit importFinished(job->succeeded, job->failed);
+}
+
+/**
+ * Start or stop write-behind mode
+ * Disabling keeps unsent mutations in the journal; they are replayed
+ * once write-behind is enabled again for the same base URL
+ *
+ * @param enabled - true to journal mutations and replay them in the background
+ */
+void ApiClient::setWriteBehindEnabled(bool enabled)
+{
+    if (enabled == m_writeBehindEnabled) {
+        return;
+    }
+    
+    m_writeBehindEnabled = enabled;
+    qDebug() << "Write-behind" << (enabled ? "enabled" : "disabled");
+    
+    if (forwardToTransport([enabled](ApiClient *transport) { transport->setWriteBehindEnabled(enabled); })) {
+        return;
+    }
+    if (enabled) {
+        openJournal();
+    } else {
+        closeJournal();
+    }
+}
+
+/**
+ * Start or stop push updates
+ *
+ * @param enabled - true to keep the change event stream open
+ */
+void ApiClient::setPushEnabled(bool enabled)
+{
+    if (enabled == m_pushEnabled) {
+        return;
+    }
+    
+    m_pushEnabled = enabled;
+    qDebug() << "Push updates" << (enabled ? "enabled" : "disabled");
+    
+    if (forwardToTransport([enabled](ApiClient *transport) { transport->setPushEnabled(enabled); })) {
+        return;
+    }
+    if (enabled) {
+        openEventStream();
+    } else {
+        closeEventStream();
+    }
+}
+
+void ApiClient::updateCustomer(int id, const Customer &customer)
+{
+    qDebug() << "updateCustomer() called with id:" << id;
+    if (m_writeBehindEnabled) {
+        if (!forwardToTransport([id, customer](ApiClient *transport) {
+                transport->journalMutation(CustomerJournal::UpdateOperation, id, customer);
+            })) {
+            journalMutation(CustomerJournal::UpdateOperation, id, customer);
+        }
+        return;
+    }
+    if (forwardRequest([id, customer](ApiClient *transport) { transport->updateCustomer(id, customer); })) {
+        return;
+    }
+    const QJsonObject data = customerInput(customer);
+    schedule(InteractivePriority, [this, id, data]() { sendPutRequest(customerRequest(UpdateRoute, id), data); });
+}
+
+void ApiClient::deleteCustomer(int id)
+{
+    qDebug() << "deleteCustomer() called with id:" << id;
+    if (m_writeBehindEnabled) {
+        if (!forwardToTransport([id](ApiClient *transport) {
+                transport->journalMutation(CustomerJournal::DeleteOperation, id, Customer());
+            })) {
+            journalMutation(CustomerJournal::DeleteOperation, id, Customer());
+        }
+        return;
+    }
+    if (forwardRequest([id](ApiClient *transport) { transport->deleteCustomer(id); })) {
+        return;
+    }
+    schedule(InteractivePriority, [this, id]() { sendDeleteRequest(customerRequest(DeleteRoute, id)); });
+}
+
+void ApiClient::checkHealth()
+{
+    qDebug() << "checkHealth() called";
+    if (forwardRequest([](ApiClient *transport) { transport->checkHealth(); })) {
+        return;
+    }
+    scheduleGet(InteractivePriority, { HealthRoute, "/health" });
+}
+
+/**
+ * Build a request with the settings shared by every endpoint
+ * HTTP/2 lets concurrent requests (e.g. an import window) share one
+ * connection instead of queueing behind HTTP/1.1's per-host limit
+ */
+QNetworkRequest ApiClient::createRequest(const QString &endpoint) const
+{
+    QNetworkRequest request(QUrl(m_baseUrl + endpoint));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Accept", "application/json");
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setTransferTimeout(120000);
+    return request;
+}
+
+/**
+ * Assign a request id, take a scheduler slot and start collecting
+ * metrics for a reply; its state lives in m_requests until the reply
+ * has been handled
+ *
+ * @param reply     - Reply to instrument
+ * @param context   - Route and parameters it was sent with
+ * @param bytesSent - Request body size
+ */
+void ApiClient::instrumentReply(QNetworkReply *reply, const RequestContext &context, qint64 bytesSent)
+{
+    RequestState state;
+    state.context = context;
+    state.requestId = m_assignedRequestId;
+    if (!state.requestId) {
+        state.requestId = nextRequestId();
+        m_lastRequestId = state.requestId;
+    }
+    state.aliasIds = std::exchange(m_assignedAliasIds, {});
+    state.priority = m_assignedPriority;
+    state.host = hostKey(reply->url());
+    state.rateLimitPending = isRateLimited(context.route);
+    state.startNs = m_assignedQueuedNs >= 0 ? m_assignedQueuedNs : m_clock.nsecsElapsed();
+    m_assignedRequestId = 0;
+    m_assignedPriority = NormalPriority;
+    m_assignedQueuedNs = -1;
+    
+    // Holds a scheduler slot until it finishes, and spends the server's
+    // rate limit budget until the response reports it
+    ++m_activeCounts[state.priority];
+    ++m_activeHostCounts[state.host];
+    if (state.rateLimitPending) {
+        rateLimitStarted(state.priority, state.host);
+    }
+    
+    m_metrics.requestStarted(m_routeMetrics[context.route], bytesSent);
+    m_requests.insert(reply, state);
+    m_replies.insert(state.requestId, reply);
+    for (quint64 aliasId : std::as_const(state.aliasIds)) {
+        m_replies.insert(aliasId, reply);
+    }
+    
+    // Finished and encrypted arrive through the network manager
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, &ApiClient::onReplyConnecting);
+    connect(reply, &QNetworkReply::requestSent, this, &ApiClient::onReplyRequestSent);
+    connect(reply, &QNetworkReply::metaDataChanged, this, &ApiClient::onReplyMetaDataChanged);
+    connect(reply, &QNetworkReply::downloadProgress, this, &ApiClient::onReplyDownloadProgress);
+}
+
+/**
+ * State of the reply whose signal is being handled, null if it is not
+ * one of ours
+ */
+ApiClient::RequestState *ApiClient::senderState()
+{
+    const auto it = m_requests.find(static_cast<QNetworkReply*>(sender()));
+    return it != m_requests.end() ? &*it : nullptr;
+}
+
+void ApiClient::onReplyConnecting()
+{
+    RequestState *state = senderState();
+    if (state && state->connectingNs < 0) {
+        state->connectingNs = m_clock.nsecsElapsed();
+    }
+}
+
+void ApiClient::onReplyEncrypted(QNetworkReply *reply)
+{
+    const auto it = m_requests.find(reply);
+    if (it != m_requests.end() && it->encryptedNs < 0) {
+        it->encryptedNs = m_clock.nsecsElapsed();
+    }
+}
+
+void ApiClient::onReplyRequestSent()
+{
+    RequestState *state = senderState();
+    if (state && state->sentNs < 0) {
+        state->sentNs = m_clock.nsecsElapsed();
+    }
+}
+
+void ApiClient::onReplyMetaDataChanged()
+{
+    RequestState *state = senderState();
+    if (!state) {
+        return;
+    }
+    if (state->headersNs < 0) {
+        state->headersNs = m_clock.nsecsElapsed();
+    }
+    updateRateLimit(static_cast<QNetworkReply*>(sender()), *state);
+}
+
+void ApiClient::onReplyDownloadProgress(qint64 received, qint64)
+{
+    if (RequestState *state = senderState()) {
+        state->bytesReceived = received;
+    }
+}
+
+/**
+ * A reply finished: give back its scheduler slot, record its network
+ * phases and report requestFinished for every caller it answers, before
+ * the response is handled
+ */
+void ApiClient::releaseRequest(QNetworkReply *reply, RequestState &state)
+{
+    const qint64 endNs = m_clock.nsecsElapsed();
+    
+    --m_activeCounts[state.priority];
+    if (--m_activeHostCounts[state.host] <= 0) {
+        m_activeHostCounts.remove(state.host);
+    }
+    updateRateLimit(reply, state);  // Failed before any headers arrived
+    scheduleDispatch();
+    
+    const int endpoint = m_routeMetrics[state.context.route];
+    auto record = [&](ApiMetrics::Phase phase, qint64 from, qint64 to) {
+        m_metrics.recordPhase(endpoint, phase, (to - from) / 1000);
+    };
+    
+    const qint64 firstNetwork = state.connectingNs >= 0 ? state.connectingNs : state.sentNs;
+    if (firstNetwork >= 0) {
+        record(ApiMetrics::QueuePhase, state.startNs, firstNetwork);
+    }
+    if (state.connectingNs >= 0 && state.sentNs >= 0) {
+        record(ApiMetrics::ConnectPhase, state.connectingNs, state.sentNs);
+    }
+    if (state.connectingNs >= 0 && state.encryptedNs >= 0) {
+        record(ApiMetrics::TlsPhase, state.connectingNs, state.encryptedNs);
+    }
+    if (state.sentNs >= 0 && state.headersNs >= 0) {
+        record(ApiMetrics::WaitPhase, state.sentNs, state.headersNs);
+    }
+    if (state.headersNs >= 0) {
+        record(ApiMetrics::DownloadPhase, state.headersNs, endNs);
+    }
+    record(ApiMetrics::TotalPhase, state.startNs, endNs);
+    
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    bool error = reply->error() != QNetworkReply::NoError || httpStatus >= 400;
+    m_metrics.requestFinished(endpoint, error, state.bytesReceived);
+    
+    // Backend reachable again: replay the journal now, not after the backoff
+    if (m_journalRetryDelay && !error) {
+        m_journalRetryDelay = 0;
+        m_journalFlushTimer->start(0);
+    }
+    
+    // Copied: receivers may send requests (m_requests grows)
+    const quint64 requestId = state.requestId;
+    const QList<quint64> aliasIds = state.aliasIds;
+    emit requestFinished(requestId, httpStatus, reply->error());
+    
+    // Network thread mode: coalesced GETs that brought their own id
+    for (quint64 aliasId : aliasIds) {
+        emit requestFinished(aliasId, httpStatus, reply->error());
+    }
+}
+
+/**
+ * Add response handling time to a route's parse phase
+ *
+ * @param parseNs - Total for the reply (streamed ones are parsed in steps)
+ */
+void ApiClient::recordParseTime(Route route, qint64 parseNs)
+{
+    m_metrics.recordPhase(m_routeMetrics[route], ApiMetrics::ParsePhase, parseNs / 1000);
+}
+
+bool ApiClient::isCbor(QNetworkReply *reply)
+{
+    return reply->header(QNetworkRequest::ContentTypeHeader).toString().startsWith("application/cbor");
+}
+
+/**
+ * Writable fields of a customer (the API manages id and timestamps)
+ */
+QJsonObject ApiClient::customerInput(const Customer &customer)
+{
+    QJsonObject json = customer.toJson();
+    json.remove("id");
+    json.remove("createdAt");
+    json.remove("updatedAt");
+    return json;
+}
+
+// HTTP request methods
+QNetworkReply *ApiClient::sendGetRequest(const RequestContext &context)
+{
+    const QString &endpoint = context.endpoint;
+    
+    // Attach to an identical GET that is still in flight; its response is
+    // parsed once and the resulting signal reaches every receiver. A caller
+    // with an id of its own is an alias; one without shares the reply's id
+    // and counts as a waiter
+    const QString key = "GET " + endpoint;
+    if (m_coalescingEnabled) {
+        if (QNetworkReply *pending = m_inFlightGets.value(key)) {
+            RequestState &state = m_requests[pending];
+            if (m_assignedRequestId) {
+                QList<quint64> aliasIds = std::exchange(m_assignedAliasIds, {});
+                aliasIds.prepend(m_assignedRequestId);
+                for (quint64 aliasId : aliasIds) {
+                    m_replies.insert(aliasId, pending);
+                }
+                state.aliasIds.append(aliasIds);
+                m_assignedRequestId = 0;
+            } else {
+                ++state.waiters;
+                m_lastRequestId = state.requestId;
+            }
+            qDebug() << "Coalesced GET" << endpoint;
+            return pending;
+        }
+    }
+    
+    qDebug() << "Sending GET request to:" << m_baseUrl + endpoint;
+    noteActivity();
+    
+    QNetworkRequest request = createRequest(endpoint);
+    
+    // Customer lists in CBOR: smaller, and strings need no unescaping
+    const bool streamed = m_streamingEnabled && context.route == CustomersRoute;
+    if (m_cborEnabled && !streamed && routeSpec(context.route).response != JsonResponse) {
+        request.setRawHeader("Accept", "application/cbor, application/json;q=0.9");
+    }
+    
+    // Revalidate the stored snapshot instead of downloading it again
+    if (m_snapshotEnabled && context.route == CustomersRoute) {
+        if (!m_snapshotEtag.isEmpty()) {
+            request.setRawHeader("If-None-Match", m_snapshotEtag);
+        }
+        if (!m_snapshotLastModified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", m_snapshotLastModified);
+        }
+    }
+    
+    QNetworkReply *reply = networkManager()->get(request);
+    instrumentReply(reply, context, 0);
+    
+    if (m_coalescingEnabled) {
+        m_inFlightGets.insert(key, reply);
+    }
+    
+    // Streaming mode: parse the customer list as it arrives
+    if (streamed) {
+        m_streamParsers.insert(reply, QSharedPointer<CustomerStreamParser>::create());
+        connect(reply, &QNetworkReply::readyRead, this, &ApiClient::onStreamReadyRead);
+    }
+    
+    qDebug() << "Request sent, waiting for response...";
+    return reply;
+}
+
+QNetworkReply *ApiClient::sendPostRequest(const RequestContext &context, const QJsonObject &data)
+{
+    detachInFlightGets("/api/customers");
+    
+    qDebug() << "Sending POST request to:" << m_baseUrl + context.endpoint;
+    noteActivity();
+    
+    QNetworkRequest request = createRequest(context.endpoint);
+    
+    QJsonDocument doc(data);
+    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
+    
+    QNetworkReply *reply = networkManager()->post(request, jsonData);
+    instrumentReply(reply, context, jsonData.size());
+    return reply;
+}
+
+QNetworkReply *ApiClient::sendPutRequest(const RequestContext &context, const QJsonObject &data)
+{
+    detachInFlightGets("/api/customers");
+    
+    qDebug() << "Sending PUT request to:" << m_baseUrl + context.endpoint;
+    noteActivity();
+    
+    QNetworkRequest request = createRequest(context.endpoint);
+    
+    QJsonDocument doc(data);
+    QByteArray jsonData = doc.toJson(QJsonDocument::Compact);
+    
+    QNetworkReply *reply = networkManager()->put(request, jsonData);
+    instrumentReply(reply, context, jsonData.size());
+    return reply;
+}
+
+QNetworkReply *ApiClient::sendDeleteRequest(const RequestContext &context)
+{
+    detachInFlightGets("/api/customers");
+    
+    qDebug() << "Sending DELETE request to:" << m_baseUrl + context.endpoint;
+    noteActivity();
+    
+    QNetworkRequest request = createRequest(context.endpoint);
+    
+    QNetworkReply *reply = networkManager()->deleteResource(request);
+    instrumentReply(reply, context, 0);
+    return reply;
+}
+
+void ApiClient::schedulePrewarm()
+{
+    if (!m_prewarmScheduled) {
+        m_prewarmScheduled = true;
+        QTimer::singleShot(0, this, [this]() {
+            if (m_prewarmEnabled && m_prewarmScheduled) {
+                prewarm();
+            }
+            m_prewarmScheduled = false;
+        });
+    }
+}
+
+/**
+ * A real request keeps the connection warm by itself;
+ * the next heartbeat is due a full base interval later
+ */
+void ApiClient::noteActivity()
+{
+    if (m_sessionActive) {
+        m_heartbeatTimer->start(m_heartbeatBaseInterval);
+    }
+}
+
+/**
+ * Heartbeat timer - probe the backend, then wait twice as long
+ * (up to the maximum) unless a real request comes first
+ */
+void ApiClient::onHeartbeat()
+{
+    if (!m_sessionActive) {
+        return;
+    }
+    
+    schedule(BackgroundPriority, [this]() { sendProbe(false); }, QString(), false);
+    
+    int next = qMin(m_heartbeatTimer->interval() * 2, m_heartbeatMaxInterval);
+    qDebug() << "Heartbeat sent, next in" << next / 1000 << "s";
+    m_heartbeatTimer->start(next);
+}
+
+/**
+ * Silent /health request for pre-warming and heartbeats
+ * Bypasses coalescing; its route never emits healthCheckSuccess or
+ * errorOccurred
+ *
+ * @param prewarm - Report the result through prewarmFinished
+ */
+void ApiClient::sendProbe(bool prewarm)
+{
+    const RequestContext context { .route = ProbeRoute, .endpoint = "/health", .prewarm = prewarm };
+    QNetworkReply *reply = networkManager()->get(createRequest(context.endpoint));
+    instrumentReply(reply, context, 0);
+}
+
+/**
+ * Stop coalescing onto GETs that may now return stale data
+ * Called before a write; the detached replies still complete normally,
+ * but GETs issued after the write go over the wire again
+ *
+ * @param endpointPrefix - Endpoints starting with this are detached
+ */
+void ApiClient::detachInFlightGets(const QString &endpointPrefix)
+{
+    const QString keyPrefix = "GET " + endpointPrefix;
+    for (auto it = m_inFlightGets.begin(); it != m_inFlightGets.end(); ) {
+        if (it.key().startsWith(keyPrefix)) {
+            it = m_inFlightGets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ApiClient::startImport(const QSharedPointer<ImportJob> &job)
+{
+    m_import = job;
+    qDebug() << "Import started - mode:" << (m_importMode == BatchImport ? "batch" : "single row")
+             << "window:" << m_importWindow << "batch size:" << m_importBatchSize;
+    pumpImport();
+}
+
+/**
+ * Fill the import window
+ * Sends batches until importWindow requests are in flight; finishes the
+ * import once every row has been sent and answered
+ */
+void ApiClient::pumpImport()
+{
+    QSharedPointer<ImportJob> job = m_import;  // Receivers may cancel the import
+    const int batchSize = m_importMode == BatchImport ? m_importBatchSize : 1;
+    
+    while (m_import == job && job->inFlight.count() < m_importWindow && hasRequestSlot(BackgroundPriority)) {
+        ImportJob::Batch batch;
+        batch.batchRequest = m_importMode == BatchImport;
+        
+        // Queued rows first, then the file
+        const int queued = qMin(batchSize, int(job->queue.count()));
+        batch.customers = job->queue.mid(0, queued);
+        batch.items = job->queueItems.mid(0, queued);
+        job->queue.remove(0, queued);
+        job->queueItems.remove(0, queued);
+        
+        if (job->reader && batch.customers.count() < batchSize) {
+            QList<qint64> lines;
+            batch.customers += job->reader->read(batchSize - batch.customers.count(), &lines);
+            for (qint64 line : lines) {
+                batch.items.append(int(line));
+            }
+            job->itemsRead += lines.count();
+            
+            const QList<CustomerImportReader::Error> errors = job->reader->takeErrors();
+            job->itemsRead += errors.count();
+            job->failed += errors.count();
+            for (const CustomerImportReader::Error &error : errors) {
+                emit importItemFailed(int(error.line), error.message);
+            }
+            if (job->reader->atEnd()) {
+                job->total = job->itemsRead;
+            }
+        }
+        
+        if (batch.customers.isEmpty()) {
+            break;
+        }
+        
+        QNetworkReply *reply;
+        m_assignedPriority = BackgroundPriority;
+        if (batch.batchRequest) {
+            QJsonArray rows;
+            for (const Customer &customer : batch.customers) {
+                rows.append(customerInput(customer));
+            }
+            reply = sendPostRequest({ BatchCreateRoute, "/api/customers/batch" }, QJsonObject{ { "customers", rows } });
+        } else {
+            reply = sendPostRequest({ ImportRoute, "/api/customers" }, customerInput(batch.customers.first()));
+        }
+        job->inFlight.insert(reply, batch);
+    }
+    
+    if (m_import != job || !job->inFlight.isEmpty() || !job->queue.isEmpty()
+        || (job->reader && !job->reader->atEnd())) {
+        return;
+    }
+    
+    m_import.reset();
+    qDebug() << "Import finished:" << job->succeeded << "created," << job->failed << "failed";
+    emit importProgress(job->succeeded, job->failed, job->succeeded + job->failed);
+    emit importFinished(job->succeeded, job->failed);
+}
+
+/**
+ * Import request finished
+ * Reports per-row results instead of errorOccurred. A batch rejected by
+ * validation lists its invalid rows; those fail and the remaining rows
+ * are queued again. Any other failure fails every row of the request.
+ */
+void ApiClient::handleImportReply(QNetworkReply *reply, const RequestContext &, const QByteArray &)
+{
+    QSharedPointer<ImportJob> job = m_import;
+    if (!job || !job->inFlight.contains(reply)) {
+        return;  // Aborted by cancelImport()
+    }
+    const ImportJob::Batch batch = job->inFlight.take(reply);
+    
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QJsonObject obj = QJsonDocument::fromJson(reply->readAll()).object();
+    
+    if (reply->error() == QNetworkReply::NoError && obj["success"].toBool()) {
+        job->succeeded += batch.customers.count();
+        if (!batch.batchRequest) {
+            emit customerCreated(Customer(obj["data"].toObject()));
+        }
+    } else {
+        QSet<int> invalid;
+        if (httpStatus == 400 && batch.batchRequest) {
+            for (const QJsonValue &value : obj["errors"].toArray()) {
+                QJsonObject error = value.toObject();
+                int index = error["index"].toInt(-1);
+                if (index >= 0 && index < batch.customers.count() && !invalid.contains(index)) {
+                    invalid.insert(index);
+                    ++job->failed;
+                    emit importItemFailed(batch.items.at(index), error["message"].toString());
+                }
+            }
+        }
+        
+        if (!invalid.isEmpty()) {
+            for (int i = batch.customers.count() - 1; i >= 0; --i) {
+                if (!invalid.contains(i)) {
+                    job->queue.prepend(batch.customers.at(i));
+                    job->queueItems.prepend(batch.items.at(i));
+                }
+            }
+        } else {
+            QString message = obj["message"].toString();
+            if (message.isEmpty()) {
+                message = reply->errorString();
+            }
+            if (httpStatus > 0) {
+                message = QString("HTTP %1: %2").arg(httpStatus).arg(message);
+            }
+            
+            qDebug() << "Import request failed for" << batch.customers.count() << "rows:" << message;
+            job->failed += batch.customers.count();
+            for (int item : batch.items) {
+                emit importItemFailed(item, message);
+            }
+        }
+    }
+    
+    if (m_import != job) {
+        return;  // Cancelled by a receiver
+    }
+    
+    emit importProgress(job->succeeded, job->failed, job->total);
+    pumpImport();
 }
 
-void ApiClient::updateCustomer(int id, const Customer &customer)
+/**
+ * Open the journal of the current base URL
+ * Mutations left over from an earlier run are replayed right away
+ */
+void ApiClient::openJournal()
 {
-    qDebug() << "updateCustomer() called with id:" << id;
-    QJsonObject json = customer.toJson();
-    json.remove("id");
-    json.remove("createdAt");
-    json.remove("updatedAt");
-    sendPutRequest(QString("/api/customers/%1").arg(id), json);
+    QSharedPointer<CustomerJournal> journal =
+        QSharedPointer<CustomerJournal>::create(CustomerJournal::pathForBaseUrl(m_baseUrl));
+    if (!journal->open()) {
+        emit errorOccurred("Cannot open the customer journal, changes are sent directly");
+        return;
+    }
+    m_journal = journal;
+    
+    // Provisional ids still pending must not be handed out again
+    const int lowest = m_journal->lowestProvisionalId();
+    int current = m_provisionalIds->loadRelaxed();
+    while (lowest < current && !m_provisionalIds->testAndSetRelaxed(current, lowest, current)) {
+    }
+    
+    const int pending = m_journal->pendingCount();
+    if (pending > 0) {
+        qDebug() << "Replaying" << pending << "journaled customer changes";
+        m_journalFlushTimer->start(0);
+    }
+    emit pendingWritesChanged(pending);
 }
 
-void ApiClient::deleteCustomer(int id)
+/**
+ * Close the journal
+ * Replays in flight are aborted; their records stay pending and are sent
+ * again when the journal is next opened
+ */
+void ApiClient::closeJournal()
 {
-    qDebug() << "deleteCustomer() called with id:" << id;
-    sendDeleteRequest(QString("/api/customers/%1").arg(id));
+    m_journalSyncTimer->stop();
+    m_journalFlushTimer->stop();
+    m_journalRetryDelay = 0;
+    
+    const QList<QNetworkReply*> replies = m_journalWrites.keys();
+    m_journalWrites.clear();
+    for (QNetworkReply *reply : replies) {
+        abortReply(reply);
+    }
+    
+    if (m_journal) {
+        m_journal->close();
+        m_journal.reset();
+    }
 }
 
-void ApiClient::checkHealth()
+/**
+ * Write-behind mode: record a mutation and report it done
+ * The record is fsynced with the rest of its burst (group commit) and
+ * replayed once the burst has settled. Without a journal the request is
+ * sent directly.
+ *
+ * @param operation - Create, update or delete
+ * @param id        - Customer id (provisional for creates)
+ * @param customer  - Fields for a create or update
+ */
+void ApiClient::journalMutation(CustomerJournal::Operation operation, int id, const Customer &customer)
 {
-    qDebug() << "checkHealth() called";
-    sendGetRequest("/health");
+    if (!m_journal) {
+        const QJsonObject data = customerInput(customer);
+        schedule(InteractivePriority, [this, operation, id, data]() {
+            if (operation == CustomerJournal::CreateOperation) {
+                sendPostRequest({ CreateRoute, "/api/customers" }, data);
+            } else if (operation == CustomerJournal::UpdateOperation) {
+                sendPutRequest(customerRequest(UpdateRoute, id), data);
+            } else {
+                sendDeleteRequest(customerRequest(DeleteRoute, id));
+            }
+        });
+        return;
+    }
+    
+    m_journal->append(operation, id, customer);
+    if (!m_journalSyncTimer->isActive()) {
+        m_journalSyncTimer->start();
+    }
+    if (!m_journalRetryDelay && !m_journalFlushTimer->isActive()) {
+        m_journalFlushTimer->start(JournalSettleMs);
+    }
+    
+    // Local result, as the server would report it
+    Customer local = customer;
+    local.setId(m_journal->resolveId(id));
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (operation == CustomerJournal::CreateOperation) {
+        local.setCreatedAt(now);
+        local.setUpdatedAt(now);
+        emit customerCreated(local);
+    } else if (operation == CustomerJournal::UpdateOperation) {
+        local.setUpdatedAt(now);
+        emit customerUpdated(local);
+    } else {
+        emit customerDeleted(local.getId());
+    }
+    emit pendingWritesChanged(m_journal->pendingCount());
 }
 
-// HTTP request methods
-void ApiClient::sendGetRequest(const QString &endpoint)
+/**
+ * Replay the journal
+ * Sends one coalesced request per customer, up to JournalWindow at a
+ * time. A customer with a request in flight, or whose create has not
+ * been answered yet, waits for the next round; creates that were
+ * deleted again are dropped without a request.
+ */
+void ApiClient::flushJournal()
 {
-    QUrl url(m_baseUrl + endpoint);
-    qDebug() << "Sending GET request to:" << url.toString();
-    
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    request.setTransferTimeout(120000);
+    if (!m_journal || m_journal->pendingCount() == 0) {
+        return;
+    }
     
-    QNetworkReply *reply = m_networkManager->get(request);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("method", "GET");
-    reply->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
+    // Only send what would survive a crash
+    m_journal->sync();
     
-    // Connect finished signal for THIS specific reply
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onReplyFinished(reply);
-    });
+    QSet<quint64> inFlight;
+    QSet<int> busyIds;
+    for (const CustomerJournal::Mutation &mutation : std::as_const(m_journalWrites)) {
+        for (quint64 sequence : mutation.sequences) {
+            inFlight.insert(sequence);
+        }
+        busyIds.insert(mutation.id);
+    }
     
-    // Connect error signal
-    connect(reply, &QNetworkReply::errorOccurred, this, [reply](QNetworkReply::NetworkError code) {
-        qDebug() << "Network error occurred:" << code << reply->errorString();
-    });
+    bool dropped = false;
+    const QList<CustomerJournal::Mutation> mutations = m_journal->coalesce(inFlight);
+    for (const CustomerJournal::Mutation &mutation : mutations) {
+        if (m_journalWrites.count() >= JournalWindow) {
+            break;
+        }
+        if (busyIds.contains(mutation.id)) {
+            continue;
+        }
+        if (mutation.operation == CustomerJournal::NoOperation) {
+            m_journal->acknowledge(mutation.sequences);
+            dropped = true;
+            continue;
+        }
+        if (mutation.id < 0 && mutation.operation != CustomerJournal::CreateOperation) {
+            continue;  // Waits for the server id
+        }
+        if (!hasRequestSlot(BackgroundPriority)) {
+            break;
+        }
+        
+        QNetworkReply *reply;
+        m_assignedPriority = BackgroundPriority;
+        if (mutation.operation == CustomerJournal::CreateOperation) {
+            reply = sendPostRequest({ JournalCreateRoute, "/api/customers" }, customerInput(mutation.customer));
+        } else if (mutation.operation == CustomerJournal::UpdateOperation) {
+            reply = sendPutRequest(customerRequest(JournalUpdateRoute, mutation.id), customerInput(mutation.customer));
+        } else {
+            reply = sendDeleteRequest(customerRequest(JournalDeleteRoute, mutation.id));
+        }
+        m_journalWrites.insert(reply, mutation);
+        busyIds.insert(mutation.id);
+    }
     
-    qDebug() << "Request sent, waiting for response...";
+    if (dropped) {
+        m_journalSyncTimer->start();
+        emit pendingWritesChanged(m_journal->pendingCount());
+    }
 }
 
-void ApiClient::sendPostRequest(const QString &endpoint, const QJsonObject &data)
+/**
+ * Journal replay finished: updates the journal instead of emitting results
+ * Connection failures, timeouts, 429 and 5xx keep the records and retry
+ * with exponential backoff. Any other error means the mutation can never
+ * succeed: it is dropped and reported (a rejected create takes the
+ * customer's later records with it and removes the provisional row).
+ */
+void ApiClient::handleJournalReply(QNetworkReply *reply, const RequestContext &context, const QByteArray &)
 {
-    QUrl url(m_baseUrl + endpoint);
-    qDebug() << "Sending POST request to:" << url.toString();
-    
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    request.setTransferTimeout(120000);
+    if (!m_journalWrites.contains(reply)) {
+        return;  // Aborted by closeJournal()
+    }
+    const CustomerJournal::Mutation mutation = m_journalWrites.take(reply);
+    const int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const bool created = mutation.operation == CustomerJournal::CreateOperation;
     
-    QJsonDocument doc(data);
-    QByteArray jsonData = doc.toJson();
+    // The records stay pending; replays failing together back off once
+    auto retryLater = [&](const QString &reason) {
+        if (!m_journalFlushTimer->isActive()) {
+            m_journalRetryDelay = m_journalRetryDelay ? qMin(m_journalRetryDelay * 2, JournalMaxRetryMs) : JournalRetryMs;
+            m_journalFlushTimer->start(m_journalRetryDelay);
+        }
+        qDebug() << "Journal replay failed:" << reason << "- retrying in" << m_journalRetryDelay << "ms";
+        m_metrics.recordRetry(m_routeMetrics[context.route]);
+    };
     
-    QNetworkReply *reply = m_networkManager->post(request, jsonData);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("method", "POST");
-    reply->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
+    if (reply->error() != QNetworkReply::NoError
+        && (httpStatus == 0 || httpStatus == 408 || httpStatus == 429 || httpStatus >= 500)) {
+        retryLater(reply->errorString());
+        return;
+    }
     
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onReplyFinished(reply);
-    });
+    if (reply->error() == QNetworkReply::NoError) {
+        if (created) {
+            // Without the server's id the provisional one cannot be mapped
+            // (e.g. a proxy answered): send again, at least once as usual
+            QJsonParseError parseError;
+            const QJsonDocument document = QJsonDocument::fromJson(reply->readAll(), &parseError);
+            Customer customer(document.object()["data"].toObject());
+            if (parseError.error != QJsonParseError::NoError || customer.getId() <= 0) {
+                retryLater("create acknowledged without a customer id");
+                return;
+            }
+            
+            // A lost acknowledgement would create the customer twice
+            m_journal->acknowledge(mutation.sequences, customer.getId());
+            m_journal->sync();
+            emit customerIdAssigned(mutation.id, customer);
+        } else {
+            m_journal->acknowledge(mutation.sequences);
+            m_journalSyncTimer->start();
+        }
+    } else if (created) {
+        m_journal->acknowledge(m_journal->pendingSequences(mutation.id));
+        m_journalSyncTimer->start();
+        handleError(reply);
+        emit customerDeleted(mutation.id);
+    } else {
+        m_journal->acknowledge(mutation.sequences);
+        m_journalSyncTimer->start();
+        
+        // Deleting a customer that is already gone is not an error
+        if (!(mutation.operation == CustomerJournal::DeleteOperation && httpStatus == 404)) {
+            handleError(reply);
+        }
+    }
     
-    connect(reply, &QNetworkReply::errorOccurred, this, [reply](QNetworkReply::NetworkError code) {
-        qDebug() << "Network error occurred:" << code << reply->errorString();
-    });
+    m_journalRetryDelay = 0;
+    emit pendingWritesChanged(m_journal->pendingCount());
+    flushJournal();
 }
 
-void ApiClient::sendPutRequest(const QString &endpoint, const QJsonObject &data)
+/**
+ * Push updates: open the change event stream
+ * The stream bypasses the scheduler (it never finishes, so it would hold
+ * its slot forever) but counts against the host limit while it is open.
+ * It is not instrumented either: its duration says nothing about latency.
+ */
+void ApiClient::openEventStream()
 {
-    QUrl url(m_baseUrl + endpoint);
-    qDebug() << "Sending PUT request to:" << url.toString();
+    m_eventReconnectTimer->stop();
+    if (m_eventStream) {
+        return;
+    }
     
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    request.setTransferTimeout(120000);
+    // Each (re)connect counts against the server's rate limit
+    const QString host = hostKey(QUrl(m_baseUrl));
+    const qint64 delayNs = rateLimitDelay(BackgroundPriority, host);
+    if (delayNs > 0) {
+        m_eventReconnectTimer->start(timerMs(delayNs));
+        return;
+    }
     
-    QJsonDocument doc(data);
-    QByteArray jsonData = doc.toJson();
+    QNetworkRequest request = createRequest("/api/customers/events");
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    request.setTransferTimeout(EventIdleTimeoutMs);
+    if (!m_lastEventId.isEmpty()) {
+        request.setRawHeader("Last-Event-ID", m_lastEventId);
+    }
     
-    QNetworkReply *reply = m_networkManager->put(request, jsonData);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("method", "PUT");
-    reply->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
+    m_eventParser = QSharedPointer<ServerEventParser>::create();
+    m_eventStreamHost = host;
+    ++m_activeHostCounts[m_eventStreamHost];
+    rateLimitStarted(BackgroundPriority, host);
     
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onReplyFinished(reply);
+    QNetworkReply *reply = networkManager()->get(request);
+    m_eventStream = reply;
+    connect(reply, &QNetworkReply::metaDataChanged, this, [this, reply]() {
+        updateRateLimit(reply);
     });
-    
-    connect(reply, &QNetworkReply::errorOccurred, this, [reply](QNetworkReply::NetworkError code) {
-        qDebug() << "Network error occurred:" << code << reply->errorString();
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+        onEventStreamReadyRead(reply);
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        onEventStreamFinished(reply);
     });
 }
 
-void ApiClient::sendDeleteRequest(const QString &endpoint)
+/**
+ * Push updates: close the change event stream and stop reconnecting
+ */
+void ApiClient::closeEventStream()
 {
-    QUrl url(m_baseUrl + endpoint);
-    qDebug() << "Sending DELETE request to:" << url.toString();
+    m_eventReconnectTimer->stop();
+    m_eventReconnectDelay = 0;
     
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    request.setTransferTimeout(120000);
+    if (m_eventStreamConnected) {
+        m_eventStreamConnected = false;
+        emit pushConnectedChanged(false);
+    }
+    if (m_eventStream) {
+        releaseEventStream()->abort();
+    }
+}
+
+/**
+ * Push updates: forget the current stream and give back its host slot
+ *
+ * @return QNetworkReply* - The stream's reply
+ */
+QNetworkReply *ApiClient::releaseEventStream()
+{
+    QNetworkReply *reply = std::exchange(m_eventStream, nullptr);
+    m_eventParser.reset();
+    if (--m_activeHostCounts[m_eventStreamHost] <= 0) {
+        m_activeHostCounts.remove(m_eventStreamHost);
+    }
+    scheduleDispatch();
+    return reply;
+}
+
+/**
+ * Push updates: turn the events received so far into customer signals
+ * Every event carries an id, so a reconnect resumes after the last one
+ * handled here
+ */
+void ApiClient::onEventStreamReadyRead(QNetworkReply *reply)
+{
+    if (reply != m_eventStream
+        || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+        return;
+    }
     
-    QNetworkReply *reply = m_networkManager->deleteResource(request);
-    reply->setProperty("endpoint", endpoint);
-    reply->setProperty("method", "DELETE");
-    reply->setProperty("startTime", QDateTime::currentMSecsSinceEpoch());
+    m_eventParser->feed(reply->readAll());
+    if (m_eventParser->retryMs() >= 0) {
+        m_eventRetryMs = m_eventParser->retryMs();
+    }
     
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onReplyFinished(reply);
-    });
+    const QList<ServerEventParser::Event> events = m_eventParser->takeEvents();
+    for (const ServerEventParser::Event &event : events) {
+        if (!m_eventStreamConnected) {
+            // First event of this connection: the stream works
+            m_eventStreamConnected = true;
+            m_eventReconnectDelay = 0;
+            emit pushConnectedChanged(true);
+        }
+        m_lastEventId = event.id;
+        
+        const QJsonObject data = QJsonDocument::fromJson(event.data).object();
+        if (event.type == "customerCreated") {
+            emit customerCreated(Customer(data));
+        } else if (event.type == "customerUpdated") {
+            emit customerUpdated(Customer(data));
+        } else if (event.type == "customerDeleted") {
+            emit customerDeleted(data["id"].toInt());
+        } else if (event.type == "resync") {
+            // Changes were missed (server restart, or offline too long)
+            qDebug() << "Push stream cannot resume, syncing customers";
+            syncCustomers(BackgroundPriority);
+        }
+    }
+}
+
+/**
+ * Push updates: the stream ended; reconnect unless it was closed here
+ * A stream that delivered events reconnects after the server's retry
+ * delay; while connecting keeps failing the delay doubles up to a minute
+ */
+void ApiClient::onEventStreamFinished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    updateRateLimit(reply);
+    if (reply != m_eventStream) {
+        return;  // Closed by closeEventStream()
+    }
+    releaseEventStream();
     
-    connect(reply, &QNetworkReply::errorOccurred, this, [reply](QNetworkReply::NetworkError code) {
-        qDebug() << "Network error occurred:" << code << reply->errorString();
-    });
+    const bool wasConnected = m_eventStreamConnected;
+    if (wasConnected) {
+        m_eventStreamConnected = false;
+        emit pushConnectedChanged(false);
+    }
+    m_eventReconnectDelay = wasConnected ? m_eventRetryMs
+                                         : qBound(m_eventRetryMs, m_eventReconnectDelay * 2, EventMaxReconnectMs);
+    qDebug() << "Push stream closed:" << reply->errorString()
+             << "- reconnecting in" << m_eventReconnectDelay << "ms";
+    m_metrics.recordRetry(m_eventStreamMetrics);
+    m_eventReconnectTimer->start(m_eventReconnectDelay);
 }
 
 // Response handlers
 void ApiClient::onReplyFinished(QNetworkReply *reply)
 {
-    if (!reply) {
-        qDebug() << "ERROR: Reply is null!";
-        return;
+    const auto it = m_requests.constFind(reply);
+    if (it == m_requests.cend()) {
+        return;  // The push stream, handled by onEventStreamFinished()
     }
     
-    QString endpoint = reply->property("endpoint").toString();
-    QString method = reply->property("method").toString();
-    qint64 startTime = reply->property("startTime").toLongLong();
-    qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - startTime;
+    // A copy: signals emitted from here may start requests
+    RequestState state = *it;
+    releaseRequest(reply, state);
     
-    qDebug() << "Response received for" << method << endpoint;
+    // Handlers still find the reply's ids (completeAwaited)
+    handleReply(reply, state);
+    const RequestState handled = m_requests.take(reply);
+    m_replies.remove(handled.requestId);
+    for (quint64 aliasId : handled.aliasIds) {
+        m_replies.remove(aliasId);
+    }
+}
+
+/**
+ * Route a finished reply to its handler
+ */
+void ApiClient::handleReply(QNetworkReply *reply, const RequestState &state)
+{
+    const RequestContext &context = state.context;
+    const RouteSpec &spec = routeSpec(context.route);
+    const qint64 elapsed = (m_clock.nsecsElapsed() - state.startNs) / 1000000;
+    
+    qDebug() << "Response received for" << spec.method << context.endpoint;
     qDebug() << "Response time:" << elapsed << "ms";
+    
+    // Later identical GETs must start a new request
+    if (reply->operation() == QNetworkAccessManager::GetOperation) {
+        const QString key = "GET " + context.endpoint;
+        if (m_inFlightGets.value(key) == reply) {
+            m_inFlightGets.remove(key);
+        }
+    }
     qDebug() << "HTTP Status:" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    qDebug() << "Error code:" << reply->error();
+    qDebug() << "Error code:" << reply->error() << reply->errorString();
+    
+    QSharedPointer<CustomerStreamParser> streamParser = m_streamParsers.take(reply);
+    QSharedPointer<CustomerSnapshot::Writer> snapshotWriter = m_snapshotWriters.take(reply);
+    
+    // Routes that read the reply themselves, aborted ones included
+    if (spec.response == ReplyResponse) {
+        (this->*spec.handler)(reply, context, QByteArray());
+        reply->deleteLater();
+        return;
+    }
+    
+    if (state.cancelled) {
+        completeAwaited(reply, { ApiError::cancelled(), {} });
+        reply->deleteLater();
+        return;
+    }
+    
+    const qint64 parseStartNs = m_clock.nsecsElapsed();
     
     if (reply->error() != QNetworkReply::NoError) {
         qDebug() << "ERROR:" << reply->errorString();
+        const int errorStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (context.route == CustomerRoute && errorStatus == 404) {
+            m_customerCache.remove(context.customerId);
+        }
+        
+        // The server purged tombstones newer than our watermark: start over
+        if (context.deltaSync && errorStatus == 410) {
+            qDebug() << "Delta sync cursor expired, running a full sync";
+            resetSync();
+            syncCustomers(state.priority);
+            reply->deleteLater();
+            return;
+        }
         handleError(reply);
         reply->deleteLater();
         return;
     }
     
+    // Snapshot still current - no body to read or parse
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus == 304 && context.route == CustomersRoute) {
+        qDebug() << "Customer list not modified, keeping snapshot";
+        emit customersNotModified();
+        reply->deleteLater();
+        return;
+    }
+    
+    // Streamed customer list - most of the body has already been consumed
+    if (streamParser) {
+        if (m_snapshotEnabled && !snapshotWriter) {
+            snapshotWriter = createSnapshotWriter(reply);
+        }
+        if (finishStream(streamParser.data(), snapshotWriter.data(), reply) && snapshotWriter) {
+            commitSnapshot(snapshotWriter.data(), reply);
+        }
+        recordParseTime(context.route, state.parseNs + m_clock.nsecsElapsed() - parseStartNs);
+        reply->deleteLater();
+        return;
+    }
+    
     // Read response data ONCE
     QByteArray responseData = reply->readAll();
     qDebug() << "Response data length:" << responseData.length() << "bytes";
     qDebug() << "Response preview:" << responseData.left(200);
     
-    // Route to appropriate handler based on endpoint - pass the data
-    if (endpoint == "/api/customers" && method == "GET") {
-        handleCustomersResponse(responseData);
-    } else if (endpoint.startsWith("/api/customers/") && method == "GET") {
-        handleCustomerResponse(responseData);
-    } else if (endpoint == "/api/customers" && method == "POST") {
-        handleCreateResponse(responseData);
-    } else if (endpoint.startsWith("/api/customers/") && method == "PUT") {
-        handleUpdateResponse(responseData);
-    } else if (endpoint.startsWith("/api/customers/") && method == "DELETE") {
-        handleDeleteResponse(reply, responseData);
-    } else if (endpoint == "/health") {
-        handleHealthResponse(responseData);
+    // Large customer lists are decoded off the GUI thread; the reply is
+    // deleted once the result has been delivered
+    if (m_asyncDecodeEnabled && spec.response == CustomerListResponse
+        && responseData.size() >= m_asyncDecodeThreshold) {
+        decodeCustomersAsync(reply, context, responseData);
+        return;
     }
     
+    // Hand the data to the route's handler
+    (this->*spec.handler)(reply, context, responseData);
+    
+    recordParseTime(context.route, m_clock.nsecsElapsed() - parseStartNs);
     reply->deleteLater();
 }
 
-void ApiClient::handleCustomersResponse(const QByteArray &responseData)
+/**
+ * Streaming mode: feed newly arrived bytes to the reply's parser
+ * and emit every full chunk of customers parsed so far
+ */
+void ApiClient::onStreamReadyRead()
+{
+    QNetworkReply *reply = static_cast<QNetworkReply*>(sender());
+    CustomerStreamParser *parser = m_streamParsers.value(reply).data();
+    RequestState *state = senderState();
+    if (!parser || !state) {
+        return;
+    }
+    
+    // Leave error bodies unread so handleError() can report them
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus < 200 || httpStatus >= 300) {
+        return;
+    }
+    
+    const qint64 parseStartNs = m_clock.nsecsElapsed();
+    parser->feed(reply->readAll());
+    state->parseNs += m_clock.nsecsElapsed() - parseStartNs;
+    
+    CustomerSnapshot::Writer *writer = nullptr;
+    if (m_snapshotEnabled) {
+        if (!m_snapshotWriters.contains(reply)) {
+            m_snapshotWriters.insert(reply, createSnapshotWriter(reply));
+        }
+        writer = m_snapshotWriters.value(reply).data();
+    }
+    
+    while (parser->pendingCount() >= m_streamChunkSize) {
+        QList<Customer> chunk = parser->takeCustomers(m_streamChunkSize);
+        if (writer) {
+            writer->append(chunk);
+        }
+        m_customerCache.insert(chunk, m_clock.elapsed());
+        emit customersChunkReceived(chunk);
+    }
+}
+
+/**
+ * Streaming mode: consume the tail of the body, flush the last
+ * partial chunk and report the outcome of the whole list
+ *
+ * @return bool - true if the complete list was received
+ */
+bool ApiClient::finishStream(CustomerStreamParser *parser, CustomerSnapshot::Writer *writer, QNetworkReply *reply)
+{
+    parser->feed(reply->readAll());
+    parser->finish();
+    
+    if (parser->hasError()) {
+        qDebug() << "Streaming parse failed:" << parser->errorString();
+        emit errorOccurred(parser->errorString());
+        return false;
+    }
+    
+    if (!parser->isSuccess()) {
+        qDebug() << "API returned error:" << parser->message();
+        emit errorOccurred(parser->message());
+        return false;
+    }
+    
+    if (parser->pendingCount() > 0) {
+        QList<Customer> chunk = parser->takeCustomers();
+        if (writer) {
+            writer->append(chunk);
+        }
+        m_customerCache.insert(chunk, m_clock.elapsed());
+        emit customersChunkReceived(chunk);
+    }
+    
+    qDebug() << "Streamed customers:" << parser->totalParsed();
+    emit customersStreamFinished(parser->totalParsed());
+    return true;
+}
+
+/**
+ * Customer list, page or sync decoded on the calling thread
+ */
+void ApiClient::handleCustomersResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData)
 {
     qDebug() << "Parsing customers response...";
     
-    // Parse as UTF-8
-    QJsonDocument doc = QJsonDocument::fromJson(responseData);
+    QSharedPointer<DecodedCustomers> decoded = prepareDecode(reply, context);
+    decodeCustomers(decoded.data(), responseData, nullptr);
+    deliverCustomers(*decoded);
+}
+
+/**
+ * Collect on the GUI thread everything the decoder needs from the reply
+ * and the client, so decodeCustomers() can run on any thread
+ *
+ * @param context - A customers, page or sync request
+ */
+QSharedPointer<ApiClient::DecodedCustomers> ApiClient::prepareDecode(QNetworkReply *reply, const RequestContext &context) const
+{
+    const bool fullList = context.route == CustomersRoute;
+    QSharedPointer<DecodedCustomers> decoded = QSharedPointer<DecodedCustomers>::create();
+    decoded->fullList = fullList;
+    decoded->cursor = context.cursor;
+    decoded->cbor = isCbor(reply);
+    decoded->sync = context.route == SyncRoute;
+    decoded->deltaSync = context.deltaSync;
+    decoded->materialize = !decoded->sync
+        && isSignalConnected(fullList ? QMetaMethod::fromSignal(&ApiClient::customersReceived)
+                                      : QMetaMethod::fromSignal(&ApiClient::customersPageReceived));
+    if (fullList && m_snapshotEnabled) {
+        decoded->snapshotPath = CustomerSnapshot::pathForBaseUrl(m_baseUrl);
+        decoded->etag = reply->rawHeader("ETag");
+        decoded->lastModified = reply->rawHeader("Last-Modified");
+    }
+    return decoded;
+}
+
+/**
+ * Decode a customer list body; thread-safe (touches no client state)
+ *
+ * Views keep offsets into the UTF-8 body and decode fields on first use.
+ * The Customer list for the old signals and the snapshot file are built
+ * here too, so the GUI thread only has to emit the result.
+ *
+ * @param pool - Pool for parallel ranges of large arrays (null = sequential)
+ */
+void ApiClient::decodeCustomers(DecodedCustomers *decoded, const QByteArray &responseData, QThreadPool *pool)
+{
+    QElapsedTimer timer;
+    timer.start();
     
-    if (doc.isNull()) {
-        qDebug() << "Failed to parse JSON response";
-        emit errorOccurred("Invalid JSON response from server");
-        return;
+    if (decoded->cbor) {
+        decoded->result = CustomerView::parseCborList(responseData);
+    } else {
+        decoded->result = pool ? CustomerView::parseList(responseData, pool) : CustomerView::parseList(responseData);
     }
     
-    QJsonObject obj = doc.object();
+    if (decoded->result.valid && decoded->result.success) {
+        if (decoded->materialize) {
+            decoded->customers = CustomerView::toCustomers(decoded->result.customers);
+        }
+        if (!decoded->snapshotPath.isEmpty()) {
+            CustomerSnapshot::Writer writer(decoded->snapshotPath, decoded->etag, decoded->lastModified);
+            writer.append(decoded->result.customers);
+            decoded->snapshotSaved = writer.commit();
+        }
+    }
     
-    qDebug() << "Success field:" << obj["success"].toBool();
+    decoded->decodeNs = timer.nsecsElapsed();
+}
+
+/**
+ * Decode a customer list on the decode pool; the reply stays alive
+ * until the result has been delivered on the GUI thread
+ */
+void ApiClient::decodeCustomersAsync(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData)
+{
+    QSharedPointer<DecodedCustomers> decoded = prepareDecode(reply, context);
+    QPointer<QNetworkReply> guard(reply);
+    QThreadPool *pool = decodePool();
+    const Route route = context.route;
     
-    if (obj["success"].toBool()) {
-        QList<Customer> customers;
-        QJsonArray dataArray = obj["data"].toArray();
+    qDebug() << "Decoding" << responseData.size() << "bytes on the decode pool";
+    pool->start([this, guard, decoded, responseData, pool, route]() {
+        decodeCustomers(decoded.data(), responseData, pool);
         
-        qDebug() << "Number of customers:" << dataArray.count();
+        // Queued to the client's thread; the destructor waits for the pool
+        QMetaObject::invokeMethod(this, [this, guard, decoded, route]() {
+            const qint64 deliverStartNs = m_clock.nsecsElapsed();
+            deliverCustomers(*decoded);
+            recordParseTime(route, decoded->decodeNs + m_clock.nsecsElapsed() - deliverStartNs);
+            if (guard) {
+                guard->deleteLater();
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+/**
+ * Emit a decoded customer list (GUI thread)
+ */
+void ApiClient::deliverCustomers(const DecodedCustomers &decoded)
+{
+    const CustomerView::ParseResult &result = decoded.result;
+    
+    if (!result.valid) {
+        qDebug() << "Failed to parse" << (decoded.cbor ? "CBOR" : "JSON") << "response";
+        emit errorOccurred(decoded.cbor ? "Invalid CBOR response from server" : "Invalid JSON response from server");
+        return;
+    }
+    
+    if (!result.success) {
+        qDebug() << "API returned error:" << result.message;
+        emit errorOccurred(result.message);
+        return;
+    }
+    
+    if (decoded.sync) {
+        deliverSync(decoded);
+        return;
+    }
+    
+    m_customerCache.insert(result.customers, m_clock.elapsed());
+    
+    if (!decoded.fullList) {
+        int cursor = decoded.cursor;
+        int nextCursor = result.nextCursor;  // null on the last page -> 0
         
-        for (const QJsonValue &value : dataArray) {
-            Customer customer(value.toObject());
-            customers.append(customer);
+        qDebug() << "Customer page after" << cursor << ":" << result.customers.count() << "customers";
+        emit customerViewsPageReceived(result.customers, cursor, nextCursor);
+        if (decoded.materialize) {
+            emit customersPageReceived(decoded.customers, cursor, nextCursor);
+        }
+        return;
+    }
+    
+    qDebug() << "Number of customers:" << result.customers.count();
+    
+    // Revalidate against the saved snapshot unless the base URL changed meanwhile
+    if (!decoded.snapshotPath.isEmpty()) {
+        if (!decoded.snapshotSaved) {
+            qDebug() << "Failed to save customer snapshot";
+        } else if (decoded.snapshotPath == CustomerSnapshot::pathForBaseUrl(m_baseUrl)) {
+            m_snapshotEtag = decoded.etag;
+            m_snapshotLastModified = decoded.lastModified;
+        }
+    }
+    
+    emit customerViewsReceived(result.customers);
+    if (decoded.materialize) {
+        emit customersReceived(decoded.customers);
+    }
+}
+
+/**
+ * Merge a delta sync result into the sync state and emit what changed
+ * Rows seen before (the overlap window is read twice) are dropped and
+ * tombstones are reported as deleted ids. A complete (first) sync starts
+ * the state over; a delta arriving with no watermark set was sent before
+ * resetSync() and is ignored.
+ */
+void ApiClient::deliverSync(const DecodedCustomers &decoded)
+{
+    const bool complete = !decoded.deltaSync;
+    if (complete) {
+        m_syncWatermark = CustomerView::NoTimestamp;
+        m_syncRecent.clear();
+    } else if (m_syncWatermark == CustomerView::NoTimestamp) {
+        qDebug() << "Ignoring delta sync from before a reset";
+        return;
+    }
+    
+    QList<CustomerView> changed;
+    QList<int> deletedIds;
+    for (const CustomerView &customer : decoded.result.customers) {
+        const qint64 updatedAt = customer.updatedAtMSecs();
+        auto seen = m_syncRecent.constFind(customer.getId());
+        if (seen != m_syncRecent.cend() && *seen == updatedAt) {
+            continue;
         }
         
-        emit customersReceived(customers);
+        if (customer.isDeleted()) {
+            deletedIds.append(customer.getId());
+        } else {
+            changed.append(customer);
+        }
+        m_syncRecent.insert(customer.getId(), updatedAt);
+        m_syncWatermark = qMax(m_syncWatermark, updatedAt);
+    }
+    
+    // Only rows inside the overlap window can come back
+    if (m_syncWatermark != CustomerView::NoTimestamp) {
+        const qint64 cutoff = m_syncWatermark - SyncOverlapMs;
+        m_syncRecent.removeIf([cutoff](QHash<int, qint64>::iterator it) {
+            return it.value() <= cutoff;
+        });
+    }
+    
+    m_customerCache.insert(changed, m_clock.elapsed());
+    for (int id : deletedIds) {
+        m_customerCache.remove(id);
+    }
+    
+    qDebug() << (complete ? "Full sync:" : "Delta sync:") << changed.count() << "changed,"
+             << deletedIds.count() << "deleted";
+    emit customersSynced(changed, deletedIds, complete);
+}
+
+/**
+ * Start a snapshot for the customer list carried by a reply
+ * The reply's validators are stored in the snapshot header
+ */
+QSharedPointer<CustomerSnapshot::Writer> ApiClient::createSnapshotWriter(QNetworkReply *reply) const
+{
+    return QSharedPointer<CustomerSnapshot::Writer>::create(CustomerSnapshot::pathForBaseUrl(m_baseUrl),
+                                                            reply->rawHeader("ETag"),
+                                                            reply->rawHeader("Last-Modified"));
+}
+
+/**
+ * Finish a snapshot and revalidate against its validators from now on
+ */
+void ApiClient::commitSnapshot(CustomerSnapshot::Writer *writer, QNetworkReply *reply)
+{
+    if (writer->commit()) {
+        m_snapshotEtag = reply->rawHeader("ETag");
+        m_snapshotLastModified = reply->rawHeader("Last-Modified");
     } else {
-        QString errorMsg = obj["message"].toString();
-        qDebug() << "API returned error:" << errorMsg;
-        emit errorOccurred(errorMsg);
+        qDebug() << "Failed to save customer snapshot";
     }
 }
 
-void ApiClient::handleCustomerResponse(const QByteArray &responseData)
+void ApiClient::handleCustomerResponse(QNetworkReply *reply, const RequestContext &, const QByteArray &responseData)
 {
     QJsonDocument doc = QJsonDocument::fromJson(responseData);
     
     if (doc.isNull()) {
         emit errorOccurred("Invalid JSON response from server");
+        failAwaited(reply, "Invalid JSON response from server");
         return;
     }
     
@@ -275,13 +3238,55 @@ void ApiClient::handleCustomerResponse(const QByteArray &responseData)
     
     if (obj["success"].toBool()) {
         Customer customer(obj["data"].toObject());
+        m_customerCache.insert(customer, m_clock.elapsed());
         emit customerReceived(customer);
+        completeAwaited(reply, { {}, { customer } });
     } else {
         emit errorOccurred(obj["message"].toString());
+        failAwaited(reply, obj["message"].toString());
+    }
+}
+
+/**
+ * Batched lookup: one customerReceived per customer found, and an error
+ * for each requested id the server does not have
+ */
+void ApiClient::handleLookupResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData)
+{
+    const bool cbor = isCbor(reply);
+    const CustomerView::ParseResult result = cbor ? CustomerView::parseCborList(responseData)
+                                                  : CustomerView::parseList(responseData);
+    if (!result.valid) {
+        emit errorOccurred(cbor ? "Invalid CBOR response from server" : "Invalid JSON response from server");
+        failAwaited(reply, cbor ? "Invalid CBOR response from server" : "Invalid JSON response from server");
+        return;
+    }
+    if (!result.success) {
+        emit errorOccurred(result.message);
+        failAwaited(reply, result.message);
+        return;
+    }
+    
+    // Every caller gets the whole batch and picks its own customer
+    const QList<Customer> customers = CustomerView::toCustomers(result.customers);
+    completeAwaited(reply, { {}, customers });
+    
+    QSet<int> found;
+    for (const Customer &customer : customers) {
+        found.insert(customer.getId());
+        m_customerCache.insert(customer, m_clock.elapsed());
+        emit customerReceived(customer);
+    }
+    
+    for (int id : context.customerIds) {
+        if (!found.contains(id)) {
+            m_customerCache.remove(id);
+            emit errorOccurred(QString("Customer %1 not found").arg(id));
+        }
     }
 }
 
-void ApiClient::handleCreateResponse(const QByteArray &responseData)
+void ApiClient::handleCreateResponse(QNetworkReply *, const RequestContext &, const QByteArray &responseData)
 {
     QJsonDocument doc = QJsonDocument::fromJson(responseData);
     
@@ -300,7 +3305,7 @@ void ApiClient::handleCreateResponse(const QByteArray &responseData)
     }
 }
 
-void ApiClient::handleUpdateResponse(const QByteArray &responseData)
+void ApiClient::handleUpdateResponse(QNetworkReply *, const RequestContext &, const QByteArray &responseData)
 {
     QJsonDocument doc = QJsonDocument::fromJson(responseData);
     
@@ -319,7 +3324,7 @@ void ApiClient::handleUpdateResponse(const QByteArray &responseData)
     }
 }
 
-void ApiClient::handleDeleteResponse(QNetworkReply *reply, const QByteArray &responseData)
+void ApiClient::handleDeleteResponse(QNetworkReply *, const RequestContext &context, const QByteArray &responseData)
 {
     QJsonDocument doc = QJsonDocument::fromJson(responseData);
     
@@ -331,15 +3336,13 @@ void ApiClient::handleDeleteResponse(QNetworkReply *reply, const QByteArray &res
     QJsonObject obj = doc.object();
     
     if (obj["success"].toBool()) {
-        QString endpoint = reply->property("endpoint").toString();
-        int id = endpoint.split("/").last().toInt();
-        emit customerDeleted(id);
+        emit customerDeleted(context.customerId);
     } else {
         emit errorOccurred(obj["message"].toString());
     }
 }
 
-void ApiClient::handleHealthResponse(const QByteArray &responseData)
+void ApiClient::handleHealthResponse(QNetworkReply *, const RequestContext &, const QByteArray &responseData)
 {
     qDebug() << "Health response:" << QString::fromUtf8(responseData);
     
@@ -357,6 +3360,22 @@ void ApiClient::handleHealthResponse(const QByteArray &responseData)
     emit healthCheckSuccess(status);
 }
 
+/**
+ * Pre-warm or heartbeat probe finished (aborted ones too): logged, and
+ * reported through prewarmFinished for pre-warming
+ */
+void ApiClient::handleProbeReply(QNetworkReply *reply, const RequestContext &context, const QByteArray &)
+{
+    const qint64 elapsed = (m_clock.nsecsElapsed() - m_requests.constFind(reply)->startNs) / 1000000;
+    bool ok = reply->error() == QNetworkReply::NoError;
+    qDebug() << (context.prewarm ? "Pre-warm" : "Heartbeat") << "probe" << (ok ? "succeeded" : "failed")
+             << "in" << elapsed << "ms" << (ok ? QString() : reply->errorString());
+    
+    if (context.prewarm) {
+        emit prewarmFinished(ok, elapsed);
+    }
+}
+
 void ApiClient::handleError(QNetworkReply *reply)
 {
     QString errorMsg;
@@ -369,8 +3388,8 @@ void ApiClient::handleError(QNetworkReply *reply)
     qDebug() << "Error response data:" << responseData;
     
     if (!responseData.isEmpty()) {
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonObject obj = doc.object();
+        QJsonObject obj = isCbor(reply) ? QCborValue::fromCbor(responseData).toMap().toJsonObject()
+                                        : QJsonDocument::fromJson(responseData).object();
         errorMsg = obj["message"].toString();
     }
     
@@ -384,4 +3403,5 @@ void ApiClient::handleError(QNetworkReply *reply)
     
     qDebug() << "Emitting error:" << errorMsg;
     emit errorOccurred(QString("API Error: %1").arg(errorMsg));
+    failAwaited(reply, errorMsg);
 }
@@ -16,60 +16,584 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QList>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QThread>
+#include <QAtomicInteger>
+#include <array>
+#include <functional>
+#include "apimetrics.h"
+#include "apiresult.h"
 #include "customer.h"
+#include "customerjournal.h"
+#include "customersnapshot.h"
+#include "customerview.h"
+#include "customercache.h"
+#include "task.h"
+
+class CustomerStreamParser;
+class ServerEventParser;
+class CustomerImportReader;
 
 class ApiClient : public QObject
 {
     Q_OBJECT
+    
+    // Benchmarks drive the response handlers directly
+    friend class CustomerBenchmark;
 
 public:
     explicit ApiClient(QObject *parent = nullptr);
     ~ApiClient();
     
+    // Request scheduling: every request belongs to a priority class and is
+    // queued until its class and its host have a free slot. Interactive
+    // requests (one customer, a table page, the health check, direct
+    // writes) start first; normal and background ones wait while anything
+    // more urgent is queued for the host and never take its last slot, so
+    // an interactive request always finds one. Background: delta sync,
+    // imports, journal replay and heartbeats.
+    enum RequestPriority {
+        InteractivePriority,
+        NormalPriority,
+        BackgroundPriority
+    };
+    void setConcurrencyLimit(RequestPriority priority, int requests);
+    int concurrencyLimit(RequestPriority priority) const { return m_concurrencyLimits[priority]; }
+    void setHostConcurrencyLimit(int requests);  // Default 6, QNetworkAccessManager's HTTP/1.1 connections
+    int hostConcurrencyLimit() const { return m_hostConcurrencyLimit; }
+    // Drop queued requests of a class and abort those in flight (obsolete
+    // work); requestFinished reports them as OperationCanceledError.
+    // Imports and journal replays are left alone (see cancelImport()).
+    void abortRequests(RequestPriority priority);
+    
+    // Rate limit pacing: the backend's limiter (express-rate-limit, a fixed
+    // window per client address, /health exempt) reports its budget in the
+    // RateLimit-* response headers. The client mirrors it per host and
+    // spends it by class: interactive requests may use all of it, normal and
+    // background ones leave a tenth for them, and background ones are spread
+    // evenly over the rest of the window. After a 429 nothing limited is
+    // sent until its Retry-After has passed.
+    void setRateLimitPacingEnabled(bool enabled);
+    bool isRateLimitPacingEnabled() const { return m_rateLimitPacingEnabled; }
+    
+    // Network thread mode: the transport (network manager, replies, response
+    // handling) runs in a second client on a dedicated QThread with its own
+    // event loop, so socket reads and TLS work do not wait for painting or
+    // modal dialogs. This object keeps the same API and is the one to use:
+    // calls are queued to the network thread and signals come back queued;
+    // none of them waits for the network thread. The customer cache moves
+    // to the transport and back. Disabling stops the thread and drops the
+    // requests still in flight there.
+    void setNetworkThreadEnabled(bool enabled);
+    bool isNetworkThreadEnabled() const { return m_transport != nullptr; }
+    
     // Set API base URL (default: production)
     void setBaseUrl(const QString &url);
     QString getBaseUrl() const { return m_baseUrl; }
     
+    // Streaming mode: getAllCustomers() delivers customers in chunks
+    // via customersChunkReceived while the body is still downloading
+    void setStreamingEnabled(bool enabled) { m_streamingEnabled = enabled; syncTransport(); }
+    bool isStreamingEnabled() const { return m_streamingEnabled; }
+    void setStreamChunkSize(int size) { m_streamChunkSize = qMax(1, size); syncTransport(); }
+    
+    // Request coalescing: identical GETs issued while one is already
+    // in flight attach to that reply instead of going over the wire
+    void setRequestCoalescingEnabled(bool enabled) { m_coalescingEnabled = enabled; syncTransport(); }
+    bool isRequestCoalescingEnabled() const { return m_coalescingEnabled; }
+    
+    // Binary responses: customer list GETs send Accept: application/cbor
+    // (JSON as the fallback) and CBOR bodies are decoded straight into
+    // views. Not used for streamed lists, which need JSON. Compression
+    // (gzip/deflate, plus br where Qt supports it) is negotiated and
+    // undone by QNetworkAccessManager itself.
+    void setCborEnabled(bool enabled) { m_cborEnabled = enabled; syncTransport(); }
+    bool isCborEnabled() const { return m_cborEnabled; }
+    
+    // Lookup batching: getCustomerById() calls made in the same event loop
+    // pass are deduplicated and sent as GET /api/customers?ids=1,2,3 (up to
+    // 100 ids per request), one round trip and one query instead of one per
+    // id. customerReceived still arrives once per customer; requestFinished
+    // reports the batch's status to every caller, and each id the server
+    // does not have raises errorOccurred.
+    void setLookupBatchingEnabled(bool enabled) { m_lookupBatchingEnabled = enabled; syncTransport(); }
+    bool isLookupBatchingEnabled() const { return m_lookupBatchingEnabled; }
+    
+    // Customer cache: getCustomerById() answers from a byte-bounded LRU
+    // cache filled by every single, list, page and sync response and kept
+    // current by this client's creates, updates and deletes (pushed ones
+    // included). An entry older than the max age is still served at once
+    // and refreshed by a background request, whose answer arrives as a
+    // second customerReceived. A hit sends no request; its request id is
+    // reported by requestFinished with HTTP status 0. Hit ratio, evictions
+    // and memory use are part of metrics(). Size 0 disables the cache.
+    void setCustomerCacheSize(qsizetype bytes);     // Default 8 MB
+    qsizetype customerCacheSize() const { return m_customerCacheSize; }
+    void setCustomerCacheMaxAge(int ms);            // Default 30 s
+    int customerCacheMaxAge() const { return m_customerCacheMaxAge; }
+    void clearCustomerCache();
+    
+    // Asynchronous decoding: customer list bodies of at least threshold
+    // bytes are parsed (and snapshotted) on a worker pool and delivered
+    // with a queued call, so the GUI thread only emits the result. Large
+    // "data" arrays are split into ranges decoded in parallel.
+    void setAsyncDecodeEnabled(bool enabled) { m_asyncDecodeEnabled = enabled; syncTransport(); }
+    bool isAsyncDecodeEnabled() const { return m_asyncDecodeEnabled; }
+    void setAsyncDecodeThreshold(qsizetype bytes) { m_asyncDecodeThreshold = qMax<qsizetype>(0, bytes); syncTransport(); }
+    qsizetype asyncDecodeThreshold() const { return m_asyncDecodeThreshold; }
+    
+    // Persistent customer snapshot (one file per base URL)
+    // When enabled, getAllCustomers() revalidates with If-None-Match /
+    // If-Modified-Since and a 304 reply emits customersNotModified
+    void setSnapshotEnabled(bool enabled) { m_snapshotEnabled = enabled; syncTransport(); }
+    bool isSnapshotEnabled() const { return m_snapshotEnabled; }
+    void loadSnapshot();  // Emits snapshotLoaded if there is one
+    
+    // Bulk import: keeps up to importWindow requests in flight (multiplexed
+    // over one HTTP/2 connection when the server supports it). BatchImport
+    // sends importBatchSize rows per POST /api/customers/batch request;
+    // SingleRowImport sends one POST /api/customers per row.
+    enum ImportMode {
+        BatchImport,
+        SingleRowImport
+    };
+    void setImportMode(ImportMode mode) { m_importMode = mode; syncTransport(); }
+    ImportMode importMode() const { return m_importMode; }
+    void setImportWindow(int requests) { m_importWindow = qMax(1, requests); syncTransport(); }
+    int importWindow() const { return m_importWindow; }
+    void setImportBatchSize(int size) { m_importBatchSize = qBound(1, size, 1000); syncTransport(); }
+    int importBatchSize() const { return m_importBatchSize; }
+    bool isImporting() const { return m_transport ? m_transportImporting : !m_import.isNull(); }
+    
+    // Write-behind mode: createCustomer/updateCustomer/deleteCustomer are
+    // appended to a durable local journal (fsynced in batches) and reported
+    // done right away through customerCreated/Updated/Deleted; creates get a
+    // provisional negative id. A background flusher replays the journal in
+    // order once writes have settled, coalescing operations on the same
+    // customer, retries with backoff while the backend is unreachable and
+    // resumes as soon as any request gets through. customerIdAssigned maps
+    // provisional ids to server ids. Delivery is at least once: a create
+    // whose acknowledgement was lost in a crash is sent again.
+    void setWriteBehindEnabled(bool enabled);
+    bool isWriteBehindEnabled() const { return m_writeBehindEnabled; }
+    
+    // Push updates: keeps GET /api/customers/events (Server-Sent Events)
+    // open and turns its events into customerCreated / customerUpdated /
+    // customerDeleted, so the client stays current without polling. A
+    // dropped stream reconnects after the server's retry delay (backing off
+    // to a minute while connecting fails) and resumes after the last event
+    // id; if the server cannot replay what was missed, syncCustomers() runs.
+    // The open stream takes one of the host's request slots.
+    void setPushEnabled(bool enabled);
+    bool isPushEnabled() const { return m_pushEnabled; }
+    
+    // Connection pre-warming: shortly after construction (and after a base
+    // URL change) the client opens the TLS connection and sends a silent
+    // /health probe, so the first real request does not pay for the
+    // handshake or an App Service cold start
+    void setPrewarmEnabled(bool enabled) { m_prewarmEnabled = enabled; syncTransport(); }
+    bool isPrewarmEnabled() const { return m_prewarmEnabled; }
+    void prewarm();
+    
+    // Keep-alive heartbeat while an ATM session is active: silent /health
+    // probes every baseMs after the last request, backing off to maxMs
+    // while the session stays idle. Activating a session also pre-warms.
+    void setSessionActive(bool active);
+    bool isSessionActive() const { return m_sessionActive; }
+    void setHeartbeatInterval(int baseMs, int maxMs);
+    
+    // Request metrics (latency histograms per endpoint and phase, counters)
+    // requestMetrics() has a snapshot emitted through metricsUpdated, and
+    // setMetricsInterval() one every intervalMs (0 = stop). In network
+    // thread mode the snapshots are taken on the network thread, and
+    // metrics() returns the latest one received instead of waiting.
+    ApiMetrics metrics() const;  // Snapshot
+    void requestMetrics();
+    void setMetricsInterval(int intervalMs);
+    bool exportMetrics(const QString &filePath) const { return metrics().exportToFile(filePath); }
+    void resetMetrics();
+    
+    // Request ids: every request sent gets one; lastRequestId() is the id
+    // of the request behind the latest call (for a coalesced GET, the id of
+    // the request it joined) and requestFinished reports its outcome.
+    // In network thread mode the id is assigned when the call is queued;
+    // a coalesced GET then keeps its own id and is reported under it.
+    quint64 lastRequestId() const { return m_lastRequestId; }
+    
     // Customer endpoints
-    void getAllCustomers();
+    void getAllCustomers(RequestPriority priority = NormalPriority);
+    void getCustomersPage(int limit, int cursor = 0);  // cursor = last id of previous page
+    
+    // Delta sync: the first call downloads every customer, later calls
+    // only what changed since (GET /api/customers?updatedSince=&includeDeleted=true,
+    // starting a few seconds before the newest updatedAt seen so commits
+    // that landed late are not missed). Results arrive via customersSynced;
+    // rows already delivered are filtered out. resetSync() makes the next
+    // call a complete one again.
+    void syncCustomers(RequestPriority priority = BackgroundPriority);
+    void resetSync();
     void getCustomerById(int id);
-    void createCustomer(const Customer &customer);
+    int createCustomer(const Customer &customer);  // Provisional id in write-behind mode, else 0
+    void createCustomers(const QList<Customer> &customers);
+    bool importCustomers(const QString &filePath);  // CSV or NDJSON, read while sending; false if unreadable
+    void cancelImport();
     void updateCustomer(int id, const Customer &customer);
     void deleteCustomer(int id);
     
     // Health check
     void checkHealth();
+    
+    // Awaitable lookups (C++20 coroutines): the request is made when the
+    // task is first awaited (or started with then()), goes through the
+    // same cache, batching and scheduling as getCustomerById(), and the
+    // task finishes with that request's own result - no need to match
+    // signals to calls. The usual signals are still emitted. Tasks started
+    // together (whenAll) are sent together: lookups of one pass share one
+    // ?ids= request. Cancelling the token finishes the task at once with
+    // ApiError::cancelled() and drops or aborts the request unless another
+    // caller shares it; so does destroying a task that is still waiting.
+    Task<ApiResult<Customer>> fetchCustomer(int id, CancellationToken token = {});
+    Task<ApiResult<QList<Customer>>> fetchCustomers(QList<int> ids, CancellationToken token = {});  // Missing ids skipped
+    
+    // Drop one queued request or abort it in flight; requestFinished
+    // reports OperationCanceledError. A request shared with other callers
+    // (coalesced or batched) keeps going for them.
+    void abortRequest(quint64 requestId);
 
 signals:
     // Success signals
     void customersReceived(const QList<Customer> &customers);
+    void customersPageReceived(const QList<Customer> &customers, int cursor, int nextCursor);  // nextCursor 0 = last page
+    // Same lists as lazily decoded views (cheaper; the Customer signals
+    // are only materialized when something is connected to them)
+    void customerViewsReceived(const QList<CustomerView> &customers);
+    void customerViewsPageReceived(const QList<CustomerView> &customers, int cursor, int nextCursor);
+    void customersChunkReceived(const QList<Customer> &customers);  // Streaming mode
+    void customersStreamFinished(int totalCount);                   // Streaming mode
+    void snapshotLoaded(const QList<Customer> &customers, const QDateTime &savedAt);
+    void customersNotModified();                                    // Snapshot still current
+    // Delta sync result; complete = changed is the whole list (first sync)
+    void customersSynced(const QList<CustomerView> &changed, const QList<int> &deletedIds, bool complete);
     void customerReceived(const Customer &customer);
     void customerCreated(const Customer &customer);
     void customerUpdated(const Customer &customer);
     void customerDeleted(int id);
+    void customerIdAssigned(int provisionalId, const Customer &customer);  // Write-behind mode
+    void pendingWritesChanged(int count);                                // Write-behind mode
+    void pushConnectedChanged(bool connected);                           // Push updates
+    void rateLimited(int retryAfterMs);                                  // 429: requests wait this long
     void healthCheckSuccess(const QString &status);
     
+    // Bulk import - item is the list index (createCustomers) or the
+    // file line (importCustomers); total is -1 until the file is read
+    void importProgress(int succeeded, int failed, int total);
+    void importItemFailed(int item, const QString &message);
+    void importFinished(int succeeded, int failed);
+    
+    // Every request, before the endpoint-specific signal
+    void requestFinished(quint64 requestId, int httpStatus, QNetworkReply::NetworkError error);
+    
+    // Pre-warm probe result (not emitted for heartbeats)
+    void prewarmFinished(bool ok, qint64 elapsedMs);
+    
+    // Metrics snapshot (requestMetrics / setMetricsInterval)
+    void metricsUpdated(const ApiMetrics &metrics);
+    
     // Error signal
     void errorOccurred(const QString &errorMessage);
 
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+
 private:
-    QNetworkAccessManager *m_networkManager;
+    struct ImportJob;
+    struct DecodedCustomers;
+    class RequestAwaiter;
+    
+    // Result of an awaited request, handed from the transport to the facade
+    struct Completion {
+        ApiError error;
+        QList<Customer> customers;               // Lookups: every customer the reply carried
+    };
+
+    // Response routing: every request carries a RequestContext naming its
+    // route, and its reply goes to that route's entry in Routes
+    enum Route {
+        CustomersRoute,                          // GET /api/customers
+        CustomersPageRoute,                      // GET /api/customers?limit=&cursor=
+        SyncRoute,                               // GET /api/customers?updatedSince=
+        LookupRoute,                             // GET /api/customers?ids=
+        CustomerRoute,                           // GET /api/customers/{id}
+        CreateRoute,                             // POST /api/customers
+        UpdateRoute,                             // PUT /api/customers/{id}
+        DeleteRoute,                             // DELETE /api/customers/{id}
+        JournalCreateRoute,                      // POST /api/customers (write-behind replays)
+        JournalUpdateRoute,                      // PUT /api/customers/{id} (write-behind replays)
+        JournalDeleteRoute,                      // DELETE /api/customers/{id} (write-behind replays)
+        ImportRoute,                             // POST /api/customers (single row imports)
+        BatchCreateRoute,                        // POST /api/customers/batch (imports)
+        HealthRoute,                             // GET /health
+        ProbeRoute,                              // GET /health (pre-warming, heartbeats)
+        RouteCount
+    };
+    enum ResponseType {
+        JsonResponse,                            // JSON envelope, parsed by the handler
+        CustomerListResponse,                    // JSON or CBOR list; large ones decoded off the GUI thread
+        LookupResponse,                          // JSON or CBOR list, parsed by the handler
+        ReplyResponse                            // Handler reads the reply itself, errors included
+    };
+    struct RequestContext {
+        Route route;
+        QString endpoint;                        // Path and query as sent
+        int customerId = 0;                      // Routes with an {id}
+        QList<int> customerIds;                  // Lookups
+        int cursor = 0;                          // Pages
+        bool deltaSync = false;                  // Syncs reporting tombstones
+        bool prewarm = false;                    // Probes reported through prewarmFinished
+    };
+    using ResponseHandler = void (ApiClient::*)(QNetworkReply *reply, const RequestContext &context,
+                                                const QByteArray &responseData);
+    struct RouteSpec {
+        Route route;
+        const char *method;
+        const char *pattern;                     // Metrics template: ids as {id}, no query
+        ResponseType response;
+        ResponseHandler handler;
+    };
+    static const std::array<RouteSpec, RouteCount> Routes;  // Indexed by Route
+    
+    // A reply's state from the send until it has been handled
+    struct RequestState {
+        RequestContext context;
+        quint64 requestId = 0;
+        QList<quint64> aliasIds;                 // Callers with ids of their own merged into it
+        int waiters = 1;                         // Callers answered under requestId
+        RequestPriority priority = NormalPriority;
+        QString host;                            // Holds one of its scheduler slots
+        bool rateLimitPending = false;           // Spent from the host's budget, no response counted yet
+        bool cancelled = false;                  // Aborted on purpose, not reported as an error
+        qint64 startNs = 0;                      // Scheduled (or sent) on m_clock
+        qint64 connectingNs = -1;                // Network phases on m_clock, -1 = not seen
+        qint64 encryptedNs = -1;
+        qint64 sentNs = -1;
+        qint64 headersNs = -1;
+        qint64 bytesReceived = 0;
+        qint64 parseNs = 0;                      // Streamed bodies: parsed while downloading
+    };
+
+    QNetworkAccessManager *m_networkManager;     // Created on first use, see networkManager()
     QString m_baseUrl;
+    bool m_streamingEnabled;
+    int m_streamChunkSize;
+    QHash<QNetworkReply*, QSharedPointer<CustomerStreamParser>> m_streamParsers;
+    bool m_snapshotEnabled;
+    QByteArray m_snapshotEtag;
+    QByteArray m_snapshotLastModified;
+    QHash<QNetworkReply*, QSharedPointer<CustomerSnapshot::Writer>> m_snapshotWriters;
+    bool m_coalescingEnabled;
+    QHash<QString, QNetworkReply*> m_inFlightGets;  // "GET <endpoint>" -> reply
+    ImportMode m_importMode;
+    int m_importWindow;
+    int m_importBatchSize;
+    QSharedPointer<ImportJob> m_import;
+    bool m_prewarmEnabled;
+    bool m_prewarmScheduled;
+    bool m_sessionActive;
+    int m_heartbeatBaseInterval;
+    int m_heartbeatMaxInterval;
+    QTimer *m_heartbeatTimer;
+    ApiMetrics m_metrics;
+    ApiMetrics m_transportMetrics;               // Network thread mode: latest snapshot received
+    QTimer *m_metricsTimer;                      // Publishes snapshots through metricsUpdated
+    std::array<int, RouteCount> m_routeMetrics;  // Route -> m_metrics endpoint index
+    int m_eventStreamMetrics;                    // m_metrics endpoint index of the push stream
+    QElapsedTimer m_clock;  // Monotonic time base for metrics
+    quint64 m_lastRequestId;
+    bool m_asyncDecodeEnabled;
+    bool m_cborEnabled;
+    qsizetype m_asyncDecodeThreshold;
+    QThreadPool *m_decodePool;                   // Created on first use, see decodePool()
+    qint64 m_syncWatermark;                      // Newest updatedAt synced (ms), NoTimestamp = none yet
+    QHash<int, qint64> m_syncRecent;             // id -> updatedAt of rows inside the overlap window
+    
+    // Lookup batching
+    bool m_lookupBatchingEnabled;
+    QList<QPair<int, quint64>> m_pendingLookups; // Customer id, request id
+    QTimer *m_lookupTimer;                       // Fires at the end of the event loop pass
+    
+    // Customer cache
+    qsizetype m_customerCacheSize;
+    int m_customerCacheMaxAge;
+    CustomerCache m_customerCache;
+    
+    // Request scheduling
+    static constexpr int PriorityCount = BackgroundPriority + 1;
+    struct ScheduledRequest {
+        RequestPriority priority;
+        QString host;
+        QString key;                             // "GET <endpoint>" for GETs that can be merged
+        quint64 requestId;
+        QList<quint64> aliasIds;                 // Identical GETs merged while queued
+        qint64 queuedNs;
+        std::function<void()> send;
+        bool rateLimited;                        // Counts against the server's rate limit
+    };
+    std::array<int, PriorityCount> m_concurrencyLimits;
+    int m_hostConcurrencyLimit;
+    QList<ScheduledRequest> m_scheduledRequests;  // FIFO within each class
+    QHash<QNetworkReply*, RequestState> m_requests;  // Sent, until handled
+    QHash<quint64, QNetworkReply*> m_replies;    // Request id (own or alias) -> its entry in m_requests
+    std::array<int, PriorityCount> m_activeCounts;
+    QHash<QString, int> m_activeHostCounts;
+    bool m_dispatchScheduled;
+    RequestPriority m_assignedPriority;          // Class of the request being sent
+    qint64 m_assignedQueuedNs;                   // When it was scheduled, -1 = now
+    QList<quint64> m_assignedAliasIds;           // Callers merged into it while queued
+    
+    // Rate limit pacing
+    struct RateLimitBucket {
+        int limit = -1;                          // -1 until the server has reported one
+        int remaining = 0;                       // Left in the window, requests in flight deducted
+        qint64 resetNs = 0;                      // Window end on m_clock
+        qint64 windowNs = 0;                     // From RateLimit-Policy, 0 = unknown
+        qint64 blockedUntilNs = 0;               // Retry-After of a 429
+        qint64 nextBackgroundNs = 0;             // Paced start of the next background request
+        int inFlight = 0;                        // Sent, not yet counted by a response
+    };
+    bool m_rateLimitPacingEnabled;
+    QHash<QString, RateLimitBucket> m_rateLimits;  // Per host
+    QTimer *m_rateLimitTimer;                    // Wakes the dispatcher for deferred requests
+    
+    // Write-behind mode
+    bool m_writeBehindEnabled;
+    QSharedPointer<CustomerJournal> m_journal;   // Null if disabled or not openable
+    QHash<QNetworkReply*, CustomerJournal::Mutation> m_journalWrites;  // Replays in flight
+    QTimer *m_journalSyncTimer;                  // Group commit of appended records
+    QTimer *m_journalFlushTimer;                 // Settle delay, then retry backoff
+    int m_journalRetryDelay;                     // 0 = not backing off
+    QAtomicInteger<int> m_provisionalIdCounter;
+    QAtomicInteger<int> *m_provisionalIds;       // Shared with the transport
+    
+    // Push updates
+    bool m_pushEnabled;
+    QNetworkReply *m_eventStream;
+    QSharedPointer<ServerEventParser> m_eventParser;
+    QString m_eventStreamHost;
+    bool m_eventStreamConnected;                 // "ready" (or an event) received
+    QByteArray m_lastEventId;
+    int m_eventRetryMs;                          // Reconnect delay set by the server
+    int m_eventReconnectDelay;
+    QTimer *m_eventReconnectTimer;
+    
+    // Network thread mode
+    ApiClient *m_transport;                      // Lives on m_networkThread
+    ApiClient *m_facade;                         // Transport: the client it works for
+    QThread *m_networkThread;
+    bool m_transportImporting;
+    QAtomicInteger<quint64> m_requestIdCounter;
+    QAtomicInteger<quint64> *m_requestIds;       // Shared with the transport
+    quint64 m_assignedRequestId;                 // Reserved by the facade, 0 = none
+    
+    // Awaitable API
+    QMultiHash<quint64, RequestAwaiter*> m_awaiting;  // Suspended coroutines by request id
+    QSet<quint64> m_awaitedRequests;             // Transport side: results to hand back
     
     // Helper methods
-    void sendGetRequest(const QString &endpoint);
-    void sendPostRequest(const QString &endpoint, const QJsonObject &data);
-    void sendPutRequest(const QString &endpoint, const QJsonObject &data);
-    void sendDeleteRequest(const QString &endpoint);
+    template<typename Call> bool forwardToTransport(Call call);
+    template<typename Call> bool forwardRequest(Call call);
+    void forwardSignal(const QMetaMethod &signal);
+    QNetworkAccessManager *networkManager();
+    QThreadPool *decodePool();
+    void syncTransport();
+    quint64 nextRequestId();
+    static QString hostKey(const QUrl &url);
+    bool canStart(RequestPriority priority, const QString &host, bool rateLimited = true) const;
+    bool hasRequestSlot(RequestPriority priority) const;
+    void schedule(RequestPriority priority, std::function<void()> send, const QString &key = QString(),
+                  bool rateLimited = true, const QList<quint64> &aliasIds = {});
+    void scheduleGet(RequestPriority priority, const RequestContext &context);
+    void startScheduled(const ScheduledRequest &request);
+    void scheduleDispatch();
+    void dispatchScheduled();
+    void cancelScheduled(const ScheduledRequest &request);
+    void flushLookups();
+    void watchRequest(quint64 requestId);
+    void completeAwaited(quint64 requestId, const Completion &completion);
+    void completeAwaited(QNetworkReply *reply, const Completion &completion);
+    void failAwaited(QNetworkReply *reply, const QString &message);
+    void resumeAwaiting(quint64 requestId, const Completion &completion);
+    qint64 rateLimitDelay(RequestPriority priority, const QString &host) const;
+    void rateLimitStarted(RequestPriority priority, const QString &host);
+    void updateRateLimit(QNetworkReply *reply, RequestState &state);
+    void armRateLimitTimer();
+    int nextProvisionalId();
+    void openJournal();
+    void closeJournal();
+    void journalMutation(CustomerJournal::Operation operation, int id, const Customer &customer);
+    void flushJournal();
+    void handleJournalReply(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void openEventStream();
+    void closeEventStream();
+    QNetworkReply *releaseEventStream();
+    void onEventStreamReadyRead(QNetworkReply *reply);
+    void onEventStreamFinished(QNetworkReply *reply);
+    static const RouteSpec &routeSpec(Route route);
+    static bool isRateLimited(Route route);
+    static bool isBulkRoute(Route route);
+    static RequestContext customerRequest(Route route, int id);
+    QNetworkRequest createRequest(const QString &endpoint) const;
+    static QJsonObject customerInput(const Customer &customer);
+    static bool isCbor(QNetworkReply *reply);
+    void instrumentReply(QNetworkReply *reply, const RequestContext &context, qint64 bytesSent);
+    RequestState *senderState();
+    void abortReply(QNetworkReply *reply);
+    void releaseRequest(QNetworkReply *reply, RequestState &state);
+    void recordParseTime(Route route, qint64 parseNs);
+    QNetworkReply *sendGetRequest(const RequestContext &context);
+    QNetworkReply *sendPostRequest(const RequestContext &context, const QJsonObject &data);
+    QNetworkReply *sendPutRequest(const RequestContext &context, const QJsonObject &data);
+    QNetworkReply *sendDeleteRequest(const RequestContext &context);
+    void detachInFlightGets(const QString &endpointPrefix);
+    void schedulePrewarm();
+    void noteActivity();
+    void onHeartbeat();
+    void sendProbe(bool prewarm);
+    void startImport(const QSharedPointer<ImportJob> &job);
+    void pumpImport();
+    void handleImportReply(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
     
+    void onReplyConnecting();
+    void onReplyEncrypted(QNetworkReply *reply);
+    void onReplyRequestSent();
+    void onReplyMetaDataChanged();
+    void onReplyDownloadProgress(qint64 received, qint64 total);
     void onReplyFinished(QNetworkReply *reply);
-    void handleCustomersResponse(const QByteArray &responseData);
-    void handleCustomerResponse(const QByteArray &responseData);
-    void handleCreateResponse(const QByteArray &responseData);
-    void handleUpdateResponse(const QByteArray &responseData);
-    void handleDeleteResponse(QNetworkReply *reply, const QByteArray &responseData);
-    void handleHealthResponse(const QByteArray &responseData);
+    void handleReply(QNetworkReply *reply, const RequestState &state);
+    void onStreamReadyRead();
+    bool finishStream(CustomerStreamParser *parser, CustomerSnapshot::Writer *writer, QNetworkReply *reply);
+    void handleCustomersResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    QSharedPointer<DecodedCustomers> prepareDecode(QNetworkReply *reply, const RequestContext &context) const;
+    static void decodeCustomers(DecodedCustomers *decoded, const QByteArray &responseData, QThreadPool *pool);
+    void decodeCustomersAsync(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void deliverCustomers(const DecodedCustomers &decoded);
+    void deliverSync(const DecodedCustomers &decoded);
+    void handleCustomerResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleLookupResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleCreateResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleUpdateResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleDeleteResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleHealthResponse(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
+    void handleProbeReply(QNetworkReply *reply, const RequestContext &context, const QByteArray &responseData);
     void handleError(QNetworkReply *reply);
+    
+    QSharedPointer<CustomerSnapshot::Writer> createSnapshotWriter(QNetworkReply *reply) const;
+    void commitSnapshot(CustomerSnapshot::Writer *writer, QNetworkReply *reply);
 };
 
 #endif // APICLIENT_H
@@ -0,0 +1,354 @@
+/**
+ * apimetrics.cpp - Request metrics implementation
+ */
+
+#include "apimetrics.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStringList>
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int SubBucketBits = 7;
+const int SubBucketCount = 1 << SubBucketBits;   // Exact values below this
+const int HalfSubBucketCount = SubBucketCount / 2;
+
+const double Quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+QString formatSeconds(qint64 micros)
+{
+    return QString::number(micros / 1e6, 'g', 6);
+}
+
+QString escapeLabel(QString value)
+{
+    return value.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+}
+
+} // namespace
+
+ApiMetrics::Histogram::Histogram()
+    : m_count(0)
+    , m_sum(0)
+    , m_min(0)
+    , m_max(0)
+{
+}
+
+/**
+ * Bucket of a value
+ * Each power of two above SubBucketCount gets HalfSubBucketCount buckets:
+ * the value shifted right until it fits in [64, 128) selects the bucket
+ */
+int ApiMetrics::Histogram::bucketIndex(qint64 micros)
+{
+    if (micros < SubBucketCount) {
+        return int(micros);
+    }
+
+    const int msb = 63 - qCountLeadingZeroBits(quint64(micros));
+    const int shift = msb - (SubBucketBits - 1);
+    return (shift + 1) * HalfSubBucketCount + int(micros >> shift) - HalfSubBucketCount;
+}
+
+/**
+ * Representative (midpoint) value of a bucket
+ */
+qint64 ApiMetrics::Histogram::bucketValue(int index)
+{
+    if (index < SubBucketCount) {
+        return index;
+    }
+
+    const int shift = index / HalfSubBucketCount - 1;
+    const qint64 lower = qint64(index % HalfSubBucketCount + HalfSubBucketCount) << shift;
+    return lower + ((qint64(1) << shift) >> 1);
+}
+
+void ApiMetrics::Histogram::record(qint64 micros)
+{
+    micros = qMax<qint64>(0, micros);
+
+    const int index = bucketIndex(micros);
+    if (index >= m_buckets.count()) {
+        m_buckets.resize(index + 1, 0);
+    }
+    ++m_buckets[index];
+
+    m_min = m_count ? qMin(m_min, micros) : micros;
+    m_max = qMax(m_max, micros);
+    m_sum += micros;
+    ++m_count;
+}
+
+void ApiMetrics::Histogram::clear()
+{
+    *this = Histogram();
+}
+
+qint64 ApiMetrics::Histogram::percentile(double fraction) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    const quint64 rank = qMax<quint64>(1, quint64(std::ceil(fraction * m_count)));
+    quint64 seen = 0;
+    for (int i = 0; i < m_buckets.count(); ++i) {
+        seen += m_buckets.at(i);
+        if (seen >= rank) {
+            return qBound(m_min, bucketValue(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+/**
+ * Register an endpoint
+ *
+ * @param method   - HTTP method
+ * @param endpoint - Template, e.g. "/api/customers/{id}"
+ * @return int - Index to record it with; the same for a pair already registered
+ */
+int ApiMetrics::addEndpoint(const QString &method, const QString &endpoint)
+{
+    for (int i = 0; i < m_endpoints.count(); ++i) {
+        if (m_endpoints.at(i).method == method && m_endpoints.at(i).endpoint == endpoint) {
+            return i;
+        }
+    }
+
+    Endpoint stats;
+    stats.method = method;
+    stats.endpoint = endpoint;
+    m_endpoints.append(stats);
+    return int(m_endpoints.count() - 1);
+}
+
+/**
+ * Request sent
+ *
+ * @param endpoint  - Index from addEndpoint()
+ * @param bytesSent - Size of the request body
+ */
+void ApiMetrics::requestStarted(int endpoint, qint64 bytesSent)
+{
+    Endpoint &stats = m_endpoints[endpoint];
+    ++stats.requests;
+    ++stats.inFlight;
+    stats.bytesSent += quint64(qMax<qint64>(0, bytesSent));
+}
+
+void ApiMetrics::requestFinished(int endpoint, bool error, qint64 bytesReceived)
+{
+    Endpoint &stats = m_endpoints[endpoint];
+    stats.inFlight = qMax(0, stats.inFlight - 1);
+    stats.bytesReceived += quint64(qMax<qint64>(0, bytesReceived));
+    if (error) {
+        ++stats.errors;
+    }
+}
+
+void ApiMetrics::clear()
+{
+    for (Endpoint &stats : m_endpoints) {
+        Endpoint empty;
+        empty.method = stats.method;
+        empty.endpoint = stats.endpoint;
+        stats = empty;
+    }
+}
+
+/**
+ * Endpoints that have been used since the last clear()
+ */
+QList<ApiMetrics::Endpoint> ApiMetrics::endpoints() const
+{
+    QList<Endpoint> result;
+    for (const Endpoint &stats : m_endpoints) {
+        if (stats.requests || stats.retries) {
+            result.append(stats);
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Endpoint &a, const Endpoint &b) {
+        return a.endpoint != b.endpoint ? a.endpoint < b.endpoint : a.method < b.method;
+    });
+    return result;
+}
+
+int ApiMetrics::inFlight() const
+{
+    int total = 0;
+    for (const Endpoint &stats : m_endpoints) {
+        total += stats.inFlight;
+    }
+    return total;
+}
+
+/**
+ * Share of customer lookups answered from the cache (fresh or stale)
+ */
+double ApiMetrics::CacheStats::hitRatio() const
+{
+    const quint64 lookups = hits + staleHits + misses;
+    return lookups ? double(hits + staleHits) / lookups : 0.0;
+}
+
+/**
+ * Prometheus text exposition format
+ * Latencies are summaries in seconds with quantile labels
+ */
+QByteArray ApiMetrics::toPrometheus() const
+{
+    const QList<Endpoint> list = endpoints();
+    QStringList lines;
+
+    auto labels = [](const Endpoint &stats) {
+        return QString("method=\"%1\",endpoint=\"%2\"").arg(escapeLabel(stats.method), escapeLabel(stats.endpoint));
+    };
+
+    lines << "# HELP pankki_api_request_duration_seconds Request latency by phase"
+          << "# TYPE pankki_api_request_duration_seconds summary";
+    for (const Endpoint &stats : list) {
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            const Histogram &histogram = stats.phases[phase];
+            if (histogram.count() == 0) {
+                continue;
+            }
+            const QString base = labels(stats) + QString(",phase=\"%1\"").arg(phaseName(Phase(phase)));
+            for (double quantile : Quantiles) {
+                lines << QString("pankki_api_request_duration_seconds{%1,quantile=\"%2\"} %3")
+                             .arg(base).arg(quantile).arg(formatSeconds(histogram.percentile(quantile)));
+            }
+            lines << QString("pankki_api_request_duration_seconds_sum{%1} %2").arg(base, formatSeconds(histogram.sum()))
+                  << QString("pankki_api_request_duration_seconds_count{%1} %2").arg(base).arg(histogram.count());
+        }
+    }
+
+    auto counter = [&](const char *name, const char *help, const char *type, auto value) {
+        lines << QString("# HELP %1 %2").arg(name, help) << QString("# TYPE %1 %2").arg(name, type);
+        for (const Endpoint &stats : list) {
+            lines << QString("%1{%2} %3").arg(name, labels(stats)).arg(value(stats));
+        }
+    };
+    counter("pankki_api_requests_total", "Requests sent", "counter", [](const Endpoint &s) { return s.requests; });
+    counter("pankki_api_errors_total", "Failed requests (network error or HTTP >= 400)", "counter", [](const Endpoint &s) { return s.errors; });
+    counter("pankki_api_retries_total", "Requests sent again after a failure", "counter", [](const Endpoint &s) { return s.retries; });
+    counter("pankki_api_sent_bytes_total", "Request body bytes", "counter", [](const Endpoint &s) { return s.bytesSent; });
+    counter("pankki_api_received_bytes_total", "Response body bytes", "counter", [](const Endpoint &s) { return s.bytesReceived; });
+    counter("pankki_api_in_flight", "Requests waiting for a response", "gauge", [](const Endpoint &s) { return s.inFlight; });
+
+    auto cacheMetric = [&](const char *name, const char *help, const char *type, auto value) {
+        lines << QString("# HELP %1 %2").arg(name, help) << QString("# TYPE %1 %2").arg(name, type)
+              << QString("%1 %2").arg(name).arg(value);
+    };
+    cacheMetric("pankki_api_cache_hits_total", "Customer lookups answered from the cache while fresh", "counter", m_cache.hits);
+    cacheMetric("pankki_api_cache_stale_hits_total", "Customer lookups answered from the cache and revalidated", "counter", m_cache.staleHits);
+    cacheMetric("pankki_api_cache_misses_total", "Customer lookups sent to the server", "counter", m_cache.misses);
+    cacheMetric("pankki_api_cache_evictions_total", "Customers evicted to stay within the memory bound", "counter", m_cache.evictions);
+    cacheMetric("pankki_api_cache_entries", "Customers cached", "gauge", m_cache.entries);
+    cacheMetric("pankki_api_cache_bytes", "Memory charged to cached customers", "gauge", m_cache.bytes);
+    cacheMetric("pankki_api_cache_max_bytes", "Customer cache memory bound", "gauge", m_cache.maxBytes);
+
+    return lines.join('\n').toUtf8() + '\n';
+}
+
+/**
+ * JSON dump, latencies in milliseconds
+ */
+QByteArray ApiMetrics::toJson() const
+{
+    QJsonArray entries;
+    for (const Endpoint &stats : endpoints()) {
+        QJsonObject phases;
+        for (int phase = 0; phase < PhaseCount; ++phase) {
+            const Histogram &histogram = stats.phases[phase];
+            if (histogram.count() == 0) {
+                continue;
+            }
+            phases[phaseName(Phase(phase))] = QJsonObject{
+                { "count", qint64(histogram.count()) },
+                { "min", histogram.min() / 1000.0 },
+                { "mean", histogram.mean() / 1000.0 },
+                { "p50", histogram.percentile(0.5) / 1000.0 },
+                { "p90", histogram.percentile(0.9) / 1000.0 },
+                { "p99", histogram.percentile(0.99) / 1000.0 },
+                { "p999", histogram.percentile(0.999) / 1000.0 },
+                { "max", histogram.max() / 1000.0 }
+            };
+        }
+
+        entries.append(QJsonObject{
+            { "method", stats.method },
+            { "endpoint", stats.endpoint },
+            { "requests", qint64(stats.requests) },
+            { "errors", qint64(stats.errors) },
+            { "retries", qint64(stats.retries) },
+            { "bytesSent", qint64(stats.bytesSent) },
+            { "bytesReceived", qint64(stats.bytesReceived) },
+            { "inFlight", stats.inFlight },
+            { "latencyMs", phases }
+        });
+    }
+
+    QJsonObject root{
+        { "generatedAt", QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs) },
+        { "endpoints", entries },
+        { "cache", QJsonObject{
+            { "hits", qint64(m_cache.hits) },
+            { "staleHits", qint64(m_cache.staleHits) },
+            { "misses", qint64(m_cache.misses) },
+            { "hitRatio", m_cache.hitRatio() },
+            { "evictions", qint64(m_cache.evictions) },
+            { "entries", m_cache.entries },
+            { "bytes", m_cache.bytes },
+            { "maxBytes", m_cache.maxBytes }
+        } }
+    };
+    return QJsonDocument(root).toJson();
+}
+
+/**
+ * Write a metrics dump
+ *
+ * @param filePath - Target file; *.json gets JSON, anything else Prometheus text
+ * @return bool - true if the file was written
+ */
+bool ApiMetrics::exportToFile(const QString &filePath) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    file.write(filePath.endsWith(".json", Qt::CaseInsensitive) ? toJson() : toPrometheus());
+    return file.commit();
+}
+
+QString ApiMetrics::phaseName(Phase phase)
+{
+    switch (phase) {
+    case QueuePhase:
+        return QStringLiteral("queue");
+    case TlsPhase:
+        return QStringLiteral("tls");
+    case ConnectPhase:
+        return QStringLiteral("connect");
+    case WaitPhase:
+        return QStringLiteral("wait");
+    case DownloadPhase:
+        return QStringLiteral("download");
+    case ParsePhase:
+        return QStringLiteral("parse");
+    case TotalPhase:
+    case PhaseCount:
+        break;
+    }
+    return QStringLiteral("total");
+}
@@ -0,0 +1,131 @@
+/**
+ * ApiMetrics - Request metrics collected by ApiClient
+ *
+ * One entry per method and endpoint template ("/api/customers/{id}"),
+ * registered up front and recorded by index, each holding:
+ * - latency histograms per phase (queue, connect, TLS, wait, download,
+ *   parse, total) with ~1% resolution from microseconds to days, so p50/p99/p999
+ *   come from every request rather than a sample
+ * - request, error and retry counters, bytes sent/received, in-flight gauge
+ *
+ * plus the customer cache counters (hits, misses, evictions, memory use).
+ *
+ * Phases follow the QNetworkReply signals. Qt reports when a connection
+ * starts (socketStartedConnecting) and when its TLS handshake is done
+ * (encrypted), but not when DNS or TCP finish: the TLS phase runs from
+ * connecting to encrypted (DNS + TCP + handshake), the connect phase on
+ * to the request being sent. Both are absent when an open connection was
+ * reused, and the TLS phase for plain HTTP.
+ *
+ * ApiClient::metrics() returns a copy, so a snapshot can be read or
+ * exported while requests keep updating the live metrics.
+ */
+
+#ifndef APIMETRICS_H
+#define APIMETRICS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class ApiMetrics
+{
+public:
+    enum Phase {
+        QueuePhase,     // Request scheduled -> socket connecting (or request sent)
+        ConnectPhase,   // DNS + TCP + TLS -> request sent (new connections only)
+        TlsPhase,       // Connecting -> TLS handshake done (new HTTPS connections only)
+        WaitPhase,      // Request sent -> response headers (time to first byte)
+        DownloadPhase,  // Response headers -> last byte
+        ParsePhase,     // Response handling in ApiClient
+        TotalPhase,     // Request created -> last byte
+        PhaseCount
+    };
+
+    /**
+     * Log-linear latency histogram (HDR style)
+     * Values below 128 us are exact; above, each power of two is split
+     * into 64 buckets reported at their midpoint, so any value is off by
+     * at most 1/128
+     */
+    class Histogram
+    {
+    public:
+        Histogram();
+
+        void record(qint64 micros);
+        void clear();
+
+        quint64 count() const { return m_count; }
+        qint64 min() const { return m_count ? m_min : 0; }
+        qint64 max() const { return m_max; }
+        double mean() const { return m_count ? double(m_sum) / m_count : 0.0; }
+        qint64 sum() const { return m_sum; }
+
+        // Value below which the given fraction of samples fall (0.5, 0.99, 0.999)
+        qint64 percentile(double fraction) const;
+
+    private:
+        static int bucketIndex(qint64 micros);
+        static qint64 bucketValue(int index);
+
+        QList<quint64> m_buckets;  // Grown on demand
+        quint64 m_count;
+        qint64 m_sum;
+        qint64 m_min;
+        qint64 m_max;
+    };
+
+    struct Endpoint {
+        QString method;
+        QString endpoint;          // Template, e.g. "/api/customers/{id}"
+        Histogram phases[PhaseCount];
+        quint64 requests = 0;
+        quint64 errors = 0;        // Network errors and HTTP >= 400
+        quint64 retries = 0;
+        quint64 bytesSent = 0;
+        quint64 bytesReceived = 0;
+        int inFlight = 0;
+    };
+
+    // Customer cache (see CustomerCache)
+    struct CacheStats {
+        quint64 hits = 0;          // Fresh entries served
+        quint64 staleHits = 0;     // Stale entries served, then revalidated
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 bytes = 0;
+        qint64 maxBytes = 0;
+        int entries = 0;
+
+        double hitRatio() const;
+    };
+
+    // Recording (called by ApiClient): endpoints are registered once and
+    // then recorded by the returned index, without any string work
+    int addEndpoint(const QString &method, const QString &endpoint);  // Known pair: its index
+    void requestStarted(int endpoint, qint64 bytesSent);
+    void requestFinished(int endpoint, bool error, qint64 bytesReceived);
+    void recordPhase(int endpoint, Phase phase, qint64 micros) { m_endpoints[endpoint].phases[phase].record(micros); }
+    void recordRetry(int endpoint) { ++m_endpoints[endpoint].retries; }
+    void clear();  // Counters only, registrations stay
+    void setCacheStats(const CacheStats &stats) { m_cache = stats; }
+
+    // Reading
+    QList<Endpoint> endpoints() const;  // Used ones, sorted by method and endpoint
+    int inFlight() const;
+    const CacheStats &cacheStats() const { return m_cache; }
+
+    // Export - Prometheus text exposition format or JSON (milliseconds)
+    QByteArray toPrometheus() const;
+    QByteArray toJson() const;
+    bool exportToFile(const QString &filePath) const;  // JSON for *.json, else Prometheus
+
+    static QString phaseName(Phase phase);
+
+private:
+    QList<Endpoint> m_endpoints;  // By index from addEndpoint()
+    CacheStats m_cache;
+};
+
+#endif // APIMETRICS_H
@@ -0,0 +1,206 @@
+/**
+ * apimetricspanel.cpp - Request metrics debug view implementation
+ */
+
+#include "apimetricspanel.h"
+#include "apiclient.h"
+#include <QComboBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column {
+    MethodColumn,
+    EndpointColumn,
+    RequestsColumn,
+    ErrorsColumn,
+    InFlightColumn,
+    P50Column,
+    P99Column,
+    P999Column,
+    MaxColumn,
+    ReceivedColumn,
+    ColumnCount
+};
+
+QString formatMillis(qint64 micros)
+{
+    return QString::number(micros / 1000.0, 'f', micros < 10000 ? 2 : 0);
+}
+
+QString formatBytes(quint64 bytes)
+{
+    if (bytes >= 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    }
+    if (bytes >= 1024) {
+        return QString("%1 kB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 B").arg(bytes);
+}
+
+} // namespace
+
+/**
+ * Constructor
+ *
+ * @param apiClient - Client whose metrics are shown (not owned)
+ * @param parent    - Parent widget
+ */
+ApiMetricsPanel::ApiMetricsPanel(ApiClient *apiClient, QWidget *parent)
+    : QWidget(parent)
+    , m_apiClient(apiClient)
+    , m_phaseCombo(new QComboBox(this))
+    , m_table(new QTableWidget(0, ColumnCount, this))
+    , m_summaryLabel(new QLabel(this))
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    // Phase selector and actions
+    QHBoxLayout *toolbar = new QHBoxLayout();
+    toolbar->addWidget(new QLabel("Latency phase:", this));
+    for (int phase = 0; phase < ApiMetrics::PhaseCount; ++phase) {
+        m_phaseCombo->addItem(ApiMetrics::phaseName(ApiMetrics::Phase(phase)), phase);
+    }
+    m_phaseCombo->setCurrentIndex(ApiMetrics::TotalPhase);
+    toolbar->addWidget(m_phaseCombo);
+    toolbar->addStretch();
+
+    QPushButton *exportButton = new QPushButton("Export...", this);
+    QPushButton *resetButton = new QPushButton("Reset", this);
+    toolbar->addWidget(exportButton);
+    toolbar->addWidget(resetButton);
+    layout->addLayout(toolbar);
+
+    m_table->setHorizontalHeaderLabels({ "Method", "Endpoint", "Requests", "Errors", "In flight",
+                                         "p50 ms", "p99 ms", "p99.9 ms", "Max ms", "Received" });
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(EndpointColumn, QHeaderView::Stretch);
+    layout->addWidget(m_table, 1);
+
+    m_summaryLabel->setStyleSheet("color: #666;");
+    layout->addWidget(m_summaryLabel);
+
+    connect(m_apiClient, &ApiClient::metricsUpdated, this, &ApiMetricsPanel::onMetricsUpdated);
+    connect(m_phaseCombo, &QComboBox::currentIndexChanged, this, &ApiMetricsPanel::showMetrics);
+    connect(exportButton, &QPushButton::clicked, this, &ApiMetricsPanel::onExportClicked);
+    connect(resetButton, &QPushButton::clicked, this, &ApiMetricsPanel::onResetClicked);
+}
+
+/**
+ * Ask the client for a fresh metrics snapshot (shown when it arrives)
+ */
+void ApiMetricsPanel::refresh()
+{
+    m_apiClient->requestMetrics();
+}
+
+void ApiMetricsPanel::onMetricsUpdated(const ApiMetrics &metrics)
+{
+    m_metrics = metrics;
+    if (isVisible()) {
+        showMetrics();
+    }
+}
+
+/**
+ * Fill the table from the latest snapshot
+ */
+void ApiMetricsPanel::showMetrics()
+{
+    const ApiMetrics &metrics = m_metrics;
+    const QList<ApiMetrics::Endpoint> endpoints = metrics.endpoints();
+    const int phase = m_phaseCombo->currentData().toInt();
+
+    m_table->setRowCount(endpoints.count());
+
+    quint64 requests = 0;
+    quint64 errors = 0;
+    for (int row = 0; row < endpoints.count(); ++row) {
+        const ApiMetrics::Endpoint &stats = endpoints.at(row);
+        const ApiMetrics::Histogram &histogram = stats.phases[phase];
+        requests += stats.requests;
+        errors += stats.errors;
+
+        const QStringList values = {
+            stats.method,
+            stats.endpoint,
+            QString::number(stats.requests),
+            QString::number(stats.errors),
+            QString::number(stats.inFlight),
+            histogram.count() ? formatMillis(histogram.percentile(0.5)) : QString("-"),
+            histogram.count() ? formatMillis(histogram.percentile(0.99)) : QString("-"),
+            histogram.count() ? formatMillis(histogram.percentile(0.999)) : QString("-"),
+            histogram.count() ? formatMillis(histogram.max()) : QString("-"),
+            formatBytes(stats.bytesReceived)
+        };
+
+        for (int column = 0; column < ColumnCount; ++column) {
+            QTableWidgetItem *item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem();
+                if (column >= RequestsColumn) {
+                    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                }
+                m_table->setItem(row, column, item);
+            }
+            item->setText(values.at(column));
+        }
+    }
+
+    QString summary = QString("%1 request(s), %2 error(s), %3 in flight")
+                          .arg(requests).arg(errors).arg(metrics.inFlight());
+    const ApiMetrics::CacheStats &cache = metrics.cacheStats();
+    if (cache.maxBytes > 0) {
+        summary += QString(" - cache %1% hits (%2 stale), %3 of %4, %5 evicted")
+                       .arg(cache.hitRatio() * 100.0, 0, 'f', 1)
+                       .arg(cache.staleHits)
+                       .arg(formatBytes(cache.bytes), formatBytes(cache.maxBytes))
+                       .arg(cache.evictions);
+    }
+    m_summaryLabel->setText(summary);
+}
+
+void ApiMetricsPanel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    refresh();
+    m_apiClient->setMetricsInterval(1000);
+}
+
+void ApiMetricsPanel::hideEvent(QHideEvent *event)
+{
+    m_apiClient->setMetricsInterval(0);
+    QWidget::hideEvent(event);
+}
+
+/**
+ * Export button - Prometheus text (*.prom) or JSON (*.json)
+ */
+void ApiMetricsPanel::onExportClicked()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "Export API Metrics", "api-metrics.prom",
+                                                    "Prometheus text (*.prom *.txt);;JSON (*.json)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    if (!m_apiClient->exportMetrics(filePath)) {
+        QMessageBox::warning(this, "Export Failed", "Could not write " + filePath);
+    }
+}
+
+void ApiMetricsPanel::onResetClicked()
+{
+    m_apiClient->resetMetrics();
+    refresh();
+}
@@ -0,0 +1,50 @@
+/**
+ * ApiMetricsPanel - Debug view of ApiClient request metrics
+ *
+ * Table of requests per endpoint with latency percentiles, from the
+ * snapshots the client publishes once a second while the panel is
+ * visible, plus export of the full metrics as a Prometheus text or JSON
+ * file.
+ */
+
+#ifndef APIMETRICSPANEL_H
+#define APIMETRICSPANEL_H
+
+#include <QWidget>
+#include "apimetrics.h"
+
+class ApiClient;
+class QComboBox;
+class QLabel;
+class QTableWidget;
+
+class ApiMetricsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ApiMetricsPanel(ApiClient *apiClient, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onMetricsUpdated(const ApiMetrics &metrics);
+    void onExportClicked();
+    void onResetClicked();
+
+private:
+    void showMetrics();
+
+    ApiClient *m_apiClient;
+    QComboBox *m_phaseCombo;
+    QTableWidget *m_table;
+    QLabel *m_summaryLabel;
+    ApiMetrics m_metrics;  // Latest snapshot
+};
+
+#endif // APIMETRICSPANEL_H
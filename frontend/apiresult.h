@@ -0,0 +1,47 @@
+/**
+ * ApiResult - Outcome of an awaited ApiClient call
+ *
+ * Either a value or an ApiError carrying what the errorOccurred signal
+ * would have reported, plus the HTTP status and network error behind it.
+ */
+
+#ifndef APIRESULT_H
+#define APIRESULT_H
+
+#include <QNetworkReply>
+#include <QString>
+
+struct ApiError
+{
+    int httpStatus = 0;                                             // 0 = no HTTP response
+    QNetworkReply::NetworkError networkError = QNetworkReply::NoError;
+    QString message;                                                // Empty = no error
+
+    bool isError() const { return !message.isEmpty(); }
+    bool isCancelled() const { return networkError == QNetworkReply::OperationCanceledError; }
+
+    static ApiError cancelled()
+    {
+        return { 0, QNetworkReply::OperationCanceledError, QStringLiteral("Request cancelled") };
+    }
+};
+
+template<typename T>
+class ApiResult
+{
+public:
+    ApiResult(const T &value) : m_value(value) {}
+    ApiResult(T &&value) : m_value(std::move(value)) {}
+    ApiResult(const ApiError &error) : m_error(error) {}
+
+    bool isOk() const { return !m_error.isError(); }
+    const T &value() const { return m_value; }  // Default-constructed on error
+    T takeValue() { return std::move(m_value); }
+    const ApiError &error() const { return m_error; }
+
+private:
+    T m_value;
+    ApiError m_error;
+};
+
+#endif // APIRESULT_H
@@ -0,0 +1,590 @@
+/**
+ * customerbench.cpp - Micro-benchmarks for the customer parse path
+ *
+ * Each benchmark runs on synthetic payloads of 10, 10 000 and 1 000 000
+ * customers (capped by FRONTEND_BENCH_MAX_CUSTOMERS; the end-to-end case
+ * against MockBackend stops at 10 000). Besides the usual
+ * QBENCHMARK output, every case is measured for ns/customer and
+ * allocations/customer, and the results plus peak RSS are written as JSON
+ * to FRONTEND_BENCH_RESULTS (default: frontend_bench_results.json).
+ *
+ * Allocations are counted by interposing malloc on glibc, which also
+ * sees Qt's container allocations; elsewhere only operator new is
+ * counted, which misses QString/QByteArray data. On glibc free is
+ * interposed too, so the bytes a container keeps can be measured.
+ */
+
+#include <QtTest>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <QSysInfo>
+#include <QThreadPool>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "apiclient.h"
+#include "customerstore.h"
+#include "customerview.h"
+#include "isotimestamp.h"
+#include "mockbackend.h"
+#include "payloadgenerator.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// === ALLOCATION COUNTING ===
+
+static std::atomic<quint64> g_allocations { 0 };
+static std::atomic<qint64> g_liveBytes { 0 };  // Usable bytes currently allocated (glibc only)
+
+#if defined(__GLIBC__)
+static const bool LiveBytesCounted = true;
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+
+void *malloc(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *pointer = __libc_malloc(size);
+    if (pointer) {
+        g_liveBytes.fetch_add(qint64(malloc_usable_size(pointer)), std::memory_order_relaxed);
+    }
+    return pointer;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *pointer = __libc_calloc(count, size);
+    if (pointer) {
+        g_liveBytes.fetch_add(qint64(malloc_usable_size(pointer)), std::memory_order_relaxed);
+    }
+    return pointer;
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const qint64 before = pointer ? qint64(malloc_usable_size(pointer)) : 0;
+    void *result = __libc_realloc(pointer, size);
+    if (result) {
+        g_liveBytes.fetch_add(qint64(malloc_usable_size(result)) - before, std::memory_order_relaxed);
+    } else if (size == 0) {
+        g_liveBytes.fetch_sub(before, std::memory_order_relaxed);  // Freed
+    }
+    return result;
+}
+
+void free(void *pointer)
+{
+    if (pointer) {
+        g_liveBytes.fetch_sub(qint64(malloc_usable_size(pointer)), std::memory_order_relaxed);
+    }
+    __libc_free(pointer);
+}
+}
+#else
+static const bool LiveBytesCounted = false;
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+#endif
+
+namespace {
+
+qint64 peakRssBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.PeakWorkingSetSize);
+    }
+    return -1;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(Q_OS_MACOS)
+    return qint64(usage.ru_maxrss);         // Bytes
+#else
+    return qint64(usage.ru_maxrss) * 1024;  // Kilobytes
+#endif
+#endif
+}
+
+/**
+ * Finished reply with a fixed body, for driving the response handlers
+ */
+class FakeReply : public QNetworkReply
+{
+public:
+    FakeReply(const QByteArray &body, int httpStatus, NetworkError error = NoError)
+    {
+        m_body.setData(body);
+        m_body.open(QIODevice::ReadOnly);
+        setAttribute(QNetworkRequest::HttpStatusCodeAttribute, httpStatus);
+        if (error != NoError) {
+            setError(error, QString("HTTP %1").arg(httpStatus));
+        }
+        setOpenMode(QIODevice::ReadOnly);
+        setFinished(true);
+    }
+
+    void abort() override {}
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override { return m_body.bytesAvailable() + QNetworkReply::bytesAvailable(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override { return m_body.read(data, maxSize); }
+
+private:
+    QBuffer m_body;
+};
+
+void silenceDebugOutput(QtMsgType type, const QMessageLogContext &context, const QString &message)
+{
+    if (type == QtDebugMsg) {
+        return;  // ApiClient logs every response; keep the benchmark output readable
+    }
+    fprintf(stderr, "%s\n", qPrintable(qFormatLogMessage(type, context, message)));
+}
+
+} // namespace
+
+class CustomerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void fromJson_data() { addSizes(); }
+    void fromJson();
+    void customerViewParseList_data() { addSizes(); }
+    void customerViewParseList();
+    void customerViewParseListParallel_data() { addSizes(); }
+    void customerViewParseListParallel();
+    void customerViewParseCborList_data() { addSizes(); }
+    void customerViewParseCborList();
+    void isoTimestamp_data() { addSizes(); }
+    void isoTimestamp();
+    void toJson_data() { addSizes(); }
+    void toJson();
+    void customerStore_data() { addSizes(); }
+    void customerStore();
+    void handleCustomersResponse_data() { addSizes(); }
+    void handleCustomersResponse();
+    void handleError_data() { addSizes(); }
+    void handleError();
+    void getAllCustomersEndToEnd_data() { addSizes(10000); }
+    void getAllCustomersEndToEnd();
+
+private:
+    void addSizes(int limit = 1000000);
+
+    /**
+     * Time and count allocations of one benchmark case
+     * Runs the body until at least 200 ms have passed (at least once)
+     */
+    template<typename Body>
+    void measure(const char *name, int customers, Body body)
+    {
+        body();  // Warm up caches and lazily created data
+
+        const quint64 allocationsBefore = g_allocations.load();
+        body();
+        const quint64 allocations = g_allocations.load() - allocationsBefore;
+
+        QElapsedTimer timer;
+        int iterations = 0;
+        timer.start();
+        do {
+            body();
+            ++iterations;
+        } while (timer.elapsed() < 200);
+        const qint64 elapsedNs = timer.nsecsElapsed();
+
+        m_results.append(QJsonObject{
+            { "name", name },
+            { "customers", customers },
+            { "iterations", iterations },
+            { "nsPerCustomer", double(elapsedNs) / iterations / customers },
+            { "allocationsPerCustomer", double(allocations) / customers }
+        });
+    }
+
+    PayloadGenerator m_generator;
+    QJsonArray m_results;
+    QtMessageHandler m_previousHandler = nullptr;
+};
+
+void CustomerBenchmark::initTestCase()
+{
+    m_previousHandler = qInstallMessageHandler(silenceDebugOutput);
+}
+
+/**
+ * Write the machine-readable results
+ */
+void CustomerBenchmark::cleanupTestCase()
+{
+    qInstallMessageHandler(m_previousHandler);
+
+    QJsonObject root{
+        { "benchmarks", m_results },
+        { "peakRssBytes", peakRssBytes() },
+        { "qtVersion", qVersion() },
+        { "cpu", QSysInfo::currentCpuArchitecture() },
+        { "os", QSysInfo::prettyProductName() },
+        { "allocationCounter",
+#if defined(__GLIBC__)
+          "malloc"
+#else
+          "operator new"
+#endif
+        }
+    };
+
+    QString path = qEnvironmentVariable("FRONTEND_BENCH_RESULTS", "frontend_bench_results.json");
+    QFile file(path);
+    QVERIFY2(file.open(QIODevice::WriteOnly), qPrintable(file.errorString()));
+    file.write(QJsonDocument(root).toJson());
+    qInfo("Benchmark results written to %s", qPrintable(path));
+}
+
+void CustomerBenchmark::addSizes(int limit)
+{
+    QTest::addColumn<int>("customers");
+
+    const int maxCustomers = qEnvironmentVariableIntValue("FRONTEND_BENCH_MAX_CUSTOMERS") > 0
+        ? qEnvironmentVariableIntValue("FRONTEND_BENCH_MAX_CUSTOMERS")
+        : 1000000;
+
+    for (int count : { 10, 10000, 1000000 }) {
+        if (count <= maxCustomers && count <= limit) {
+            QTest::newRow(qPrintable(QString::number(count))) << count;
+        }
+    }
+}
+
+void CustomerBenchmark::fromJson()
+{
+    QFETCH(int, customers);
+
+    const QJsonArray data = QJsonDocument::fromJson(m_generator.customersResponse(customers)).object()["data"].toArray();
+    QList<Customer> parsed;
+    parsed.reserve(customers);
+
+    auto body = [&]() {
+        parsed.clear();
+        for (const QJsonValue &value : data) {
+            parsed.append(Customer(value.toObject()));
+        }
+    };
+
+    measure("Customer::fromJson", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(parsed.count(), customers);
+}
+
+/**
+ * CustomerView::parseList plus the fields a table row shows (id and
+ * names); addresses and timestamps stay undecoded
+ */
+void CustomerBenchmark::customerViewParseList()
+{
+    QFETCH(int, customers);
+
+    const QByteArray payload = m_generator.customersResponse(customers);
+    qsizetype characters = 0;
+    int parsed = 0;
+
+    auto body = [&]() {
+        const CustomerView::ParseResult result = CustomerView::parseList(payload);
+        characters = 0;
+        for (const CustomerView &view : result.customers) {
+            characters += view.getId() > 0 ? view.getFirstName().size() + view.getLastName().size() : 0;
+        }
+        parsed = result.customers.count();
+    };
+
+    measure("CustomerView::parseList", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(parsed, customers);
+    QVERIFY(characters > 0);
+}
+
+/**
+ * CustomerView::parseList splitting the array over the global thread pool
+ */
+void CustomerBenchmark::customerViewParseListParallel()
+{
+    QFETCH(int, customers);
+
+    const QByteArray payload = m_generator.customersResponse(customers);
+    int parsed = 0;
+
+    auto body = [&]() {
+        parsed = CustomerView::parseList(payload, QThreadPool::globalInstance()).customers.count();
+    };
+
+    measure("CustomerView::parseList (parallel)", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(parsed, customers);
+}
+
+/**
+ * The same list as application/cbor (what the backend sends on
+ * Accept: application/cbor), with the same fields read as parseList
+ */
+void CustomerBenchmark::customerViewParseCborList()
+{
+    QFETCH(int, customers);
+
+    const QByteArray payload = MockBackend::toCbor(m_generator.customersResponse(customers));
+    qsizetype characters = 0;
+    int parsed = 0;
+
+    auto body = [&]() {
+        const CustomerView::ParseResult result = CustomerView::parseCborList(payload);
+        characters = 0;
+        for (const CustomerView &view : result.customers) {
+            characters += view.getId() > 0 ? view.getFirstName().size() + view.getLastName().size() : 0;
+        }
+        parsed = result.customers.count();
+    };
+
+    measure("CustomerView::parseCborList", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(parsed, customers);
+    QVERIFY(characters > 0);
+}
+
+/**
+ * IsoTimestamp::parse on the createdAt strings of a payload
+ */
+void CustomerBenchmark::isoTimestamp()
+{
+    QFETCH(int, customers);
+
+    const QList<Customer> list = m_generator.customers(customers);
+    QList<QByteArray> timestamps;
+    timestamps.reserve(customers);
+    for (const Customer &customer : list) {
+        timestamps.append(customer.getCreatedAt().toString(Qt::ISODateWithMs).toLatin1());
+    }
+    qint64 sum = 0;
+
+    auto body = [&]() {
+        sum = 0;
+        for (const QByteArray &timestamp : timestamps) {
+            qint64 msecs = 0;
+            IsoTimestamp::parse(timestamp, &msecs);
+            sum += msecs;
+        }
+    };
+
+    measure("IsoTimestamp::parse", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QVERIFY(sum != 0);
+}
+
+void CustomerBenchmark::toJson()
+{
+    QFETCH(int, customers);
+
+    const QList<Customer> list = m_generator.customers(customers);
+    qsizetype fields = 0;
+
+    auto body = [&]() {
+        fields = 0;
+        for (const Customer &customer : list) {
+            fields += customer.toJson().size();
+        }
+    };
+
+    measure("Customer::toJson", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QVERIFY(fields >= qsizetype(customers) * 4);
+}
+
+/**
+ * CustomerStore::append from parsed views, and the heap bytes per
+ * customer the store keeps against a QList<Customer> of the same rows
+ */
+void CustomerBenchmark::customerStore()
+{
+    QFETCH(int, customers);
+
+    const QList<CustomerView> views = CustomerView::parseList(m_generator.customersResponse(customers)).customers;
+
+    qint64 before = g_liveBytes.load();
+    const QList<Customer> baseline = CustomerView::toCustomers(views);
+    const qint64 baselineBytes = g_liveBytes.load() - before;
+
+    before = g_liveBytes.load();
+    CustomerStore store;
+    store.append(views);
+    const qint64 storeBytes = g_liveBytes.load() - before;
+
+    QJsonObject memory{
+        { "name", "CustomerStore memory" },
+        { "customers", customers },
+        { "reportedBytesPerCustomer", double(store.memoryUsage()) / customers }  // CustomerStore::memoryUsage()
+    };
+    if (LiveBytesCounted) {
+        memory.insert("bytesPerCustomer", double(storeBytes) / customers);
+        memory.insert("baselineBytesPerCustomer", double(baselineBytes) / customers);  // QList<Customer>
+    }
+    m_results.append(memory);
+
+    auto body = [&]() {
+        store.clear();
+        store.append(views);
+    };
+
+    measure("CustomerStore::append", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(store.count(), customers);
+    QCOMPARE(baseline.count(), customers);
+}
+
+void CustomerBenchmark::handleCustomersResponse()
+{
+    QFETCH(int, customers);
+
+    const QByteArray payload = m_generator.customersResponse(customers);
+    ApiClient client;
+    client.setPrewarmEnabled(false);
+    FakeReply reply(QByteArray(), 200);
+    const ApiClient::RequestContext context { ApiClient::CustomersRoute, QStringLiteral("/api/customers") };
+
+    int received = 0;
+    connect(&client, &ApiClient::customerViewsReceived, this, [&received](const QList<CustomerView> &list) {
+        received = list.count();
+    });
+
+    auto body = [&]() {
+        client.handleCustomersResponse(&reply, context, payload);
+    };
+
+    measure("ApiClient::handleCustomersResponse", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(received, customers);
+}
+
+void CustomerBenchmark::handleError()
+{
+    QFETCH(int, customers);
+
+    const QByteArray payload = m_generator.batchErrorResponse(customers);
+    ApiClient client;
+    client.setPrewarmEnabled(false);
+
+    QString message;
+    connect(&client, &ApiClient::errorOccurred, this, [&message](const QString &error) {
+        message = error;
+    });
+
+    // handleError() reads the body, so every run needs a fresh reply
+    auto body = [&]() {
+        FakeReply reply(payload, 400, QNetworkReply::ContentOperationNotPermittedError);
+        client.handleError(&reply);
+    };
+
+    measure("ApiClient::handleError", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QVERIFY(message.contains("are invalid"));
+}
+
+/**
+ * GET /api/customers over loopback HTTP against MockBackend, through
+ * customersReceived; includes the mock's response work (body and ETag)
+ */
+void CustomerBenchmark::getAllCustomersEndToEnd()
+{
+    QFETCH(int, customers);
+
+    MockBackend backend;
+    backend.seedCustomers(customers);
+    QVERIFY2(backend.listen(), qPrintable(backend.errorString()));
+
+    ApiClient client;
+    client.setPrewarmEnabled(false);
+    client.setBaseUrl(backend.baseUrl());
+
+    QEventLoop loop;
+    int received = 0;
+    connect(&client, &ApiClient::customersReceived, &loop, [&](const QList<Customer> &list) {
+        received = list.count();
+        loop.quit();
+    });
+    connect(&client, &ApiClient::errorOccurred, &loop, &QEventLoop::quit);
+
+    auto body = [&]() {
+        received = 0;
+        client.getAllCustomers();
+        loop.exec();
+    };
+
+    measure("ApiClient::getAllCustomers (MockBackend)", customers, body);
+    QBENCHMARK {
+        body();
+    }
+    QCOMPARE(received, customers);
+}
+
+QTEST_GUILESS_MAIN(CustomerBenchmark)
+
+#include "customerbench.moc"
@@ -6,6 +6,7 @@
  */
 
 #include "customer.h"
+#include "isotimestamp.h"
 #include <QJsonDocument>
 
 /**
@@ -80,15 +81,15 @@ void Customer::fromJson(const QJsonObject &json)
     m_lastName = json["lastName"].toString();
     m_address = json["address"].toString();
     
-    // Parse ISO 8601 timestamps from API
+    // Parse ISO 8601 timestamps from API (fast path for Date.toISOString)
     QString createdAtStr = json["createdAt"].toString();
     if (!createdAtStr.isEmpty()) {
-        m_createdAt = QDateTime::fromString(createdAtStr, Qt::ISODate);
+        m_createdAt = IsoTimestamp::toDateTime(createdAtStr);
     }
     
     QString updatedAtStr = json["updatedAt"].toString();
     if (!updatedAtStr.isEmpty()) {
-        m_updatedAt = QDateTime::fromString(updatedAtStr, Qt::ISODate);
+        m_updatedAt = IsoTimestamp::toDateTime(updatedAtStr);
     }
 }
 
@@ -0,0 +1,179 @@
+/**
+ * customercache.cpp - Customer cache implementation
+ */
+
+#include "customercache.h"
+
+namespace {
+
+// Charged per entry besides its strings: the Entry and its list node, the
+// index node, and the QString/QDateTime private data
+const qsizetype EntryOverhead = 160;
+
+} // namespace
+
+/**
+ * Constructor
+ *
+ * @param maxBytes - Memory bound, 0 = disabled
+ * @param maxAgeMs - Age after which an entry is stale
+ */
+CustomerCache::CustomerCache(qsizetype maxBytes, qint64 maxAgeMs)
+    : m_maxBytes(qMax<qsizetype>(0, maxBytes))
+    , m_maxAgeMs(qMax<qint64>(0, maxAgeMs))
+    , m_bytes(0)
+{
+}
+
+void CustomerCache::setMaxBytes(qsizetype maxBytes)
+{
+    m_maxBytes = qMax<qsizetype>(0, maxBytes);
+    evict();
+}
+
+/**
+ * Look up a customer
+ *
+ * @param id       - Customer id
+ * @param nowMs    - Current time (same clock as insert())
+ * @param customer - Receives the cached customer unless Miss
+ * @return Lookup - Miss, Fresh or Stale
+ */
+CustomerCache::Lookup CustomerCache::find(int id, qint64 nowMs, Customer *customer)
+{
+    const auto it = m_index.constFind(id);
+    if (it == m_index.cend()) {
+        ++m_stats.misses;
+        return Miss;
+    }
+
+    // Move to the front: most recently used
+    m_entries.splice(m_entries.begin(), m_entries, *it);
+    const Entry &entry = m_entries.front();
+    *customer = entry.customer;
+
+    if (nowMs - entry.storedMs > m_maxAgeMs) {
+        ++m_stats.staleHits;
+        return Stale;
+    }
+    ++m_stats.hits;
+    return Fresh;
+}
+
+void CustomerCache::insert(const Customer &customer, qint64 nowMs)
+{
+    if (m_maxBytes <= 0) {
+        return;
+    }
+
+    const qsizetype entryCost = cost(customer.getFirstName().size() + customer.getLastName().size()
+                                     + customer.getAddress().size());
+    remove(customer.getId());
+    if (entryCost > m_maxBytes) {
+        return;
+    }
+
+    m_entries.push_front(Entry{ customer, nowMs, entryCost });
+    m_index.insert(customer.getId(), m_entries.begin());
+    m_bytes += entryCost;
+    evict();
+}
+
+void CustomerCache::insert(const QList<Customer> &customers, qint64 nowMs)
+{
+    for (const Customer &customer : customers) {
+        insert(customer, nowMs);
+    }
+}
+
+/**
+ * Store a list response
+ * Only the tail that fits is materialized: inserting the rest would just
+ * evict it again
+ */
+void CustomerCache::insert(const QList<CustomerView> &views, qint64 nowMs)
+{
+    if (m_maxBytes <= 0) {
+        return;
+    }
+
+    qsizetype first = views.count();
+    qsizetype budget = m_maxBytes;
+    while (first > 0) {
+        const CustomerView &view = views.at(first - 1);
+        if (!view.isDeleted()) {
+            // UTF-8 length: at least the UTF-16 length
+            budget -= cost(view.firstNameUtf8().size() + view.lastNameUtf8().size() + view.addressUtf8().size());
+            if (budget < 0) {
+                break;
+            }
+        }
+        --first;
+    }
+
+    for (qsizetype i = 0; i < views.count(); ++i) {
+        const CustomerView &view = views.at(i);
+        if (view.isDeleted()) {
+            remove(view.getId());
+        } else if (i >= first) {
+            insert(view.toCustomer(), nowMs);
+        } else {
+            remove(view.getId());  // The cached copy is out of date
+        }
+    }
+}
+
+void CustomerCache::remove(int id)
+{
+    const auto it = m_index.constFind(id);
+    if (it == m_index.cend()) {
+        return;
+    }
+
+    m_bytes -= (*it)->cost;
+    m_entries.erase(*it);
+    m_index.erase(it);
+}
+
+void CustomerCache::clear()
+{
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+ApiMetrics::CacheStats CustomerCache::stats() const
+{
+    ApiMetrics::CacheStats stats = m_stats;
+    stats.entries = int(m_index.count());
+    stats.bytes = m_bytes;
+    stats.maxBytes = m_maxBytes;
+    return stats;
+}
+
+void CustomerCache::resetStats()
+{
+    m_stats = ApiMetrics::CacheStats();
+}
+
+/**
+ * Memory charged for an entry with the given total string length
+ */
+qsizetype CustomerCache::cost(qsizetype textLength)
+{
+    return EntryOverhead + textLength * qsizetype(sizeof(QChar));
+}
+
+/**
+ * Drop least recently used entries until the total fits the bound
+ */
+void CustomerCache::evict()
+{
+    while (m_bytes > m_maxBytes && !m_entries.empty()) {
+        const Entry &entry = m_entries.back();
+        m_bytes -= entry.cost;
+        m_index.remove(entry.customer.getId());
+        m_entries.pop_back();
+        ++m_stats.evictions;
+    }
+}
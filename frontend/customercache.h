@@ -0,0 +1,72 @@
+/**
+ * CustomerCache - Byte-bounded LRU cache of customers by id
+ *
+ * ApiClient keeps the customers it has seen here (single, list, page and
+ * sync responses, and its own changes) so getCustomerById() can answer
+ * without a round trip. The bound is in bytes: each entry is charged
+ * for its strings plus a fixed overhead, and the least recently used
+ * entries are evicted once the total goes over the limit.
+ *
+ * Entries older than the max age are stale: find() still returns them
+ * (the caller revalidates in the background), so a lookup never waits on
+ * the network for a customer that has been seen before.
+ */
+
+#ifndef CUSTOMERCACHE_H
+#define CUSTOMERCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <list>
+#include "apimetrics.h"
+#include "customer.h"
+#include "customerview.h"
+
+class CustomerCache
+{
+public:
+    enum Lookup {
+        Miss,
+        Fresh,
+        Stale       // Older than the max age; serve and revalidate
+    };
+
+    explicit CustomerCache(qsizetype maxBytes = 0, qint64 maxAgeMs = 30000);
+
+    void setMaxBytes(qsizetype maxBytes);  // 0 disables the cache (and empties it)
+    qsizetype maxBytes() const { return m_maxBytes; }
+    void setMaxAge(qint64 maxAgeMs) { m_maxAgeMs = qMax<qint64>(0, maxAgeMs); }
+    qint64 maxAge() const { return m_maxAgeMs; }
+
+    // Lookup; counts a hit or a miss and marks the entry recently used
+    Lookup find(int id, qint64 nowMs, Customer *customer);
+
+    // Store (or replace) customers as of nowMs
+    void insert(const Customer &customer, qint64 nowMs);
+    void insert(const QList<Customer> &customers, qint64 nowMs);
+    void insert(const QList<CustomerView> &views, qint64 nowMs);  // Tombstones are removed
+    void remove(int id);
+    void clear();
+
+    ApiMetrics::CacheStats stats() const;
+    void resetStats();
+
+private:
+    struct Entry {
+        Customer customer;
+        qint64 storedMs;
+        qsizetype cost;
+    };
+
+    static qsizetype cost(qsizetype textLength);
+    void evict();
+
+    qsizetype m_maxBytes;
+    qint64 m_maxAgeMs;
+    qsizetype m_bytes;
+    std::list<Entry> m_entries;                           // Most recently used first
+    QHash<int, std::list<Entry>::iterator> m_index;
+    ApiMetrics::CacheStats m_stats;
+};
+
+#endif // CUSTOMERCACHE_H
@@ -0,0 +1,284 @@
+/**
+ * customerimportreader.cpp - Customer import file reader implementation
+ */
+
+#include "customerimportreader.h"
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+// "First_Name" -> "firstname"
+QString columnKey(const QString &name)
+{
+    return name.trimmed().toLower().remove('_').remove(' ');
+}
+
+} // namespace
+
+/**
+ * Constructor
+ *
+ * @param filePath - CSV or NDJSON file to import
+ * @param format   - File format (AutoFormat = detect)
+ */
+CustomerImportReader::CustomerImportReader(const QString &filePath, Format format)
+    : m_file(filePath)
+    , m_format(format)
+    , m_line(0)
+    , m_recordsRead(0)
+    , m_separator(',')
+    , m_firstNameColumn(0)
+    , m_lastNameColumn(1)
+    , m_addressColumn(2)
+    , m_pendingLine(0)
+    , m_hasPendingRecord(false)
+{
+}
+
+/**
+ * Open the file, detect its format and read the CSV header
+ *
+ * @return bool - false if the file cannot be read (see errorString())
+ */
+bool CustomerImportReader::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+
+    // Spreadsheet exports often start with a UTF-8 byte order mark
+    if (m_file.peek(3) == "\xEF\xBB\xBF") {
+        m_file.read(3);
+    }
+
+    if (m_format == AutoFormat) {
+        const QString suffix = QFileInfo(m_file.fileName()).suffix().toLower();
+        if (suffix == "csv" || suffix == "txt") {
+            m_format = CsvFormat;
+        } else if (suffix == "ndjson" || suffix == "jsonl" || suffix == "json") {
+            m_format = NdjsonFormat;
+        } else {
+            m_format = m_file.peek(64).trimmed().startsWith('{') ? NdjsonFormat : CsvFormat;
+        }
+    }
+
+    if (m_format == NdjsonFormat) {
+        return true;
+    }
+
+    // Separator: whichever of ',' and ';' occurs more outside quotes
+    const QByteArray head = m_file.peek(4096).split('\n').first();
+    int commas = 0;
+    int semicolons = 0;
+    bool quoted = false;
+    for (char c : head) {
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (!quoted && c == ',') {
+            ++commas;
+        } else if (!quoted && c == ';') {
+            ++semicolons;
+        }
+    }
+    m_separator = semicolons > commas ? ';' : ',';
+
+    // Header row, or the first customer if the columns are not named
+    QStringList first;
+    const qint64 firstLine = m_line + 1;
+    if (readCsvRecord(&first)) {
+        QStringList keys;
+        for (const QString &field : first) {
+            keys.append(columnKey(field));
+        }
+        if (keys.contains("firstname") || keys.contains("lastname") || keys.contains("address")) {
+            setColumns(keys);
+        } else {
+            m_pendingRecord = first;
+            m_pendingLine = firstLine;
+            m_hasPendingRecord = true;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Read the next customers
+ *
+ * @param maxCount - Maximum number of customers to return
+ * @param lines    - Optional; receives the starting line of each customer
+ * @return QList<Customer> - Valid customers; empty at the end of the file
+ */
+QList<Customer> CustomerImportReader::read(int maxCount, QList<qint64> *lines)
+{
+    QList<Customer> customers;
+    customers.reserve(maxCount);
+
+    Customer customer;
+    qint64 line = 0;
+    while (customers.count() < maxCount && readCustomer(&customer, &line)) {
+        customers.append(customer);
+        if (lines) {
+            lines->append(line);
+        }
+    }
+
+    return customers;
+}
+
+bool CustomerImportReader::atEnd() const
+{
+    return !m_hasPendingRecord && m_file.atEnd();
+}
+
+QList<CustomerImportReader::Error> CustomerImportReader::takeErrors()
+{
+    QList<Error> errors;
+    errors.swap(m_errors);
+    return errors;
+}
+
+/**
+ * Read one CSV record, which may span several lines
+ *
+ * @param fields - Receives the fields of the record
+ * @return bool - false at the end of the file
+ */
+bool CustomerImportReader::readCsvRecord(QStringList *fields)
+{
+    fields->clear();
+
+    QString field;
+    bool quoted = false;
+    bool started = false;
+
+    while (!m_file.atEnd()) {
+        QString line = QString::fromUtf8(m_file.readLine());
+        ++m_line;
+
+        while (line.endsWith('\n') || line.endsWith('\r')) {
+            line.chop(1);
+        }
+        if (!started && line.trimmed().isEmpty()) {
+            continue;  // Blank line between records
+        }
+        started = true;
+
+        for (int i = 0; i < line.size(); ++i) {
+            const QChar c = line.at(i);
+            if (quoted) {
+                if (c == '"' && i + 1 < line.size() && line.at(i + 1) == '"') {
+                    field.append('"');  // Escaped quote
+                    ++i;
+                } else if (c == '"') {
+                    quoted = false;
+                } else {
+                    field.append(c);
+                }
+            } else if (c == '"') {
+                quoted = true;
+            } else if (c == QLatin1Char(m_separator)) {
+                fields->append(field);
+                field.clear();
+            } else {
+                field.append(c);
+            }
+        }
+
+        if (!quoted) {
+            fields->append(field);
+            return true;
+        }
+        field.append('\n');  // Line break inside a quoted field
+    }
+
+    // Unterminated quote at the end of the file - keep what was read
+    if (started) {
+        fields->append(field.trimmed());
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Read the next valid customer, skipping (and recording) invalid rows
+ *
+ * @return bool - false at the end of the file
+ */
+bool CustomerImportReader::readCustomer(Customer *customer, qint64 *line)
+{
+    for (;;) {
+        qint64 recordLine = m_line + 1;
+        *customer = Customer();
+
+        if (m_format == NdjsonFormat) {
+            if (m_file.atEnd()) {
+                return false;
+            }
+            const QByteArray text = m_file.readLine().trimmed();
+            ++m_line;
+            if (text.isEmpty()) {
+                continue;
+            }
+
+            QJsonParseError parseError;
+            const QJsonDocument doc = QJsonDocument::fromJson(text, &parseError);
+            if (!doc.isObject()) {
+                m_errors.append({ recordLine, parseError.error != QJsonParseError::NoError
+                                                  ? parseError.errorString()
+                                                  : QStringLiteral("Expected a JSON object") });
+                continue;
+            }
+            customer->fromJson(doc.object());
+        } else {
+            QStringList fields;
+            if (m_hasPendingRecord) {
+                fields = m_pendingRecord;
+                recordLine = m_pendingLine;
+                m_pendingRecord.clear();
+                m_hasPendingRecord = false;
+            } else if (!readCsvRecord(&fields)) {
+                return false;
+            }
+
+            const int needed = qMax(m_firstNameColumn, qMax(m_lastNameColumn, m_addressColumn));
+            if (fields.count() <= needed) {
+                m_errors.append({ recordLine, QString("Expected %1 columns, found %2").arg(needed + 1).arg(fields.count()) });
+                continue;
+            }
+            customer->setFirstName(fields.at(m_firstNameColumn).trimmed());
+            customer->setLastName(fields.at(m_lastNameColumn).trimmed());
+            customer->setAddress(fields.at(m_addressColumn).trimmed());
+        }
+
+        ++m_recordsRead;
+
+        if (!customer->isValid()) {
+            m_errors.append({ recordLine, QStringLiteral("Missing required fields: firstName, lastName, address") });
+            continue;
+        }
+        *line = recordLine;
+        return true;
+    }
+}
+
+/**
+ * Map the named CSV columns; a missing name keeps its positional default
+ *
+ * @param header - Normalized column names of the header row
+ */
+void CustomerImportReader::setColumns(const QStringList &header)
+{
+    if (header.contains("firstname")) {
+        m_firstNameColumn = header.indexOf("firstname");
+    }
+    if (header.contains("lastname")) {
+        m_lastNameColumn = header.indexOf("lastname");
+    }
+    if (header.contains("address")) {
+        m_addressColumn = header.indexOf("address");
+    }
+}
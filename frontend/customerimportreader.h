@@ -0,0 +1,79 @@
+/**
+ * CustomerImportReader - Streaming reader for customer import files
+ *
+ * Reads customers from CSV or NDJSON (one JSON object per line) a few
+ * records at a time, so an import of any size only keeps the records
+ * currently being sent in memory.
+ *
+ * CSV:
+ * - optional header row naming the columns (firstName, lastName, address;
+ *   case and '_' are ignored), otherwise columns are taken in that order
+ * - ',' or ';' separator (detected from the first row)
+ * - RFC 4180 quoting, so addresses may contain separators and newlines
+ *
+ * Rows that cannot be read are skipped and reported through takeErrors().
+ */
+
+#ifndef CUSTOMERIMPORTREADER_H
+#define CUSTOMERIMPORTREADER_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "customer.h"
+
+class CustomerImportReader
+{
+public:
+    enum Format {
+        AutoFormat,    // From the file extension, else from the content
+        CsvFormat,
+        NdjsonFormat
+    };
+
+    struct Error {
+        qint64 line;      // 1-based line where the record starts
+        QString message;
+    };
+
+    explicit CustomerImportReader(const QString &filePath, Format format = AutoFormat);
+
+    bool open();
+    QString errorString() const { return m_error; }
+    Format format() const { return m_format; }
+
+    // Read up to maxCount valid customers (fewer only at the end of the file)
+    // lines, if given, receives the line each customer starts on
+    QList<Customer> read(int maxCount, QList<qint64> *lines = nullptr);
+    bool atEnd() const;
+
+    // Rows skipped since the last call
+    QList<Error> takeErrors();
+
+    // Progress
+    qint64 recordsRead() const { return m_recordsRead; }
+    qint64 bytesRead() const { return m_file.pos(); }
+    qint64 size() const { return m_file.size(); }
+
+private:
+    bool readCsvRecord(QStringList *fields);
+    bool readCustomer(Customer *customer, qint64 *line);
+    void setColumns(const QStringList &header);
+
+    QFile m_file;
+    Format m_format;
+    QString m_error;
+    QList<Error> m_errors;
+    qint64 m_line;
+    qint64 m_recordsRead;
+    char m_separator;
+    int m_firstNameColumn;
+    int m_lastNameColumn;
+    int m_addressColumn;
+    QStringList m_pendingRecord;  // First CSV row when it was not a header
+    qint64 m_pendingLine;
+    bool m_hasPendingRecord;
+};
+
+#endif // CUSTOMERIMPORTREADER_H
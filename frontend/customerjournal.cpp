@@ -0,0 +1,535 @@
+/**
+ * customerjournal.cpp - Customer write-behind journal implementation
+ *
+ * The file is opened through a plain descriptor so sync() can fsync it
+ * (QFile has no way to do that). Records are framed with their length and
+ * a checksum; replay stops at the first record that does not check out.
+ */
+
+#include "customerjournal.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char JournalMagic[4] = { 'P', 'K', 'C', 'J' };
+const quint16 JournalVersion = 1;
+
+const qsizetype HeaderSize = 4 + 2 + 2;
+const qsizetype FrameSize = 4 + 2;                  // Length + checksum
+const qsizetype EntrySize = 1 + 8 + 4;              // Type, sequence, id
+const qsizetype FieldsSize = 2 + 2 + 2;             // String lengths
+const qsizetype AcknowledgeSize = EntrySize + 4;
+const quint32 MaxPayloadSize = 1024 * 1024;
+const qint64 CompactSize = 4 * 1024 * 1024;         // Rewrite a file grown past this
+
+template <typename T>
+void appendValue(QByteArray &out, T value)
+{
+    const T le = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+template <typename T>
+T readValue(const char *data)
+{
+    return qFromLittleEndian<T>(reinterpret_cast<const uchar *>(data));
+}
+
+QByteArray journalHeader()
+{
+    QByteArray header(JournalMagic, sizeof(JournalMagic));
+    appendValue<quint16>(header, JournalVersion);
+    appendValue<quint16>(header, 0);
+    return header;
+}
+
+// Strings are stored with 16-bit lengths; database columns are at most 255 characters
+QByteArray clampedUtf8(const QString &text)
+{
+    QByteArray utf8 = text.toUtf8();
+    if (utf8.size() > 0xFFFF) {
+        utf8.truncate(0xFFFF);
+    }
+    return utf8;
+}
+
+int openDescriptor(const QString &path)
+{
+#ifdef Q_OS_WIN
+    return _wopen(reinterpret_cast<const wchar_t *>(path.utf16()), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY,
+                  _S_IREAD | _S_IWRITE);
+#else
+    return ::open(QFile::encodeName(path).constData(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+#endif
+}
+
+bool syncDescriptor(int fd)
+{
+#ifdef Q_OS_WIN
+    return _commit(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+} // namespace
+
+/**
+ * Constructor
+ *
+ * @param path - Journal file path (see pathForBaseUrl)
+ */
+CustomerJournal::CustomerJournal(const QString &path)
+    : m_path(path)
+    , m_fd(-1)
+    , m_nextSequence(1)
+    , m_unsynced(false)
+{
+}
+
+CustomerJournal::~CustomerJournal()
+{
+    close();
+}
+
+/**
+ * Journal file location for an API base URL
+ * Files live in the application data directory (not the cache, which
+ * may be cleaned up), named by a hash of the URL
+ *
+ * @param baseUrl - API base URL
+ * @return QString - Absolute journal file path
+ */
+QString CustomerJournal::pathForBaseUrl(const QString &baseUrl)
+{
+    const QByteArray hash = QCryptographicHash::hash(baseUrl.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dir + "/journal-" + QString::fromLatin1(hash) + ".log";
+}
+
+/**
+ * Open the journal and load the mutations still pending
+ * A torn record at the end is cut off; a file that is not a journal at
+ * all is moved aside (".bad") and a new one started
+ *
+ * @return bool - true if the journal is open for appending
+ */
+bool CustomerJournal::open()
+{
+    close();
+    m_pending.clear();
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+
+    if (!openFile()) {
+        return false;
+    }
+
+    const QByteArray data = m_file.readAll();
+    if (data.isEmpty()) {
+        return writeHeader();
+    }
+
+    if (data.size() < HeaderSize || std::memcmp(data.constData(), JournalMagic, sizeof(JournalMagic)) != 0
+        || readValue<quint16>(data.constData() + 4) != JournalVersion) {
+        qDebug() << "Customer journal" << m_path << "is not readable, starting a new one";
+        close();
+        QFile::remove(m_path + ".bad");
+        QFile::rename(m_path, m_path + ".bad");
+        return openFile() && writeHeader();
+    }
+
+    const qint64 validSize = replay(data);
+    if (validSize < data.size()) {
+        qDebug() << "Customer journal: dropping" << data.size() - validSize << "bytes of a torn record";
+        m_file.resize(validSize);
+        m_unsynced = true;
+    }
+    if (m_pending.isEmpty() && validSize > HeaderSize) {
+        truncate();
+    }
+
+    qDebug() << "Customer journal opened:" << m_pending.count() << "pending mutations";
+    return true;
+}
+
+/**
+ * Make outstanding records durable and close the file
+ */
+void CustomerJournal::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    sync();
+    m_file.close();
+    m_fd = -1;
+}
+
+/**
+ * Append a mutation
+ * The record goes to the OS right away (it survives the application
+ * crashing); call sync() to make it survive a power loss as well
+ *
+ * @param operation - Create, update or delete
+ * @param id        - Customer id (provisional for creates)
+ * @param customer  - Fields for a create or update
+ * @return quint64 - Sequence number, for acknowledge()
+ */
+quint64 CustomerJournal::append(Operation operation, int id, const Customer &customer)
+{
+    const quint64 sequence = m_nextSequence++;
+    Entry entry { operation, id, customer };
+    entry.customer.setId(id);
+
+    writeRecord(entryPayload(sequence, entry));
+    m_pending.insert(sequence, entry);
+    return sequence;
+}
+
+/**
+ * Mark mutations as applied on the server
+ * The file is truncated once nothing is pending, or rewritten when it
+ * has grown past the size limit
+ *
+ * @param sequences  - Records the request covered
+ * @param assignedId - Server id given to the create among them (0 = none)
+ */
+void CustomerJournal::acknowledge(const QList<quint64> &sequences, int assignedId)
+{
+    for (quint64 sequence : sequences) {
+        auto it = m_pending.find(sequence);
+        if (it == m_pending.end()) {
+            continue;
+        }
+
+        const bool created = it->operation == CreateOperation && it->id < 0 && assignedId != 0;
+        writeRecord(acknowledgePayload(sequence, it->id, created ? assignedId : 0));
+        if (created) {
+            m_assignedIds.insert(it->id, assignedId);
+        }
+        m_pending.erase(it);
+    }
+
+    if (m_pending.isEmpty()) {
+        truncate();
+    } else if (m_file.isOpen() && m_file.size() > CompactSize) {
+        compact();
+    }
+}
+
+/**
+ * Make everything appended since the last call durable (one fsync)
+ *
+ * @return bool - false if the data could not be synced
+ */
+bool CustomerJournal::sync()
+{
+    if (!m_file.isOpen() || !m_unsynced) {
+        return true;
+    }
+
+    m_unsynced = false;
+    if (!m_file.flush() || !syncDescriptor(m_fd)) {
+        qDebug() << "Customer journal sync failed:" << m_path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Lowest provisional id in use, so new ones do not collide after a restart
+ *
+ * @return int - Negative id, or 0 if there is none
+ */
+int CustomerJournal::lowestProvisionalId() const
+{
+    int lowest = 0;
+    for (const Entry &entry : m_pending) {
+        lowest = qMin(lowest, entry.id);
+    }
+    for (auto it = m_assignedIds.cbegin(); it != m_assignedIds.cend(); ++it) {
+        lowest = qMin(lowest, it.key());
+    }
+    return lowest;
+}
+
+/**
+ * Fold the pending records into one request per customer
+ * Mutations are ordered by their first pending record.
+ *
+ * @param excluded - Records already in flight
+ * @return QList<Mutation> - Requests to send (NoOperation ones need none)
+ */
+QList<CustomerJournal::Mutation> CustomerJournal::coalesce(const QSet<quint64> &excluded) const
+{
+    QList<Mutation> mutations;
+    QHash<int, qsizetype> slots;  // Resolved id -> index in mutations
+
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (excluded.contains(it.key())) {
+            continue;
+        }
+
+        const Entry &entry = it.value();
+        const int id = resolveId(entry.id);
+        auto slot = slots.constFind(id);
+        if (slot == slots.cend()) {
+            Mutation mutation;
+            mutation.operation = entry.operation;
+            mutation.id = id;
+            mutation.customer = entry.customer;
+            mutation.customer.setId(id);
+            mutation.sequences.append(it.key());
+            slots.insert(id, mutations.count());
+            mutations.append(mutation);
+            continue;
+        }
+
+        Mutation &mutation = mutations[*slot];
+        mutation.sequences.append(it.key());
+        if (entry.operation == UpdateOperation
+            && (mutation.operation == CreateOperation || mutation.operation == UpdateOperation)) {
+            mutation.customer = entry.customer;
+            mutation.customer.setId(id);
+        } else if (entry.operation == DeleteOperation) {
+            const bool neverSent = mutation.operation == CreateOperation || mutation.operation == NoOperation;
+            mutation.operation = neverSent ? NoOperation : DeleteOperation;
+        }
+    }
+    return mutations;
+}
+
+/**
+ * Pending records of one customer (e.g. to drop them all after its
+ * create was rejected)
+ *
+ * @param id - Resolved customer id
+ */
+QList<quint64> CustomerJournal::pendingSequences(int id) const
+{
+    QList<quint64> sequences;
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        if (resolveId(it->id) == id) {
+            sequences.append(it.key());
+        }
+    }
+    return sequences;
+}
+
+QByteArray CustomerJournal::entryPayload(quint64 sequence, const Entry &entry)
+{
+    QByteArray payload;
+    appendValue<quint8>(payload, entry.operation);
+    appendValue<quint64>(payload, sequence);
+    appendValue<qint32>(payload, entry.id);
+
+    if (entry.operation == CreateOperation || entry.operation == UpdateOperation) {
+        const QByteArray firstName = clampedUtf8(entry.customer.getFirstName());
+        const QByteArray lastName = clampedUtf8(entry.customer.getLastName());
+        const QByteArray address = clampedUtf8(entry.customer.getAddress());
+        appendValue<quint16>(payload, quint16(firstName.size()));
+        appendValue<quint16>(payload, quint16(lastName.size()));
+        appendValue<quint16>(payload, quint16(address.size()));
+        payload += firstName + lastName + address;
+    }
+    return payload;
+}
+
+QByteArray CustomerJournal::acknowledgePayload(quint64 sequence, int id, int assignedId)
+{
+    QByteArray payload;
+    appendValue<quint8>(payload, AcknowledgeRecord);
+    appendValue<quint64>(payload, sequence);
+    appendValue<qint32>(payload, id);
+    appendValue<qint32>(payload, assignedId);
+    return payload;
+}
+
+QByteArray CustomerJournal::frame(const QByteArray &payload)
+{
+    QByteArray record;
+    record.reserve(FrameSize + payload.size());
+    appendValue<quint32>(record, quint32(payload.size()));
+    appendValue<quint16>(record, qChecksum(payload));
+    record += payload;
+    return record;
+}
+
+bool CustomerJournal::openFile()
+{
+    m_fd = openDescriptor(m_path);
+    if (m_fd < 0 || !m_file.open(m_fd, QIODevice::ReadWrite, QFileDevice::AutoCloseHandle)) {
+        qDebug() << "Cannot open customer journal:" << m_path;
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool CustomerJournal::writeHeader()
+{
+    const QByteArray header = journalHeader();
+    m_unsynced = true;
+    return m_file.write(header) == header.size() && m_file.flush();
+}
+
+bool CustomerJournal::writeRecord(const QByteArray &payload)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    const QByteArray record = frame(payload);
+    m_unsynced = true;
+    if (m_file.write(record) != record.size() || !m_file.flush()) {
+        qDebug() << "Customer journal write failed:" << m_file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Load the records of a journal file
+ *
+ * @param data - Whole file, header included
+ * @return qint64 - Size of the intact part of the file
+ */
+qint64 CustomerJournal::replay(const QByteArray &data)
+{
+    qint64 offset = HeaderSize;
+    while (data.size() - offset >= FrameSize) {
+        const quint32 length = readValue<quint32>(data.constData() + offset);
+        const quint16 checksum = readValue<quint16>(data.constData() + offset + 4);
+        if (length > MaxPayloadSize || data.size() - offset - FrameSize < length) {
+            break;
+        }
+
+        const QByteArrayView payload(data.constData() + offset + FrameSize, length);
+        if (qChecksum(payload) != checksum || !replayRecord(payload)) {
+            break;
+        }
+        offset += FrameSize + length;
+    }
+    return offset;
+}
+
+bool CustomerJournal::replayRecord(QByteArrayView payload)
+{
+    if (payload.size() < EntrySize) {
+        return false;
+    }
+
+    const char *data = payload.data();
+    const quint8 type = quint8(data[0]);
+    const quint64 sequence = readValue<quint64>(data + 1);
+    const qint32 id = readValue<qint32>(data + 9);
+    m_nextSequence = qMax(m_nextSequence, sequence + 1);
+
+    switch (type) {
+    case CreateRecord:
+    case UpdateRecord: {
+        if (payload.size() < EntrySize + FieldsSize) {
+            return false;
+        }
+        const quint16 firstNameLength = readValue<quint16>(data + EntrySize);
+        const quint16 lastNameLength = readValue<quint16>(data + EntrySize + 2);
+        const quint16 addressLength = readValue<quint16>(data + EntrySize + 4);
+        if (payload.size() != EntrySize + FieldsSize + firstNameLength + lastNameLength + addressLength) {
+            return false;
+        }
+
+        const char *text = data + EntrySize + FieldsSize;
+        Customer customer;
+        customer.setId(id);
+        customer.setFirstName(QString::fromUtf8(text, firstNameLength));
+        customer.setLastName(QString::fromUtf8(text + firstNameLength, lastNameLength));
+        customer.setAddress(QString::fromUtf8(text + firstNameLength + lastNameLength, addressLength));
+        m_pending.insert(sequence, Entry { Operation(type), id, customer });
+        return true;
+    }
+    case DeleteRecord:
+        if (payload.size() != EntrySize) {
+            return false;
+        }
+        m_pending.insert(sequence, Entry { DeleteOperation, id, Customer() });
+        return true;
+    case AcknowledgeRecord: {
+        if (payload.size() != AcknowledgeSize) {
+            return false;
+        }
+        const qint32 assignedId = readValue<qint32>(data + EntrySize);
+        m_pending.remove(sequence);
+        if (id < 0 && assignedId != 0) {
+            m_assignedIds.insert(id, assignedId);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * Nothing pending: drop every record, keep the header
+ * Provisional id mappings stay known in memory for late callers.
+ */
+void CustomerJournal::truncate()
+{
+    if (m_file.isOpen() && m_file.size() > HeaderSize) {
+        m_file.resize(HeaderSize);
+        m_unsynced = true;
+    }
+}
+
+/**
+ * Rewrite the file with only the pending records, plus the provisional id
+ * mappings they still need (acknowledgements with sequence 0)
+ */
+void CustomerJournal::compact()
+{
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot compact customer journal:" << out.errorString();
+        return;
+    }
+
+    out.write(journalHeader());
+
+    QSet<int> referenced;
+    for (const Entry &entry : std::as_const(m_pending)) {
+        referenced.insert(entry.id);
+    }
+    for (auto it = m_assignedIds.cbegin(); it != m_assignedIds.cend(); ++it) {
+        if (referenced.contains(it.key())) {
+            out.write(frame(acknowledgePayload(0, it.key(), it.value())));
+        }
+    }
+    for (auto it = m_pending.cbegin(); it != m_pending.cend(); ++it) {
+        out.write(frame(entryPayload(it.key(), it.value())));
+    }
+
+    // The open descriptor would keep Windows from replacing the file
+    sync();
+    m_file.close();
+    m_fd = -1;
+    if (!out.commit()) {
+        qDebug() << "Cannot compact customer journal:" << out.errorString();
+    }
+    openFile();
+}
@@ -0,0 +1,119 @@
+/**
+ * CustomerJournal - Durable write-behind log of customer mutations
+ *
+ * In write-behind mode ApiClient appends every create/update/delete here
+ * and reports it done right away; the journal is replayed to the backend
+ * when it is reachable. The file is append-only: append() hands the record
+ * to the OS, sync() makes everything appended since the last call durable
+ * with one fsync, and acknowledge() appends a record marking mutations as
+ * applied on the server. Once nothing is pending the file is truncated;
+ * a file grown past a size limit is rewritten with the pending records only.
+ *
+ * File format (little-endian):
+ *   Header:  "PKCJ" | u16 version | u16 reserved
+ *   Record:  u32 payloadLength | u16 checksum (qChecksum of the payload) | payload
+ *   Payload: u8 type | u64 sequence | i32 id
+ *            create, update:  | u16 firstNameLength | u16 lastNameLength
+ *                             | u16 addressLength | UTF-8 strings
+ *            delete:          nothing more
+ *            acknowledge:     | i32 assignedId (server id of a create, 0 = none)
+ *
+ * Creates carry a provisional negative id until the server assigns the
+ * real one; records written before that keep the provisional id and
+ * resolveId() maps it. A torn record at the end (crash mid-write) is cut
+ * off when the journal is opened. One file is kept per API base URL.
+ */
+
+#ifndef CUSTOMERJOURNAL_H
+#define CUSTOMERJOURNAL_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include "customer.h"
+
+class CustomerJournal
+{
+public:
+    enum Operation : quint8 {
+        NoOperation,        // Coalesced away (create followed by delete)
+        CreateOperation,
+        UpdateOperation,
+        DeleteOperation
+    };
+
+    // Pending records of one customer folded into a single request:
+    // create + updates -> create with the last fields, updates -> the
+    // last update, update + delete -> delete, create + delete -> nothing
+    struct Mutation
+    {
+        Operation operation = NoOperation;
+        int id = 0;                 // Resolved id (negative = not created yet)
+        Customer customer;          // Fields to send (create, update)
+        QList<quint64> sequences;   // Records the request covers
+    };
+
+    explicit CustomerJournal(const QString &path);
+    ~CustomerJournal();
+
+    // Journal file location for an API base URL
+    static QString pathForBaseUrl(const QString &baseUrl);
+
+    bool open();
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    // Writing
+    quint64 append(Operation operation, int id, const Customer &customer = Customer());
+    void acknowledge(const QList<quint64> &sequences, int assignedId = 0);
+    bool sync();
+    bool needsSync() const { return m_unsynced; }
+
+    // Pending state
+    int pendingCount() const { return m_pending.count(); }
+    int lowestProvisionalId() const;  // 0 if none
+    int resolveId(int id) const { return m_assignedIds.value(id, id); }
+    QList<Mutation> coalesce(const QSet<quint64> &excluded = QSet<quint64>()) const;
+    QList<quint64> pendingSequences(int id) const;
+
+private:
+    enum RecordType : quint8 {
+        CreateRecord = CreateOperation,
+        UpdateRecord = UpdateOperation,
+        DeleteRecord = DeleteOperation,
+        AcknowledgeRecord
+    };
+
+    struct Entry
+    {
+        Operation operation;
+        int id;
+        Customer customer;
+    };
+
+    static QByteArray entryPayload(quint64 sequence, const Entry &entry);
+    static QByteArray acknowledgePayload(quint64 sequence, int id, int assignedId);
+    static QByteArray frame(const QByteArray &payload);
+    bool openFile();
+    bool writeHeader();
+    bool writeRecord(const QByteArray &payload);
+    qint64 replay(const QByteArray &data);
+    bool replayRecord(QByteArrayView payload);
+    void truncate();
+    void compact();
+
+    QString m_path;
+    QFile m_file;
+    int m_fd;                         // Descriptor behind m_file, for fsync
+    QMap<quint64, Entry> m_pending;   // Not acknowledged, by sequence
+    QHash<int, int> m_assignedIds;    // Provisional id -> server id
+    quint64 m_nextSequence;
+    bool m_unsynced;                  // Appended since the last sync()
+};
+
+#endif // CUSTOMERJOURNAL_H
@@ -0,0 +1,644 @@
+/**
+ * customerlistmodel.cpp - Customer table model implementation
+ *
+ * Data is formatted on demand in data(), which the view only calls
+ * for visible cells, so scrolling cost does not depend on row count.
+ */
+
+#include "customerlistmodel.h"
+#include "apiclient.h"
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+namespace {
+
+// Store field behind each sortable column
+const CustomerStore::Field SortFields[CustomerListModel::ColumnCount] = {
+    CustomerStore::IdField,
+    CustomerStore::FirstNameField,
+    CustomerStore::LastNameField,
+    CustomerStore::AddressField,
+    CustomerStore::CreatedAtField
+};
+
+} // namespace
+
+/**
+ * Constructor
+ * Connects to the API client signals that change the customer list
+ *
+ * @param apiClient - Client used for page requests (not owned)
+ * @param parent    - Parent object
+ */
+CustomerListModel::CustomerListModel(ApiClient *apiClient, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_apiClient(apiClient)
+    , m_sortColumn(-1)
+    , m_sortOrder(Qt::AscendingOrder)
+    , m_pageSize(200)
+    , m_nextCursor(0)
+    , m_hasMore(false)
+    , m_fetching(false)
+    , m_pageRequestId(0)
+{
+    connect(m_apiClient, &ApiClient::customerViewsPageReceived, this, &CustomerListModel::onPageReceived);
+    connect(m_apiClient, &ApiClient::customerCreated, this, &CustomerListModel::onCustomerCreated);
+    connect(m_apiClient, &ApiClient::customerUpdated, this, &CustomerListModel::onCustomerUpdated);
+    connect(m_apiClient, &ApiClient::customerDeleted, this, &CustomerListModel::onCustomerDeleted);
+    connect(m_apiClient, &ApiClient::customerIdAssigned, this, &CustomerListModel::onCustomerIdAssigned);
+    connect(m_apiClient, &ApiClient::customersSynced, this, &CustomerListModel::onCustomersSynced);
+    connect(m_apiClient, &ApiClient::requestFinished, this, &CustomerListModel::onRequestFinished);
+}
+
+int CustomerListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.count();
+}
+
+int CustomerListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant CustomerListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.count()) {
+        return QVariant();
+    }
+
+    const int row = m_rows.at(index.row());
+
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case IdColumn:
+            return m_store.id(row);
+        case FirstNameColumn:
+            return m_store.firstName(row);
+        case LastNameColumn:
+            return m_store.lastName(row);
+        case AddressColumn:
+            return m_store.address(row);
+        case CreatedColumn:
+            return m_store.createdAtMSecs(row) != CustomerStore::NoTimestamp
+                ? m_store.createdAt(row).toLocalTime().toString("yyyy-MM-dd HH:mm:ss")
+                : QString();
+        }
+    } else if (role == Qt::TextAlignmentRole && index.column() == IdColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    return QVariant();
+}
+
+QVariant CustomerListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case IdColumn:
+        return QStringLiteral("ID");
+    case FirstNameColumn:
+        return QStringLiteral("First name");
+    case LastNameColumn:
+        return QStringLiteral("Last name");
+    case AddressColumn:
+        return QStringLiteral("Address");
+    case CreatedColumn:
+        return QStringLiteral("Created");
+    }
+
+    return QVariant();
+}
+
+/**
+ * More rows are available while the server reported further pages
+ * and no page request is already pending
+ */
+bool CustomerListModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_hasMore && !m_fetching;
+}
+
+/**
+ * Request the next page (called by the view when scrolling near the end)
+ */
+void CustomerListModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) {
+        return;
+    }
+
+    m_fetching = true;
+    m_apiClient->getCustomersPage(m_pageSize, m_nextCursor);
+    m_pageRequestId = m_apiClient->lastRequestId();
+}
+
+/**
+ * Sort the loaded rows (called by the view when a header is clicked)
+ * Rows loaded later are merged into the same order. Persistent indexes
+ * (selection, current row) stay on their customer.
+ */
+void CustomerListModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column < ColumnCount ? column : -1;
+    m_sortOrder = order;
+
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const QModelIndexList before = persistentIndexList();
+    QList<int> storeRows;
+    storeRows.reserve(before.count());
+    for (const QModelIndex &index : before) {
+        storeRows.append(m_rows.at(index.row()));
+    }
+
+    applySort();
+
+    // Same filter, so every row is still there: old -> new via store row
+    QModelIndexList after;
+    after.reserve(before.count());
+    for (qsizetype i = 0; i < before.count(); ++i) {
+        after.append(index(m_viewRows.at(storeRows.at(i)), before.at(i).column()));
+    }
+    changePersistentIndexList(before, after);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+/**
+ * Drop all rows and load the first page again
+ */
+void CustomerListModel::refresh()
+{
+    beginResetModel();
+    m_store.clear();
+    m_index.clear();
+    m_rows.clear();
+    m_viewRows.clear();
+    m_nextCursor = 0;
+    m_hasMore = true;
+    m_fetching = false;
+    m_pageRequestId = 0;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+/**
+ * Replace the rows with a complete customer list (no further pages)
+ *
+ * @param customers - Complete list, e.g. from a snapshot or full fetch
+ */
+template<typename List>
+void CustomerListModel::resetRows(const List &customers)
+{
+    beginResetModel();
+    m_store.clear();
+    m_store.append(customers);
+    m_index.clear();
+    m_index.addOrUpdate(customers);
+    applySort();
+    m_nextCursor = customers.isEmpty() ? 0 : customers.last().getId();
+    m_hasMore = false;
+    m_fetching = false;
+    m_pageRequestId = 0;
+    endResetModel();
+}
+
+void CustomerListModel::setCustomers(const QList<Customer> &customers)
+{
+    resetRows(customers);
+}
+
+void CustomerListModel::setCustomers(const QList<CustomerView> &customers)
+{
+    resetRows(customers);
+}
+
+/**
+ * Append rows at the end (e.g. streamed chunks and pages); a sorted view
+ * merges them into its order
+ *
+ * @param customers - Customers following the current last row
+ */
+template<typename List>
+void CustomerListModel::appendRows(const List &customers)
+{
+    if (customers.isEmpty()) {
+        return;
+    }
+
+    const int first = m_store.count();
+    m_store.append(customers);
+    m_index.addOrUpdate(customers);
+    m_viewRows.resize(m_store.count(), -1);
+    m_nextCursor = customers.last().getId();
+
+    QList<int> added;
+    for (int row = first; row < m_store.count(); ++row) {
+        if (acceptsRow(row)) {
+            added.append(row);
+        }
+    }
+    insertStoreRows(added);
+}
+
+void CustomerListModel::appendCustomers(const QList<Customer> &customers)
+{
+    appendRows(customers);
+}
+
+void CustomerListModel::appendCustomers(const QList<CustomerView> &customers)
+{
+    appendRows(customers);
+}
+
+/**
+ * Show only customers matching the search text
+ * Matching is by word prefix, ignoring case and diacritics
+ *
+ * @param filter - Search text (empty = show all loaded rows)
+ */
+void CustomerListModel::setFilter(const QString &filter)
+{
+    const QString trimmed = filter.trimmed();
+    if (trimmed == m_filter) {
+        return;
+    }
+
+    beginResetModel();
+    m_filter = trimmed;
+    applySort();
+    endResetModel();
+}
+
+/**
+ * Page response handler
+ * Ignores pages that do not continue the current list (e.g. requested
+ * by another view, or from before a refresh)
+ */
+void CustomerListModel::onPageReceived(const QList<CustomerView> &customers, int cursor, int nextCursor)
+{
+    if (!m_fetching || cursor != m_nextCursor) {
+        return;
+    }
+
+    m_fetching = false;
+    m_pageRequestId = 0;
+    m_hasMore = nextCursor > 0;
+    appendCustomers(customers);
+
+    emit pageLoaded(m_rows.count(), m_hasMore);
+}
+
+void CustomerListModel::onCustomerCreated(const Customer &customer)
+{
+    // Rows beyond the loaded pages arrive with a later page
+    if (m_hasMore) {
+        return;
+    }
+
+    // Pushed echo of a create already applied here
+    if (m_store.indexOfId(customer.getId()) >= 0) {
+        onCustomerUpdated(customer);
+        return;
+    }
+
+    appendCustomers({ customer });
+}
+
+void CustomerListModel::onCustomerUpdated(const Customer &customer)
+{
+    int storeRow = m_store.indexOfId(customer.getId());
+    if (storeRow < 0) {
+        return;
+    }
+
+    // Write-behind updates are reported before the server has the row
+    Customer updated = customer;
+    if (!updated.getCreatedAt().isValid()) {
+        updated.setCreatedAt(m_store.createdAt(storeRow));
+    }
+
+    m_store.update(storeRow, updated);
+    m_index.addOrUpdate(updated);
+
+    // The edit may move the customer in or out of the filter, or to
+    // another place in the sort order
+    int row = m_viewRows.at(storeRow);
+    bool accepted = acceptsRow(storeRow);
+    if (row >= 0 && accepted) {
+        row = repositionRow(row);
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+    } else if (row >= 0) {
+        removeViewRows({ row });
+    } else if (accepted) {
+        insertStoreRows({ storeRow });
+    }
+}
+
+void CustomerListModel::onCustomerDeleted(int id)
+{
+    removeCustomers({ id });
+}
+
+/**
+ * Write-behind mode: the server created a customer shown under a
+ * provisional id; a delta sync may have brought the real row already
+ */
+void CustomerListModel::onCustomerIdAssigned(int provisionalId, const Customer &customer)
+{
+    onCustomerDeleted(provisionalId);
+    if (m_store.indexOfId(customer.getId()) < 0) {
+        onCustomerCreated(customer);
+    }
+}
+
+/**
+ * Delta sync handler: merge changed customers and drop deleted ones
+ * Rows already at the same updatedAt (e.g. edits made through this
+ * client) are left alone. A complete sync replaces the list.
+ */
+void CustomerListModel::onCustomersSynced(const QList<CustomerView> &changed, const QList<int> &deletedIds,
+                                          bool complete)
+{
+    if (complete) {
+        // Sync results come in updatedAt order; keep the id order of pages
+        QList<CustomerView> customers = changed;
+        std::sort(customers.begin(), customers.end(), [](const CustomerView &a, const CustomerView &b) {
+            return a.getId() < b.getId();
+        });
+        resetRows(customers);
+        emit pageLoaded(m_rows.count(), m_hasMore);
+        return;
+    }
+
+    removeCustomers(deletedIds);
+
+    QList<CustomerView> added;
+    for (const CustomerView &customer : changed) {
+        const int storeRow = m_store.indexOfId(customer.getId());
+        if (storeRow < 0) {
+            // Rows beyond the loaded pages arrive with a later page
+            if (!m_hasMore) {
+                added.append(customer);
+            }
+        } else if (m_store.updatedAtMSecs(storeRow) != customer.updatedAtMSecs()) {
+            onCustomerUpdated(customer.toCustomer());
+        }
+    }
+    appendCustomers(added);
+}
+
+/**
+ * A failed page request stops paging until the next refresh, so the
+ * view does not retry in a loop while scrolling; a cancelled one may be
+ * requested again. Failures of other requests are ignored.
+ */
+void CustomerListModel::onRequestFinished(quint64 requestId, int httpStatus, QNetworkReply::NetworkError error)
+{
+    if (!m_fetching || requestId != m_pageRequestId) {
+        return;
+    }
+    if (error == QNetworkReply::NoError && httpStatus < 400) {
+        return;  // The page follows through customerViewsPageReceived
+    }
+
+    m_fetching = false;
+    m_pageRequestId = 0;
+    if (error != QNetworkReply::OperationCanceledError) {
+        m_hasMore = false;
+    }
+}
+
+/**
+ * Rebuild the view-row mapping for the current sort column and filter
+ */
+void CustomerListModel::applySort()
+{
+    if (m_sortColumn >= 0) {
+        m_rows = m_store.sortedRows(SortFields[m_sortColumn], m_sortOrder);
+    } else {
+        m_rows.resize(m_store.count());
+        std::iota(m_rows.begin(), m_rows.end(), 0);
+        if (m_store.removedCount() > 0) {
+            m_rows.removeIf([this](int storeRow) { return m_store.isRemoved(storeRow); });
+        }
+    }
+
+    if (!m_filter.isEmpty()) {
+        QList<bool> matched(m_store.count(), false);
+        for (int id : m_index.search(m_filter, CustomerSearchIndex::PrefixMatch)) {
+            int storeRow = m_store.indexOfId(id);
+            if (storeRow >= 0) {
+                matched[storeRow] = true;
+            }
+        }
+        m_rows.removeIf([&matched](int storeRow) { return !matched.at(storeRow); });
+    }
+
+    m_viewRows.fill(-1, m_store.count());
+    updateViewRows(0, m_rows.count());
+}
+
+/**
+ * Show new store rows
+ * Unsorted, they are appended. Sorted, the chunk is sorted by itself and
+ * merged in: each run of rows landing between the same two existing rows
+ * is one beginInsertRows, found by a binary search from the previous run.
+ *
+ * @param storeRows - Store rows not shown yet, accepted by the filter
+ */
+void CustomerListModel::insertStoreRows(QList<int> storeRows)
+{
+    if (storeRows.isEmpty()) {
+        return;
+    }
+
+    if (m_sortColumn < 0) {
+        const qsizetype first = m_rows.count();
+        beginInsertRows(QModelIndex(), int(first), int(first + storeRows.count() - 1));
+        m_rows.append(storeRows);
+        endInsertRows();
+        updateViewRows(first, m_rows.count());
+        return;
+    }
+
+    auto before = [this](int a, int b) { return sortsBefore(a, b); };
+    std::stable_sort(storeRows.begin(), storeRows.end(), before);
+
+    qsizetype firstPosition = -1;
+    qsizetype from = 0;
+    qsizetype next = 0;
+    while (next < storeRows.count()) {
+        const qsizetype position = std::upper_bound(m_rows.cbegin() + from, m_rows.cend(), storeRows.at(next), before)
+                                 - m_rows.cbegin();
+        qsizetype end = next + 1;
+        while (end < storeRows.count() && (position == m_rows.count() || before(storeRows.at(end), m_rows.at(position)))) {
+            ++end;
+        }
+
+        beginInsertRows(QModelIndex(), int(position), int(position + end - next - 1));
+        m_rows.insert(position, end - next, 0);
+        std::copy(storeRows.cbegin() + next, storeRows.cbegin() + end, m_rows.begin() + position);
+        endInsertRows();
+
+        if (firstPosition < 0) {
+            firstPosition = position;
+        }
+        from = position + end - next;
+        next = end;
+    }
+    updateViewRows(firstPosition, m_rows.count());
+}
+
+/**
+ * Hide view rows
+ * Contiguous rows go in one beginRemoveRows, from the bottom up so the
+ * rows of the next run keep their index
+ *
+ * @param viewRows - Rows to remove, in any order
+ */
+void CustomerListModel::removeViewRows(QList<int> viewRows)
+{
+    if (viewRows.isEmpty()) {
+        return;
+    }
+
+    std::sort(viewRows.begin(), viewRows.end(), std::greater<int>());
+    viewRows.erase(std::unique(viewRows.begin(), viewRows.end()), viewRows.end());
+
+    qsizetype next = 0;
+    while (next < viewRows.count()) {
+        qsizetype end = next + 1;
+        while (end < viewRows.count() && viewRows.at(end) == viewRows.at(end - 1) - 1) {
+            ++end;
+        }
+        const int first = viewRows.at(end - 1);
+        const int last = viewRows.at(next);
+
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row) {
+            m_viewRows[m_rows.at(row)] = -1;
+        }
+        m_rows.remove(first, last - first + 1);
+        endRemoveRows();
+
+        next = end;
+    }
+    updateViewRows(viewRows.last(), m_rows.count());
+}
+
+/**
+ * Delete customers
+ * Their view rows are removed first, then their store rows become
+ * tombstones; the store is compacted once tombstones make up half of it
+ *
+ * @param ids - Customer ids; unknown ones are skipped
+ */
+void CustomerListModel::removeCustomers(const QList<int> &ids)
+{
+    QList<int> storeRows;
+    QList<int> viewRows;
+    for (int id : ids) {
+        const int storeRow = m_store.indexOfId(id);
+        if (storeRow < 0) {
+            continue;
+        }
+        storeRows.append(storeRow);
+        if (m_viewRows.at(storeRow) >= 0) {
+            viewRows.append(m_viewRows.at(storeRow));
+        }
+    }
+    if (storeRows.isEmpty()) {
+        return;
+    }
+    std::sort(storeRows.begin(), storeRows.end());
+    storeRows.erase(std::unique(storeRows.begin(), storeRows.end()), storeRows.end());
+
+    removeViewRows(viewRows);
+    for (int storeRow : std::as_const(storeRows)) {
+        m_index.remove(m_store.id(storeRow));
+        m_store.removeAt(storeRow);
+    }
+
+    if (m_store.removedCount() > m_store.count() / 2) {
+        compactStore();
+    }
+}
+
+/**
+ * Move a changed row to its place in the sort order
+ * Only its neighbours are compared unless it has to move; the new place
+ * is then found by a binary search on that side.
+ *
+ * @param row - View row of the changed customer
+ * @return int - Its view row afterwards
+ */
+int CustomerListModel::repositionRow(int row)
+{
+    if (m_sortColumn < 0) {
+        return row;
+    }
+
+    auto before = [this](int a, int b) { return sortsBefore(a, b); };
+    const int storeRow = m_rows.at(row);
+    int target;
+    if (row > 0 && before(storeRow, m_rows.at(row - 1))) {
+        target = int(std::upper_bound(m_rows.cbegin(), m_rows.cbegin() + row, storeRow, before) - m_rows.cbegin());
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), target);
+    } else if (row + 1 < m_rows.count() && before(m_rows.at(row + 1), storeRow)) {
+        const int destination = int(std::upper_bound(m_rows.cbegin() + row + 1, m_rows.cend(), storeRow, before)
+                                    - m_rows.cbegin());
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), destination);
+        target = destination - 1;  // Counted before the row left its place
+    } else {
+        return row;
+    }
+
+    m_rows.move(row, target);
+    endMoveRows();
+    updateViewRows(qMin(row, target), qMax(row, target) + 1);
+    return target;
+}
+
+/**
+ * Refresh the store-row -> view-row mapping of a range of view rows
+ */
+void CustomerListModel::updateViewRows(qsizetype from, qsizetype to)
+{
+    for (qsizetype row = from; row < to; ++row) {
+        m_viewRows[m_rows.at(row)] = int(row);
+    }
+}
+
+/**
+ * Drop the store's tombstones; view rows keep their place, so views and
+ * persistent indexes see no change
+ */
+void CustomerListModel::compactStore()
+{
+    const QList<int> newRows = m_store.compact();
+    for (int &storeRow : m_rows) {
+        storeRow = newRows.at(storeRow);
+    }
+    m_viewRows.fill(-1, m_store.count());
+    updateViewRows(0, m_rows.count());
+}
+
+/**
+ * Whether a store row comes before another in the current sort order
+ */
+bool CustomerListModel::sortsBefore(int storeRowA, int storeRowB) const
+{
+    const CustomerStore::Field field = SortFields[m_sortColumn];
+    return m_sortOrder == Qt::AscendingOrder ? m_store.lessThan(field, storeRowA, storeRowB)
+                                             : m_store.lessThan(field, storeRowB, storeRowA);
+}
+
+bool CustomerListModel::acceptsRow(int storeRow) const
+{
+    return m_filter.isEmpty()
+        || m_index.matches(m_store.id(storeRow), m_filter, CustomerSearchIndex::PrefixMatch);
+}
@@ -0,0 +1,117 @@
+/**
+ * CustomerListModel - Table model for the customer view
+ *
+ * Backs a QTableView so only the visible rows are ever rendered.
+ * Rows are loaded page by page through ApiClient::getCustomersPage()
+ * as the view scrolls (canFetchMore/fetchMore), and kept in sync with
+ * the create/update/delete signals of the API client. Delta sync results
+ * (ApiClient::syncCustomers) are merged in, touching only changed rows.
+ *
+ * Rows live in a column-oriented CustomerStore; the model keeps a
+ * view-row -> store-row mapping so sorting never moves customer data.
+ * The same mapping implements the search filter (setFilter), which is
+ * answered by a CustomerSearchIndex kept in step with the store.
+ * An inverse store-row -> view-row mapping finds a customer's view row
+ * directly, and deleted customers stay in the store as tombstones until
+ * they make up half of it, so a change costs a binary search and a
+ * shift of the view rows rather than a scan of the table.
+ */
+
+#ifndef CUSTOMERLISTMODEL_H
+#define CUSTOMERLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QNetworkReply>
+#include "customer.h"
+#include "customerstore.h"
+#include "customerview.h"
+#include "customersearchindex.h"
+
+class ApiClient;
+
+class CustomerListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        IdColumn,
+        FirstNameColumn,
+        LastNameColumn,
+        AddressColumn,
+        CreatedColumn,
+        ColumnCount
+    };
+
+    explicit CustomerListModel(ApiClient *apiClient, QObject *parent = nullptr);
+
+    // QAbstractTableModel interface
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // Paging
+    void setPageSize(int size) { m_pageSize = qMax(1, size); }
+    int pageSize() const { return m_pageSize; }
+    bool hasMore() const { return m_hasMore; }
+    void refresh();
+
+    // Direct loading (snapshot, full list, streamed chunks)
+    void setCustomers(const QList<Customer> &customers);
+    void setCustomers(const QList<CustomerView> &customers);
+    void appendCustomers(const QList<Customer> &customers);
+    void appendCustomers(const QList<CustomerView> &customers);
+
+    // Search - only rows matching every word of the filter are shown
+    void setFilter(const QString &filter);
+    QString filter() const { return m_filter; }
+
+    Customer customerAt(int row) const { return m_store.customer(m_rows.at(row)); }
+    const CustomerStore &store() const { return m_store; }
+
+signals:
+    void pageLoaded(int rowCount, bool hasMore);
+
+private slots:
+    void onPageReceived(const QList<CustomerView> &customers, int cursor, int nextCursor);
+    void onCustomerCreated(const Customer &customer);
+    void onCustomerUpdated(const Customer &customer);
+    void onCustomerDeleted(int id);
+    void onCustomerIdAssigned(int provisionalId, const Customer &customer);
+    void onCustomersSynced(const QList<CustomerView> &changed, const QList<int> &deletedIds, bool complete);
+    void onRequestFinished(quint64 requestId, int httpStatus, QNetworkReply::NetworkError error);
+
+private:
+    template<typename List> void resetRows(const List &customers);
+    template<typename List> void appendRows(const List &customers);
+    void applySort();
+    void insertStoreRows(QList<int> storeRows);
+    void removeViewRows(QList<int> viewRows);
+    void removeCustomers(const QList<int> &ids);
+    int repositionRow(int row);
+    void updateViewRows(qsizetype from, qsizetype to);
+    void compactStore();
+    bool sortsBefore(int storeRowA, int storeRowB) const;
+    bool acceptsRow(int storeRow) const;
+
+    ApiClient *m_apiClient;
+    CustomerStore m_store;
+    CustomerSearchIndex m_index;
+    QString m_filter;
+    QList<int> m_rows;  // View row -> store row (filtered)
+    QList<int> m_viewRows;  // Store row -> view row, -1 = not shown
+    int m_sortColumn;   // -1 = storage order
+    Qt::SortOrder m_sortOrder;
+    int m_pageSize;
+    int m_nextCursor;   // Last id loaded so far
+    bool m_hasMore;     // More pages on the server
+    bool m_fetching;    // Page request in flight
+    quint64 m_pageRequestId;  // Its ApiClient request id
+};
+
+#endif // CUSTOMERLISTMODEL_H
@@ -0,0 +1,442 @@
+/**
+ * customersearchindex.cpp - Customer search index implementation
+ *
+ * Each customer is one document: the folded "first last address" text,
+ * stored back to back in a single arena. Queries of three or more bytes
+ * intersect trigram posting lists; shorter queries scan the arena once.
+ */
+
+#include "customersearchindex.h"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CUSTOMERSEARCH_HAVE_SSE2
+#endif
+
+namespace {
+
+const int CompactThreshold = 1024;  // Minimum dead documents before compacting
+
+/**
+ * Find a byte string
+ *
+ * Vectorized first/last-byte filter: compares the needle's first and last
+ * byte against 16 (SSE2) or 32 (AVX2) candidate positions at once and
+ * only runs memcmp where both match.
+ *
+ * @return qsizetype - Offset of the first match, or -1
+ */
+qsizetype findBytes(const char *haystack, qsizetype size, const char *needle, qsizetype length)
+{
+    if (length == 0) {
+        return 0;
+    }
+    if (length > size) {
+        return -1;
+    }
+
+    const qsizetype lastStart = size - length;
+    qsizetype i = 0;
+
+#if defined(__AVX2__)
+    {
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[length - 1]);
+
+        for (; i + 31 <= lastStart; i += 32) {
+            const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i));
+            const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(haystack + i + length - 1));
+            quint32 mask = quint32(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+
+            while (mask) {
+                const qsizetype pos = i + qCountTrailingZeroBits(mask);
+                if (memcmp(haystack + pos, needle, length) == 0) {
+                    return pos;
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+#if defined(CUSTOMERSEARCH_HAVE_SSE2)
+    {
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[length - 1]);
+
+        for (; i + 15 <= lastStart; i += 16) {
+            const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+            const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + length - 1));
+            quint32 mask = quint32(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+
+            while (mask) {
+                const qsizetype pos = i + qCountTrailingZeroBits(mask);
+                if (memcmp(haystack + pos, needle, length) == 0) {
+                    return pos;
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    for (; i <= lastStart; ++i) {
+        if (haystack[i] == needle[0] && memcmp(haystack + i, needle, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Letters, digits and any byte of a multi-byte UTF-8 character
+inline bool isWordByte(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || uchar(c) >= 0x80;
+}
+
+/**
+ * Does the term occur in the text (at a word start for prefix matching)?
+ */
+bool containsTerm(QByteArrayView text, const QByteArray &term, CustomerSearchIndex::MatchMode mode)
+{
+    qsizetype from = 0;
+    while (from <= text.size() - term.size()) {
+        const qsizetype pos = findBytes(text.data() + from, text.size() - from, term.constData(), term.size());
+        if (pos < 0) {
+            return false;
+        }
+
+        const qsizetype at = from + pos;
+        if (mode == CustomerSearchIndex::SubstringMatch || at == 0 || !isWordByte(text[at - 1])) {
+            return true;
+        }
+        from = at + 1;
+    }
+    return false;
+}
+
+inline quint32 trigramAt(const char *text)
+{
+    return quint32(uchar(text[0])) | (quint32(uchar(text[1])) << 8) | (quint32(uchar(text[2])) << 16);
+}
+
+// Distinct trigrams of a text, sorted
+QList<quint32> trigrams(QByteArrayView text)
+{
+    QList<quint32> result;
+    if (text.size() < 3) {
+        return result;
+    }
+
+    result.reserve(text.size() - 2);
+    for (qsizetype i = 0; i + 3 <= text.size(); ++i) {
+        result.append(trigramAt(text.data() + i));
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// Intersection of two ascending document lists
+QList<int> intersect(const QList<int> &a, const QList<int> &b)
+{
+    QList<int> result;
+    result.reserve(qMin(a.size(), b.size()));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+    return result;
+}
+
+} // namespace
+
+/**
+ * Constructor
+ */
+CustomerSearchIndex::CustomerSearchIndex()
+    : m_deadDocs(0)
+{
+}
+
+void CustomerSearchIndex::clear()
+{
+    m_text.clear();
+    m_docOffsets.clear();
+    m_docCustomerIds.clear();
+    m_docByCustomer.clear();
+    m_postings.clear();
+    m_deadDocs = 0;
+}
+
+/**
+ * Index a customer, replacing its previous entry if any
+ *
+ * @param customer - Customer to index (name and address)
+ */
+void CustomerSearchIndex::addOrUpdate(const Customer &customer)
+{
+    remove(customer.getId());
+    appendDoc(customer.getId(), fold(customer.getFirstName() + ' ' + customer.getLastName() + ' ' + customer.getAddress()));
+}
+
+void CustomerSearchIndex::addOrUpdate(const QList<Customer> &customers)
+{
+    for (const Customer &customer : customers) {
+        addOrUpdate(customer);
+    }
+}
+
+void CustomerSearchIndex::addOrUpdate(const CustomerView &customer)
+{
+    remove(customer.getId());
+    appendDoc(customer.getId(), fold(customer.getFirstName() + ' ' + customer.getLastName() + ' ' + customer.getAddress()));
+}
+
+void CustomerSearchIndex::addOrUpdate(const QList<CustomerView> &customers)
+{
+    for (const CustomerView &customer : customers) {
+        addOrUpdate(customer);
+    }
+}
+
+/**
+ * Drop a customer from the index
+ *
+ * @param customerId - Id of the customer to remove
+ */
+void CustomerSearchIndex::remove(int customerId)
+{
+    auto it = m_docByCustomer.find(customerId);
+    if (it == m_docByCustomer.end()) {
+        return;
+    }
+
+    m_docCustomerIds[it.value()] = -1;
+    m_docByCustomer.erase(it);
+    ++m_deadDocs;
+
+    if (m_deadDocs > CompactThreshold && m_deadDocs > m_docByCustomer.count()) {
+        compact();
+    }
+}
+
+/**
+ * Find customers by name or address
+ *
+ * @param query      - Words to look for (all must match)
+ * @param mode       - PrefixMatch or SubstringMatch
+ * @param maxResults - Stop after this many results (-1 = no limit)
+ * @return QList<int> - Matching customer ids
+ */
+QList<int> CustomerSearchIndex::search(const QString &query, MatchMode mode, int maxResults) const
+{
+    QList<int> results;
+
+    const QList<QByteArray> terms = queryTerms(query);
+    if (terms.isEmpty()) {
+        return results;
+    }
+
+    QList<int> docs = candidates(terms);
+    if (docs.isEmpty() && std::all_of(terms.begin(), terms.end(), [](const QByteArray &term) { return term.size() < 3; })) {
+        // No trigram to narrow with - scan the arena for the longest term
+        const QByteArray &longest = *std::max_element(terms.begin(), terms.end(),
+            [](const QByteArray &a, const QByteArray &b) { return a.size() < b.size(); });
+        docs = scanAll(longest, mode);
+    }
+
+    for (int doc : docs) {
+        if (m_docCustomerIds.at(doc) < 0 || !docMatches(doc, terms, mode)) {
+            continue;
+        }
+        results.append(m_docCustomerIds.at(doc));
+        if (maxResults >= 0 && results.count() >= maxResults) {
+            break;
+        }
+    }
+
+    return results;
+}
+
+/**
+ * Check a single customer against a query
+ *
+ * @return bool - true if the customer is indexed and matches
+ */
+bool CustomerSearchIndex::matches(int customerId, const QString &query, MatchMode mode) const
+{
+    const int doc = m_docByCustomer.value(customerId, -1);
+    if (doc < 0) {
+        return false;
+    }
+
+    const QList<QByteArray> terms = queryTerms(query);
+    return !terms.isEmpty() && docMatches(doc, terms, mode);
+}
+
+/**
+ * Fold text for matching
+ *
+ * Compatibility decomposition splits "ä" into "a" + combining diaeresis;
+ * the combining marks are dropped and the rest is case folded. Control
+ * characters become spaces so documents never contain the '\n' separator.
+ *
+ * @param text - Text to fold
+ * @return QByteArray - Folded UTF-8 text
+ */
+QByteArray CustomerSearchIndex::fold(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        const QChar::Category category = c.category();
+        if (category == QChar::Mark_NonSpacing || category == QChar::Mark_Enclosing) {
+            continue;
+        }
+        if (category == QChar::Other_Control || c.isSpace()) {
+            folded.append(QLatin1Char(' '));
+            continue;
+        }
+        folded.append(c);
+    }
+
+    return folded.toCaseFolded().toUtf8();
+}
+
+QList<QByteArray> CustomerSearchIndex::queryTerms(const QString &query) const
+{
+    QList<QByteArray> terms = fold(query).split(' ');
+    terms.removeAll(QByteArray());
+    return terms;
+}
+
+/**
+ * Candidate documents from the trigram posting lists
+ * Intersects the lists of every trigram of every term, shortest first
+ *
+ * @return QList<int> - Ascending documents (empty if no term has a trigram)
+ */
+QList<int> CustomerSearchIndex::candidates(const QList<QByteArray> &terms) const
+{
+    QList<const QList<int> *> lists;
+    for (const QByteArray &term : terms) {
+        for (quint32 trigram : trigrams(term)) {
+            auto it = m_postings.constFind(trigram);
+            if (it == m_postings.constEnd()) {
+                return QList<int>();  // Trigram occurs nowhere
+            }
+            lists.append(&it.value());
+        }
+    }
+
+    if (lists.isEmpty()) {
+        return QList<int>();
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const QList<int> *a, const QList<int> *b) {
+        return a->size() < b->size();
+    });
+
+    QList<int> result = *lists.first();
+    for (int i = 1; i < lists.count() && !result.isEmpty(); ++i) {
+        result = intersect(result, *lists.at(i));
+    }
+    return result;
+}
+
+/**
+ * Scan the whole arena for one term
+ * Used for one- and two-letter queries that have no trigram
+ *
+ * @return QList<int> - Ascending live documents containing the term
+ */
+QList<int> CustomerSearchIndex::scanAll(const QByteArray &term, MatchMode mode) const
+{
+    QList<int> docs;
+    const char *text = m_text.constData();
+    const qsizetype size = m_text.size();
+
+    qsizetype from = 0;
+    while (from < size) {
+        const qsizetype pos = findBytes(text + from, size - from, term.constData(), term.size());
+        if (pos < 0) {
+            break;
+        }
+
+        const qsizetype at = from + pos;
+        const int doc = int(std::upper_bound(m_docOffsets.begin(), m_docOffsets.end(), quint32(at)) - m_docOffsets.begin()) - 1;
+
+        if (mode == SubstringMatch || at == m_docOffsets.at(doc) || !isWordByte(text[at - 1])) {
+            if (m_docCustomerIds.at(doc) >= 0) {
+                docs.append(doc);
+            }
+            // Continue with the next document
+            from = doc + 1 < m_docOffsets.count() ? m_docOffsets.at(doc + 1) : size;
+        } else {
+            from = at + 1;
+        }
+    }
+
+    return docs;
+}
+
+bool CustomerSearchIndex::docMatches(int doc, const QList<QByteArray> &terms, MatchMode mode) const
+{
+    const QByteArrayView text = docText(doc);
+    for (const QByteArray &term : terms) {
+        if (!containsTerm(text, term, mode)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QByteArrayView CustomerSearchIndex::docText(int doc) const
+{
+    const quint32 start = m_docOffsets.at(doc);
+    const quint32 end = doc + 1 < m_docOffsets.count() ? m_docOffsets.at(doc + 1) : quint32(m_text.size());
+    return QByteArrayView(m_text.constData() + start, end - start - 1);  // Without '\n'
+}
+
+void CustomerSearchIndex::appendDoc(int customerId, const QByteArray &text)
+{
+    const int doc = m_docOffsets.count();
+
+    m_docOffsets.append(quint32(m_text.size()));
+    m_docCustomerIds.append(customerId);
+    m_docByCustomer.insert(customerId, doc);
+    m_text.append(text);
+    m_text.append('\n');
+
+    for (quint32 trigram : trigrams(text)) {
+        m_postings[trigram].append(doc);
+    }
+}
+
+/**
+ * Rebuild the index from live documents only
+ */
+void CustomerSearchIndex::compact()
+{
+    QList<QPair<int, QByteArray>> live;
+    live.reserve(m_docByCustomer.count());
+    for (int doc = 0; doc < m_docCustomerIds.count(); ++doc) {
+        if (m_docCustomerIds.at(doc) >= 0) {
+            live.append({ m_docCustomerIds.at(doc), docText(doc).toByteArray() });
+        }
+    }
+
+    clear();
+    for (const auto &entry : live) {
+        appendDoc(entry.first, entry.second);
+    }
+}
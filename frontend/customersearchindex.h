@@ -0,0 +1,71 @@
+/**
+ * CustomerSearchIndex - In-memory "find customer" index
+ *
+ * Supports as-you-type search by name or address:
+ * - case and diacritic folding ("maki" finds "Mäki", "ÅKERLUND" finds
+ *   "Åkerlund"), so operators can type without ä/ö/å on the keyboard
+ * - prefix (start of a word) and substring matching; every word of the
+ *   query must match
+ * - trigram posting lists narrow the candidates, which are then verified
+ *   against the folded text with SSE2 (or AVX2 when compiled for it)
+ *
+ * Updates are incremental: a changed customer gets a new entry and the
+ * old one is marked dead; the index is compacted when dead entries
+ * outnumber live ones.
+ */
+
+#ifndef CUSTOMERSEARCHINDEX_H
+#define CUSTOMERSEARCHINDEX_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "customer.h"
+#include "customerview.h"
+
+class CustomerSearchIndex
+{
+public:
+    enum MatchMode {
+        PrefixMatch,     // Query words match the start of a word
+        SubstringMatch   // Query words match anywhere
+    };
+
+    CustomerSearchIndex();
+
+    // Maintenance
+    void clear();
+    void addOrUpdate(const Customer &customer);
+    void addOrUpdate(const QList<Customer> &customers);
+    void addOrUpdate(const CustomerView &customer);
+    void addOrUpdate(const QList<CustomerView> &customers);
+    void remove(int customerId);
+    int count() const { return m_docByCustomer.count(); }
+
+    // Queries - results are customer ids in insertion order
+    QList<int> search(const QString &query, MatchMode mode = SubstringMatch, int maxResults = -1) const;
+    bool matches(int customerId, const QString &query, MatchMode mode = SubstringMatch) const;
+
+    // Lower-case, diacritic-free UTF-8 form used for indexing and queries
+    static QByteArray fold(const QString &text);
+
+private:
+    QList<QByteArray> queryTerms(const QString &query) const;
+    QList<int> candidates(const QList<QByteArray> &terms) const;
+    QList<int> scanAll(const QByteArray &term, MatchMode mode) const;
+    bool docMatches(int doc, const QList<QByteArray> &terms, MatchMode mode) const;
+    QByteArrayView docText(int doc) const;
+    void appendDoc(int customerId, const QByteArray &text);
+    void compact();
+
+    QByteArray m_text;              // All documents, each terminated by '\n'
+    QList<quint32> m_docOffsets;    // Start of each document in m_text
+    QList<int> m_docCustomerIds;    // Customer id per document (-1 = dead)
+    QHash<int, int> m_docByCustomer;
+    QHash<quint32, QList<int>> m_postings;  // Trigram -> documents (ascending)
+    int m_deadDocs;
+};
+
+#endif // CUSTOMERSEARCHINDEX_H
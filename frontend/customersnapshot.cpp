@@ -0,0 +1,300 @@
+/**
+ * customersnapshot.cpp - Customer snapshot file implementation
+ *
+ * Writes go through QSaveFile so a crash never leaves a half-written
+ * snapshot behind. Reads map the file and decode records in place.
+ */
+
+#include "customersnapshot.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QTimeZone>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+const char SnapshotMagic[4] = { 'P', 'K', 'C', 'S' };
+const quint16 SnapshotVersion = 1;
+const qint64 NoTimestamp = std::numeric_limits<qint64>::min();
+
+// Offset of the record count inside the header
+const qint64 CountOffset = 8;
+
+// Fixed part of the header / of a record
+const qsizetype HeaderSize = 4 + 2 + 2 + 4 + 8 + 2 + 2;
+const qsizetype RecordSize = 4 + 8 + 8 + 2 + 2 + 2;
+
+template <typename T>
+void writeValue(QIODevice &device, T value)
+{
+    const T le = qToLittleEndian(value);
+    device.write(reinterpret_cast<const char *>(&le), sizeof(T));
+}
+
+template <typename T>
+T readValue(const uchar *data)
+{
+    return qFromLittleEndian<T>(data);
+}
+
+qint64 toMSecs(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : NoTimestamp;
+}
+
+QDateTime fromMSecs(qint64 msecs)
+{
+    return msecs == NoTimestamp ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC);
+}
+
+// Strings are stored with 16-bit lengths; database columns are at most 255 characters
+void clampUtf8(QByteArray &utf8)
+{
+    if (utf8.size() > 0xFFFF) {
+        utf8.truncate(0xFFFF);
+    }
+}
+
+} // namespace
+
+/**
+ * Writer constructor
+ * Opens a temporary file and writes the header with a zero record count
+ *
+ * @param path         - Snapshot file path
+ * @param etag         - ETag header of the response being saved
+ * @param lastModified - Last-Modified header of the response being saved
+ */
+CustomerSnapshot::Writer::Writer(const QString &path, const QByteArray &etag, const QByteArray &lastModified)
+    : m_file(path)
+    , m_count(0)
+    , m_ok(false)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    if (!m_file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write customer snapshot:" << m_file.errorString();
+        return;
+    }
+
+    const QByteArray etagBytes = etag.left(0xFFFF);
+    const QByteArray lastModifiedBytes = lastModified.left(0xFFFF);
+
+    m_file.write(SnapshotMagic, sizeof(SnapshotMagic));
+    writeValue<quint16>(m_file, SnapshotVersion);
+    writeValue<quint16>(m_file, 0);
+    writeValue<quint32>(m_file, 0);  // Patched in commit()
+    writeValue<qint64>(m_file, QDateTime::currentMSecsSinceEpoch());
+    writeValue<quint16>(m_file, quint16(etagBytes.size()));
+    writeValue<quint16>(m_file, quint16(lastModifiedBytes.size()));
+    m_file.write(etagBytes);
+    m_file.write(lastModifiedBytes);
+
+    m_ok = true;
+}
+
+void CustomerSnapshot::Writer::append(const Customer &customer)
+{
+    appendRecord(customer.getId(), toMSecs(customer.getCreatedAt()), toMSecs(customer.getUpdatedAt()),
+                 customer.getFirstName().toUtf8(), customer.getLastName().toUtf8(), customer.getAddress().toUtf8());
+}
+
+void CustomerSnapshot::Writer::append(const QList<Customer> &customers)
+{
+    for (const Customer &customer : customers) {
+        append(customer);
+    }
+}
+
+/**
+ * Append a lazily decoded customer; its UTF-8 is written unconverted
+ */
+void CustomerSnapshot::Writer::append(const CustomerView &customer)
+{
+    // Both sentinels are the minimum qint64
+    appendRecord(customer.getId(), customer.createdAtMSecs(), customer.updatedAtMSecs(),
+                 customer.firstNameUtf8(), customer.lastNameUtf8(), customer.addressUtf8());
+}
+
+void CustomerSnapshot::Writer::append(const QList<CustomerView> &customers)
+{
+    for (const CustomerView &customer : customers) {
+        append(customer);
+    }
+}
+
+void CustomerSnapshot::Writer::appendRecord(qint32 id, qint64 createdAt, qint64 updatedAt, QByteArray firstName,
+                                            QByteArray lastName, QByteArray address)
+{
+    if (!m_ok) {
+        return;
+    }
+
+    clampUtf8(firstName);
+    clampUtf8(lastName);
+    clampUtf8(address);
+
+    writeValue<qint32>(m_file, id);
+    writeValue<qint64>(m_file, createdAt);
+    writeValue<qint64>(m_file, updatedAt);
+    writeValue<quint16>(m_file, quint16(firstName.size()));
+    writeValue<quint16>(m_file, quint16(lastName.size()));
+    writeValue<quint16>(m_file, quint16(address.size()));
+    m_file.write(firstName);
+    m_file.write(lastName);
+    m_file.write(address);
+
+    ++m_count;
+}
+
+/**
+ * Patch the record count and atomically replace the snapshot file
+ *
+ * @return bool - true if the snapshot was written
+ */
+bool CustomerSnapshot::Writer::commit()
+{
+    if (!m_ok) {
+        m_file.cancelWriting();
+        return false;
+    }
+
+    if (!m_file.seek(CountOffset)) {
+        m_file.cancelWriting();
+        return false;
+    }
+    writeValue<quint32>(m_file, m_count);
+
+    m_ok = false;
+    return m_file.commit();
+}
+
+/**
+ * Constructor
+ *
+ * @param path - Snapshot file path (see pathForBaseUrl)
+ */
+CustomerSnapshot::CustomerSnapshot(const QString &path)
+    : m_path(path)
+{
+}
+
+/**
+ * Snapshot file location for an API base URL
+ * Files live in the cache directory, named by a hash of the URL
+ *
+ * @param baseUrl - API base URL
+ * @return QString - Absolute snapshot file path
+ */
+QString CustomerSnapshot::pathForBaseUrl(const QString &baseUrl)
+{
+    const QByteArray hash = QCryptographicHash::hash(baseUrl.toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return dir + "/customers-" + QString::fromLatin1(hash) + ".snap";
+}
+
+/**
+ * Load the snapshot from disk
+ * Maps the file and decodes all records; any inconsistency rejects the file
+ *
+ * @return bool - true if a valid snapshot was loaded
+ */
+bool CustomerSnapshot::load()
+{
+    m_customers.clear();
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (size < HeaderSize) {
+        return false;
+    }
+
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    const uchar *end = data + size;
+    const uchar *p = data;
+
+    if (memcmp(p, SnapshotMagic, sizeof(SnapshotMagic)) != 0
+        || readValue<quint16>(p + 4) != SnapshotVersion) {
+        return false;
+    }
+
+    const quint32 count = readValue<quint32>(p + 8);
+    const qint64 savedAt = readValue<qint64>(p + 12);
+    const quint16 etagLength = readValue<quint16>(p + 20);
+    const quint16 lastModifiedLength = readValue<quint16>(p + 22);
+    p += HeaderSize;
+
+    if (end - p < etagLength + lastModifiedLength) {
+        return false;
+    }
+    m_etag = QByteArray(reinterpret_cast<const char *>(p), etagLength);
+    p += etagLength;
+    m_lastModified = QByteArray(reinterpret_cast<const char *>(p), lastModifiedLength);
+    p += lastModifiedLength;
+
+    QList<Customer> customers;
+    customers.reserve(qMin<qint64>(count, size / RecordSize));
+
+    for (quint32 i = 0; i < count; ++i) {
+        if (end - p < RecordSize) {
+            return false;
+        }
+
+        const qint32 id = readValue<qint32>(p);
+        const qint64 createdAt = readValue<qint64>(p + 4);
+        const qint64 updatedAt = readValue<qint64>(p + 12);
+        const quint16 firstNameLength = readValue<quint16>(p + 20);
+        const quint16 lastNameLength = readValue<quint16>(p + 22);
+        const quint16 addressLength = readValue<quint16>(p + 24);
+        p += RecordSize;
+
+        if (end - p < firstNameLength + lastNameLength + addressLength) {
+            return false;
+        }
+
+        const char *text = reinterpret_cast<const char *>(p);
+        Customer customer;
+        customer.setId(id);
+        customer.setFirstName(QString::fromUtf8(text, firstNameLength));
+        customer.setLastName(QString::fromUtf8(text + firstNameLength, lastNameLength));
+        customer.setAddress(QString::fromUtf8(text + firstNameLength + lastNameLength, addressLength));
+        customer.setCreatedAt(fromMSecs(createdAt));
+        customer.setUpdatedAt(fromMSecs(updatedAt));
+        customers.append(customer);
+
+        p += firstNameLength + lastNameLength + addressLength;
+    }
+
+    m_customers.swap(customers);
+    m_savedAt = QDateTime::fromMSecsSinceEpoch(savedAt);
+    return true;
+}
+
+/**
+ * Save a complete customer list
+ *
+ * @param customers    - Customers to store
+ * @param etag         - ETag header of the response
+ * @param lastModified - Last-Modified header of the response
+ * @return bool - true if the snapshot was written
+ */
+bool CustomerSnapshot::save(const QList<Customer> &customers, const QByteArray &etag, const QByteArray &lastModified)
+{
+    Writer writer(m_path, etag, lastModified);
+    writer.append(customers);
+    return writer.commit();
+}
@@ -0,0 +1,74 @@
+/**
+ * CustomerSnapshot - Persistent on-disk copy of the last customer list
+ *
+ * Lets the application show customers immediately at startup and
+ * revalidate them with If-None-Match / If-Modified-Since afterwards.
+ *
+ * File format (little-endian, read through a memory map):
+ *   Header:  "PKCS" | u16 version | u16 reserved | u32 count | i64 savedAt
+ *            | u16 etagLength | u16 lastModifiedLength | etag | lastModified
+ *   Record:  i32 id | i64 createdAt | i64 updatedAt
+ *            | u16 firstNameLength | u16 lastNameLength | u16 addressLength
+ *            | UTF-8 firstName | UTF-8 lastName | UTF-8 address
+ *
+ * Timestamps are epoch milliseconds (INT64_MIN = not set).
+ * One file is kept per API base URL.
+ */
+
+#ifndef CUSTOMERSNAPSHOT_H
+#define CUSTOMERSNAPSHOT_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QSaveFile>
+#include <QString>
+#include "customer.h"
+#include "customerview.h"
+
+class CustomerSnapshot
+{
+public:
+    // Incremental writer - lets streamed lists be saved chunk by chunk
+    class Writer
+    {
+    public:
+        Writer(const QString &path, const QByteArray &etag, const QByteArray &lastModified);
+
+        void append(const Customer &customer);
+        void append(const QList<Customer> &customers);
+        void append(const CustomerView &customer);
+        void append(const QList<CustomerView> &customers);
+        bool commit();
+
+    private:
+        void appendRecord(qint32 id, qint64 createdAt, qint64 updatedAt, QByteArray firstName,
+                          QByteArray lastName, QByteArray address);
+
+        QSaveFile m_file;
+        quint32 m_count;
+        bool m_ok;
+    };
+
+    explicit CustomerSnapshot(const QString &path);
+
+    // Snapshot file location for an API base URL
+    static QString pathForBaseUrl(const QString &baseUrl);
+
+    bool load();
+    bool save(const QList<Customer> &customers, const QByteArray &etag, const QByteArray &lastModified);
+
+    QList<Customer> customers() const { return m_customers; }
+    QByteArray etag() const { return m_etag; }
+    QByteArray lastModified() const { return m_lastModified; }
+    QDateTime savedAt() const { return m_savedAt; }
+
+private:
+    QString m_path;
+    QList<Customer> m_customers;
+    QByteArray m_etag;
+    QByteArray m_lastModified;
+    QDateTime m_savedAt;
+};
+
+#endif // CUSTOMERSNAPSHOT_H
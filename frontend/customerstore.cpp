@@ -0,0 +1,618 @@
+/**
+ * customerstore.cpp - Column-oriented customer storage implementation
+ *
+ * Strings are converted to UTF-16 only when a row is read, so scans over
+ * ids, timestamps or interned keys touch a few small integer columns.
+ */
+
+#include "customerstore.h"
+#include <QTimeZone>
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+const qint64 CustomerStore::NoTimestamp = std::numeric_limits<qint64>::min();
+
+/**
+ * Intern a string
+ *
+ * @param text - UTF-8 text
+ * @return quint32 - Key of the (possibly already stored) string
+ */
+quint32 CustomerStore::StringPool::intern(QByteArrayView text)
+{
+    // At most half full, so probe sequences stay short
+    if (qsizetype(count() + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+
+    const qsizetype slot = slotOf(text);
+    if (m_slots.at(slot) != 0) {
+        return m_slots.at(slot) - 1;
+    }
+
+    const quint32 key = quint32(count());
+    m_arena.append(text.data(), text.size());
+    m_offsets.append(quint32(m_arena.size()));
+    m_slots[slot] = key + 1;
+    return key;
+}
+
+int CustomerStore::StringPool::find(QByteArrayView text) const
+{
+    if (m_slots.isEmpty()) {
+        return -1;
+    }
+    return int(m_slots.at(slotOf(text))) - 1;
+}
+
+QByteArrayView CustomerStore::StringPool::value(quint32 key) const
+{
+    const quint32 start = m_offsets.at(key);
+    return QByteArrayView(m_arena.constData() + start, m_offsets.at(key + 1) - start);
+}
+
+void CustomerStore::StringPool::clear()
+{
+    m_arena.clear();
+    m_offsets = { 0 };
+    m_slots.clear();
+}
+
+qint64 CustomerStore::StringPool::memoryUsage() const
+{
+    return m_arena.capacity() + (m_offsets.capacity() + m_slots.capacity()) * qint64(sizeof(quint32));
+}
+
+/**
+ * Slot holding text, or the empty slot it would go into (linear probing)
+ */
+qsizetype CustomerStore::StringPool::slotOf(QByteArrayView text) const
+{
+    const qsizetype mask = m_slots.size() - 1;
+    for (qsizetype slot = qsizetype(qHash(text) & size_t(mask)); ; slot = (slot + 1) & mask) {
+        const quint32 entry = m_slots.at(slot);
+        if (entry == 0 || value(entry - 1) == text) {
+            return slot;
+        }
+    }
+}
+
+/**
+ * Double the table (16 slots at first) and re-insert every key
+ */
+void CustomerStore::StringPool::grow()
+{
+    m_slots = QList<quint32>(qMax<qsizetype>(16, m_slots.size() * 2), 0);
+    for (int key = 0; key < count(); ++key) {
+        m_slots[slotOf(value(quint32(key)))] = quint32(key) + 1;
+    }
+}
+
+/**
+ * Constructor
+ */
+CustomerStore::CustomerStore()
+    : m_removedCount(0)
+    , m_houseGarbage(0)
+{
+}
+
+void CustomerStore::reserve(int size)
+{
+    m_ids.reserve(size);
+    m_firstNameKeys.reserve(size);
+    m_lastNameKeys.reserve(size);
+    m_streetKeys.reserve(size);
+    m_localityKeys.reserve(size);
+    m_houseOffsets.reserve(size);
+    m_houseLengths.reserve(size);
+    m_createdAt.reserve(size);
+    m_updatedAt.reserve(size);
+    m_removed.reserve(size);
+    m_rowById.reserve(size);
+}
+
+void CustomerStore::clear()
+{
+    m_ids.clear();
+    m_firstNameKeys.clear();
+    m_lastNameKeys.clear();
+    m_streetKeys.clear();
+    m_localityKeys.clear();
+    m_houseOffsets.clear();
+    m_houseLengths.clear();
+    m_createdAt.clear();
+    m_updatedAt.clear();
+    m_removed.clear();
+    m_removedCount = 0;
+    m_firstNames.clear();
+    m_lastNames.clear();
+    m_streets.clear();
+    m_localities.clear();
+    m_houseArena.clear();
+    m_houseGarbage = 0;
+    m_rowById.clear();
+}
+
+/**
+ * Append a customer as a new row
+ *
+ * @param customer - Customer to store (copied into the columns)
+ */
+void CustomerStore::append(const Customer &customer)
+{
+    setRow(appendRow(), customer);
+}
+
+void CustomerStore::append(const QList<Customer> &customers)
+{
+    reserve(count() + customers.count());
+    for (const Customer &customer : customers) {
+        append(customer);
+    }
+}
+
+/**
+ * Append a lazily decoded customer as a new row
+ * The strings go from the response body into the pools without a
+ * QString round trip, and timestamps are never turned into QDateTime.
+ *
+ * @param customer - View into a customer list response
+ */
+void CustomerStore::append(const CustomerView &customer)
+{
+    const qint64 createdAt = customer.createdAtMSecs();
+    const qint64 updatedAt = customer.updatedAtMSecs();
+    setRow(appendRow(), customer.getId(), customer.firstNameUtf8(), customer.lastNameUtf8(), customer.addressUtf8(),
+           createdAt == CustomerView::NoTimestamp ? NoTimestamp : createdAt,
+           updatedAt == CustomerView::NoTimestamp ? NoTimestamp : updatedAt);
+}
+
+void CustomerStore::append(const QList<CustomerView> &customers)
+{
+    reserve(count() + customers.count());
+    for (const CustomerView &customer : customers) {
+        append(customer);
+    }
+}
+
+/**
+ * Replace the data of an existing row
+ *
+ * @param row      - Row to overwrite
+ * @param customer - New customer data
+ */
+void CustomerStore::update(int row, const Customer &customer)
+{
+    m_rowById.remove(m_ids.at(row));
+    m_houseGarbage += m_houseLengths.at(row);
+    setRow(row, customer);
+
+    if (m_houseGarbage > m_houseArena.size() / 2) {
+        compactHouseArena();
+    }
+}
+
+/**
+ * Remove a row
+ * The row becomes a tombstone: other rows keep their index, and the id
+ * is free for another row right away
+ *
+ * @param row - Row to remove
+ */
+void CustomerStore::removeAt(int row)
+{
+    m_rowById.remove(m_ids.at(row));
+    m_houseGarbage += m_houseLengths.at(row);
+    m_houseLengths[row] = 0;
+    m_removed[row] = true;
+    ++m_removedCount;
+
+    if (m_houseGarbage > m_houseArena.size() / 2) {
+        compactHouseArena();
+    }
+}
+
+/**
+ * Drop the removed rows; the others move up, keeping their order
+ *
+ * @return QList<int> - New index of every old row, -1 for removed ones
+ */
+QList<int> CustomerStore::compact()
+{
+    QList<int> newRows(count(), -1);
+    int next = 0;
+    for (int row = 0; row < count(); ++row) {
+        if (m_removed.at(row)) {
+            continue;
+        }
+        if (next != row) {
+            m_rowById[m_ids.at(row)] = next;
+        }
+        newRows[row] = next++;
+    }
+
+    auto compactColumn = [&newRows, next](auto &column) {
+        for (int row = 0; row < newRows.count(); ++row) {
+            if (newRows.at(row) >= 0) {
+                column[newRows.at(row)] = column.at(row);
+            }
+        }
+        column.resize(next);
+    };
+    compactColumn(m_ids);
+    compactColumn(m_firstNameKeys);
+    compactColumn(m_lastNameKeys);
+    compactColumn(m_streetKeys);
+    compactColumn(m_localityKeys);
+    compactColumn(m_houseOffsets);
+    compactColumn(m_houseLengths);
+    compactColumn(m_createdAt);
+    compactColumn(m_updatedAt);
+    m_removed.fill(false, next);
+    m_removedCount = 0;
+
+    return newRows;
+}
+
+/**
+ * Rows whose field equals a value exactly
+ * Interned fields compare a single integer column
+ *
+ * @param field - FirstNameField or LastNameField
+ * @param value - Value to match
+ * @return QList<int> - Matching rows in storage order
+ */
+QList<int> CustomerStore::findRows(Field field, const QString &value) const
+{
+    QList<int> rows;
+
+    const QList<quint32> *keys = nullptr;
+    int key = -1;
+    const QByteArray utf8 = value.toUtf8();
+
+    if (field == FirstNameField) {
+        keys = &m_firstNameKeys;
+        key = m_firstNames.find(utf8);
+    } else if (field == LastNameField) {
+        keys = &m_lastNameKeys;
+        key = m_lastNames.find(utf8);
+    } else if (field == AddressField) {
+        for (int row = 0; row < count(); ++row) {
+            if (!m_removed.at(row) && address(row) == value) {
+                rows.append(row);
+            }
+        }
+        return rows;
+    }
+
+    if (!keys || key < 0) {
+        return rows;
+    }
+
+    const quint32 *data = keys->constData();
+    for (int row = 0; row < keys->count(); ++row) {
+        if (data[row] == quint32(key) && !m_removed.at(row)) {
+            rows.append(row);
+        }
+    }
+    return rows;
+}
+
+/**
+ * Row order sorted by a field
+ *
+ * String fields are ranked once per distinct interned value, after
+ * which rows are sorted by plain integer comparisons.
+ *
+ * @param field - Field to sort by
+ * @param order - Ascending or descending
+ * @return QList<int> - Row indexes in sorted order, removed rows left out
+ */
+QList<int> CustomerStore::sortedRows(Field field, Qt::SortOrder order) const
+{
+    QList<int> rows(count());
+    std::iota(rows.begin(), rows.end(), 0);
+    if (m_removedCount > 0) {
+        rows.removeIf([this](int row) { return m_removed.at(row); });
+    }
+
+    auto sortBy = [&rows, order](auto less) {
+        if (order == Qt::AscendingOrder) {
+            std::stable_sort(rows.begin(), rows.end(), less);
+        } else {
+            std::stable_sort(rows.begin(), rows.end(), [&less](int a, int b) { return less(b, a); });
+        }
+    };
+
+    switch (field) {
+    case IdField:
+        sortBy([this](int a, int b) { return m_ids.at(a) < m_ids.at(b); });
+        break;
+    case CreatedAtField:
+        sortBy([this](int a, int b) { return m_createdAt.at(a) < m_createdAt.at(b); });
+        break;
+    case UpdatedAtField:
+        sortBy([this](int a, int b) { return m_updatedAt.at(a) < m_updatedAt.at(b); });
+        break;
+    case FirstNameField: {
+        const QList<int> rank = rankKeys(m_firstNames);
+        sortBy([this, &rank](int a, int b) { return rank.at(m_firstNameKeys.at(a)) < rank.at(m_firstNameKeys.at(b)); });
+        break;
+    }
+    case LastNameField: {
+        const QList<int> rank = rankKeys(m_lastNames);
+        sortBy([this, &rank](int a, int b) { return rank.at(m_lastNameKeys.at(a)) < rank.at(m_lastNameKeys.at(b)); });
+        break;
+    }
+    case AddressField: {
+        const QList<int> streetRank = rankKeys(m_streets);
+        const QList<int> localityRank = rankKeys(m_localities);
+        sortBy([this, &streetRank, &localityRank](int a, int b) {
+            const int streetA = streetRank.at(m_streetKeys.at(a));
+            const int streetB = streetRank.at(m_streetKeys.at(b));
+            if (streetA != streetB) {
+                return streetA < streetB;
+            }
+            const int house = houseText(a).compare(houseText(b));
+            if (house != 0) {
+                return house < 0;
+            }
+            return localityRank.at(m_localityKeys.at(a)) < localityRank.at(m_localityKeys.at(b));
+        });
+        break;
+    }
+    }
+
+    return rows;
+}
+
+/**
+ * Whether row a sorts before row b by a field
+ * Compares the two rows directly instead of ranking every value, so
+ * placing one row into a sorted list costs a binary search.
+ *
+ * @param field - Field to compare
+ * @param a     - Row index
+ * @param b     - Row index
+ * @return bool - true if a comes first in ascending order
+ */
+bool CustomerStore::lessThan(Field field, int a, int b) const
+{
+    switch (field) {
+    case IdField:
+        return m_ids.at(a) < m_ids.at(b);
+    case CreatedAtField:
+        return m_createdAt.at(a) < m_createdAt.at(b);
+    case UpdatedAtField:
+        return m_updatedAt.at(a) < m_updatedAt.at(b);
+    case FirstNameField:
+        return compareKeys(m_firstNames, m_firstNameKeys.at(a), m_firstNameKeys.at(b)) < 0;
+    case LastNameField:
+        return compareKeys(m_lastNames, m_lastNameKeys.at(a), m_lastNameKeys.at(b)) < 0;
+    case AddressField: {
+        const int street = compareKeys(m_streets, m_streetKeys.at(a), m_streetKeys.at(b));
+        if (street != 0) {
+            return street < 0;
+        }
+        const int house = houseText(a).compare(houseText(b));
+        if (house != 0) {
+            return house < 0;
+        }
+        return compareKeys(m_localities, m_localityKeys.at(a), m_localityKeys.at(b)) < 0;
+    }
+    }
+
+    return false;
+}
+
+/**
+ * Materialize a row as a regular Customer
+ *
+ * @param row - Row index
+ * @return Customer - Independent copy of the row
+ */
+Customer CustomerStore::customer(int row) const
+{
+    Customer customer;
+    customer.setId(id(row));
+    customer.setFirstName(firstName(row));
+    customer.setLastName(lastName(row));
+    customer.setAddress(address(row));
+    customer.setCreatedAt(createdAt(row));
+    customer.setUpdatedAt(updatedAt(row));
+    return customer;
+}
+
+QList<Customer> CustomerStore::toList() const
+{
+    QList<Customer> customers;
+    customers.reserve(count() - m_removedCount);
+    for (int row = 0; row < count(); ++row) {
+        if (!m_removed.at(row)) {
+            customers.append(customer(row));
+        }
+    }
+    return customers;
+}
+
+QString CustomerStore::address(int row) const
+{
+    const QByteArrayView street = m_streets.value(m_streetKeys.at(row));
+    const QByteArrayView house = houseText(row);
+    const QByteArrayView locality = m_localities.value(m_localityKeys.at(row));
+
+    QByteArray utf8;
+    utf8.reserve(street.size() + house.size() + locality.size());
+    utf8.append(street.data(), street.size());
+    utf8.append(house.data(), house.size());
+    utf8.append(locality.data(), locality.size());
+    return QString::fromUtf8(utf8);
+}
+
+/**
+ * Approximate heap usage
+ *
+ * @return qint64 - Bytes used by columns, pools, arena and id index
+ */
+qint64 CustomerStore::memoryUsage() const
+{
+    const qint64 rows = m_ids.capacity();
+    const qint64 columns = rows * qint64(sizeof(qint32) + 5 * sizeof(quint32) + sizeof(quint16) + 2 * sizeof(qint64) + sizeof(bool));
+
+    return columns
+         + m_firstNames.memoryUsage() + m_lastNames.memoryUsage()
+         + m_streets.memoryUsage() + m_localities.memoryUsage()
+         + m_houseArena.capacity()
+         + m_rowById.capacity() + m_rowById.size() * qint64(2 * sizeof(int));  // Offset byte per bucket + node
+}
+
+/**
+ * Split an address into street name, house part and locality
+ *
+ * street   = text before the first digit ("Kauppurienkatu ")
+ * locality = text from the last ", " after the house part (", 90100 Oulu")
+ * house    = everything in between ("1 A 2")
+ */
+CustomerStore::AddressParts CustomerStore::splitAddress(QByteArrayView address)
+{
+    qsizetype firstDigit = 0;
+    while (firstDigit < address.size() && (address[firstDigit] < '0' || address[firstDigit] > '9')) {
+        ++firstDigit;
+    }
+
+    if (firstDigit == address.size()) {
+        return { address, QByteArrayView(), QByteArrayView() };
+    }
+
+    qsizetype localityStart = address.size();
+    for (qsizetype i = address.size() - 2; i > firstDigit; --i) {
+        if (address[i] == ',' && address[i + 1] == ' ') {
+            localityStart = i;
+            break;
+        }
+    }
+
+    return {
+        address.first(firstDigit),
+        address.sliced(firstDigit, localityStart - firstDigit),
+        address.sliced(localityStart)
+    };
+}
+
+QDateTime CustomerStore::toDateTime(qint64 msecs)
+{
+    return msecs == NoTimestamp ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC);
+}
+
+qint64 CustomerStore::toMSecs(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : NoTimestamp;
+}
+
+int CustomerStore::appendRow()
+{
+    m_ids.append(0);
+    m_firstNameKeys.append(0);
+    m_lastNameKeys.append(0);
+    m_streetKeys.append(0);
+    m_localityKeys.append(0);
+    m_houseOffsets.append(0);
+    m_houseLengths.append(0);
+    m_createdAt.append(NoTimestamp);
+    m_updatedAt.append(NoTimestamp);
+    m_removed.append(false);
+    return count() - 1;
+}
+
+void CustomerStore::setRow(int row, const Customer &customer)
+{
+    setRow(row, customer.getId(), customer.getFirstName().toUtf8(), customer.getLastName().toUtf8(),
+           customer.getAddress().toUtf8(), toMSecs(customer.getCreatedAt()), toMSecs(customer.getUpdatedAt()));
+}
+
+void CustomerStore::setRow(int row, int id, QByteArrayView firstName, QByteArrayView lastName, QByteArrayView address,
+                           qint64 createdAt, qint64 updatedAt)
+{
+    const AddressParts parts = splitAddress(address);
+
+    m_ids[row] = id;
+    m_firstNameKeys[row] = m_firstNames.intern(firstName);
+    m_lastNameKeys[row] = m_lastNames.intern(lastName);
+    m_streetKeys[row] = m_streets.intern(parts.street);
+    m_localityKeys[row] = m_localities.intern(parts.locality);
+
+    const qsizetype houseLength = qMin<qsizetype>(parts.house.size(), 0xFFFF);
+    m_houseOffsets[row] = quint32(m_houseArena.size());
+    m_houseLengths[row] = quint16(houseLength);
+    m_houseArena.append(parts.house.data(), houseLength);
+
+    m_createdAt[row] = createdAt;
+    m_updatedAt[row] = updatedAt;
+
+    m_rowById.insert(id, row);
+}
+
+QByteArrayView CustomerStore::houseText(int row) const
+{
+    return QByteArrayView(m_houseArena.constData() + m_houseOffsets.at(row), m_houseLengths.at(row));
+}
+
+/**
+ * Rewrite the house arena without bytes of updated or removed rows
+ */
+void CustomerStore::compactHouseArena()
+{
+    QByteArray arena;
+    arena.reserve(m_houseArena.size() - m_houseGarbage);
+
+    for (int row = 0; row < count(); ++row) {
+        const QByteArrayView house = houseText(row);
+        m_houseOffsets[row] = quint32(arena.size());
+        arena.append(house.data(), house.size());
+    }
+
+    m_houseArena.swap(arena);
+    m_houseGarbage = 0;
+}
+
+/**
+ * Rank of every interned value in case-insensitive, locale-aware order
+ *
+ * @return QList<int> - rank[key] for each key of the pool
+ */
+QList<int> CustomerStore::rankKeys(const StringPool &pool) const
+{
+    const int size = pool.count();
+
+    QList<QString> values;
+    values.reserve(size);
+    for (int key = 0; key < size; ++key) {
+        values.append(QString::fromUtf8(pool.value(quint32(key))).toCaseFolded());
+    }
+
+    QList<int> keys(size);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::sort(keys.begin(), keys.end(), [&values](int a, int b) {
+        return QString::localeAwareCompare(values.at(a), values.at(b)) < 0;
+    });
+
+    QList<int> rank(size);
+    for (int i = 0; i < size; ++i) {
+        rank[keys.at(i)] = i;
+    }
+    return rank;
+}
+
+/**
+ * Order of two interned values, as rankKeys() ranks them
+ */
+int CustomerStore::compareKeys(const StringPool &pool, quint32 a, quint32 b)
+{
+    if (a == b) {
+        return 0;
+    }
+    return QString::localeAwareCompare(QString::fromUtf8(pool.value(a)).toCaseFolded(),
+                                       QString::fromUtf8(pool.value(b)).toCaseFolded());
+}
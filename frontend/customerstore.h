@@ -0,0 +1,180 @@
+/**
+ * CustomerStore - Column-oriented storage for large customer lists
+ *
+ * Keeps customers as structure-of-arrays instead of a QList<Customer>:
+ * - ids and epoch-millisecond timestamps in contiguous integer columns
+ * - first names, last names, street names and localities interned as
+ *   UTF-8 in string pools (each distinct value is stored once)
+ * - the remaining part of the address (house number etc.) in a UTF-8 arena
+ *
+ * An address "Kauppurienkatu 1 A 2, 90100 Oulu" is split into the street
+ * name "Kauppurienkatu ", the house part "1 A 2" and the locality
+ * ", 90100 Oulu"; the pieces concatenate back to the original text.
+ *
+ * CustomerStore::Ref offers the Customer getters on top of a stored row,
+ * and customer() materializes a regular Customer for existing call sites.
+ *
+ * Removing a row leaves a tombstone, so row indexes stay valid and nothing
+ * is renumbered; compact() drops the tombstones in one pass and reports
+ * where the remaining rows went.
+ */
+
+#ifndef CUSTOMERSTORE_H
+#define CUSTOMERSTORE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "customer.h"
+#include "customerview.h"
+
+class CustomerStore
+{
+public:
+    enum Field {
+        IdField,
+        FirstNameField,
+        LastNameField,
+        AddressField,
+        CreatedAtField,
+        UpdatedAtField
+    };
+
+    // Read-only view of one stored customer (same getters as Customer)
+    class Ref
+    {
+    public:
+        Ref(const CustomerStore *store, int row) : m_store(store), m_row(row) {}
+
+        int row() const { return m_row; }
+        int getId() const { return m_store->id(m_row); }
+        QString getFirstName() const { return m_store->firstName(m_row); }
+        QString getLastName() const { return m_store->lastName(m_row); }
+        QString getAddress() const { return m_store->address(m_row); }
+        QDateTime getCreatedAt() const { return m_store->createdAt(m_row); }
+        QDateTime getUpdatedAt() const { return m_store->updatedAt(m_row); }
+        QString getFullName() const { return getFirstName() + " " + getLastName(); }
+        Customer toCustomer() const { return m_store->customer(m_row); }
+
+    private:
+        const CustomerStore *m_store;
+        int m_row;
+    };
+
+    // Sentinel for "timestamp not set"
+    static const qint64 NoTimestamp;
+
+    CustomerStore();
+
+    // Size (removed rows count until compact())
+    int count() const { return m_ids.count(); }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+    int removedCount() const { return m_removedCount; }
+    bool isRemoved(int row) const { return m_removed.at(row); }
+    void reserve(int size);
+    void clear();
+
+    // Modification
+    void append(const Customer &customer);
+    void append(const QList<Customer> &customers);
+    void append(const CustomerView &customer);  // UTF-8 copied as is
+    void append(const QList<CustomerView> &customers);
+    void update(int row, const Customer &customer);
+    void removeAt(int row);
+    QList<int> compact();  // Old row -> new row, -1 = removed
+
+    // Lookup
+    int indexOfId(int id) const { return m_rowById.value(id, -1); }
+    QList<int> findRows(Field field, const QString &value) const;
+    QList<int> sortedRows(Field field, Qt::SortOrder order = Qt::AscendingOrder) const;
+    bool lessThan(Field field, int a, int b) const;  // Same order as sortedRows(), for single rows
+
+    // Row access
+    Ref at(int row) const { return Ref(this, row); }
+    Customer customer(int row) const;
+    QList<Customer> toList() const;
+
+    // Column access
+    int id(int row) const { return m_ids.at(row); }
+    QString firstName(int row) const { return QString::fromUtf8(m_firstNames.value(m_firstNameKeys.at(row))); }
+    QString lastName(int row) const { return QString::fromUtf8(m_lastNames.value(m_lastNameKeys.at(row))); }
+    QString address(int row) const;
+    qint64 createdAtMSecs(int row) const { return m_createdAt.at(row); }
+    qint64 updatedAtMSecs(int row) const { return m_updatedAt.at(row); }
+    QDateTime createdAt(int row) const { return toDateTime(m_createdAt.at(row)); }
+    QDateTime updatedAt(int row) const { return toDateTime(m_updatedAt.at(row)); }
+
+    // Approximate heap usage in bytes
+    qint64 memoryUsage() const;
+
+private:
+    // Deduplicating pool of UTF-8 strings, addressed by a 32-bit key
+    // The hash table holds keys only and compares against the arena, so
+    // each string is stored once
+    class StringPool
+    {
+    public:
+        quint32 intern(QByteArrayView text);
+        int find(QByteArrayView text) const;  // -1 if not present
+        QByteArrayView value(quint32 key) const;
+        int count() const { return m_offsets.count() - 1; }
+        void clear();
+        qint64 memoryUsage() const;
+
+    private:
+        qsizetype slotOf(QByteArrayView text) const;
+        void grow();
+
+        QByteArray m_arena;
+        QList<quint32> m_offsets { 0 };  // Start of each string (+ end sentinel)
+        QList<quint32> m_slots;          // Open addressing: key + 1, 0 = empty
+    };
+
+    struct AddressParts
+    {
+        QByteArrayView street;
+        QByteArrayView house;
+        QByteArrayView locality;
+    };
+
+    static AddressParts splitAddress(QByteArrayView address);
+    static QDateTime toDateTime(qint64 msecs);
+    static qint64 toMSecs(const QDateTime &dateTime);
+
+    void setRow(int row, const Customer &customer);
+    void setRow(int row, int id, QByteArrayView firstName, QByteArrayView lastName, QByteArrayView address,
+                qint64 createdAt, qint64 updatedAt);
+    int appendRow();
+    QByteArrayView houseText(int row) const;
+    void compactHouseArena();
+    QList<int> rankKeys(const StringPool &pool) const;
+    static int compareKeys(const StringPool &pool, quint32 a, quint32 b);
+
+    // Columns
+    QList<qint32> m_ids;
+    QList<quint32> m_firstNameKeys;
+    QList<quint32> m_lastNameKeys;
+    QList<quint32> m_streetKeys;
+    QList<quint32> m_localityKeys;
+    QList<quint32> m_houseOffsets;
+    QList<quint16> m_houseLengths;
+    QList<qint64> m_createdAt;
+    QList<qint64> m_updatedAt;
+    QList<bool> m_removed;
+    int m_removedCount;
+
+    // String storage
+    StringPool m_firstNames;
+    StringPool m_lastNames;
+    StringPool m_streets;
+    StringPool m_localities;
+    QByteArray m_houseArena;
+    qint64 m_houseGarbage;  // Arena bytes no longer referenced
+
+    QHash<int, int> m_rowById;
+};
+
+#endif // CUSTOMERSTORE_H
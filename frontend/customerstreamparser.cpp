@@ -0,0 +1,261 @@
+/**
+ * customerstreamparser.cpp - Incremental customer list parser implementation
+ *
+ * A small byte-level state machine tracks strings, nesting depth and the
+ * keys of the top-level envelope. Each complete object inside "data" is
+ * cut out of the buffer and decoded on its own, after which its bytes
+ * are discarded.
+ */
+
+#include "customerstreamparser.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+/**
+ * Constructor
+ * Starts in the "waiting for envelope" state
+ */
+CustomerStreamParser::CustomerStreamParser()
+    : m_pos(0)
+    , m_depth(0)
+    , m_inString(false)
+    , m_escape(false)
+    , m_expectKey(false)
+    , m_inData(false)
+    , m_keyStart(-1)
+    , m_valueStart(-1)
+    , m_objectStart(-1)
+    , m_totalParsed(0)
+    , m_complete(false)
+    , m_success(false)
+{
+}
+
+/**
+ * Append response bytes and parse as far as possible
+ *
+ * @param data - Next piece of the response body (any size, any boundary)
+ */
+void CustomerStreamParser::feed(const QByteArray &data)
+{
+    if (hasError() || data.isEmpty()) {
+        return;
+    }
+
+    m_buffer.append(data);
+    scan();
+    compact();
+}
+
+/**
+ * Mark end of input
+ * A body that ended before the envelope was closed is reported as an error
+ */
+void CustomerStreamParser::finish()
+{
+    if (!hasError() && !m_complete) {
+        setError("Truncated JSON response from server");
+    }
+}
+
+/**
+ * Take parsed customers out of the parser
+ *
+ * @param maxCount - Maximum number of customers to take (-1 = all)
+ * @return QList<Customer> - Customers in response order
+ */
+QList<Customer> CustomerStreamParser::takeCustomers(int maxCount)
+{
+    if (maxCount < 0 || maxCount >= m_customers.count()) {
+        QList<Customer> customers;
+        customers.swap(m_customers);
+        return customers;
+    }
+
+    QList<Customer> customers = m_customers.mid(0, maxCount);
+    m_customers.remove(0, maxCount);
+    return customers;
+}
+
+/**
+ * Scan newly buffered bytes
+ *
+ * Depth 1 is the envelope object, depth 2 the "data" array and depth 3
+ * a single customer object. Strings are skipped with escape handling so
+ * braces inside names or addresses do not affect the nesting.
+ */
+void CustomerStreamParser::scan()
+{
+    const char *data = m_buffer.constData();
+    const int size = m_buffer.size();
+
+    for (int i = m_pos; i < size && !hasError(); ++i) {
+        const char c = data[i];
+
+        if (m_inString) {
+            if (m_escape) {
+                m_escape = false;
+            } else if (c == '\\') {
+                m_escape = true;
+            } else if (c == '"') {
+                m_inString = false;
+                if (m_depth == 1 && m_expectKey) {
+                    m_key = QByteArray(data + m_keyStart, i - m_keyStart);
+                    m_keyStart = -1;
+                }
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            m_inString = true;
+            if (m_depth == 1 && m_expectKey) {
+                m_keyStart = i + 1;
+            }
+            break;
+        case ':':
+            if (m_depth == 1) {
+                m_expectKey = false;
+                m_valueStart = i + 1;
+            }
+            break;
+        case ',':
+            if (m_depth == 1) {
+                endTopLevelValue(i);
+                m_expectKey = true;
+            }
+            break;
+        case '{':
+        case '[':
+            if (m_depth == 0) {
+                if (c != '{' || m_complete) {
+                    setError("Invalid JSON response from server");
+                    break;
+                }
+                m_expectKey = true;
+            } else if (m_depth == 1 && c == '[' && m_key == "data") {
+                m_inData = true;
+            } else if (m_depth == 2 && m_inData && c == '{') {
+                m_objectStart = i;
+            }
+            ++m_depth;
+            break;
+        case '}':
+        case ']':
+            --m_depth;
+            if (m_depth < 0) {
+                setError("Invalid JSON response from server");
+            } else if (m_depth == 2 && m_inData && c == '}') {
+                handleCustomerObject(m_objectStart, i + 1);
+                m_objectStart = -1;
+            } else if (m_depth == 1 && m_inData && c == ']') {
+                m_inData = false;
+            } else if (m_depth == 0) {
+                endTopLevelValue(i);
+                m_complete = true;
+            }
+            break;
+        default:
+            if (m_depth == 0 && c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+                setError("Invalid JSON response from server");
+            }
+            break;
+        }
+    }
+
+    m_pos = size;
+}
+
+/**
+ * Drop bytes that are no longer needed
+ * Keeps only the partial customer object or envelope value still being read
+ */
+void CustomerStreamParser::compact()
+{
+    // Only "success" and "message" values are ever read back
+    if (m_key != "success" && m_key != "message") {
+        m_valueStart = -1;
+    }
+
+    int keepFrom = m_buffer.size();
+    if (m_objectStart >= 0) {
+        keepFrom = qMin(keepFrom, m_objectStart);
+    }
+    if (m_valueStart >= 0) {
+        keepFrom = qMin(keepFrom, m_valueStart);
+    }
+    if (m_keyStart >= 0) {
+        keepFrom = qMin(keepFrom, m_keyStart);
+    }
+
+    if (keepFrom <= 0) {
+        return;
+    }
+
+    m_buffer.remove(0, keepFrom);
+    m_pos -= keepFrom;
+    if (m_objectStart >= 0) {
+        m_objectStart -= keepFrom;
+    }
+    if (m_valueStart >= 0) {
+        m_valueStart -= keepFrom;
+    }
+    if (m_keyStart >= 0) {
+        m_keyStart -= keepFrom;
+    }
+}
+
+/**
+ * Handle the end of a top-level envelope value
+ * Extracts "success" and "message"; everything else is ignored
+ *
+ * @param end - Buffer offset one past the value
+ */
+void CustomerStreamParser::endTopLevelValue(int end)
+{
+    if (m_valueStart >= 0 && end > m_valueStart) {
+        const QByteArray value = m_buffer.mid(m_valueStart, end - m_valueStart).trimmed();
+
+        if (m_key == "success") {
+            m_success = (value == "true");
+        } else if (m_key == "message") {
+            // Wrap in an array so the JSON parser handles string escapes
+            QJsonDocument doc = QJsonDocument::fromJson("[" + value + "]");
+            m_message = doc.array().at(0).toString();
+        }
+    }
+
+    m_key.clear();
+    m_valueStart = -1;
+}
+
+/**
+ * Decode one complete customer object
+ *
+ * @param start - Buffer offset of the opening brace
+ * @param end   - Buffer offset one past the closing brace
+ */
+void CustomerStreamParser::handleCustomerObject(int start, int end)
+{
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(m_buffer.constData() + start, end - start), &parseError);
+
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        setError("Invalid JSON response from server");
+        return;
+    }
+
+    m_customers.append(Customer(doc.object()));
+    ++m_totalParsed;
+}
+
+void CustomerStreamParser::setError(const QString &error)
+{
+    if (m_error.isEmpty()) {
+        m_error = error;
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * CustomerStreamParser - Incremental parser for customer list responses
+ *
+ * Tokenizes the {"success":..,"data":[...]} envelope returned by
+ * GET /api/customers as the bytes arrive, so customers can be handed
+ * out in chunks while the body is still downloading.
+ *
+ * Only the bytes of the customer object currently being received are
+ * buffered, so memory use stays flat regardless of the list size.
+ */
+
+#ifndef CUSTOMERSTREAMPARSER_H
+#define CUSTOMERSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "customer.h"
+
+class CustomerStreamParser
+{
+public:
+    CustomerStreamParser();
+
+    // Feed the next piece of the response body
+    void feed(const QByteArray &data);
+
+    // Signal end of input; reports an error if the envelope is incomplete
+    void finish();
+
+    // Take up to maxCount parsed customers (all of them if maxCount < 0)
+    QList<Customer> takeCustomers(int maxCount = -1);
+
+    // State
+    int pendingCount() const { return m_customers.count(); }
+    int totalParsed() const { return m_totalParsed; }
+    bool isComplete() const { return m_complete; }
+    bool hasError() const { return !m_error.isEmpty(); }
+    QString errorString() const { return m_error; }
+
+    // Envelope fields
+    bool isSuccess() const { return m_success; }
+    QString message() const { return m_message; }
+
+private:
+    void scan();
+    void compact();
+    void endTopLevelValue(int end);
+    void handleCustomerObject(int start, int end);
+    void setError(const QString &error);
+
+    QByteArray m_buffer;
+    int m_pos;             // Next byte of m_buffer to scan
+    int m_depth;           // Current object/array nesting depth
+    bool m_inString;
+    bool m_escape;
+    bool m_expectKey;      // At depth 1: next string is a key
+    bool m_inData;         // Inside the "data" array
+    int m_keyStart;        // Start of the envelope key being read
+    int m_valueStart;      // Start of the envelope value being read
+    int m_objectStart;     // Start of the customer object being read
+    QByteArray m_key;      // Current envelope key
+
+    QList<Customer> m_customers;
+    int m_totalParsed;
+    bool m_complete;
+    bool m_success;
+    QString m_message;
+    QString m_error;
+};
+
+#endif // CUSTOMERSTREAMPARSER_H
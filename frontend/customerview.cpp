@@ -0,0 +1,1052 @@
+/**
+ * customerview.cpp - Lazily decoded customer implementation
+ *
+ * The scanner validates the whole body as JSON (so malformed responses
+ * are still rejected) but only records positions; nothing is allocated
+ * per customer except the view itself.
+ */
+
+#include "customerview.h"
+#include "isotimestamp.h"
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QJsonDocument>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QTimeZone>
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+const qint64 CustomerView::NoTimestamp = std::numeric_limits<qint64>::min();
+
+namespace {
+
+// Nesting allowed inside skipped values
+const int MaxDepth = 256;
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(QByteArray &out, char32_t codePoint)
+{
+    if (codePoint < 0x80) {
+        out.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        out.append(char(0xC0 | (codePoint >> 6)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        out.append(char(0xE0 | (codePoint >> 12)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (codePoint >> 18)));
+        out.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        out.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        out.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/**
+ * Resolve the escapes of a string the scanner has already validated
+ *
+ * @param text - String contents between the quotes
+ * @return QByteArray - UTF-8 text (unpaired surrogates become U+FFFD)
+ */
+QByteArray unescape(QByteArrayView text)
+{
+    QByteArray out;
+    out.reserve(text.size());
+
+    auto hex4 = [&text](qsizetype pos) {
+        return (hexValue(text[pos]) << 12) | (hexValue(text[pos + 1]) << 8)
+             | (hexValue(text[pos + 2]) << 4) | hexValue(text[pos + 3]);
+    };
+
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c != '\\') {
+            out.append(c);
+            continue;
+        }
+
+        const char escape = text[++i];
+        switch (escape) {
+        case 'b': out.append('\b'); break;
+        case 'f': out.append('\f'); break;
+        case 'n': out.append('\n'); break;
+        case 'r': out.append('\r'); break;
+        case 't': out.append('\t'); break;
+        case 'u': {
+            char32_t codePoint = char32_t(hex4(i + 1));
+            i += 4;
+            if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                // High surrogate: combine with a following \uDC00-\uDFFF
+                if (i + 6 < text.size() && text[i + 1] == '\\' && text[i + 2] == 'u') {
+                    const char32_t low = char32_t(hex4(i + 3));
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    } else {
+                        codePoint = 0xFFFD;
+                    }
+                } else {
+                    codePoint = 0xFFFD;
+                }
+            } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+                codePoint = 0xFFFD;
+            }
+            appendUtf8(out, codePoint);
+            break;
+        }
+        default:  // " \ /
+            out.append(escape);
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+/**
+ * Minimal JSON scanner over the response body
+ * Every scan function returns false on malformed input.
+ */
+class CustomerView::Scanner
+{
+public:
+    // Scans [from, to) of the body; positions stay relative to the body
+    Scanner(const QByteArray &body, qsizetype from, qsizetype to)
+        : m_data(body.constData())
+        , m_size(to)
+        , m_pos(from)
+    {
+    }
+
+    qsizetype pos() { skipSpace(); return m_pos; }
+    void seek(qsizetype pos) { m_pos = pos; }
+    bool atEnd() { skipSpace(); return m_pos == m_size; }
+
+    bool consume(char c)
+    {
+        skipSpace();
+        if (m_pos < m_size && m_data[m_pos] == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(char c)
+    {
+        skipSpace();
+        return m_pos < m_size && m_data[m_pos] == c;
+    }
+
+    /**
+     * String value
+     *
+     * @param start   - Receives the offset of the first character
+     * @param length  - Receives the length without quotes
+     * @param escaped - Receives whether the string contains escapes
+     */
+    bool string(qsizetype *start, qsizetype *length, bool *escaped)
+    {
+        if (!consume('"')) {
+            return false;
+        }
+
+        *start = m_pos;
+        *escaped = false;
+        while (m_pos < m_size) {
+            const uchar c = uchar(m_data[m_pos]);
+            if (c == '"') {
+                *length = m_pos - *start;
+                ++m_pos;
+                return true;
+            }
+            if (c < 0x20) {
+                return false;
+            }
+            if (c == '\\') {
+                *escaped = true;
+                if (++m_pos == m_size) {
+                    return false;
+                }
+                const char escape = m_data[m_pos];
+                if (escape == 'u') {
+                    if (m_pos + 4 >= m_size) {
+                        return false;
+                    }
+                    for (int i = 1; i <= 4; ++i) {
+                        if (hexValue(m_data[m_pos + i]) < 0) {
+                            return false;
+                        }
+                    }
+                    m_pos += 4;
+                } else if (escape == '\0' || !std::strchr("\"\\/bfnrt", escape)) {
+                    return false;
+                }
+            }
+            ++m_pos;
+        }
+        return false;
+    }
+
+    // Object key, unescaped only when needed
+    bool key(QByteArray *key)
+    {
+        qsizetype start;
+        qsizetype length;
+        bool escaped;
+        if (!string(&start, &length, &escaped) || !consume(':')) {
+            return false;
+        }
+        const QByteArrayView text(m_data + start, length);
+        *key = escaped ? unescape(text) : QByteArray::fromRawData(text.data(), text.size());
+        return true;
+    }
+
+    // Number per the JSON grammar
+    bool number(QByteArrayView *text)
+    {
+        skipSpace();
+        const qsizetype start = m_pos;
+        if (m_pos < m_size && m_data[m_pos] == '-') {
+            ++m_pos;
+        }
+        if (m_pos < m_size && m_data[m_pos] == '0') {
+            ++m_pos;
+        } else if (!digits()) {
+            return false;
+        }
+        if (m_pos < m_size && m_data[m_pos] == '.') {
+            ++m_pos;
+            if (!digits()) {
+                return false;
+            }
+        }
+        if (m_pos < m_size && (m_data[m_pos] == 'e' || m_data[m_pos] == 'E')) {
+            ++m_pos;
+            if (m_pos < m_size && (m_data[m_pos] == '+' || m_data[m_pos] == '-')) {
+                ++m_pos;
+            }
+            if (!digits()) {
+                return false;
+            }
+        }
+        *text = QByteArrayView(m_data + start, m_pos - start);
+        return true;
+    }
+
+    bool literal(QByteArrayView word)
+    {
+        skipSpace();
+        if (QByteArrayView(m_data + m_pos, m_size - m_pos).startsWith(word)) {
+            m_pos += word.size();
+            return true;
+        }
+        return false;
+    }
+
+    // Any value, discarded
+    bool skipValue(int depth = 0)
+    {
+        skipSpace();
+        if (m_pos == m_size || depth > MaxDepth) {
+            return false;
+        }
+
+        switch (m_data[m_pos]) {
+        case '"': {
+            qsizetype start;
+            qsizetype length;
+            bool escaped;
+            return string(&start, &length, &escaped);
+        }
+        case '{': {
+            ++m_pos;
+            if (consume('}')) {
+                return true;
+            }
+            do {
+                QByteArray ignored;
+                if (!key(&ignored) || !skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume('}');
+        }
+        case '[': {
+            ++m_pos;
+            if (consume(']')) {
+                return true;
+            }
+            do {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            } while (consume(','));
+            return consume(']');
+        }
+        case 't':
+            return literal("true");
+        case 'f':
+            return literal("false");
+        case 'n':
+            return literal("null");
+        default: {
+            QByteArrayView ignored;
+            return number(&ignored);
+        }
+        }
+    }
+
+private:
+    void skipSpace()
+    {
+        while (m_pos < m_size && (m_data[m_pos] == ' ' || m_data[m_pos] == '\n'
+                                  || m_data[m_pos] == '\r' || m_data[m_pos] == '\t')) {
+            ++m_pos;
+        }
+    }
+
+    bool digits()
+    {
+        const qsizetype start = m_pos;
+        while (m_pos < m_size && unsigned(m_data[m_pos]) - '0' <= 9) {
+            ++m_pos;
+        }
+        return m_pos > start;
+    }
+
+    const char *m_data;
+    qsizetype m_size;
+    qsizetype m_pos;
+};
+
+namespace {
+
+/**
+ * QJsonValue::toInt() of a JSON number: integral values in int range,
+ * anything else 0
+ */
+int toInt(QByteArrayView number)
+{
+    // Plain integers without a double round trip
+    qsizetype i = number.startsWith('-') ? 1 : 0;
+    if (number.size() - i > 0 && number.size() - i <= 9) {
+        int value = 0;
+        for (; i < number.size() && unsigned(number[i]) - '0' <= 9; ++i) {
+            value = value * 10 + (number[i] - '0');
+        }
+        if (i == number.size()) {
+            return number.startsWith('-') ? -value : value;
+        }
+    }
+
+    bool ok = false;
+    const double value = number.toByteArray().toDouble(&ok);
+    if (!ok || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()
+        || value != double(int(value))) {
+        return 0;
+    }
+    return int(value);
+}
+
+/**
+ * Structural pass for parallel parsing: find the top-level "data" array
+ * and the commas between its elements, at least rangeBytes apart
+ *
+ * Only strings and nesting are tracked; the parser validates everything
+ * afterwards, so a malformed body at worst yields unusable cuts.
+ *
+ * @return bool - false if no top-level "data" array was found
+ */
+bool splitDataArray(const QByteArray &body, qsizetype rangeBytes, qsizetype *arrayStart, qsizetype *arrayEnd,
+                    QList<qsizetype> *commas)
+{
+    const char *data = body.constData();
+    const qsizetype size = body.size();
+
+    int depth = 0;
+    int dataKey = 0;  // 1 = "data" seen at depth 1, 2 = and its ':'
+    qsizetype start = -1;
+    qsizetype nextCut = 0;
+
+    for (qsizetype i = 0; i < size; ++i) {
+        const char c = data[i];
+        switch (c) {
+        case '"': {
+            const qsizetype textStart = i + 1;
+            for (++i; i < size && data[i] != '"'; ++i) {
+                i += data[i] == '\\';
+            }
+            if (i >= size) {
+                return false;
+            }
+            if (depth == 1) {
+                dataKey = QByteArray::fromRawData(data + textStart, i - textStart) == "data" ? 1 : 0;
+            }
+            break;
+        }
+        case ':':
+            dataKey = dataKey == 1 ? 2 : 0;
+            break;
+        case '[':
+        case '{':
+            if (depth == 1 && c == '[' && dataKey == 2 && start < 0) {
+                start = i;
+                nextCut = i + rangeBytes;
+            }
+            dataKey = 0;
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (--depth < 0) {
+                return false;
+            }
+            if (depth == 1 && start >= 0) {
+                *arrayStart = start;
+                *arrayEnd = i + 1;
+                return true;
+            }
+            break;
+        case ',':
+            if (depth == 2 && start >= 0 && i >= nextCut) {
+                commas->append(i);
+                nextCut = i + rangeBytes;
+            }
+            dataKey = 0;
+            break;
+        case ' ':
+        case '\n':
+        case '\r':
+        case '\t':
+            break;
+        default:
+            dataKey = 0;
+            break;
+        }
+    }
+    return false;
+}
+
+/**
+ * Definite-length CBOR text string at the reader: its UTF-8 bytes lie
+ * right after the item header, so they are located without copying.
+ * Advances past the string.
+ *
+ * @param chunked - Set if the string is chunked (indefinite length)
+ * @return bool - false if the item is not a definite-length text string
+ *                or the data is malformed
+ */
+bool cborText(QCborStreamReader &reader, const QByteArray &body, qsizetype *start, qsizetype *length, bool *chunked)
+{
+    if (!reader.isString()) {
+        return false;
+    }
+    if (!reader.isLengthKnown()) {
+        *chunked = true;
+        return false;
+    }
+
+    // Argument size from the low five bits of the initial byte
+    const qsizetype offset = qsizetype(reader.currentOffset());
+    const int info = uchar(body.at(offset)) & 0x1f;
+    const qsizetype headerSize = info < 24 ? 1 : info == 24 ? 2 : info == 25 ? 3 : info == 26 ? 5 : 9;
+    *start = offset + headerSize;
+    *length = qsizetype(reader.length());
+    return reader.next();
+}
+
+/**
+ * Skip the value at the reader, including any tags in front of it
+ * (QCborStreamReader treats a tag as an element of its own)
+ */
+bool cborSkip(QCborStreamReader &reader)
+{
+    while (reader.isTag()) {
+        if (!reader.next()) {
+            return false;
+        }
+    }
+    return reader.next();
+}
+
+/**
+ * QJsonValue::toInt() of the CBOR number at the reader (0 if it is not
+ * an integral number in int range); advances past it
+ *
+ * @return bool - false if the item is not a number
+ */
+bool cborInt(QCborStreamReader &reader, int *value)
+{
+    const quint64 IntMax = quint64(std::numeric_limits<int>::max());
+    if (reader.isUnsignedInteger()) {
+        const quint64 integer = reader.toUnsignedInteger();
+        *value = integer <= IntMax ? int(integer) : 0;
+    } else if (reader.isNegativeInteger()) {
+        const quint64 magnitude = quint64(reader.toNegativeInteger());  // Value is -1 - magnitude
+        *value = magnitude <= IntMax ? -1 - int(magnitude) : 0;
+    } else {
+        double number;
+        if (reader.isDouble()) {
+            number = reader.toDouble();
+        } else if (reader.isFloat()) {
+            number = reader.toFloat();
+        } else if (reader.isFloat16()) {
+            number = reader.toFloat16();
+        } else {
+            return false;
+        }
+        *value = number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max()
+                 && number == double(int(number)) ? int(number) : 0;
+    }
+    return reader.next();
+}
+
+} // namespace
+
+CustomerView::CustomerView()
+    : m_id(0)
+    , m_escaped(0)
+    , m_decoded(0)
+    , m_msecs { NoTimestamp, NoTimestamp, NoTimestamp }
+{
+}
+
+/**
+ * Parse a customer list response
+ *
+ * Fields have the meaning (and defaults) of the QJsonObject accessors
+ * used by Customer::fromJson: a missing or non-string field is empty,
+ * a non-object element of "data" becomes an empty customer.
+ *
+ * @param body - Complete response body; shared by the returned views
+ * @return ParseResult - valid is false if the body is not well-formed JSON
+ */
+CustomerView::ParseResult CustomerView::parseList(const QByteArray &body)
+{
+    ParseResult result;
+    if (body.size() > std::numeric_limits<qint32>::max()) {
+        return result;
+    }
+
+    Scanner scanner(body, 0, body.size());
+    if (!parseTopLevel(scanner, body, &result, -1, -1, nullptr)) {
+        return ParseResult();
+    }
+    result.valid = true;
+    return result;
+}
+
+/**
+ * Parse a customer list response, splitting a large "data" array into
+ * ranges that are decoded in parallel
+ *
+ * A quick structural pass (strings and nesting only) cuts the array at
+ * element boundaries every rangeBytes; each range is then parsed and
+ * validated exactly as parseList(body) would. The calling thread works
+ * on ranges too, so this never waits for a pool thread that cannot start.
+ *
+ * @param body       - Complete response body
+ * @param pool       - Pool for the extra ranges
+ * @param rangeBytes - Minimum bytes per range
+ * @return ParseResult - Same result as parseList(body)
+ */
+CustomerView::ParseResult CustomerView::parseList(const QByteArray &body, QThreadPool *pool, qsizetype rangeBytes)
+{
+    qsizetype arrayStart = 0;
+    qsizetype arrayEnd = 0;
+    QList<qsizetype> commas;
+    if (!pool || pool->maxThreadCount() < 2 || body.size() < 2 * rangeBytes
+        || body.size() > std::numeric_limits<qint32>::max()
+        || !splitDataArray(body, rangeBytes, &arrayStart, &arrayEnd, &commas) || commas.isEmpty()) {
+        return parseList(body);
+    }
+
+    struct Range
+    {
+        qsizetype from;
+        qsizetype to;
+        QList<CustomerView> customers;
+        bool ok = false;
+    };
+    struct Job
+    {
+        QByteArray body;
+        QList<Range> ranges;
+        std::atomic<int> next { 0 };
+        QSemaphore done;
+    };
+
+    // Shared with the helpers: one may start only after the work is done
+    QSharedPointer<Job> job = QSharedPointer<Job>::create();
+    job->body = body;
+    qsizetype from = arrayStart + 1;
+    for (qsizetype comma : std::as_const(commas)) {
+        job->ranges.append({ from, comma, {}, false });
+        from = comma + 1;
+    }
+    job->ranges.append({ from, arrayEnd - 1, {}, false });
+
+    const int rangeCount = int(job->ranges.count());
+    Range *ranges = job->ranges.data();
+
+    auto work = [job, ranges, rangeCount]() {
+        for (int i = job->next.fetch_add(1); i < rangeCount; i = job->next.fetch_add(1)) {
+            Scanner scanner(job->body, ranges[i].from, ranges[i].to);
+            ranges[i].ok = parseElements(scanner, job->body, &ranges[i].customers) && scanner.atEnd();
+            job->done.release();
+        }
+    };
+
+    const int helpers = qMin(rangeCount - 1, pool->maxThreadCount() - 1);
+    for (int i = 0; i < helpers; ++i) {
+        pool->start(work);
+    }
+    work();
+    job->done.acquire(rangeCount);
+
+    ParseResult result;
+    Scanner scanner(body, 0, body.size());
+    int skipState = NotSkipped;
+    if (!parseTopLevel(scanner, body, &result, arrayStart, arrayEnd, &skipState)) {
+        return ParseResult();
+    }
+
+    // The ranges are part of the document even if a later "data" won
+    qsizetype total = 0;
+    for (const Range &range : std::as_const(job->ranges)) {
+        if (skipState != NotSkipped && !range.ok) {
+            return ParseResult();
+        }
+        total += range.customers.count();
+    }
+    result.valid = true;
+    if (skipState != SkippedFinal) {
+        return result;
+    }
+
+    result.customers.reserve(total);
+    for (const Range &range : std::as_const(job->ranges)) {
+        result.customers.append(range.customers);
+    }
+    return result;
+}
+
+/**
+ * Top-level {"success", "data", "nextCursor", "message"} object
+ *
+ * @param skipFrom  - Position of a "data" array parsed elsewhere (-1 = none)
+ * @param skipTo    - End of that array
+ * @param skipState - Receives a SkipState (may be null without skipFrom)
+ * @return bool - true if the body is well-formed JSON
+ */
+bool CustomerView::parseTopLevel(Scanner &scanner, const QByteArray &body, ParseResult *result,
+                                 qsizetype skipFrom, qsizetype skipTo, int *skipState)
+{
+    if (!scanner.peek('{')) {
+        // Valid JSON that is not an object carries no list
+        return scanner.skipValue() && scanner.atEnd();
+    }
+
+    scanner.consume('{');
+    if (!scanner.consume('}')) {
+        do {
+            QByteArray key;
+            if (!scanner.key(&key)) {
+                return false;
+            }
+
+            if (key == "success") {
+                if (scanner.literal("true")) {
+                    result->success = true;
+                    continue;
+                }
+                result->success = false;
+            } else if (key == "message" && scanner.peek('"')) {
+                qsizetype start;
+                qsizetype length;
+                bool escaped;
+                if (!scanner.string(&start, &length, &escaped)) {
+                    return false;
+                }
+                const QByteArrayView text(body.constData() + start, length);
+                result->message = QString::fromUtf8(escaped ? unescape(text) : text.toByteArray());
+                continue;
+            } else if (key == "nextCursor") {
+                QByteArrayView number;
+                if (scanner.number(&number)) {
+                    result->nextCursor = toInt(number);
+                    continue;
+                }
+                result->nextCursor = 0;
+            } else if (key == "data" && scanner.peek('[')) {
+                result->customers.clear();
+                if (scanner.pos() == skipFrom) {
+                    scanner.seek(skipTo);
+                    *skipState = SkippedFinal;
+                    continue;
+                }
+                if (skipState && *skipState == SkippedFinal) {
+                    *skipState = SkippedReplaced;
+                }
+                scanner.consume('[');
+                if (!scanner.consume(']')) {
+                    if (!parseElements(scanner, body, &result->customers) || !scanner.consume(']')) {
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            if (!scanner.skipValue()) {
+                return false;
+            }
+        } while (scanner.consume(','));
+
+        if (!scanner.consume('}')) {
+            return false;
+        }
+    }
+
+    return scanner.atEnd();
+}
+
+/**
+ * Comma-separated array elements, up to the first element not followed
+ * by a comma
+ */
+bool CustomerView::parseElements(Scanner &scanner, const QByteArray &body, QList<CustomerView> *customers)
+{
+    do {
+        customers->append(CustomerView());
+        if (!parseCustomer(scanner, body, &customers->last())) {
+            return false;
+        }
+    } while (scanner.consume(','));
+    return true;
+}
+
+bool CustomerView::parseCustomer(Scanner &scanner, const QByteArray &body, CustomerView *view)
+{
+    if (!scanner.peek('{')) {
+        return scanner.skipValue();
+    }
+    view->m_body = body;
+    scanner.consume('{');
+    if (scanner.consume('}')) {
+        return true;
+    }
+
+    do {
+        QByteArray key;
+        if (!scanner.key(&key)) {
+            return false;
+        }
+
+        Field field = FieldCount;
+        if (key == "id") {
+            QByteArrayView number;
+            if (scanner.number(&number)) {
+                view->m_id = toInt(number);
+                continue;
+            }
+            view->m_id = 0;
+        } else if (key == "firstName") {
+            field = FirstName;
+        } else if (key == "lastName") {
+            field = LastName;
+        } else if (key == "address") {
+            field = Address;
+        } else if (key == "createdAt") {
+            field = CreatedAt;
+        } else if (key == "updatedAt") {
+            field = UpdatedAt;
+        } else if (key == "deletedAt") {
+            field = DeletedAt;
+        }
+
+        if (field != FieldCount && scanner.peek('"')) {
+            qsizetype start;
+            qsizetype length;
+            bool escaped;
+            if (!scanner.string(&start, &length, &escaped)) {
+                return false;
+            }
+            view->m_spans[field] = { qint32(start), qint32(length) };
+            view->m_escaped = quint8((view->m_escaped & ~(1u << field)) | (unsigned(escaped) << field));
+        } else {
+            if (field != FieldCount) {
+                view->m_spans[field] = Span();
+            }
+            if (!scanner.skipValue()) {
+                return false;
+            }
+        }
+    } while (scanner.consume(','));
+    return scanner.consume('}');
+}
+
+/**
+ * Parse an application/cbor customer list response
+ *
+ * The body is the CBOR form of the JSON response (maps, arrays, text
+ * strings; timestamps as text, optionally tagged 0 = date/time string).
+ * Views share the body like JSON views. Bodies with chunked strings,
+ * which the backend does not send, are converted to JSON and parsed
+ * with parseList().
+ *
+ * @param body - Complete response body; shared by the returned views
+ * @return ParseResult - valid is false if the body is not well-formed CBOR
+ */
+CustomerView::ParseResult CustomerView::parseCborList(const QByteArray &body)
+{
+    ParseResult result;
+    if (body.isEmpty() || body.size() > std::numeric_limits<qint32>::max()) {
+        return result;
+    }
+
+    QCborStreamReader reader(body);
+    bool chunked = false;
+    const bool ok = parseCborTopLevel(reader, body, &result, &chunked);
+    if (chunked) {
+        const QCborValue value = QCborValue::fromCbor(body);
+        return parseList(QJsonDocument(value.toMap().toJsonObject()).toJson(QJsonDocument::Compact));
+    }
+    if (!ok || reader.currentOffset() != body.size()) {
+        return ParseResult();
+    }
+    result.valid = true;
+    return result;
+}
+
+/**
+ * Top-level {"success", "data", "nextCursor", "message"} map, with the
+ * same rules as the JSON parser
+ */
+bool CustomerView::parseCborTopLevel(QCborStreamReader &reader, const QByteArray &body, ParseResult *result,
+                                     bool *chunked)
+{
+    if (!reader.isMap()) {
+        // Well-formed CBOR that is not a map carries no list
+        return cborSkip(reader);
+    }
+    if (!reader.enterContainer()) {
+        return false;
+    }
+
+    while (reader.hasNext()) {
+        qsizetype start;
+        qsizetype length;
+        if (!cborText(reader, body, &start, &length, chunked)) {
+            // Non-text keys are not part of the response format
+            if (*chunked || !cborSkip(reader) || !cborSkip(reader)) {
+                return false;
+            }
+            continue;
+        }
+        const QByteArray key = QByteArray::fromRawData(body.constData() + start, length);
+
+        if (key == "success") {
+            result->success = reader.isTrue();
+        } else if (key == "message" && reader.isString()) {
+            if (!cborText(reader, body, &start, &length, chunked)) {
+                return false;
+            }
+            result->message = QString::fromUtf8(body.constData() + start, length);
+            continue;
+        } else if (key == "nextCursor") {
+            if (cborInt(reader, &result->nextCursor)) {
+                continue;
+            }
+            result->nextCursor = 0;
+        } else if (key == "data" && reader.isArray()) {
+            result->customers.clear();
+            if (reader.isLengthKnown()) {
+                result->customers.reserve(qsizetype(qMin<quint64>(reader.length(), quint64(body.size()))));
+            }
+            if (!reader.enterContainer()) {
+                return false;
+            }
+            while (reader.hasNext()) {
+                result->customers.append(CustomerView());
+                if (!parseCborCustomer(reader, body, &result->customers.last(), chunked)) {
+                    return false;
+                }
+            }
+            if (!reader.leaveContainer()) {
+                return false;
+            }
+            continue;
+        }
+
+        if (!cborSkip(reader)) {
+            return false;
+        }
+    }
+    return reader.lastError() == QCborError::NoError && reader.leaveContainer();
+}
+
+bool CustomerView::parseCborCustomer(QCborStreamReader &reader, const QByteArray &body, CustomerView *view,
+                                     bool *chunked)
+{
+    if (!reader.isMap()) {
+        return cborSkip(reader);
+    }
+    view->m_body = body;
+    if (!reader.enterContainer()) {
+        return false;
+    }
+
+    while (reader.hasNext()) {
+        qsizetype start;
+        qsizetype length;
+        if (!cborText(reader, body, &start, &length, chunked)) {
+            if (*chunked || !cborSkip(reader) || !cborSkip(reader)) {
+                return false;
+            }
+            continue;
+        }
+        const QByteArray key = QByteArray::fromRawData(body.constData() + start, length);
+
+        Field field = FieldCount;
+        if (key == "id") {
+            if (cborInt(reader, &view->m_id)) {
+                continue;
+            }
+            view->m_id = 0;
+        } else if (key == "firstName") {
+            field = FirstName;
+        } else if (key == "lastName") {
+            field = LastName;
+        } else if (key == "address") {
+            field = Address;
+        } else if (key == "createdAt") {
+            field = CreatedAt;
+        } else if (key == "updatedAt") {
+            field = UpdatedAt;
+        } else if (key == "deletedAt") {
+            field = DeletedAt;
+        }
+
+        // Timestamps may carry the standard date/time string tag
+        if ((field == CreatedAt || field == UpdatedAt || field == DeletedAt) && reader.isTag()
+            && reader.toTag() == QCborTag(QCborKnownTags::DateTimeString)) {
+            if (!reader.next()) {
+                return false;
+            }
+        }
+
+        if (field != FieldCount && reader.isString()) {
+            if (!cborText(reader, body, &start, &length, chunked)) {
+                return false;
+            }
+            view->m_spans[field] = { qint32(start), qint32(length) };
+            view->m_escaped = quint8(view->m_escaped & ~(1u << field));
+        } else {
+            if (field != FieldCount) {
+                view->m_spans[field] = Span();
+            }
+            if (!cborSkip(reader)) {
+                return false;
+            }
+        }
+    }
+    return reader.lastError() == QCborError::NoError && reader.leaveContainer();
+}
+
+QDateTime CustomerView::getCreatedAt() const
+{
+    const qint64 value = msecs(CreatedAt);
+    return value == NoTimestamp ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value, QTimeZone::UTC);
+}
+
+QDateTime CustomerView::getUpdatedAt() const
+{
+    const qint64 value = msecs(UpdatedAt);
+    return value == NoTimestamp ? QDateTime() : QDateTime::fromMSecsSinceEpoch(value, QTimeZone::UTC);
+}
+
+/**
+ * Materialize a regular Customer (decodes every field)
+ */
+Customer CustomerView::toCustomer() const
+{
+    Customer customer;
+    customer.setId(m_id);
+    customer.setFirstName(getFirstName());
+    customer.setLastName(getLastName());
+    customer.setAddress(getAddress());
+    customer.setCreatedAt(getCreatedAt());
+    customer.setUpdatedAt(getUpdatedAt());
+    return customer;
+}
+
+QList<Customer> CustomerView::toCustomers(const QList<CustomerView> &views)
+{
+    QList<Customer> customers;
+    customers.reserve(views.count());
+    for (const CustomerView &view : views) {
+        customers.append(view.toCustomer());
+    }
+    return customers;
+}
+
+QByteArrayView CustomerView::raw(Field field) const
+{
+    const Span &span = m_spans[field];
+    return span.length < 0 ? QByteArrayView() : QByteArrayView(m_body.constData() + span.offset, span.length);
+}
+
+/**
+ * UTF-8 bytes of a field
+ * Unescaped fields point into the shared body (fromRawData) and stay
+ * valid while any view of the same response exists.
+ */
+QByteArray CustomerView::utf8(Field field) const
+{
+    const QByteArrayView text = raw(field);
+    if (m_escaped & (1u << field)) {
+        return unescape(text);
+    }
+    return QByteArray::fromRawData(text.data(), text.size());
+}
+
+QString CustomerView::string(Field field) const
+{
+    if (!(m_decoded & (1u << field))) {
+        const QByteArrayView text = raw(field);
+        m_strings[field] = QString::fromUtf8(m_escaped & (1u << field) ? QByteArrayView(unescape(text)) : text);
+        m_decoded |= quint8(1u << field);
+    }
+    return m_strings[field];
+}
+
+qint64 CustomerView::msecs(Field field) const
+{
+    const int slot = field - CreatedAt;
+    if (!(m_decoded & (1u << field))) {
+        const QByteArray text = utf8(field);
+        qint64 value;
+        m_msecs[slot] = !text.isEmpty() && IsoTimestamp::parse(text, &value) ? value : NoTimestamp;
+        m_decoded |= quint8(1u << field);
+    }
+    return m_msecs[slot];
+}
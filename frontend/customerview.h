@@ -0,0 +1,136 @@
+/**
+ * CustomerView - Lazily decoded customer over a retained response body
+ *
+ * parseList() scans a customer list response once and records, for every
+ * customer, where each string field lies in the UTF-8 body instead of
+ * building QStrings and QDateTimes up front. The view shares the body
+ * (implicitly, no copy) and decodes a field the first time it is read:
+ * - strings are converted to UTF-16 on first access (JSON escapes are
+ *   resolved then as well)
+ * - timestamps go through IsoTimestamp, or stay raw UTF-8 for callers
+ *   that only need epoch milliseconds
+ *
+ * parseCborList() does the same for application/cbor bodies, where text
+ * strings are plain UTF-8 and never need unescaping.
+ *
+ * Delta sync responses add a "deletedAt" timestamp; rows where it is set
+ * are tombstones (isDeleted()) and only the id and timestamps matter.
+ *
+ * Consumers that store UTF-8 themselves (CustomerStore, snapshots) read
+ * the raw bytes and never create a QString at all. A view is a value
+ * type; decoded fields are cached per copy and the lazy getters are not
+ * thread-safe.
+ */
+
+#ifndef CUSTOMERVIEW_H
+#define CUSTOMERVIEW_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include "customer.h"
+
+class QThreadPool;
+class QCborStreamReader;
+
+class CustomerView
+{
+public:
+    struct ParseResult;
+
+    // Sentinel for "timestamp not set or invalid"
+    static const qint64 NoTimestamp;
+
+    CustomerView();
+
+    static ParseResult parseList(const QByteArray &body);
+    static ParseResult parseList(const QByteArray &body, QThreadPool *pool, qsizetype rangeBytes = 256 * 1024);
+    static ParseResult parseCborList(const QByteArray &body);
+
+    // Same getters as Customer
+    int getId() const { return m_id; }
+    QString getFirstName() const { return string(FirstName); }
+    QString getLastName() const { return string(LastName); }
+    QString getAddress() const { return string(Address); }
+    QDateTime getCreatedAt() const;
+    QDateTime getUpdatedAt() const;
+    QString getFullName() const { return getFirstName() + " " + getLastName(); }
+
+    // Epoch milliseconds without building a QDateTime
+    qint64 createdAtMSecs() const { return msecs(CreatedAt); }
+    qint64 updatedAtMSecs() const { return msecs(UpdatedAt); }
+
+    // Tombstone of a deleted customer (delta sync responses only)
+    bool isDeleted() const { return m_spans[DeletedAt].length >= 0; }
+    qint64 deletedAtMSecs() const { return msecs(DeletedAt); }
+
+    // UTF-8 text; shares the response body unless the field had escapes
+    QByteArray firstNameUtf8() const { return utf8(FirstName); }
+    QByteArray lastNameUtf8() const { return utf8(LastName); }
+    QByteArray addressUtf8() const { return utf8(Address); }
+
+    Customer toCustomer() const;
+    static QList<Customer> toCustomers(const QList<CustomerView> &views);
+
+private:
+    enum Field {
+        FirstName,
+        LastName,
+        Address,
+        CreatedAt,
+        UpdatedAt,
+        DeletedAt,
+        FieldCount
+    };
+
+    struct Span
+    {
+        qint32 offset = 0;
+        qint32 length = -1;  // -1 = field absent
+    };
+
+    class Scanner;
+
+    // How parseTopLevel() met a "data" array parsed elsewhere
+    enum SkipState {
+        NotSkipped,
+        SkippedFinal,     // Its elements are the result
+        SkippedReplaced   // A later "data" key replaced it
+    };
+
+    static bool parseTopLevel(Scanner &scanner, const QByteArray &body, ParseResult *result,
+                              qsizetype skipFrom, qsizetype skipTo, int *skipState);
+    static bool parseElements(Scanner &scanner, const QByteArray &body, QList<CustomerView> *customers);
+    static bool parseCustomer(Scanner &scanner, const QByteArray &body, CustomerView *view);
+    static bool parseCborTopLevel(QCborStreamReader &reader, const QByteArray &body, ParseResult *result, bool *chunked);
+    static bool parseCborCustomer(QCborStreamReader &reader, const QByteArray &body, CustomerView *view, bool *chunked);
+
+    QByteArrayView raw(Field field) const;
+    QByteArray utf8(Field field) const;
+    QString string(Field field) const;
+    qint64 msecs(Field field) const;
+
+    QByteArray m_body;  // Shared response body
+    Span m_spans[FieldCount];
+    int m_id;
+    quint8 m_escaped;   // Bit per field: contains JSON escapes
+
+    // Decode caches
+    mutable quint8 m_decoded;  // Bit per field
+    mutable QString m_strings[Address + 1];
+    mutable qint64 m_msecs[FieldCount - CreatedAt];
+};
+
+// Outcome of parsing a {"success", "data", "nextCursor", "message"} body
+struct CustomerView::ParseResult
+{
+    bool valid = false;  // Well-formed JSON (CBOR for parseCborList)
+    bool success = false;
+    QString message;
+    int nextCursor = 0;  // null / absent -> 0
+    QList<CustomerView> customers;
+};
+
+#endif // CUSTOMERVIEW_H
@@ -0,0 +1,178 @@
+/**
+ * isotimestamp.cpp - Fast ISO 8601 timestamp parsing implementation
+ */
+
+#include "isotimestamp.h"
+#include <QTimeZone>
+#include <climits>
+
+namespace {
+
+const qint64 MSecsPerDay = 24 * 60 * 60 * 1000;
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date
+ * (H. Hinnant's days_from_civil, no loops or tables)
+ */
+qint64 daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return qint64(era) * 146097 + dayOfEra - 719468;
+}
+
+int daysInMonth(int year, int month)
+{
+    static const int Days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return Days[month - 1] + (month == 2 && leap);
+}
+
+/**
+ * Value of the digits at [pos, pos + count); any non-digit sets *bad
+ */
+template<typename Char>
+inline int digits(const Char *text, int pos, int count, unsigned *bad)
+{
+    int value = 0;
+    for (int i = pos; i < pos + count; ++i) {
+        const unsigned digit = unsigned(text[i]) - '0';
+        *bad |= unsigned(digit > 9);
+        value = value * 10 + int(digit);
+    }
+    return value;
+}
+
+} // namespace
+
+/**
+ * Fixed-layout fast path
+ *
+ * @param msecs         - Receives epoch milliseconds
+ * @param offsetSeconds - Receives the zone offset, or INT_MIN for "Z"
+ * @return bool - false if the text needs the general parser
+ */
+template<typename Char>
+bool IsoTimestamp::parseFast(const Char *text, qsizetype size, qint64 *msecs, int *offsetSeconds)
+{
+    // 2025-01-02T08:00:00Z is the shortest accepted form
+    if (size < 20 || size > 29) {
+        return false;
+    }
+
+    unsigned bad = 0;
+    bad |= unsigned(text[4] != '-') | unsigned(text[7] != '-') | unsigned(text[10] != 'T')
+         | unsigned(text[13] != ':') | unsigned(text[16] != ':');
+    const int year = digits(text, 0, 4, &bad);
+    const int month = digits(text, 5, 2, &bad);
+    const int day = digits(text, 8, 2, &bad);
+    const int hour = digits(text, 11, 2, &bad);
+    const int minute = digits(text, 14, 2, &bad);
+    const int second = digits(text, 17, 2, &bad);
+    if (bad) {
+        return false;
+    }
+
+    // Optional fraction of 1-3 digits
+    int pos = 19;
+    int millis = 0;
+    if (text[pos] == '.') {
+        const qsizetype start = ++pos;
+        while (pos < size && pos - start < 4 && unsigned(text[pos]) - '0' <= 9) {
+            millis = millis * 10 + int(text[pos] - '0');
+            ++pos;
+        }
+        const qsizetype count = pos - start;
+        if (count == 0 || count > 3) {
+            return false;
+        }
+        millis *= count == 1 ? 100 : count == 2 ? 10 : 1;
+    }
+
+    // Zone
+    int offset = 0;
+    if (pos == size - 1 && text[pos] == 'Z') {
+        *offsetSeconds = INT_MIN;
+    } else if (pos == size - 6 && (text[pos] == '+' || text[pos] == '-') && text[pos + 3] == ':') {
+        const int offsetHours = digits(text, int(pos) + 1, 2, &bad);
+        const int offsetMinutes = digits(text, int(pos) + 4, 2, &bad);
+        if (bad || offsetHours > 14 || offsetMinutes > 59) {
+            return false;
+        }
+        offset = (offsetHours * 60 + offsetMinutes) * 60 * (text[pos] == '-' ? -1 : 1);
+        *offsetSeconds = offset;
+    } else {
+        return false;
+    }
+
+    if (year < 1 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)
+        || hour > 23 || minute > 59 || second > 59) {
+        return false;
+    }
+
+    *msecs = daysFromCivil(year, month, day) * MSecsPerDay
+           + ((hour * 60 + minute) * 60 + second - offset) * qint64(1000) + millis;
+    return true;
+}
+
+bool IsoTimestamp::parse(QByteArrayView text, qint64 *msecs)
+{
+    int offsetSeconds;
+    if (parseFast(text.data(), text.size(), msecs, &offsetSeconds)) {
+        return true;
+    }
+
+    const QDateTime dateTime = QDateTime::fromString(QString::fromLatin1(text), Qt::ISODate);
+    if (!dateTime.isValid()) {
+        return false;
+    }
+    *msecs = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+bool IsoTimestamp::parse(QStringView text, qint64 *msecs)
+{
+    int offsetSeconds;
+    if (parseFast(text.utf16(), text.size(), msecs, &offsetSeconds)) {
+        return true;
+    }
+
+    const QDateTime dateTime = QDateTime::fromString(text.toString(), Qt::ISODate);
+    if (!dateTime.isValid()) {
+        return false;
+    }
+    *msecs = dateTime.toMSecsSinceEpoch();
+    return true;
+}
+
+QDateTime IsoTimestamp::toDateTime(QByteArrayView text)
+{
+    qint64 msecs;
+    int offsetSeconds;
+    if (parseFast(text.data(), text.size(), &msecs, &offsetSeconds)) {
+        return fromFast(msecs, offsetSeconds);
+    }
+    return QDateTime::fromString(QString::fromLatin1(text), Qt::ISODate);
+}
+
+QDateTime IsoTimestamp::toDateTime(QStringView text)
+{
+    qint64 msecs;
+    int offsetSeconds;
+    if (parseFast(text.utf16(), text.size(), &msecs, &offsetSeconds)) {
+        return fromFast(msecs, offsetSeconds);
+    }
+    return QDateTime::fromString(text.toString(), Qt::ISODate);
+}
+
+/**
+ * "Z" gives a UTC QDateTime, an offset an offset-from-UTC one, as Qt does
+ */
+QDateTime IsoTimestamp::fromFast(qint64 msecs, int offsetSeconds)
+{
+    return QDateTime::fromMSecsSinceEpoch(msecs, offsetSeconds == INT_MIN ? QTimeZone(QTimeZone::UTC)
+                                                                         : QTimeZone::fromSecondsAheadOfUtc(offsetSeconds));
+}
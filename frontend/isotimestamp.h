@@ -0,0 +1,41 @@
+/**
+ * IsoTimestamp - Fast ISO 8601 / RFC 3339 timestamp parsing
+ *
+ * Parses the timestamps the backend sends (Date.toISOString, e.g.
+ * "2025-01-02T08:00:00.000Z") straight to epoch milliseconds with fixed
+ * position digit arithmetic, instead of QDateTime::fromString's general
+ * ISO parser. The fast path accepts
+ *
+ *   YYYY-MM-DDTHH:MM:SS[.f{1,3}](Z|+HH:MM|-HH:MM)
+ *
+ * with every field range checked; anything else (no zone, comma or long
+ * fractions, 24:00, leap seconds, basic format...) is handed to
+ * QDateTime::fromString(text, Qt::ISODate), so results always match Qt's.
+ */
+
+#ifndef ISOTIMESTAMP_H
+#define ISOTIMESTAMP_H
+
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QStringView>
+
+class IsoTimestamp
+{
+public:
+    // Epoch milliseconds; false if the text is not a valid timestamp
+    static bool parse(QByteArrayView text, qint64 *msecs);
+    static bool parse(QStringView text, qint64 *msecs);
+
+    // Same result (value and time spec) as QDateTime::fromString(text, Qt::ISODate)
+    static QDateTime toDateTime(QByteArrayView text);
+    static QDateTime toDateTime(QStringView text);
+
+private:
+    template<typename Char>
+    static bool parseFast(const Char *text, qsizetype size, qint64 *msecs, int *offsetSeconds);
+
+    static QDateTime fromFast(qint64 msecs, int offsetSeconds);
+};
+
+#endif // ISOTIMESTAMP_H
@@ -0,0 +1,558 @@
+/**
+ * loadgenerator.cpp - Simulated ATM fleet implementation
+ */
+
+#include "loadgenerator.h"
+#include "apiclient.h"
+#include <QJsonArray>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const char *const OperationNames[] = { "health", "list", "get", "create", "update", "delete" };
+
+const int SeedPageSize = 500;
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QString formatMillis(qint64 micros)
+{
+    return QString::number(micros / 1000.0, 'f', micros < 10000 ? 2 : 1);
+}
+
+QJsonObject latencyJson(const ApiMetrics::Histogram &histogram)
+{
+    return QJsonObject{
+        { "count", qint64(histogram.count()) },
+        { "mean", histogram.mean() / 1000.0 },
+        { "p50", histogram.percentile(0.5) / 1000.0 },
+        { "p90", histogram.percentile(0.9) / 1000.0 },
+        { "p99", histogram.percentile(0.99) / 1000.0 },
+        { "p999", histogram.percentile(0.999) / 1000.0 },
+        { "max", histogram.max() / 1000.0 }
+    };
+}
+
+} // namespace
+
+/**
+ * Constructor
+ *
+ * @param config - Load profile; the base URL has already been checked by the caller
+ * @param parent - Parent object
+ */
+LoadGenerator::LoadGenerator(const Config &config, QObject *parent)
+    : QObject(parent)
+    , m_config(config)
+    , m_random(config.seed)
+    , m_mixDistribution(std::begin(config.mix), std::end(config.mix))
+    , m_arrivalTimer(new QTimer(this))
+    , m_reportTimer(new QTimer(this))
+    , m_nextArrivalNs(0)
+    , m_arrivalEndNs(0)
+    , m_drainDeadlineNs(0)
+    , m_nextSessionId(0)
+    , m_sessionsStarted(0)
+    , m_sessionsAbandoned(0)
+    , m_seedRequestId(0)
+    , m_draining(false)
+    , m_cleaningUp(false)
+    , m_cleanupErrors(0)
+    , m_createSequence(0)
+    , m_completed(0)
+    , m_lastReportCompleted(0)
+    , m_firstSentNs(-1)
+    , m_lastCompletedNs(0)
+{
+    for (int i = 0; i < qMax(1, m_config.clients); ++i) {
+        ApiClient *client = new ApiClient(this);
+        client->setPrewarmEnabled(false);             // Connections open under load, as for a real fleet
+        client->setRequestCoalescingEnabled(false);   // Every operation must reach the backend
+        client->setRateLimitPacingEnabled(false);     // Report 429s instead of holding operations back
+        client->setCustomerCacheSize(0);              // Every lookup must reach the backend
+        client->setLookupBatchingEnabled(false);      // One request per lookup, not one ?ids= per pass
+        client->setBaseUrl(m_config.baseUrl);
+
+        connect(client, &ApiClient::requestFinished, this,
+                [this, client](quint64 requestId, int httpStatus, QNetworkReply::NetworkError error) {
+                    onRequestFinished(client, requestId, httpStatus, error);
+                });
+        connect(client, &ApiClient::customerCreated, this, [this](const Customer &customer) {
+            onCustomerCreated(customer.getId());
+        });
+        m_clients.append(client);
+    }
+
+    connect(m_clients.first(), &ApiClient::customersPageReceived, this,
+            [this](const QList<Customer> &customers, int, int) {
+                for (const Customer &customer : customers) {
+                    m_seedIds.append(customer.getId());
+                }
+            });
+
+    m_arrivalTimer->setSingleShot(true);
+    m_arrivalTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_arrivalTimer, &QTimer::timeout, this, &LoadGenerator::onArrivalTimer);
+
+    m_reportTimer->setInterval(qMax(1, m_config.reportIntervalSec) * 1000);
+    connect(m_reportTimer, &QTimer::timeout, this, &LoadGenerator::printProgress);
+}
+
+LoadGenerator::~LoadGenerator()
+{
+}
+
+/**
+ * Read a page of existing customers for the get operations, then start
+ * the arrival process
+ */
+void LoadGenerator::start()
+{
+    out() << "Load test against " << m_config.baseUrl << ": " << m_config.sessionRate << " sessions/s for "
+          << m_config.durationSec << " s, " << m_config.opsPerSession << " operations per session, "
+          << m_clients.count() << " client(s)" << Qt::endl;
+
+    m_clock.start();
+    m_clients.first()->getCustomersPage(SeedPageSize, 0);
+    m_seedRequestId = m_clients.first()->lastRequestId();
+}
+
+void LoadGenerator::beginArrivals()
+{
+    out() << "Using " << m_seedIds.count() << " existing customer(s) for get operations" << Qt::endl;
+
+    const qint64 now = m_clock.nsecsElapsed();
+    m_nextArrivalNs = now;
+    m_arrivalEndNs = now + qint64(m_config.durationSec) * 1000000000;
+    m_drainDeadlineNs = m_arrivalEndNs + qint64(m_config.drainTimeoutSec) * 1000000000;
+    m_lastReportCompleted = 0;
+    m_reportTimer->start();
+
+    QTimer::singleShot(int((m_drainDeadlineNs - now) / 1000000) + 1, this, &LoadGenerator::checkFinished);
+    onArrivalTimer();
+}
+
+/**
+ * Start every session whose arrival time has passed, then sleep until
+ * the next one. Arrivals keep their planned times even if the timer
+ * fires late, so generator lag shows up in the corrected latencies.
+ */
+void LoadGenerator::onArrivalTimer()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const double meanGapNs = 1e9 / qMax(0.001, m_config.sessionRate);
+
+    while (m_nextArrivalNs <= now && m_nextArrivalNs < m_arrivalEndNs) {
+        startSession(m_nextArrivalNs);
+        m_nextArrivalNs += qMax<qint64>(1, qint64(exponential(meanGapNs)));
+    }
+
+    if (m_nextArrivalNs >= m_arrivalEndNs) {
+        m_draining = true;
+        checkFinished();
+        return;
+    }
+
+    m_arrivalTimer->start(int((m_nextArrivalNs - now + 999999) / 1000000));
+}
+
+void LoadGenerator::startSession(qint64 plannedNs)
+{
+    const int sessionId = m_nextSessionId++;
+    Session &session = m_sessions[sessionId];
+    session.client = m_clients.at(sessionId % m_clients.count());
+    session.opsLeft = qMax(1, m_config.opsPerSession);
+    session.plannedNs = plannedNs;
+    ++m_sessionsStarted;
+
+    scheduleOperation(sessionId);
+}
+
+void LoadGenerator::scheduleOperation(int sessionId)
+{
+    const qint64 delayNs = m_sessions.value(sessionId).plannedNs - m_clock.nsecsElapsed();
+    if (delayNs <= 0) {
+        sendOperation(sessionId);
+        return;
+    }
+
+    QTimer::singleShot(int((delayNs + 999999) / 1000000), Qt::PreciseTimer, this, [this, sessionId]() {
+        sendOperation(sessionId);
+    });
+}
+
+/**
+ * Send the session's next operation
+ * Update/delete fall back to create while the run has no customers of
+ * its own, get falls back to health when there are no customers at all
+ */
+void LoadGenerator::sendOperation(int sessionId)
+{
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        return;  // Abandoned at the drain deadline
+    }
+
+    Operation operation = pickOperation();
+    if ((operation == UpdateOperation || operation == DeleteOperation) && m_createdIds.isEmpty()) {
+        operation = CreateOperation;
+    }
+    if (operation == GetOperation && m_seedIds.isEmpty() && m_createdIds.isEmpty()) {
+        operation = HealthOperation;
+    }
+
+    ApiClient *client = it->client;
+    switch (operation) {
+    case HealthOperation:
+        client->checkHealth();
+        break;
+    case ListOperation:
+        client->getAllCustomers();
+        break;
+    case GetOperation: {
+        const int index = int(m_random() % quint32(m_seedIds.count() + m_createdIds.count()));
+        client->getCustomerById(index < m_seedIds.count() ? m_seedIds.at(index)
+                                                          : m_createdIds.at(index - m_seedIds.count()));
+        break;
+    }
+    case CreateOperation:
+    case UpdateOperation: {
+        const int sequence = ++m_createSequence;
+        Customer customer;
+        customer.setFirstName("Kuormitus");
+        customer.setLastName(QString("Testi %1").arg(sequence));
+        customer.setAddress(QString("Kuormakatu %1, 00100 Helsinki").arg(1 + sequence % 200));
+        if (operation == CreateOperation) {
+            client->createCustomer(customer);
+        } else {
+            client->updateCustomer(m_createdIds.at(int(m_random() % quint32(m_createdIds.count()))), customer);
+        }
+        break;
+    }
+    case DeleteOperation: {
+        // Taken out of the pool now so no other session picks it meanwhile
+        const int index = int(m_random() % quint32(m_createdIds.count()));
+        const int id = m_createdIds.at(index);
+        m_createdIds.swapItemsAt(index, m_createdIds.count() - 1);
+        m_createdIds.removeLast();
+        client->deleteCustomer(id);
+        break;
+    }
+    case OperationCount:
+        return;
+    }
+
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_firstSentNs < 0) {
+        m_firstSentNs = now;
+    }
+    m_scheduleLag.record((now - it->plannedNs) / 1000);
+    m_pending.insert(qMakePair(client, client->lastRequestId()),
+                     PendingOperation{ sessionId, operation, it->plannedNs, now });
+}
+
+LoadGenerator::Operation LoadGenerator::pickOperation()
+{
+    return Operation(m_mixDistribution(m_random));
+}
+
+void LoadGenerator::onRequestFinished(ApiClient *client, quint64 requestId, int httpStatus,
+                                      QNetworkReply::NetworkError error)
+{
+    const QPair<ApiClient*, quint64> key(client, requestId);
+    const bool failed = error != QNetworkReply::NoError || httpStatus >= 400;
+
+    if (client == m_clients.first() && requestId == m_seedRequestId) {
+        m_seedRequestId = 0;
+        if (failed) {
+            out() << "Could not read customers (HTTP " << httpStatus << "), get operations use created customers only"
+                  << Qt::endl;
+        }
+        beginArrivals();
+        return;
+    }
+
+    if (m_cleanupRequests.remove(key)) {
+        if (failed) {
+            ++m_cleanupErrors;
+        }
+        if (m_cleanupRequests.isEmpty()) {
+            emit finished();
+        }
+        return;
+    }
+
+    auto pending = m_pending.find(key);
+    if (pending == m_pending.end()) {
+        return;
+    }
+    const PendingOperation operation = pending.value();
+    m_pending.erase(pending);
+
+    const qint64 now = m_clock.nsecsElapsed();
+    OperationStats &stats = m_stats[operation.operation];
+    ++stats.count;
+    if (failed) {
+        ++stats.errors;
+    }
+    stats.service.record((now - operation.sentNs) / 1000);
+    stats.corrected.record((now - operation.plannedNs) / 1000);
+    m_allService.record((now - operation.sentNs) / 1000);
+    m_allCorrected.record((now - operation.plannedNs) / 1000);
+    ++m_completed;
+    m_lastCompletedNs = now;
+
+    // The next operation is planned from this one's plan, not from its completion
+    auto session = m_sessions.find(operation.sessionId);
+    if (session != m_sessions.end()) {
+        if (--session->opsLeft > 0) {
+            session->plannedNs += qint64(exponential(m_config.thinkTimeMs * 1e6));
+            scheduleOperation(operation.sessionId);
+        } else {
+            m_sessions.erase(session);
+        }
+    }
+
+    checkFinished();
+}
+
+void LoadGenerator::onCustomerCreated(int id)
+{
+    if (id > 0 && !m_cleaningUp) {
+        m_createdIds.append(id);
+    }
+}
+
+void LoadGenerator::printProgress()
+{
+    const double seconds = m_clock.nsecsElapsed() / 1e9;
+    const double interval = m_reportTimer->interval() / 1000.0;
+    const double rate = (m_completed - m_lastReportCompleted) / interval;
+    m_lastReportCompleted = m_completed;
+
+    quint64 errors = 0;
+    for (const OperationStats &stats : m_stats) {
+        errors += stats.errors;
+    }
+
+    out() << QString("[%1 s] sessions %2 (%3 active), %4 in flight | %5 ops (%6/s), %7 errors | "
+                     "p99 %8 ms, corrected p99 %9 ms")
+                 .arg(seconds, 5, 'f', 0)
+                 .arg(m_sessionsStarted)
+                 .arg(m_sessions.count())
+                 .arg(m_pending.count())
+                 .arg(m_completed)
+                 .arg(rate, 0, 'f', 0)
+                 .arg(errors)
+                 .arg(formatMillis(m_allService.percentile(0.99)), formatMillis(m_allCorrected.percentile(0.99)))
+          << Qt::endl;
+}
+
+/**
+ * Done once arrivals have ended and every session has finished, or at
+ * the drain deadline; sessions still running then are abandoned
+ */
+void LoadGenerator::checkFinished()
+{
+    if (!m_draining || m_cleaningUp) {
+        return;
+    }
+    if (!m_sessions.isEmpty() && m_clock.nsecsElapsed() < m_drainDeadlineNs) {
+        return;
+    }
+
+    m_sessionsAbandoned = m_sessions.count();
+    m_sessions.clear();
+    m_pending.clear();
+    m_arrivalTimer->stop();
+    m_reportTimer->stop();
+    cleanUp();
+}
+
+/**
+ * Delete the customers the run created and did not delete itself
+ */
+void LoadGenerator::cleanUp()
+{
+    m_cleaningUp = true;
+
+    if (m_config.keepData || m_createdIds.isEmpty()) {
+        QTimer::singleShot(0, this, &LoadGenerator::finished);
+        return;
+    }
+
+    out() << "Deleting " << m_createdIds.count() << " customer(s) created by the run" << Qt::endl;
+    for (int i = 0; i < m_createdIds.count(); ++i) {
+        ApiClient *client = m_clients.at(i % m_clients.count());
+        client->deleteCustomer(m_createdIds.at(i));
+        m_cleanupRequests.insert(qMakePair(client, client->lastRequestId()));
+    }
+    m_createdIds.clear();
+}
+
+QString LoadGenerator::summary() const
+{
+    const double seconds = m_firstSentNs >= 0 ? qMax<qint64>(1, m_lastCompletedNs - m_firstSentNs) / 1e9 : 0.0;
+    QString text;
+    QTextStream stream(&text);
+
+    stream << Qt::endl
+           << QString("%1 sessions, %2 operations in %3 s: %4 ops/s")
+                  .arg(m_sessionsStarted).arg(m_completed).arg(seconds, 0, 'f', 1)
+                  .arg(seconds > 0 ? m_completed / seconds : 0.0, 0, 'f', 1)
+           << Qt::endl;
+    if (m_sessionsAbandoned > 0) {
+        stream << m_sessionsAbandoned << " session(s) still running at the drain deadline were abandoned" << Qt::endl;
+    }
+    stream << "Generator lag (planned -> sent) p99 " << formatMillis(m_scheduleLag.percentile(0.99))
+           << " ms, max " << formatMillis(m_scheduleLag.max()) << " ms" << Qt::endl << Qt::endl;
+
+    stream << QString("%1 %2 %3 | %4 %5 %6 %7 | %8 %9 %10 %11")
+                  .arg("operation", -10).arg("count", 8).arg("errors", 7)
+                  .arg("p50 ms", 9).arg("p99 ms", 9).arg("p99.9 ms", 9).arg("max ms", 9)
+                  .arg("cp50 ms", 9).arg("cp99 ms", 9).arg("cp99.9 ms", 9).arg("cmax ms", 9)
+           << Qt::endl;
+
+    auto row = [&stream](const QString &name, quint64 count, quint64 errors,
+                         const ApiMetrics::Histogram &service, const ApiMetrics::Histogram &corrected) {
+        stream << QString("%1 %2 %3 | %4 %5 %6 %7 | %8 %9 %10 %11")
+                      .arg(name, -10).arg(count, 8).arg(errors, 7)
+                      .arg(formatMillis(service.percentile(0.5)), 9)
+                      .arg(formatMillis(service.percentile(0.99)), 9)
+                      .arg(formatMillis(service.percentile(0.999)), 9)
+                      .arg(formatMillis(service.max()), 9)
+                      .arg(formatMillis(corrected.percentile(0.5)), 9)
+                      .arg(formatMillis(corrected.percentile(0.99)), 9)
+                      .arg(formatMillis(corrected.percentile(0.999)), 9)
+                      .arg(formatMillis(corrected.max()), 9)
+               << Qt::endl;
+    };
+
+    quint64 errors = 0;
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        const OperationStats &stats = m_stats[operation];
+        errors += stats.errors;
+        if (stats.count > 0) {
+            row(operationName(Operation(operation)), stats.count, stats.errors, stats.service, stats.corrected);
+        }
+    }
+    row("all", m_completed, errors, m_allService, m_allCorrected);
+
+    stream << Qt::endl << "p = service latency (sent -> response), "
+           << "cp = corrected latency (planned -> response)" << Qt::endl;
+    if (m_cleanupErrors > 0) {
+        stream << m_cleanupErrors << " created customer(s) could not be deleted" << Qt::endl;
+    }
+    return text;
+}
+
+/**
+ * Machine-readable results, latencies in milliseconds
+ */
+QJsonObject LoadGenerator::toJson() const
+{
+    const double seconds = m_firstSentNs >= 0 ? qMax<qint64>(1, m_lastCompletedNs - m_firstSentNs) / 1e9 : 0.0;
+
+    QJsonObject mix;
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        mix[operationName(Operation(operation))] = m_config.mix[operation];
+    }
+
+    QJsonObject operations;
+    quint64 errors = 0;
+    for (int operation = 0; operation < OperationCount; ++operation) {
+        const OperationStats &stats = m_stats[operation];
+        errors += stats.errors;
+        operations[operationName(Operation(operation))] = QJsonObject{
+            { "count", qint64(stats.count) },
+            { "errors", qint64(stats.errors) },
+            { "throughput", seconds > 0 ? stats.count / seconds : 0.0 },
+            { "serviceLatencyMs", latencyJson(stats.service) },
+            { "correctedLatencyMs", latencyJson(stats.corrected) }
+        };
+    }
+
+    return QJsonObject{
+        { "config", QJsonObject{
+              { "baseUrl", m_config.baseUrl },
+              { "sessionRate", m_config.sessionRate },
+              { "durationSec", m_config.durationSec },
+              { "opsPerSession", m_config.opsPerSession },
+              { "thinkTimeMs", m_config.thinkTimeMs },
+              { "clients", m_clients.count() },
+              { "seed", qint64(m_config.seed) },
+              { "mix", mix } } },
+        { "sessions", m_sessionsStarted },
+        { "sessionsAbandoned", m_sessionsAbandoned },
+        { "operations", qint64(m_completed) },
+        { "errors", qint64(errors) },
+        { "elapsedSec", seconds },
+        { "throughput", seconds > 0 ? m_completed / seconds : 0.0 },
+        { "serviceLatencyMs", latencyJson(m_allService) },
+        { "correctedLatencyMs", latencyJson(m_allCorrected) },
+        { "scheduleLagMs", latencyJson(m_scheduleLag) },
+        { "byOperation", operations }
+    };
+}
+
+QString LoadGenerator::operationName(Operation operation)
+{
+    return operation < OperationCount ? QString(OperationNames[operation]) : QString();
+}
+
+/**
+ * Parse an operation mix
+ *
+ * @param text  - e.g. "health=5,get=60,create=15,update=15,delete=5"
+ * @param mix   - Receives the weights
+ * @param error - Receives the reason when parsing fails
+ * @return bool - true if at least one weight is positive
+ */
+bool LoadGenerator::parseMix(const QString &text, double mix[OperationCount], QString *error)
+{
+    double weights[OperationCount] = {};
+
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const QString name = part.section('=', 0, 0).trimmed().toLower();
+        bool ok = false;
+        const double weight = part.section('=', 1).trimmed().toDouble(&ok);
+
+        int operation = 0;
+        while (operation < OperationCount && name != OperationNames[operation]) {
+            ++operation;
+        }
+        if (operation == OperationCount) {
+            *error = QString("Unknown operation \"%1\"").arg(name);
+            return false;
+        }
+        if (!ok || weight < 0) {
+            *error = QString("Invalid weight for %1").arg(name);
+            return false;
+        }
+        weights[operation] = weight;
+    }
+
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+    if (total <= 0) {
+        *error = "The mix needs at least one operation with a positive weight";
+        return false;
+    }
+
+    std::copy(std::begin(weights), std::end(weights), mix);
+    return true;
+}
+
+double LoadGenerator::exponential(double mean)
+{
+    std::exponential_distribution<double> distribution(1.0 / qMax(1e-9, mean));
+    return distribution(m_random);
+}
@@ -0,0 +1,157 @@
+/**
+ * LoadGenerator - Simulated ATM fleet driving the backend through ApiClient
+ *
+ * Sessions arrive open-loop (Poisson, sessionRate per second) regardless
+ * of how fast the backend answers. Each session plans opsPerSession
+ * operations spaced by exponential think times and keeps at most one
+ * request in flight, like a real ATM; an operation whose planned time has
+ * passed is sent as soon as the previous one completes.
+ *
+ * Every operation is recorded twice:
+ * - service latency: request sent -> response
+ * - corrected latency: planned time -> response, which keeps the time an
+ *   operation spent waiting behind a slow predecessor (or behind the
+ *   generator itself) instead of omitting it (coordinated omission)
+ *
+ * Sessions share a pool of ApiClient instances (clients), each with its
+ * own QNetworkAccessManager and connection pool. Update and delete only
+ * touch customers created by the run; leftovers are deleted at the end
+ * unless keepData is set.
+ */
+
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QNetworkReply>
+#include <QPair>
+#include <QSet>
+#include <QTimer>
+#include <random>
+#include "apimetrics.h"
+
+class ApiClient;
+
+class LoadGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Operation {
+        HealthOperation,   // checkHealth()
+        ListOperation,     // getAllCustomers()
+        GetOperation,      // getCustomerById()
+        CreateOperation,   // createCustomer()
+        UpdateOperation,   // updateCustomer() on a customer created by the run
+        DeleteOperation,   // deleteCustomer() on a customer created by the run
+        OperationCount
+    };
+
+    struct Config {
+        QString baseUrl = QStringLiteral("http://localhost:3000");
+        double sessionRate = 20.0;  // New sessions per second
+        int durationSec = 60;       // Arrival window; running sessions then drain
+        int drainTimeoutSec = 30;
+        int opsPerSession = 5;
+        int thinkTimeMs = 1000;     // Mean planned gap between a session's operations
+        int clients = 16;
+        int reportIntervalSec = 5;
+        bool keepData = false;      // Skip deleting leftover created customers
+        quint32 seed = 1;
+        double mix[OperationCount] = { 5, 1, 60, 14, 14, 6 };  // Relative weights
+    };
+
+    explicit LoadGenerator(const Config &config, QObject *parent = nullptr);
+    ~LoadGenerator();
+
+    void start();
+
+    // Results (valid after finished)
+    QString summary() const;
+    QJsonObject toJson() const;
+
+    static QString operationName(Operation operation);
+    // "get=60,create=20,delete=20"; unlisted operations get weight 0
+    static bool parseMix(const QString &text, double mix[OperationCount], QString *error);
+
+signals:
+    void finished();
+
+private:
+    struct Session {
+        ApiClient *client = nullptr;
+        int opsLeft = 0;
+        qint64 plannedNs = 0;  // Planned time of the next operation
+    };
+
+    struct PendingOperation {
+        int sessionId;
+        Operation operation;
+        qint64 plannedNs;
+        qint64 sentNs;
+    };
+
+    struct OperationStats {
+        ApiMetrics::Histogram service;
+        ApiMetrics::Histogram corrected;
+        quint64 count = 0;
+        quint64 errors = 0;
+    };
+
+    Config m_config;
+    QList<ApiClient*> m_clients;
+    std::mt19937 m_random;
+    std::discrete_distribution<int> m_mixDistribution;
+    QElapsedTimer m_clock;
+    QTimer *m_arrivalTimer;
+    QTimer *m_reportTimer;
+
+    // Scheduling
+    qint64 m_nextArrivalNs;
+    qint64 m_arrivalEndNs;
+    qint64 m_drainDeadlineNs;
+    int m_nextSessionId;
+    int m_sessionsStarted;
+    int m_sessionsAbandoned;
+    quint64 m_seedRequestId;
+    QHash<int, Session> m_sessions;
+    QHash<QPair<ApiClient*, quint64>, PendingOperation> m_pending;
+    bool m_draining;
+    bool m_cleaningUp;
+    QSet<QPair<ApiClient*, quint64>> m_cleanupRequests;
+    int m_cleanupErrors;
+
+    // Customer ids
+    QList<int> m_seedIds;     // Existing customers, read only
+    QList<int> m_createdIds;  // Created by the run, may be updated or deleted
+    int m_createSequence;
+
+    // Results
+    OperationStats m_stats[OperationCount];
+    ApiMetrics::Histogram m_allService;
+    ApiMetrics::Histogram m_allCorrected;
+    ApiMetrics::Histogram m_scheduleLag;  // Planned time -> actually sent
+    quint64 m_completed;
+    quint64 m_lastReportCompleted;
+    qint64 m_firstSentNs;
+    qint64 m_lastCompletedNs;
+
+    void beginArrivals();
+    void onArrivalTimer();
+    void startSession(qint64 plannedNs);
+    void scheduleOperation(int sessionId);
+    void sendOperation(int sessionId);
+    Operation pickOperation();
+    void onRequestFinished(ApiClient *client, quint64 requestId, int httpStatus, QNetworkReply::NetworkError error);
+    void onCustomerCreated(int id);
+    void printProgress();
+    void checkFinished();
+    void cleanUp();
+    double exponential(double mean);
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,195 @@
+/**
+ * Bank ATM System - Load Generator
+ *
+ * Headless console tool that simulates a fleet of ATM sessions against
+ * the REST API through ApiClient (no QtWidgets). Meant for capacity tests
+ * against a local backend:
+ *
+ *   frontend-loadgen --rate 200 --duration 120 --json results.json
+ *   frontend-loadgen --mock --mock-latency 30    (no backend needed)
+ *
+ * Only loopback URLs are accepted unless --allow-remote is given, and the
+ * production App Service is refused outright.
+ */
+
+#include "loadgenerator.h"
+#include "mockbackend.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QLoggingCategory>
+#include <QThread>
+#include <QUrl>
+#include <cstdio>
+
+namespace {
+
+/**
+ * Check that a load test may run against the URL
+ *
+ * @param url         - Backend base URL
+ * @param allowRemote - Accept hosts other than loopback
+ * @param error       - Receives the reason when refused
+ * @return bool - true if the URL may be used
+ */
+bool checkTarget(const QUrl &url, bool allowRemote, QString *error)
+{
+    if (!url.isValid() || (url.scheme() != "http" && url.scheme() != "https") || url.host().isEmpty()) {
+        *error = "Invalid URL: " + url.toString();
+        return false;
+    }
+
+    const QString host = url.host().toLower();
+    if (host.endsWith(".azurewebsites.net")) {
+        *error = "Refusing to load test the production backend (" + host + ")";
+        return false;
+    }
+
+    const bool loopback = host == "localhost" || QHostAddress(host).isLoopback();
+    if (!loopback && !allowRemote) {
+        *error = host + " is not a local address; pass --allow-remote to load test a staging backend";
+        return false;
+    }
+    return true;
+}
+
+int positiveInt(const QCommandLineParser &parser, const QString &name, bool *ok)
+{
+    bool valid = false;
+    const int value = parser.value(name).toInt(&valid);
+    if (!valid || value <= 0) {
+        std::fprintf(stderr, "--%s must be a positive integer\n", qPrintable(name));
+        *ok = false;
+    }
+    return value;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("frontend-loadgen");
+
+    LoadGenerator::Config config;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated ATM fleet load test for the Bank ATM REST API");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "url", "Backend base URL.", "url", config.baseUrl },
+        { "rate", "New ATM sessions per second (Poisson arrivals).", "sessions", QString::number(config.sessionRate) },
+        { "duration", "Seconds during which sessions arrive.", "seconds", QString::number(config.durationSec) },
+        { "drain-timeout", "Seconds to wait for running sessions afterwards.", "seconds",
+          QString::number(config.drainTimeoutSec) },
+        { "ops", "Operations per session.", "count", QString::number(config.opsPerSession) },
+        { "think", "Mean planned time between a session's operations.", "ms", QString::number(config.thinkTimeMs) },
+        { "mix", "Operation weights (health, list, get, create, update, delete).", "mix",
+          "health=5,list=1,get=60,create=14,update=14,delete=6" },
+        { "clients", "ApiClient instances shared by the sessions.", "count", QString::number(config.clients) },
+        { "report-interval", "Seconds between progress lines.", "seconds", QString::number(config.reportIntervalSec) },
+        { "seed", "Random seed.", "seed", QString::number(config.seed) },
+        { "json", "Write results as JSON to this file.", "file" },
+        { "keep-data", "Do not delete the customers the run created." },
+        { "allow-remote", "Allow a non-loopback backend (never production)." },
+        { "mock", "Run against an in-process mock backend instead of --url." },
+        { "mock-customers", "Customers in the mock backend.", "count", "1000" },
+        { "mock-latency", "Mock backend delay before every response.", "ms", "0" },
+        { "verbose", "Show ApiClient debug output." }
+    });
+    parser.process(app);
+
+    bool ok = true;
+    config.baseUrl = parser.value("url");
+    config.sessionRate = parser.value("rate").toDouble(&ok);
+    if (!ok || config.sessionRate <= 0) {
+        std::fprintf(stderr, "--rate must be a positive number\n");
+        ok = false;
+    }
+    config.durationSec = positiveInt(parser, "duration", &ok);
+    config.drainTimeoutSec = positiveInt(parser, "drain-timeout", &ok);
+    config.opsPerSession = positiveInt(parser, "ops", &ok);
+    config.thinkTimeMs = parser.value("think").toInt();
+    config.clients = positiveInt(parser, "clients", &ok);
+    config.reportIntervalSec = positiveInt(parser, "report-interval", &ok);
+    config.seed = parser.value("seed").toUInt();
+    config.keepData = parser.isSet("keep-data");
+
+    QString error;
+    if (!LoadGenerator::parseMix(parser.value("mix"), config.mix, &error)) {
+        std::fprintf(stderr, "--mix: %s\n", qPrintable(error));
+        ok = false;
+    }
+    if (!parser.isSet("mock") && !checkTarget(QUrl(config.baseUrl), parser.isSet("allow-remote"), &error)) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        ok = false;
+    }
+    if (!ok) {
+        return 2;
+    }
+
+    // ApiClient logs every request and response
+    if (!parser.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("default.debug=false");
+    }
+
+    // The mock gets its own thread so serving requests does not delay the
+    // generator's schedule
+    QThread mockThread;
+    if (parser.isSet("mock")) {
+        MockBackend::Options mockOptions;
+        mockOptions.latencyMs = parser.value("mock-latency").toInt();
+
+        MockBackend *mock = new MockBackend();
+        mock->setOptions(mockOptions);
+        mock->moveToThread(&mockThread);
+        QObject::connect(&mockThread, &QThread::finished, mock, &QObject::deleteLater);
+        mockThread.start();
+
+        const int customers = qMax(0, parser.value("mock-customers").toInt());
+        bool listening = false;
+        QMetaObject::invokeMethod(mock, [&]() {
+            mock->seedCustomers(customers);
+            listening = mock->listen();
+            config.baseUrl = mock->baseUrl();
+            error = mock->errorString();
+        }, Qt::BlockingQueuedConnection);
+
+        if (!listening) {
+            std::fprintf(stderr, "Mock backend could not listen: %s\n", qPrintable(error));
+            mockThread.quit();
+            mockThread.wait();
+            return 1;
+        }
+    }
+
+    LoadGenerator generator(config);
+    const QString jsonPath = parser.value("json");
+
+    QObject::connect(&generator, &LoadGenerator::finished, &app, [&]() {
+        std::fputs(qPrintable(generator.summary()), stdout);
+
+        int exitCode = 0;
+        if (!jsonPath.isEmpty()) {
+            QFile file(jsonPath);
+            if (file.open(QIODevice::WriteOnly)) {
+                file.write(QJsonDocument(generator.toJson()).toJson());
+                std::printf("Results written to %s\n", qPrintable(jsonPath));
+            } else {
+                std::fprintf(stderr, "Could not write %s: %s\n", qPrintable(jsonPath), qPrintable(file.errorString()));
+                exitCode = 1;
+            }
+        }
+        app.exit(exitCode);
+    });
+
+    generator.start();
+    const int exitCode = app.exec();
+
+    mockThread.quit();
+    mockThread.wait();
+    return exitCode;
+}
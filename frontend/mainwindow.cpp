@@ -14,12 +14,20 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "apiclient.h"
+#include "customerlistmodel.h"
+#include "apimetricspanel.h"
 #include <QPushButton>
 #include <QTextEdit>
+#include <QTableView>
+#include <QHeaderView>
 #include <QLabel>
+#include <QLineEdit>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QDockWidget>
+#include <QMenuBar>
 
 /**
  * Constructor
@@ -31,10 +39,34 @@ MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
     , apiClient(new ApiClient(this))  // API client for Azure backend
+    , customerModel(new CustomerListModel(apiClient, this))
+    , revalidatingSnapshot(false)
+    , importFailuresShown(0)
 {
     ui->setupUi(this);
     setupUI();          // Build the test interface
     setupConnections(); // Connect signals/slots
+    
+    // Keep network I/O (and its timing) independent of painting and
+    // modal dialogs
+    apiClient->setNetworkThreadEnabled(true);
+    
+    // Customer edits survive a backend outage (or an app restart) and
+    // are sent in the background
+    apiClient->setWriteBehindEnabled(true);
+    
+    // Changes made by other clients show up without reloading
+    apiClient->setPushEnabled(true);
+    
+    // The test UI counts as one long ATM session: keep the backend and
+    // the TLS connection warm while the window is open
+    apiClient->setSessionActive(true);
+    
+    // Show the last known customer list immediately, then revalidate it
+    // in the background (304 Not Modified if nothing has changed);
+    // onSnapshotLoaded() does both
+    apiClient->setSnapshotEnabled(true);
+    apiClient->loadSnapshot();
 }
 
 /**
@@ -52,9 +84,11 @@ MainWindow::~MainWindow()
  * 
  * Layout:
  * - Title + API URL display
- * - Two test buttons (Health Check, Get Customers)
+ * - Test buttons (Health Check, Get Customers, Import Customers)
  * - Output text area for results
+ * - Customer table (rows loaded page by page while scrolling)
  * - Status label at bottom
+ * - Debug > API Metrics (F12): dockable request metrics panel
  * 
  * Note: Uses programmatic UI instead of .ui file for flexibility
  *       Will be replaced with proper ATM interface later
@@ -100,11 +134,18 @@ void MainWindow::setupUI()
     testButton->setStyleSheet("background-color: #2196F3; color: white; font-weight: bold;");
     buttonLayout->addWidget(testButton);
     
+    // Customer import button - Bulk create from a CSV/NDJSON file
+    QPushButton *importButton = new QPushButton("3. Import Customers...", this);
+    importButton->setMinimumHeight(40);
+    importButton->setObjectName("btnImportCustomers");
+    importButton->setStyleSheet("background-color: #9C27B0; color: white; font-weight: bold;");
+    buttonLayout->addWidget(importButton);
+    
     layout->addLayout(buttonLayout);
     
     // === INFO LABEL ===
     // Warn about Azure App Service cold start delay
-    QLabel *infoLabel = new QLabel("Note: First request may take 30-60 seconds (Azure waking up)", this);
+    QLabel *infoLabel = new QLabel("Note: The Azure server is woken up in the background at startup (may take 30-60 seconds)", this);
     infoLabel->setAlignment(Qt::AlignCenter);
     infoLabel->setStyleSheet("color: #FF9800; font-style: italic;");
     layout->addWidget(infoLabel);
@@ -115,8 +156,30 @@ void MainWindow::setupUI()
     outputText->setReadOnly(true);
     outputText->setPlaceholderText("API response will appear here...\n\nTip: Try Health Check first to wake up the Azure server!");
     outputText->setObjectName("textOutput");
+    outputText->setMaximumHeight(160);
     layout->addWidget(outputText);
     
+    // === CUSTOMER SEARCH ===
+    // Filters the loaded customers as you type (name or address)
+    QLineEdit *searchEdit = new QLineEdit(this);
+    searchEdit->setObjectName("editSearch");
+    searchEdit->setPlaceholderText("Search customers by name or address...");
+    searchEdit->setClearButtonEnabled(true);
+    layout->addWidget(searchEdit);
+    
+    // === CUSTOMER TABLE ===
+    // Only visible rows are rendered; more pages load while scrolling
+    QTableView *customerTable = new QTableView(this);
+    customerTable->setObjectName("tableCustomers");
+    customerTable->setModel(customerModel);
+    customerTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    customerTable->setAlternatingRowColors(true);
+    customerTable->setSortingEnabled(true);
+    customerTable->verticalHeader()->setVisible(false);
+    customerTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);  // No per-row size hints
+    customerTable->horizontalHeader()->setSectionResizeMode(CustomerListModel::AddressColumn, QHeaderView::Stretch);
+    layout->addWidget(customerTable, 1);
+    
     // === STATUS LABEL ===
     // Real-time status updates at bottom
     QLabel *statusLabel = new QLabel("Status: Ready - Click Health Check to test connection", this);
@@ -125,6 +188,18 @@ void MainWindow::setupUI()
     layout->addWidget(statusLabel);
     
     setCentralWidget(centralWidget);
+    
+    // === DEBUG PANEL ===
+    // Request latency percentiles per endpoint, hidden until needed
+    QDockWidget *metricsDock = new QDockWidget("API Metrics", this);
+    metricsDock->setObjectName("dockApiMetrics");
+    metricsDock->setWidget(new ApiMetricsPanel(apiClient, metricsDock));
+    addDockWidget(Qt::BottomDockWidgetArea, metricsDock);
+    metricsDock->hide();
+    
+    QAction *metricsAction = metricsDock->toggleViewAction();
+    metricsAction->setShortcut(Qt::Key_F12);
+    ui->menubar->addMenu("Debug")->addAction(metricsAction);
 }
 
 /**
@@ -149,10 +224,28 @@ void MainWindow::setupConnections()
         connect(testButton, &QPushButton::clicked, this, &MainWindow::onTestConnectionClicked);
     }
     
+    QPushButton *importButton = findChild<QPushButton*>("btnImportCustomers");
+    if (importButton) {
+        connect(importButton, &QPushButton::clicked, this, &MainWindow::onImportClicked);
+    }
+    
+    QLineEdit *searchEdit = findChild<QLineEdit*>("editSearch");
+    if (searchEdit) {
+        connect(searchEdit, &QLineEdit::textChanged, customerModel, &CustomerListModel::setFilter);
+    }
+    
     // === API CLIENT CONNECTIONS ===
     // Connect async API response signals to UI update slots
-    connect(apiClient, &ApiClient::customersReceived, this, &MainWindow::onCustomersReceived);
+    connect(apiClient, &ApiClient::customerViewsReceived, this, &MainWindow::onCustomersReceived);
+    connect(apiClient, &ApiClient::snapshotLoaded, this, &MainWindow::onSnapshotLoaded);
+    connect(apiClient, &ApiClient::customersNotModified, this, &MainWindow::onCustomersNotModified);
+    connect(customerModel, &CustomerListModel::pageLoaded, this, &MainWindow::onCustomerPageLoaded);
     connect(apiClient, &ApiClient::healthCheckSuccess, this, &MainWindow::onHealthCheckSuccess);
+    connect(apiClient, &ApiClient::prewarmFinished, this, &MainWindow::onPrewarmFinished);
+    connect(apiClient, &ApiClient::rateLimited, this, &MainWindow::onRateLimited);
+    connect(apiClient, &ApiClient::importProgress, this, &MainWindow::onImportProgress);
+    connect(apiClient, &ApiClient::importItemFailed, this, &MainWindow::onImportItemFailed);
+    connect(apiClient, &ApiClient::importFinished, this, &MainWindow::onImportFinished);
     connect(apiClient, &ApiClient::errorOccurred, this, &MainWindow::onApiError);
 }
 
@@ -194,7 +287,7 @@ void MainWindow::onHealthCheckClicked()
 
 /**
  * Get customers button click handler
- * Sends GET request to /api/customers to fetch all customers from Azure MySQL
+ * Reloads the customer table from /api/customers, one page at a time
  * 
  * Purpose:
  * - Test database connectivity
@@ -214,15 +307,118 @@ void MainWindow::onTestConnectionClicked()
     if (outputText) {
         outputText->clear();
         outputText->append("=== FETCHING CUSTOMERS ===");
-        outputText->append("API Endpoint: " + apiClient->getBaseUrl() + "/api/customers");
+        outputText->append(QString("API Endpoint: %1/api/customers?limit=%2")
+                               .arg(apiClient->getBaseUrl()).arg(customerModel->pageSize()));
         outputText->append("");
         outputText->append("Connecting to Azure MySQL database...");
         outputText->append("Please wait...");
         outputText->append("");
     }
     
-    // Make async API call (response handled by onCustomersReceived)
-    apiClient->getAllCustomers();
+    // Load the first page (response handled by onCustomerPageLoaded);
+    // further pages are requested by the table while scrolling
+    customerModel->refresh();
+}
+
+/**
+ * Import button click handler
+ * Creates customers from a CSV or NDJSON file in batches; clicking
+ * again while an import is running cancels it
+ */
+void MainWindow::onImportClicked()
+{
+    if (apiClient->isImporting()) {
+        apiClient->cancelImport();
+        return;
+    }
+    
+    QString filePath = QFileDialog::getOpenFileName(this, "Import Customers", QString(),
+                                                    "Customer files (*.csv *.ndjson *.jsonl);;All files (*)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    
+    QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
+    if (outputText) {
+        outputText->clear();
+        outputText->append("=== IMPORTING CUSTOMERS ===");
+        outputText->append("File: " + filePath);
+        outputText->append(QString("Batches of %1, %2 request(s) in flight")
+                               .arg(apiClient->importBatchSize()).arg(apiClient->importWindow()));
+        outputText->append("");
+    }
+    
+    importFailuresShown = 0;
+    if (apiClient->importCustomers(filePath)) {
+        QPushButton *importButton = findChild<QPushButton*>("btnImportCustomers");
+        if (importButton) {
+            importButton->setText("Cancel Import");
+        }
+    }
+}
+
+/**
+ * Import progress handler
+ * 
+ * @param succeeded - Customers created so far
+ * @param failed    - Rows rejected so far
+ * @param total     - Rows in the file (-1 while still reading)
+ */
+void MainWindow::onImportProgress(int succeeded, int failed, int total)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    
+    if (statusLabel) {
+        statusLabel->setText(QString("Status: Importing... %1 created, %2 failed%3")
+                                 .arg(succeeded).arg(failed)
+                                 .arg(total >= 0 ? QString(" of %1").arg(total) : QString()));
+    }
+}
+
+/**
+ * Import row failure handler - lists the first failures only
+ * 
+ * @param item    - Line of the rejected row in the import file
+ * @param message - Reason
+ */
+void MainWindow::onImportItemFailed(int item, const QString &message)
+{
+    QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
+    
+    if (outputText && importFailuresShown < 20) {
+        outputText->append(QString("Line %1: %2").arg(item).arg(message));
+        ++importFailuresShown;
+    }
+}
+
+/**
+ * Import finished handler
+ * Reloads the table, since batch inserts do not return the new rows
+ */
+void MainWindow::onImportFinished(int succeeded, int failed)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
+    QPushButton *importButton = findChild<QPushButton*>("btnImportCustomers");
+    
+    if (importButton) {
+        importButton->setText("3. Import Customers...");
+    }
+    
+    if (statusLabel) {
+        statusLabel->setText(QString("Status: ? Import finished - %1 created, %2 failed").arg(succeeded).arg(failed));
+    }
+    
+    if (outputText) {
+        if (importFailuresShown < failed) {
+            outputText->append(QString("... and %1 more failed row(s)").arg(failed - importFailuresShown));
+        }
+        outputText->append("");
+        outputText->append(QString("=== IMPORT FINISHED: %1 created, %2 failed ===").arg(succeeded).arg(failed));
+    }
+    
+    // Fetch only what changed instead of reloading the table
+    apiClient->syncCustomers();
 }
 
 /**
@@ -262,16 +458,15 @@ void MainWindow::onHealthCheckSuccess(const QString &status)
  * Customers received response handler
  * Called when /api/customers responds with customer list
  * 
- * @param customers - List of Customer objects from Azure MySQL
+ * @param customers - Customers from Azure MySQL (decoded as they are shown)
  * 
  * Displays:
  * - Customer count
- * - Each customer's ID, name (UTF-8), address, timestamp
- * - Empty state message if no customers
+ * - Customers in the table view (replaces any paged rows)
  * 
  * Note: Properly handles UTF-8 for Finnish names (e.g., "Meik�l�inen")
  */
-void MainWindow::onCustomersReceived(const QList<Customer> &customers)
+void MainWindow::onCustomersReceived(const QList<CustomerView> &customers)
 {
     QLabel *statusLabel = findChild<QLabel*>("labelStatus");
     QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
@@ -281,34 +476,20 @@ void MainWindow::onCustomersReceived(const QList<Customer> &customers)
     }
     
     if (outputText) {
-        // Ensure proper UTF-8 display (no rich text formatting issues)
-        outputText->setAcceptRichText(false);
-        
+        if (revalidatingSnapshot) {
+            outputText->clear();  // Replace the cached list
+        }
         outputText->append("=== SUCCESS ===");
         outputText->append(QString("Found %1 customer(s) in Azure MySQL database:").arg(customers.count()));
         outputText->append("");
-        
-        // Handle empty database
-        if (customers.isEmpty()) {
-            outputText->append("No customers found. Database is empty.");
-            outputText->append("");
-            outputText->append("You can add customers using:");
-            outputText->append("POST " + apiClient->getBaseUrl() + "/api/customers");
-        } else {
-            // Display each customer's details
-            for (int i = 0; i < customers.count(); ++i) {
-                const Customer &customer = customers[i];
-                outputText->append(QString("?????????????????????????????"));
-                outputText->append(QString("Customer #%1:").arg(i + 1));
-                outputText->append(QString("  ID: %1").arg(customer.getId()));
-                outputText->append(QString("  Name: %1").arg(customer.getFullName())); // UTF-8 safe
-                outputText->append(QString("  Address: %1").arg(customer.getAddress()));
-                if (customer.getCreatedAt().isValid()) {
-                    outputText->append(QString("  Created: %1").arg(customer.getCreatedAt().toString("yyyy-MM-dd HH:mm:ss")));
-                }
-                outputText->append("");
-            }
-        }
+    }
+    
+    customerModel->setCustomers(customers);
+    
+    // Background refresh of the snapshot - no popup
+    if (revalidatingSnapshot) {
+        revalidatingSnapshot = false;
+        return;
     }
     
     // Show success popup with UTF-8 encoded customer name
@@ -323,6 +504,119 @@ void MainWindow::onCustomersReceived(const QList<Customer> &customers)
     QMessageBox::information(this, "API Test Successful", message);
 }
 
+/**
+ * Snapshot loaded handler
+ * Called at startup with the customer list saved by the previous run;
+ * shows it and asks the server whether it is still current
+ * 
+ * @param customers - Customers from the on-disk snapshot
+ * @param savedAt   - When the snapshot was written
+ */
+void MainWindow::onSnapshotLoaded(const QList<Customer> &customers, const QDateTime &savedAt)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
+    
+    if (statusLabel) {
+        statusLabel->setText(QString("Status: Showing %1 cached customer(s) - checking for updates...").arg(customers.count()));
+    }
+    
+    if (outputText) {
+        outputText->clear();
+        outputText->append("=== CACHED CUSTOMERS ===");
+        outputText->append("Saved: " + savedAt.toLocalTime().toString("yyyy-MM-dd HH:mm:ss"));
+        outputText->append("");
+    }
+    
+    customerModel->setCustomers(customers);
+    
+    revalidatingSnapshot = true;
+    apiClient->getAllCustomers(ApiClient::BackgroundPriority);
+}
+
+/**
+ * Customer list not modified handler
+ * The server confirmed (HTTP 304) that the displayed snapshot is current
+ */
+void MainWindow::onCustomersNotModified()
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    
+    if (statusLabel) {
+        statusLabel->setText("Status: ? Customer list is up to date");
+    }
+    
+    revalidatingSnapshot = false;
+}
+
+/**
+ * Customer page loaded handler
+ * Called each time the table has received another page of customers
+ * 
+ * @param rowCount - Customers loaded so far
+ * @param hasMore  - More pages available on the server
+ */
+void MainWindow::onCustomerPageLoaded(int rowCount, bool hasMore)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
+    
+    if (statusLabel) {
+        statusLabel->setText(QString("Status: ? Success! Loaded %1 customer(s)%2")
+                                 .arg(rowCount)
+                                 .arg(hasMore ? " - scroll down for more" : ""));
+    }
+    
+    if (outputText && rowCount <= customerModel->pageSize()) {
+        outputText->append("=== SUCCESS ===");
+        if (rowCount == 0) {
+            outputText->append("No customers found. Database is empty.");
+            outputText->append("You can add customers using:");
+            outputText->append("POST " + apiClient->getBaseUrl() + "/api/customers");
+        } else {
+            // First customer name verifies UTF-8 encoding (e.g., "Meikäläinen")
+            outputText->append("First customer: " + customerModel->customerAt(0).getFullName());
+        }
+    }
+}
+
+/**
+ * Background pre-warm handler
+ * Reports that the server is awake without interrupting the operator
+ * 
+ * @param ok        - The /health probe succeeded
+ * @param elapsedMs - Probe round trip, including any cold start
+ */
+void MainWindow::onPrewarmFinished(bool ok, qint64 elapsedMs)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    
+    // Do not hide the progress of a snapshot refresh
+    if (!statusLabel || revalidatingSnapshot) {
+        return;
+    }
+    
+    if (ok) {
+        statusLabel->setText(QString("Status: ? Server awake (%1 ms) - ready").arg(elapsedMs));
+    } else {
+        statusLabel->setText("Status: Server not reachable yet - click Health Check to retry");
+    }
+}
+
+/**
+ * The backend's rate limit was hit: requests are held until Retry-After
+ * and then sent by themselves
+ *
+ * @param retryAfterMs - Time until requests resume
+ */
+void MainWindow::onRateLimited(int retryAfterMs)
+{
+    QLabel *statusLabel = findChild<QLabel*>("labelStatus");
+    if (statusLabel) {
+        statusLabel->setText(QString("Status: Rate limited - requests resume in %1 s").arg((retryAfterMs + 999) / 1000));
+    }
+}
+
 /**
  * API error response handler
  * Called when any API request fails
@@ -338,6 +632,8 @@ void MainWindow::onCustomersReceived(const QList<Customer> &customers)
  */
 void MainWindow::onApiError(const QString &errorMessage)
 {
+    revalidatingSnapshot = false;
+    
     QLabel *statusLabel = findChild<QLabel*>("labelStatus");
     QTextEdit *outputText = findChild<QTextEdit*>("textOutput");
     
@@ -22,6 +22,8 @@
 #include <QMainWindow>
 #include "apiclient.h"
 
+class CustomerListModel;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -39,13 +41,25 @@ public:
 private slots:
     void onTestConnectionClicked();
     void onHealthCheckClicked();
-    void onCustomersReceived(const QList<Customer> &customers);
+    void onCustomersReceived(const QList<CustomerView> &customers);
+    void onSnapshotLoaded(const QList<Customer> &customers, const QDateTime &savedAt);
+    void onCustomersNotModified();
+    void onCustomerPageLoaded(int rowCount, bool hasMore);
     void onHealthCheckSuccess(const QString &status);
+    void onPrewarmFinished(bool ok, qint64 elapsedMs);
+    void onRateLimited(int retryAfterMs);
+    void onImportClicked();
+    void onImportProgress(int succeeded, int failed, int total);
+    void onImportItemFailed(int item, const QString &message);
+    void onImportFinished(int succeeded, int failed);
     void onApiError(const QString &errorMessage);
 
 private:
     Ui::MainWindow *ui;
     ApiClient *apiClient;
+    CustomerListModel *customerModel;
+    bool revalidatingSnapshot;  // Startup refresh of the cached customer list
+    int importFailuresShown;    // Failed import rows listed in the output
     
     void setupUI();
     void setupConnections();
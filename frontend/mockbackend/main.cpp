@@ -0,0 +1,79 @@
+/**
+ * Bank ATM System - Mock Backend
+ *
+ * Standalone MockBackend for running the frontend, frontend-loadgen or
+ * benchmarks without Node/MySQL or a network:
+ *
+ *   frontend-mockbackend --port 3000 --customers 10000 --latency 40 --rate-limit 100
+ */
+
+#include "mockbackend.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("frontend-mockbackend");
+
+    MockBackend::Options options;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("In-memory mock of the Bank ATM REST API");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "host", "Address to listen on.", "address", "127.0.0.1" },
+        { "port", "Port to listen on (0 = any free port).", "port", "3000" },
+        { "customers", "Synthetic customers to start with.", "count", "1000" },
+        { "seed", "Random seed for the synthetic customers.", "seed", "20260101" },
+        { "latency", "Delay before every response.", "ms", "0" },
+        { "jitter", "Extra random delay, uniform 0..jitter.", "ms", "0" },
+        { "bandwidth", "Per-connection bandwidth cap (0 = unlimited).", "kB/s", "0" },
+        { "chunked", "Send bodies with Transfer-Encoding: chunked." },
+        { "chunk-size", "Body chunk size.", "bytes", QString::number(options.chunkSize) },
+        { "drip", "Pause between body chunks (slow drip).", "ms", "0" },
+        { "rate-limit", "Requests per window per address (0 = off; backend default 100).", "count", "0" },
+        { "rate-limit-window", "Rate limit window.", "seconds", QString::number(options.rateLimitWindowMs / 1000) },
+        { "cold-start", "Delay of the first request after startup or idling (0 = off).", "ms", "0" },
+        { "cold-idle", "Idle time after which the server is cold again.", "seconds",
+          QString::number(options.coldStartIdleMs / 1000) },
+        { "verbose", "Print every request." }
+    });
+    parser.process(app);
+
+    options.latencyMs = parser.value("latency").toInt();
+    options.latencyJitterMs = parser.value("jitter").toInt();
+    options.bandwidthBytesPerSec = parser.value("bandwidth").toLongLong() * 1024;
+    options.chunked = parser.isSet("chunked");
+    options.chunkSize = qMax(1, parser.value("chunk-size").toInt());
+    options.dripIntervalMs = parser.value("drip").toInt();
+    options.rateLimitMax = parser.value("rate-limit").toInt();
+    options.rateLimitWindowMs = qMax(1, parser.value("rate-limit-window").toInt()) * 1000;
+    options.coldStartMs = parser.value("cold-start").toInt();
+    options.coldStartIdleMs = qMax(1, parser.value("cold-idle").toInt()) * 1000;
+
+    MockBackend backend;
+    backend.setOptions(options);
+    backend.seedCustomers(qMax(0, parser.value("customers").toInt()), parser.value("seed").toUInt());
+
+    if (!backend.listen(QHostAddress(parser.value("host")), quint16(parser.value("port").toUInt()))) {
+        std::fprintf(stderr, "Cannot listen on %s:%s: %s\n", qPrintable(parser.value("host")),
+                     qPrintable(parser.value("port")), qPrintable(backend.errorString()));
+        return 1;
+    }
+
+    if (parser.isSet("verbose")) {
+        QObject::connect(&backend, &MockBackend::requestHandled, &app,
+                         [](const QString &method, const QString &path, int status) {
+                             std::printf("%s %s -> %d\n", qPrintable(method), qPrintable(path), status);
+                             std::fflush(stdout);
+                         });
+    }
+
+    std::printf("Mock backend with %d customers listening on %s\n", backend.customerCount(),
+                qPrintable(backend.baseUrl()));
+    std::fflush(stdout);
+    return app.exec();
+}
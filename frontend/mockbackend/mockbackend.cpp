@@ -0,0 +1,1059 @@
+/**
+ * mockbackend.cpp - In-process backend implementation
+ */
+
+#include "mockbackend.h"
+#include "payloadgenerator.h"
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocale>
+#include <QSet>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QTimeZone>
+#include <QUrlQuery>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const int MaxPageSize = 1000;            // Same limits as customerController.js
+const int MaxBatchSize = 1000;
+const int MaxIds = 1000;
+const qsizetype MaxHeaderBytes = 64 * 1024;
+const qint64 MaxBodyBytes = 1024 * 1024;  // express.json({ limit: '1mb' })
+
+const char *const MissingFieldsMessage = "Missing required fields: firstName, lastName, address";
+
+QByteArray reasonPhrase(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    default: return "Internal Server Error";
+    }
+}
+
+QByteArray httpDate(const QDateTime &dateTime)
+{
+    return QLocale::c().toString(dateTime.toUTC(), "ddd, dd MMM yyyy hh:mm:ss").toLatin1() + " GMT";
+}
+
+/**
+ * JSON string literal, escaped like JSON.stringify
+ */
+void appendString(QByteArray &out, const QString &value)
+{
+    static const char Hex[] = "0123456789abcdef";
+
+    out.append('"');
+    const QByteArray utf8 = value.toUtf8();
+    for (char c : utf8) {
+        const uchar byte = uchar(c);
+        if (c == '"' || c == '\\') {
+            out.append('\\').append(c);
+        } else if (byte >= 0x20) {
+            out.append(c);
+        } else if (c == '\n') {
+            out.append("\\n");
+        } else if (c == '\r') {
+            out.append("\\r");
+        } else if (c == '\t') {
+            out.append("\\t");
+        } else {
+            out.append("\\u00").append(Hex[byte >> 4]).append(Hex[byte & 0xf]);
+        }
+    }
+    out.append('"');
+}
+
+QByteArray timestamp(const QDateTime &dateTime)
+{
+    return dateTime.toUTC().toString(Qt::ISODateWithMs).toLatin1();
+}
+
+// Truthiness as the controller's `!value` check sees it
+bool truthy(const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::String:
+        return !value.toString().isEmpty();
+    case QJsonValue::Double:
+        return value.toDouble() != 0;
+    case QJsonValue::Bool:
+        return value.toBool();
+    case QJsonValue::Array:
+    case QJsonValue::Object:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Weak ETag as Express computes it: W/"<length hex>-<SHA-1 base64, 27 chars>"
+ */
+QByteArray weakEtag(const QByteArray &body)
+{
+    const QByteArray hash = QCryptographicHash::hash(body, QCryptographicHash::Sha1).toBase64().left(27);
+    return "W/\"" + QByteArray::number(body.size(), 16) + '-' + hash + '"';
+}
+
+/**
+ * q of the most specific Accept range matching a media type, as the
+ * accepts module rates it (no header accepts everything)
+ */
+double acceptQuality(const QByteArray &accept, const QByteArray &type)
+{
+    if (accept.trimmed().isEmpty()) {
+        return 1;
+    }
+
+    const QByteArray typeRange = type.left(type.indexOf('/')) + "/*";
+    int specificity = -1;
+    double quality = 0;
+    for (const QByteArray &range : accept.split(',')) {
+        const QList<QByteArray> parts = range.split(';');
+        const QByteArray mediaType = parts.first().trimmed().toLower();
+        const int match = mediaType == type ? 2 : mediaType == typeRange ? 1 : mediaType == "*/*" ? 0 : -1;
+        if (match <= specificity) {
+            continue;
+        }
+        specificity = match;
+        quality = 1;
+        for (qsizetype i = 1; i < parts.size(); ++i) {
+            const QByteArray parameter = parts[i].trimmed();
+            if (parameter.startsWith("q=")) {
+                quality = parameter.mid(2).toDouble();
+            }
+        }
+    }
+    return quality;
+}
+
+bool prefersCbor(const QByteArray &accept)
+{
+    return acceptQuality(accept, "application/cbor") > acceptQuality(accept, "application/json");
+}
+
+/**
+ * cbor.js encoding of a JSON value; timestamps were Dates in the backend
+ * and carry tag 0 (date/time string)
+ */
+QCborValue cborValue(const QJsonValue &value, bool timestamp = false)
+{
+    if (value.isObject()) {
+        const QJsonObject object = value.toObject();
+        QCborMap map;
+        for (auto it = object.begin(); it != object.end(); ++it) {
+            const QString key = it.key();
+            map.insert(key, cborValue(it.value(), key == "createdAt" || key == "updatedAt" || key == "deletedAt"
+                                                      || key == "watermark"));
+        }
+        return map;
+    }
+    if (value.isArray()) {
+        QCborArray array;
+        for (const QJsonValue &item : value.toArray()) {
+            array.append(cborValue(item));
+        }
+        return array;
+    }
+    if (timestamp && value.isString()) {
+        return QCborValue(QCborKnownTags::DateTimeString, value.toString());
+    }
+    return QCborValue::fromJsonValue(value);
+}
+
+/**
+ * Initial byte and argument of a CBOR data item
+ */
+void appendCborHead(QByteArray &out, quint8 major, quint64 value)
+{
+    const char type = char(major << 5);
+    if (value < 24) {
+        out.append(char(type | value));
+        return;
+    }
+    const int bytes = value < 0x100 ? 1 : value < 0x10000 ? 2 : value < 0x100000000ULL ? 4 : 8;
+    out.append(char(type | (bytes == 1 ? 24 : bytes == 2 ? 25 : bytes == 4 ? 26 : 27)));
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out.append(char(value >> shift));
+    }
+}
+
+void appendCborText(QByteArray &out, const QByteArray &utf8)
+{
+    appendCborHead(out, 3, quint64(utf8.size()));
+    out.append(utf8);
+}
+
+} // namespace
+
+MockBackend::MockBackend(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_nextId(1)
+    , m_lastRequestNs(-1)
+    , m_warmAtNs(0)
+    , m_random(1)
+    , m_requestCount(0)
+    , m_rateLimitedCount(0)
+{
+    m_clock.start();
+    connect(m_server, &QTcpServer::newConnection, this, &MockBackend::onNewConnection);
+}
+
+MockBackend::~MockBackend()
+{
+}
+
+/**
+ * Start accepting connections
+ *
+ * @param address - Interface to bind (loopback by default)
+ * @param port    - Port, 0 = any free port (see port())
+ * @return bool - true if listening
+ */
+bool MockBackend::listen(const QHostAddress &address, quint16 port)
+{
+    return m_server->listen(address, port);
+}
+
+void MockBackend::close()
+{
+    m_server->close();
+    const QList<QTcpSocket*> sockets = m_connections.keys();  // abort() emits disconnected
+    for (QTcpSocket *socket : sockets) {
+        socket->abort();
+    }
+}
+
+quint16 MockBackend::port() const
+{
+    return m_server->serverPort();
+}
+
+QString MockBackend::baseUrl() const
+{
+    const QHostAddress address = m_server->serverAddress();
+    QString host;
+    if (address == QHostAddress::Any || address == QHostAddress::AnyIPv4 || address == QHostAddress::AnyIPv6) {
+        host = "localhost";
+    } else if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+        host = "[" + address.toString() + "]";
+    } else {
+        host = address.toString();
+    }
+    return QString("http://%1:%2").arg(host).arg(port());
+}
+
+QString MockBackend::errorString() const
+{
+    return m_server->errorString();
+}
+
+/**
+ * Fill the table with synthetic customers (PayloadGenerator data)
+ */
+void MockBackend::seedCustomers(int count, quint32 seed)
+{
+    PayloadGenerator generator(seed);
+    const QList<Customer> customers = generator.customers(count);
+    for (Customer customer : customers) {
+        customer.setId(m_nextId++);
+        indexChange(*m_customers.insert(customer.getId(), Record{ customer, serialize(customer) }), -1);
+    }
+}
+
+void MockBackend::clearCustomers()
+{
+    m_customers.clear();
+    m_deleted.clear();
+    m_changes.clear();
+    m_nextId = 1;
+}
+
+void MockBackend::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_connections.insert(socket, Connection());
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            auto it = m_connections.find(socket);
+            if (it != m_connections.end()) {
+                it->buffer.append(socket->readAll());
+                processBuffer(socket);
+            }
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+/**
+ * Take the next complete request off the connection buffer, if the
+ * connection is not busy with a previous one
+ */
+void MockBackend::processBuffer(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end() || it->busy) {
+        return;
+    }
+
+    QByteArray &buffer = it->buffer;
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buffer.size() > MaxHeaderBytes) {
+            it->busy = true;
+            send(socket, message(431, false, "Request header too large"), false);
+        }
+        return;
+    }
+
+    Request request;
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.first().trimmed().split(' ');
+    if (requestLine.count() != 3) {
+        it->busy = true;
+        send(socket, message(400, false, "Malformed request line"), false);
+        return;
+    }
+
+    for (qsizetype i = 1; i < lines.count(); ++i) {
+        const qsizetype colon = lines.at(i).indexOf(':');
+        if (colon > 0) {
+            request.headers.insert(lines.at(i).left(colon).trimmed().toLower(), lines.at(i).mid(colon + 1).trimmed());
+        }
+    }
+
+    const qint64 contentLength = qMax<qint64>(0, request.headers.value("content-length").toLongLong());
+    if (contentLength > MaxBodyBytes) {
+        it->busy = true;
+        send(socket, message(413, false, "request entity too large"), false);
+        return;
+    }
+    if (buffer.size() < headerEnd + 4 + contentLength) {
+        return;  // Body still arriving
+    }
+
+    const QByteArray target = requestLine.at(1);
+    const qsizetype question = target.indexOf('?');
+    request.method = requestLine.at(0);
+    request.path = question < 0 ? target : target.left(question);
+    request.query = question < 0 ? QByteArray() : target.mid(question + 1);
+    request.body = buffer.mid(headerEnd + 4, contentLength);
+
+    const QByteArray connection = request.headers.value("connection").toLower();
+    request.keepAlive = requestLine.at(2) == "HTTP/1.0" ? connection == "keep-alive" : connection != "close";
+
+    buffer.remove(0, headerEnd + 4 + contentLength);
+    it->busy = true;
+    dispatch(socket, request);
+}
+
+/**
+ * Handle a request: state changes happen on arrival, the response is
+ * sent after the injected cold start and latency
+ */
+void MockBackend::dispatch(QTcpSocket *socket, const Request &request)
+{
+    ++m_requestCount;
+
+    const qint64 now = m_clock.nsecsElapsed();
+    if (m_options.coldStartMs > 0
+        && (m_lastRequestNs < 0 || now - m_lastRequestNs > qint64(m_options.coldStartIdleMs) * 1000000)) {
+        m_warmAtNs = now + qint64(m_options.coldStartMs) * 1000000;
+    }
+    m_lastRequestNs = now;
+
+    QList<QPair<QByteArray, QByteArray>> limitHeaders;
+    Response response = rateLimit(socket, request, &limitHeaders)
+        ? message(429, false, "Too many requests from this IP, please try again after 15 minutes.")
+        : route(request);
+    negotiate(request, &response);
+    response.headers += limitHeaders;
+
+    emit requestHandled(QString::fromLatin1(request.method), QString::fromUtf8(request.path), response.status);
+
+    int delayMs = int(qMax<qint64>(0, m_warmAtNs - now) / 1000000) + m_options.latencyMs;
+    if (m_options.latencyJitterMs > 0) {
+        delayMs += int(m_random() % quint32(m_options.latencyJitterMs + 1));
+    }
+
+    if (delayMs <= 0) {
+        send(socket, response, request.keepAlive);
+        return;
+    }
+
+    QPointer<QTcpSocket> guard(socket);
+    const bool keepAlive = request.keepAlive;
+    QTimer::singleShot(delayMs, this, [this, guard, response, keepAlive]() {
+        if (guard) {
+            send(guard, response, keepAlive);
+        }
+    });
+}
+
+/**
+ * express-rate-limit with standardHeaders: fixed window per client address
+ * /health is never limited, like apiLimiter's skip
+ *
+ * @param headers - Receives the RateLimit-* (and Retry-After) headers
+ * @return bool - true if the request is over the limit
+ */
+bool MockBackend::rateLimit(QTcpSocket *socket, const Request &request, QList<QPair<QByteArray, QByteArray>> *headers)
+{
+    if (m_options.rateLimitMax <= 0 || request.path == "/health") {
+        return false;
+    }
+
+    const qint64 now = m_clock.nsecsElapsed();
+    RateLimitWindow &window = m_rateLimits[socket->peerAddress().toString()];
+    if (now >= window.resetNs) {
+        window.hits = 0;
+        window.resetNs = now + qint64(m_options.rateLimitWindowMs) * 1000000;
+    }
+    ++window.hits;
+
+    const QByteArray resetSeconds = QByteArray::number((window.resetNs - now + 999999999) / 1000000000);
+    headers->append({ "RateLimit-Policy", QByteArray::number(m_options.rateLimitMax) + ";w="
+                                              + QByteArray::number(m_options.rateLimitWindowMs / 1000) });
+    headers->append({ "RateLimit-Limit", QByteArray::number(m_options.rateLimitMax) });
+    headers->append({ "RateLimit-Remaining", QByteArray::number(qMax(0, m_options.rateLimitMax - window.hits)) });
+    headers->append({ "RateLimit-Reset", resetSeconds });
+
+    if (window.hits <= m_options.rateLimitMax) {
+        return false;
+    }
+
+    ++m_rateLimitedCount;
+    headers->append({ "Retry-After", resetSeconds });
+    return true;
+}
+
+MockBackend::Response MockBackend::route(const Request &request)
+{
+    QByteArray path = request.path;
+    if (path.size() > 1 && path.endsWith('/')) {
+        path.chop(1);  // Express routing is not strict about a trailing slash
+    }
+
+    const QByteArray &method = request.method;
+    const QByteArray collection = "/api/customers";
+    Response response = message(404, false, "Route not found");
+
+    if (path == "/health" && method == "GET") {
+        QByteArray body = "{\"status\":\"OK\",\"timestamp\":\"";
+        body += timestamp(QDateTime::currentDateTimeUtc()) + "\"}";
+        response = json(200, body);
+    } else if (path == collection) {
+        if (method == "GET") {
+            response = listCustomers(request);
+        } else if (method == "POST") {
+            response = createCustomer(request);
+        }
+    } else if (path == collection + "/batch" && method == "POST") {
+        response = createCustomersBatch(request);
+    } else if (path.startsWith(collection + '/') && path.count('/') == 3) {
+        bool ok = false;
+        const int id = path.mid(collection.size() + 1).toInt(&ok);
+        if (!ok && (method == "GET" || method == "PUT" || method == "DELETE")) {
+            response = message(500, false, "Invalid customer id");  // Prisma rejects NaN ids
+        } else if (method == "GET") {
+            response = getCustomer(id);
+        } else if (method == "PUT") {
+            response = updateCustomer(id, request);
+        } else if (method == "DELETE") {
+            response = deleteCustomer(id);
+        }
+    }
+
+    // The ETag is computed over the body actually sent
+    negotiate(request, &response);
+
+    // Express adds a weak ETag to every body and answers a fresh
+    // conditional GET with 304
+    if (method == "GET" && response.status == 200) {
+        const QByteArray etag = weakEtag(response.body);
+        response.headers.append({ "ETag", etag });
+
+        const QByteArray ifNoneMatch = request.headers.value("if-none-match");
+        const QByteArray ifModifiedSince = request.headers.value("if-modified-since");
+        bool fresh = !ifNoneMatch.isEmpty() || !ifModifiedSince.isEmpty();
+        if (!ifNoneMatch.isEmpty()) {
+            bool matched = false;
+            for (const QByteArray &tag : ifNoneMatch.split(',')) {
+                const QByteArray candidate = tag.trimmed();
+                matched = matched || candidate == "*" || candidate == etag || "W/" + candidate == etag;
+            }
+            fresh = fresh && matched;
+        }
+        if (!ifModifiedSince.isEmpty()) {
+            QByteArray lastModified;
+            for (const auto &header : std::as_const(response.headers)) {
+                if (header.first == "Last-Modified") {
+                    lastModified = header.second;
+                }
+            }
+            const QDateTime since = QDateTime::fromString(QString::fromLatin1(ifModifiedSince), Qt::RFC2822Date);
+            const QDateTime modified = QDateTime::fromString(QString::fromLatin1(lastModified), Qt::RFC2822Date);
+            fresh = fresh && since.isValid() && modified.isValid() && modified <= since;
+        }
+        if (fresh) {
+            response.status = 304;
+            response.body.clear();
+        }
+    }
+
+    return response;
+}
+
+/**
+ * GET /api/customers[?limit=&cursor=]
+ */
+MockBackend::Response MockBackend::listCustomers(const Request &request)
+{
+    const QUrlQuery query(QString::fromUtf8(request.query));
+    if (query.hasQueryItem("updatedSince")) {
+        return listChangedCustomers(query);
+    }
+    if (query.hasQueryItem("ids")) {
+        return listCustomersByIds(query);
+    }
+
+    int limit = -1;
+    if (query.hasQueryItem("limit")) {
+        bool ok = false;
+        limit = query.queryItemValue("limit").toInt(&ok);
+        if (!ok || limit < 1 || limit > MaxPageSize) {
+            return message(400, false, QString("limit must be between 1 and %1").arg(MaxPageSize));
+        }
+    }
+
+    int cursor = 0;
+    if (query.hasQueryItem("cursor")) {
+        bool ok = false;
+        cursor = query.queryItemValue("cursor").toInt(&ok);
+        if (!ok || cursor < 0) {
+            return message(400, false, "cursor must be a non-negative customer id");
+        }
+    }
+
+    QList<Record*> page;
+    page.reserve(limit > 0 ? limit : m_customers.count());
+    int lastId = 0;
+    QDateTime lastModified;
+    for (auto it = cursor > 0 ? m_customers.upperBound(cursor) : m_customers.begin();
+         it != m_customers.end() && (limit < 0 || page.count() < limit); ++it) {
+        page.append(&it.value());
+        lastId = it.key();
+        if (!lastModified.isValid() || it->customer.getUpdatedAt() > lastModified) {
+            lastModified = it->customer.getUpdatedAt();
+        }
+    }
+    const int count = int(page.count());
+
+    Response response;
+    QByteArray &body = response.body;
+    body.reserve(64 + qsizetype(count) * 200);
+    if (prefersCbor(request.headers.value("accept"))) {
+        // Same layout as cbor.js: definite lengths, records encoded once
+        response.cbor = true;
+        appendCborHead(body, 5, limit > 0 ? 4 : 3);
+        appendCborText(body, "success");
+        body.append(char(0xf5));
+        appendCborText(body, "data");
+        appendCborHead(body, 4, quint64(count));
+        for (Record *record : std::as_const(page)) {
+            if (record->cbor.isEmpty()) {
+                record->cbor = toCbor(record->json);
+            }
+            body.append(record->cbor);
+        }
+        appendCborText(body, "count");
+        appendCborHead(body, 0, quint64(count));
+        if (limit > 0) {
+            appendCborText(body, "nextCursor");
+            if (count == limit) {
+                appendCborHead(body, 0, quint64(lastId));
+            } else {
+                body.append(char(0xf6));
+            }
+        }
+    } else {
+        body.append("{\"success\":true,\"data\":[");
+        for (int i = 0; i < count; ++i) {
+            if (i > 0) {
+                body.append(',');
+            }
+            body.append(page[i]->json);
+        }
+        body.append("],\"count\":").append(QByteArray::number(count));
+        if (limit > 0) {
+            body.append(",\"nextCursor\":").append(count == limit ? QByteArray::number(lastId) : QByteArray("null"));
+        }
+        body.append('}');
+    }
+
+    response.headers.append({ "Cache-Control", "no-cache" });
+    if (count > 0) {
+        response.headers.append({ "Last-Modified", httpDate(lastModified) });
+    }
+    return response;
+}
+
+/**
+ * GET /api/customers?updatedSince=[&includeDeleted=true] - rows changed
+ * after the timestamp, oldest change first, from the change index
+ */
+MockBackend::Response MockBackend::listChangedCustomers(const QUrlQuery &query)
+{
+    const QDateTime since = QDateTime::fromString(query.queryItemValue("updatedSince"), Qt::ISODateWithMs);
+    if (!since.isValid()) {
+        return message(400, false, "updatedSince must be an ISO 8601 timestamp");
+    }
+    if (query.hasQueryItem("limit") || query.hasQueryItem("cursor") || query.hasQueryItem("ids")) {
+        return message(400, false, "updatedSince cannot be combined with limit, cursor or ids");
+    }
+    const bool includeDeleted = query.queryItemValue("includeDeleted") == "true";
+
+    Response response;
+    QByteArray &body = response.body;
+    body.append("{\"success\":true,\"data\":[");
+    int count = 0;
+    QDateTime watermark = since;
+    for (auto it = m_changes.upperBound({ since.toMSecsSinceEpoch(), std::numeric_limits<int>::max() });
+         it != m_changes.end(); ++it) {
+        const bool tombstone = it.value();
+        if (tombstone && !includeDeleted) {
+            continue;
+        }
+        const Record &record = tombstone ? m_deleted[it.key().second] : m_customers[it.key().second];
+        if (count++ > 0) {
+            body.append(',');
+        }
+        // Prisma's field order with the deletedAt column selected as well
+        body.append(record.json.chopped(1)).append(",\"deletedAt\":");
+        body.append(tombstone ? '"' + timestamp(record.deletedAt) + "\"}" : QByteArray("null}"));
+        watermark = record.customer.getUpdatedAt();
+    }
+    body.append("],\"count\":").append(QByteArray::number(count));
+    body.append(",\"watermark\":\"").append(timestamp(watermark)).append("\"}");
+
+    response.headers.append({ "Cache-Control", "no-cache" });
+    return response;
+}
+
+/**
+ * GET /api/customers?ids=1,2,3 - the live customers among the ids, ordered
+ * by id; the others are listed in missing
+ */
+MockBackend::Response MockBackend::listCustomersByIds(const QUrlQuery &query)
+{
+    if (query.hasQueryItem("limit") || query.hasQueryItem("cursor")) {
+        return message(400, false, "ids cannot be combined with limit or cursor");
+    }
+
+    QList<int> ids;
+    QSet<int> seen;
+    for (const QString &part : query.queryItemValue("ids").split(',')) {
+        bool ok = false;
+        const int id = part.trimmed().toInt(&ok);
+        if (!ok || id < 1) {
+            return message(400, false, "ids must be a comma-separated list of customer ids");
+        }
+        if (!seen.contains(id)) {
+            seen.insert(id);
+            ids.append(id);
+        }
+    }
+    if (ids.count() > MaxIds) {
+        return message(400, false, QString("At most %1 ids per request").arg(MaxIds));
+    }
+
+    QList<int> sorted = ids;
+    std::sort(sorted.begin(), sorted.end());
+
+    Response response;
+    QByteArray &body = response.body;
+    body.append("{\"success\":true,\"data\":[");
+    int count = 0;
+    for (int id : std::as_const(sorted)) {
+        const auto it = m_customers.constFind(id);
+        if (it == m_customers.cend()) {
+            continue;
+        }
+        if (count++ > 0) {
+            body.append(',');
+        }
+        body.append(it->json);
+    }
+    body.append("],\"count\":").append(QByteArray::number(count)).append(",\"missing\":[");
+    bool first = true;
+    for (int id : std::as_const(ids)) {
+        if (!m_customers.contains(id)) {
+            body.append(first ? "" : ",").append(QByteArray::number(id));
+            first = false;
+        }
+    }
+    body.append("]}");
+
+    response.headers.append({ "Cache-Control", "no-cache" });
+    return response;
+}
+
+MockBackend::Response MockBackend::getCustomer(int id)
+{
+    auto it = m_customers.constFind(id);
+    if (it == m_customers.cend()) {
+        return message(404, false, "Customer not found");
+    }
+    return json(200, "{\"success\":true,\"data\":" + it->json + '}');
+}
+
+/**
+ * POST /api/customers
+ */
+MockBackend::Response MockBackend::createCustomer(const Request &request)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = request.body.isEmpty() ? QJsonDocument(QJsonObject())
+                                                     : QJsonDocument::fromJson(request.body, &error);
+    if (doc.isNull()) {
+        return message(400, false, error.errorString());
+    }
+
+    const QJsonObject input = doc.object();
+    if (!hasRequiredFields(input)) {
+        return message(400, false, MissingFieldsMessage);
+    }
+    if (!fitsColumns(input)) {
+        return message(400, false, "Database operation failed");
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    Customer customer;
+    customer.setId(m_nextId++);
+    customer.setFirstName(input["firstName"].toString());
+    customer.setLastName(input["lastName"].toString());
+    customer.setAddress(input["address"].toString());
+    customer.setCreatedAt(now);
+    customer.setUpdatedAt(now);
+
+    const QByteArray data = serialize(customer);
+    indexChange(*m_customers.insert(customer.getId(), Record{ customer, data }), -1);
+    return json(201, "{\"success\":true,\"data\":" + data + ",\"message\":\"Customer created successfully\"}");
+}
+
+/**
+ * POST /api/customers/batch - all rows or none
+ */
+MockBackend::Response MockBackend::createCustomersBatch(const Request &request)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(request.body, &error);
+    if (!request.body.isEmpty() && doc.isNull()) {
+        return message(400, false, error.errorString());
+    }
+
+    const QJsonValue list = doc.object()["customers"];
+    const QJsonArray customers = list.toArray();
+    if (!list.isArray() || customers.isEmpty() || customers.count() > MaxBatchSize) {
+        return message(400, false, QString("customers must be an array of 1 to %1 items").arg(MaxBatchSize));
+    }
+
+    QByteArray errors;
+    int invalid = 0;
+    for (qsizetype i = 0; i < customers.count(); ++i) {
+        if (!hasRequiredFields(customers.at(i).toObject())) {
+            errors.append(invalid++ > 0 ? "," : "");
+            errors.append("{\"index\":" + QByteArray::number(i) + ",\"message\":\"" + MissingFieldsMessage + "\"}");
+        }
+    }
+    if (invalid > 0) {
+        QByteArray body = "{\"success\":false,\"message\":\"";
+        body += QByteArray::number(invalid) + " of " + QByteArray::number(customers.count()) + " customers are invalid";
+        body += "\",\"errors\":[" + errors + "]}";
+        return json(400, body);
+    }
+    for (const QJsonValue &value : customers) {
+        if (!fitsColumns(value.toObject())) {
+            return message(400, false, "Database operation failed");
+        }
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (const QJsonValue &value : customers) {
+        const QJsonObject input = value.toObject();
+        Customer customer;
+        customer.setId(m_nextId++);
+        customer.setFirstName(input["firstName"].toString());
+        customer.setLastName(input["lastName"].toString());
+        customer.setAddress(input["address"].toString());
+        customer.setCreatedAt(now);
+        customer.setUpdatedAt(now);
+        indexChange(*m_customers.insert(customer.getId(), Record{ customer, serialize(customer) }), -1);
+    }
+
+    const QByteArray count = QByteArray::number(customers.count());
+    return json(201, "{\"success\":true,\"count\":" + count + ",\"message\":\"" + count
+                         + " customers created successfully\"}");
+}
+
+/**
+ * PUT /api/customers/:id
+ */
+MockBackend::Response MockBackend::updateCustomer(int id, const Request &request)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = request.body.isEmpty() ? QJsonDocument(QJsonObject())
+                                                     : QJsonDocument::fromJson(request.body, &error);
+    if (doc.isNull()) {
+        return message(400, false, error.errorString());
+    }
+
+    const QJsonObject input = doc.object();
+    if (!hasRequiredFields(input)) {
+        return message(400, false, MissingFieldsMessage);
+    }
+
+    auto it = m_customers.find(id);
+    if (it == m_customers.end()) {
+        return message(404, false, "Customer not found");
+    }
+    if (!fitsColumns(input)) {
+        return message(400, false, "Database operation failed");
+    }
+
+    Customer &customer = it->customer;
+    const qint64 previousMSecs = customer.getUpdatedAt().toMSecsSinceEpoch();
+    customer.setFirstName(input["firstName"].toString());
+    customer.setLastName(input["lastName"].toString());
+    customer.setAddress(input["address"].toString());
+    customer.setUpdatedAt(QDateTime::currentDateTimeUtc());
+    it->json = serialize(customer);
+    it->cbor.clear();
+    indexChange(*it, previousMSecs);
+
+    return json(200, "{\"success\":true,\"data\":" + it->json + ",\"message\":\"Customer updated successfully\"}");
+}
+
+/**
+ * DELETE /api/customers/:id - soft delete, the row becomes a tombstone
+ */
+MockBackend::Response MockBackend::deleteCustomer(int id)
+{
+    auto it = m_customers.find(id);
+    if (it == m_customers.end()) {
+        return message(404, false, "Customer not found");
+    }
+
+    Record record = *it;
+    m_customers.erase(it);
+    const qint64 previousMSecs = record.customer.getUpdatedAt().toMSecsSinceEpoch();
+    record.deletedAt = QDateTime::currentDateTimeUtc();
+    record.customer.setUpdatedAt(record.deletedAt);
+    record.json = serialize(record.customer);
+    record.cbor.clear();
+    indexChange(*m_deleted.insert(id, record), previousMSecs);
+
+    return message(200, true, "Customer deleted successfully");
+}
+
+/**
+ * Move a row to its new place in the change index
+ *
+ * @param record        - Live row or tombstone, updatedAt already set
+ * @param previousMSecs - updatedAt before the change, -1 for a new row
+ */
+void MockBackend::indexChange(const Record &record, qint64 previousMSecs)
+{
+    const int id = record.customer.getId();
+    if (previousMSecs >= 0) {
+        m_changes.remove({ previousMSecs, id });
+    }
+    m_changes.insert({ record.customer.getUpdatedAt().toMSecsSinceEpoch(), id }, record.deletedAt.isValid());
+}
+
+/**
+ * Write a response, throttled and chunked as configured
+ */
+void MockBackend::send(QTcpSocket *socket, const Response &response, bool keepAlive)
+{
+    const bool hasBody = response.status != 304;
+    const bool chunked = m_options.chunked && hasBody;
+
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(response.status) + ' ' + reasonPhrase(response.status) + "\r\n";
+    head += "Date: " + httpDate(QDateTime::currentDateTimeUtc()) + "\r\n";
+    if (hasBody) {
+        head += response.cbor ? QByteArray("Content-Type: application/cbor\r\n")
+                              : QByteArray("Content-Type: application/json; charset=utf-8\r\n");
+        head += chunked ? QByteArray("Transfer-Encoding: chunked\r\n")
+                        : QByteArray("Content-Length: " + QByteArray::number(response.body.size()) + "\r\n");
+    }
+    for (const auto &header : response.headers) {
+        head += header.first + ": " + header.second + "\r\n";
+    }
+    head += keepAlive ? "Connection: keep-alive\r\nKeep-Alive: timeout=5\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    const bool throttled = m_options.bandwidthBytesPerSec > 0 || m_options.dripIntervalMs > 0;
+    if (!hasBody || (!chunked && !throttled)) {
+        socket->write(hasBody ? QByteArray(head + response.body) : head);
+        finishResponse(socket, keepAlive);
+        return;
+    }
+
+    QSharedPointer<Transfer> transfer = QSharedPointer<Transfer>::create();
+    transfer->body = response.body;
+    transfer->chunked = chunked;
+    transfer->keepAlive = keepAlive;
+    transfer->sliceSize = qMax(1, m_options.chunkSize);
+    transfer->intervalMs = m_options.dripIntervalMs;
+    if (m_options.bandwidthBytesPerSec > 0) {
+        // Slices of ~20 ms at the capped rate
+        transfer->sliceSize = int(qBound<qint64>(1, m_options.bandwidthBytesPerSec / 50, transfer->sliceSize));
+        transfer->intervalMs = qMax(transfer->intervalMs,
+                                    int(qint64(transfer->sliceSize) * 1000 / m_options.bandwidthBytesPerSec));
+    }
+
+    socket->write(head);
+    sendSlice(socket, transfer);
+}
+
+void MockBackend::sendSlice(QPointer<QTcpSocket> socket, QSharedPointer<Transfer> transfer)
+{
+    if (!socket) {
+        return;
+    }
+
+    const QByteArray slice = transfer->body.mid(transfer->offset, transfer->sliceSize);
+    transfer->offset += slice.size();
+    const bool last = transfer->offset >= transfer->body.size();
+
+    if (transfer->chunked) {
+        QByteArray frame;
+        if (!slice.isEmpty()) {
+            frame = QByteArray::number(slice.size(), 16) + "\r\n" + slice + "\r\n";
+        }
+        socket->write(last ? QByteArray(frame + "0\r\n\r\n") : frame);
+    } else {
+        socket->write(slice);
+    }
+
+    if (last) {
+        finishResponse(socket, transfer->keepAlive);
+        return;
+    }
+
+    QTimer::singleShot(transfer->intervalMs, this, [this, socket, transfer]() {
+        sendSlice(socket, transfer);
+    });
+}
+
+/**
+ * Close the connection or move on to the next buffered request
+ */
+void MockBackend::finishResponse(QTcpSocket *socket, bool keepAlive)
+{
+    if (!keepAlive) {
+        socket->disconnectFromHost();
+        return;
+    }
+
+    auto it = m_connections.find(socket);
+    if (it != m_connections.end()) {
+        it->busy = false;
+        processBuffer(socket);
+    }
+}
+
+MockBackend::Response MockBackend::json(int status, const QByteArray &body)
+{
+    Response response;
+    response.status = status;
+    response.body = body;
+    return response;
+}
+
+MockBackend::Response MockBackend::message(int status, bool success, const QString &text)
+{
+    QByteArray body = success ? "{\"success\":true,\"message\":" : "{\"success\":false,\"message\":";
+    appendString(body, text);
+    body.append('}');
+    return json(status, body);
+}
+
+/**
+ * contentNegotiation.js: CBOR instead of JSON when the client prefers it
+ * (JSON wins ties); applied once per response
+ */
+void MockBackend::negotiate(const Request &request, Response *response)
+{
+    if (response->headers.contains({ "Vary", "Accept" })) {
+        return;
+    }
+    response->headers.append({ "Vary", "Accept" });
+    if (!response->cbor && response->status != 304 && prefersCbor(request.headers.value("accept"))) {
+        response->body = toCbor(response->body);
+        response->cbor = true;
+    }
+}
+
+QByteArray MockBackend::toCbor(const QByteArray &json)
+{
+    return cborValue(QJsonDocument::fromJson(json).object()).toCbor();
+}
+
+bool MockBackend::hasRequiredFields(const QJsonObject &input)
+{
+    return truthy(input["firstName"]) && truthy(input["lastName"]) && truthy(input["address"]);
+}
+
+/**
+ * Values Prisma/MySQL would store: strings within the column sizes
+ */
+bool MockBackend::fitsColumns(const QJsonObject &input)
+{
+    const QJsonValue firstName = input["firstName"];
+    const QJsonValue lastName = input["lastName"];
+    const QJsonValue address = input["address"];
+    return firstName.isString() && firstName.toString().size() <= 100
+        && lastName.isString() && lastName.toString().size() <= 100
+        && address.isString() && address.toString().size() <= 255;
+}
+
+/**
+ * Customer JSON in Prisma's field order
+ */
+QByteArray MockBackend::serialize(const Customer &customer)
+{
+    QByteArray out;
+    out.reserve(200);
+    out.append("{\"id\":").append(QByteArray::number(customer.getId()));
+    out.append(",\"firstName\":");
+    appendString(out, customer.getFirstName());
+    out.append(",\"lastName\":");
+    appendString(out, customer.getLastName());
+    out.append(",\"address\":");
+    appendString(out, customer.getAddress());
+    out.append(",\"createdAt\":\"").append(timestamp(customer.getCreatedAt()));
+    out.append("\",\"updatedAt\":\"").append(timestamp(customer.getUpdatedAt()));
+    out.append("\"}");
+    return out;
+}
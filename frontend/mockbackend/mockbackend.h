@@ -0,0 +1,170 @@
+/**
+ * MockBackend - In-process HTTP server implementing the backend contract
+ *
+ * Serves /health and /api/customers (list with limit/cursor paging and
+ * ETag/Last-Modified validators, updatedSince deltas with tombstones,
+ * get, create, batch create, update, delete) from an in-memory table, with the same status codes and JSON
+ * bodies as the Express backend, so ApiClient can be benchmarked and
+ * load tested offline and deterministically. Like the backend it answers
+ * Accept: application/cbor with the same body as CBOR (no compression).
+ *
+ * Conditions can be injected through Options:
+ * - latency (fixed plus uniform jitter) before every response
+ * - cold start: the first request, or the first after an idle period,
+ *   waits as if the App Service was starting (others queue behind it)
+ * - bandwidth cap per connection
+ * - chunked transfer encoding and slow-drip bodies (pause between chunks)
+ * - rate limiting like express-rate-limit: fixed window per client
+ *   address, RateLimit-* headers and 429 with Retry-After
+ *
+ * Plain HTTP/1.1 with keep-alive on QTcpServer; one request is handled
+ * at a time per connection, as QNetworkAccessManager does not pipeline.
+ */
+
+#ifndef MOCKBACKEND_H
+#define MOCKBACKEND_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QMap>
+#include <QPointer>
+#include <QSharedPointer>
+#include <random>
+#include "customer.h"
+
+class QTcpServer;
+class QUrlQuery;
+class QTcpSocket;
+
+class MockBackend : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options {
+        int latencyMs = 0;                      // Before every response
+        int latencyJitterMs = 0;                // Plus uniform 0..jitter
+        int coldStartMs = 0;                    // 0 = always warm
+        int coldStartIdleMs = 20 * 60 * 1000;   // Idle time after which the server is cold again
+        qint64 bandwidthBytesPerSec = 0;        // Per connection, 0 = unlimited
+        bool chunked = false;                   // Transfer-Encoding: chunked
+        int chunkSize = 16 * 1024;
+        int dripIntervalMs = 0;                 // Pause between body chunks
+        int rateLimitMax = 0;                   // Requests per window per address, 0 = off
+        int rateLimitWindowMs = 15 * 60 * 1000;
+    };
+
+    explicit MockBackend(QObject *parent = nullptr);
+    ~MockBackend();
+
+    bool listen(const QHostAddress &address = QHostAddress::LocalHost, quint16 port = 0);
+    void close();
+    quint16 port() const;
+    QString baseUrl() const;
+    QString errorString() const;
+
+    void setOptions(const Options &options) { m_options = options; }
+    Options options() const { return m_options; }
+
+    // In-memory customer table
+    void seedCustomers(int count, quint32 seed = 20260101);
+    void clearCustomers();
+    int customerCount() const { return m_customers.count(); }
+
+    quint64 requestCount() const { return m_requestCount; }
+    quint64 rateLimitedCount() const { return m_rateLimitedCount; }
+
+    // JSON response body as the backend encodes it for application/cbor
+    static QByteArray toCbor(const QByteArray &json);
+
+signals:
+    void requestHandled(const QString &method, const QString &path, int status);
+
+private:
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QByteArray query;
+        QHash<QByteArray, QByteArray> headers;  // Lower-case names
+        QByteArray body;
+        bool keepAlive = true;
+    };
+
+    struct Response {
+        int status = 200;
+        QList<QPair<QByteArray, QByteArray>> headers;
+        QByteArray body;
+        bool cbor = false;  // Body is application/cbor (else JSON)
+    };
+
+    struct Connection {
+        QByteArray buffer;
+        bool busy = false;
+    };
+
+    struct Record {
+        Customer customer;
+        QByteArray json;     // Serialized once per change
+        QByteArray cbor;     // Built on first CBOR request, cleared on change
+        QDateTime deletedAt; // Tombstones only
+    };
+
+    struct Transfer {
+        QByteArray body;
+        qsizetype offset = 0;
+        int sliceSize = 0;
+        int intervalMs = 0;
+        bool chunked = false;
+        bool keepAlive = true;
+    };
+
+    struct RateLimitWindow {
+        int hits = 0;
+        qint64 resetNs = 0;
+    };
+
+    QTcpServer *m_server;
+    Options m_options;
+    QHash<QTcpSocket*, Connection> m_connections;
+    QMap<int, Record> m_customers;  // Ordered by id for keyset paging
+    QMap<int, Record> m_deleted;    // Tombstones (soft-deleted rows)
+    QMap<QPair<qint64, int>, bool> m_changes;  // (updatedAt ms, id) -> tombstone, like the updated_at index
+    int m_nextId;
+    QHash<QString, RateLimitWindow> m_rateLimits;
+    QElapsedTimer m_clock;
+    qint64 m_lastRequestNs;
+    qint64 m_warmAtNs;
+    std::mt19937 m_random;
+    quint64 m_requestCount;
+    quint64 m_rateLimitedCount;
+
+    void onNewConnection();
+    void processBuffer(QTcpSocket *socket);
+    void dispatch(QTcpSocket *socket, const Request &request);
+    bool rateLimit(QTcpSocket *socket, const Request &request, QList<QPair<QByteArray, QByteArray>> *headers);
+    Response route(const Request &request);
+    Response listCustomers(const Request &request);
+    Response listChangedCustomers(const QUrlQuery &query);
+    Response listCustomersByIds(const QUrlQuery &query);
+    Response getCustomer(int id);
+    Response createCustomer(const Request &request);
+    Response createCustomersBatch(const Request &request);
+    Response updateCustomer(int id, const Request &request);
+    Response deleteCustomer(int id);
+    void indexChange(const Record &record, qint64 previousMSecs);
+    void send(QTcpSocket *socket, const Response &response, bool keepAlive);
+    void sendSlice(QPointer<QTcpSocket> socket, QSharedPointer<Transfer> transfer);
+    void finishResponse(QTcpSocket *socket, bool keepAlive);
+
+    static Response json(int status, const QByteArray &body);
+    static Response message(int status, bool success, const QString &text);
+    static bool hasRequiredFields(const QJsonObject &input);
+    static bool fitsColumns(const QJsonObject &input);
+    static QByteArray serialize(const Customer &customer);
+    static void negotiate(const Request &request, Response *response);
+};
+
+#endif // MOCKBACKEND_H
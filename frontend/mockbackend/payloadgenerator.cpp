@@ -0,0 +1,125 @@
+/**
+ * payloadgenerator.cpp - Synthetic customer data implementation
+ */
+
+#include "payloadgenerator.h"
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimeZone>
+
+namespace {
+
+const char *const FirstNames[] = {
+    "Matti", "Maija", "Juha", "Päivi", "Jyrki", "Sirpa", "Mikko", "Tuula", "Jaakko", "Anneli",
+    "Väinö", "Kyösti", "Sisko", "Hannele", "Sören", "Åsa", "Eeva", "Pekka", "Liisa", "Jörn",
+    "Aino", "Eino", "Helmi", "Tapani", "Kerttu", "Veikko", "Marjatta", "Ilkka", "Sanna", "Jari"
+};
+
+const char *const LastNames[] = {
+    "Meikäläinen", "Virtanen", "Korhonen", "Mäkinen", "Nieminen", "Hämäläinen", "Laine",
+    "Heikkinen", "Jääskeläinen", "Koskinen", "Järvinen", "Lehtonen", "Pöllänen", "Kärkkäinen", "Äijälä",
+    "Öhman", "Åkerlund", "Kemppainen", "Väisänen", "Mäkelä", "Lämsä", "Räsänen", "Kähkönen"
+};
+
+const char *const Streets[] = {
+    "Kauppurienkatu", "Isokatu", "Torikatu", "Hämeenkatu", "Pyynikintie", "Yliopistonkatu",
+    "Kävelykatu", "Mäkelänkatu", "Pohjoisesplanadi", "Länsiväylä", "Sääksmäentie", "Ärjänsaarentie"
+};
+
+const struct { const char *postcode; const char *city; } Cities[] = {
+    { "90100", "Oulu" }, { "33100", "Tampere" }, { "00100", "Helsinki" },
+    { "40100", "Jyväskylä" }, { "13100", "Hämeenlinna" }, { "04600", "Mäntsälä" },
+    { "20100", "Turku" }, { "65100", "Vaasa" }, { "96100", "Rovaniemi" }, { "87100", "Kajaani" }
+};
+
+template<typename T, size_t N>
+const T &pick(std::mt19937 &random, const T (&items)[N])
+{
+    return items[random() % N];
+}
+
+} // namespace
+
+PayloadGenerator::PayloadGenerator(quint32 seed)
+    : m_random(seed)
+    , m_clock(QDateTime(QDate(2025, 1, 2), QTime(8, 0), QTimeZone::UTC).toMSecsSinceEpoch())
+{
+}
+
+QByteArray PayloadGenerator::customersResponse(int count)
+{
+    QByteArray body;
+    body.reserve(qsizetype(count) * 200 + 64);
+    body.append("{\"success\":true,\"data\":[");
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            body.append(',');
+        }
+        body.append(customerJson(i + 1));
+    }
+    body.append("],\"count\":");
+    body.append(QByteArray::number(count));
+    body.append('}');
+    return body;
+}
+
+QByteArray PayloadGenerator::batchErrorResponse(int count)
+{
+    QByteArray body;
+    body.reserve(qsizetype(count) * 80 + 128);
+    body.append("{\"success\":false,\"message\":\"");
+    body.append(QByteArray::number(count) + " of " + QByteArray::number(count) + " customers are invalid");
+    body.append("\",\"errors\":[");
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            body.append(',');
+        }
+        body.append("{\"index\":" + QByteArray::number(i)
+                    + ",\"message\":\"Missing required fields: firstName, lastName, address\"}");
+    }
+    body.append("]}");
+    return body;
+}
+
+QList<Customer> PayloadGenerator::customers(int count)
+{
+    QList<Customer> result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        result.append(Customer(QJsonDocument::fromJson(customerJson(i + 1)).object()));
+    }
+    return result;
+}
+
+QByteArray PayloadGenerator::customerJson(int id)
+{
+    const auto &city = pick(m_random, Cities);
+    const QByteArray created = timestamp();
+    const QByteArray updated = m_random() % 4 == 0 ? timestamp() : created;
+
+    QByteArray json;
+    json.reserve(220);
+    json.append("{\"id\":").append(QByteArray::number(id));
+    json.append(",\"firstName\":\"").append(pick(m_random, FirstNames));
+    json.append("\",\"lastName\":\"").append(pick(m_random, LastNames));
+    json.append("\",\"address\":\"").append(pick(m_random, Streets)).append(' ');
+    json.append(QByteArray::number(1 + m_random() % 120));
+    if (m_random() % 3 == 0) {
+        json.append(' ').append(char('A' + m_random() % 4)).append(' ').append(QByteArray::number(1 + m_random() % 40));
+    }
+    json.append(", ").append(city.postcode).append(' ').append(city.city);
+    json.append("\",\"createdAt\":\"").append(created);
+    json.append("\",\"updatedAt\":\"").append(updated);
+    json.append("\"}");
+    return json;
+}
+
+/**
+ * Next timestamp, seconds to hours after the previous one
+ */
+QByteArray PayloadGenerator::timestamp()
+{
+    m_clock += 1000 + qint64(m_random() % (3 * 60 * 60 * 1000));
+    return QDateTime::fromMSecsSinceEpoch(m_clock, QTimeZone::UTC).toString(Qt::ISODateWithMs).toUtf8();
+}
@@ -0,0 +1,39 @@
+/**
+ * PayloadGenerator - Synthetic customer data for benchmarks and the mock backend
+ *
+ * Produces deterministic customers with Finnish names and addresses
+ * (ä, ö, å in roughly the share seen in real data) and ISO 8601
+ * timestamps with milliseconds, in the same JSON shape the backend
+ * returns, so the parse path sees realistic UTF-8 and string lengths.
+ */
+
+#ifndef PAYLOADGENERATOR_H
+#define PAYLOADGENERATOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <random>
+#include "customer.h"
+
+class PayloadGenerator
+{
+public:
+    explicit PayloadGenerator(quint32 seed = 20260101);
+
+    // GET /api/customers body: {"success":true,"data":[...],"count":N}
+    QByteArray customersResponse(int count);
+
+    // 400 body of a rejected batch import with one error per row
+    QByteArray batchErrorResponse(int count);
+
+    QList<Customer> customers(int count);
+
+private:
+    QByteArray customerJson(int id);
+    QByteArray timestamp();
+
+    std::mt19937 m_random;
+    qint64 m_clock;  // Milliseconds since epoch, advances per customer
+};
+
+#endif // PAYLOADGENERATOR_H
@@ -0,0 +1,119 @@
+/**
+ * servereventparser.cpp - Event stream parser implementation
+ *
+ * Complete lines are handled as they arrive; only the trailing partial
+ * line and the fields of the event being read are buffered.
+ */
+
+#include "servereventparser.h"
+
+/**
+ * Constructor
+ */
+ServerEventParser::ServerEventParser()
+    : m_skipLineFeed(false)
+    , m_hasData(false)
+    , m_retryMs(-1)
+{
+}
+
+/**
+ * Append body bytes and parse every complete line
+ *
+ * @param data - Next piece of the body (any size, any boundary)
+ */
+void ServerEventParser::feed(const QByteArray &data)
+{
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < data.size(); ++i) {
+        const char c = data.at(i);
+        if (c == '\n' && m_skipLineFeed && i == start && m_buffer.isEmpty()) {
+            m_skipLineFeed = false;
+            start = i + 1;  // Second half of a CRLF split across feeds
+            continue;
+        }
+        m_skipLineFeed = false;
+        if (c != '\n' && c != '\r') {
+            continue;
+        }
+
+        m_buffer.append(data.constData() + start, i - start);
+        handleLine(m_buffer);
+        m_buffer.clear();
+
+        if (c == '\r') {
+            if (i + 1 < data.size() && data.at(i + 1) == '\n') {
+                ++i;
+            } else if (i + 1 == data.size()) {
+                m_skipLineFeed = true;
+            }
+        }
+        start = i + 1;
+    }
+    m_buffer.append(data.constData() + start, data.size() - start);
+}
+
+QList<ServerEventParser::Event> ServerEventParser::takeEvents()
+{
+    QList<Event> events;
+    events.swap(m_events);
+    return events;
+}
+
+void ServerEventParser::handleLine(const QByteArray &line)
+{
+    if (line.isEmpty()) {
+        dispatch();
+        return;
+    }
+    if (line.startsWith(':')) {
+        return;  // Comment
+    }
+
+    const qsizetype colon = line.indexOf(':');
+    const QByteArray field = colon < 0 ? line : line.left(colon);
+    QByteArray value;
+    if (colon >= 0) {
+        value = line.mid(colon + 1);
+        if (value.startsWith(' ')) {
+            value.remove(0, 1);
+        }
+    }
+
+    if (field == "event") {
+        m_type = value;
+    } else if (field == "data") {
+        m_data += value;
+        m_data += '\n';
+        m_hasData = true;
+    } else if (field == "id") {
+        if (!value.contains('\0')) {
+            m_lastEventId = value;
+        }
+    } else if (field == "retry") {
+        bool ok = false;
+        const int retryMs = value.toInt(&ok);
+        if (ok && retryMs >= 0) {
+            m_retryMs = retryMs;
+        }
+    }
+}
+
+/**
+ * Blank line: the fields read so far form one event (none without data)
+ */
+void ServerEventParser::dispatch()
+{
+    if (m_hasData) {
+        Event event;
+        event.type = m_type.isEmpty() ? QByteArray("message") : m_type;
+        event.data = m_data;
+        event.data.chop(1);  // Trailing '\n' of the last data: line
+        event.id = m_lastEventId;
+        m_events.append(event);
+    }
+
+    m_type.clear();
+    m_data.clear();
+    m_hasData = false;
+}
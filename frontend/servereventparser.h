@@ -0,0 +1,53 @@
+/**
+ * ServerEventParser - Incremental parser for text/event-stream bodies
+ *
+ * Splits a Server-Sent Events stream (GET /api/customers/events) into
+ * events as the bytes arrive, following the WHATWG event stream rules:
+ * "field: value" lines, events end at a blank line, lines starting with
+ * ':' are comments (keep-alive pings), and id / retry persist across
+ * events. Lines may end in LF, CR or CRLF.
+ */
+
+#ifndef SERVEREVENTPARSER_H
+#define SERVEREVENTPARSER_H
+
+#include <QByteArray>
+#include <QList>
+
+class ServerEventParser
+{
+public:
+    struct Event
+    {
+        QByteArray type;  // "message" if the event had no event: field
+        QByteArray data;  // data: lines joined with '\n'
+        QByteArray id;    // Last event id in effect for this event
+    };
+
+    ServerEventParser();
+
+    // Feed the next piece of the body
+    void feed(const QByteArray &data);
+
+    // Take the events completed so far
+    QList<Event> takeEvents();
+
+    // Resume state
+    QByteArray lastEventId() const { return m_lastEventId; }
+    int retryMs() const { return m_retryMs; }  // -1 until the server sends retry:
+
+private:
+    void handleLine(const QByteArray &line);
+    void dispatch();
+
+    QByteArray m_buffer;      // Incomplete line
+    bool m_skipLineFeed;      // Last line ended in CR; drop a following LF
+    QByteArray m_type;
+    QByteArray m_data;
+    bool m_hasData;
+    QByteArray m_lastEventId;
+    int m_retryMs;
+    QList<Event> m_events;
+};
+
+#endif // SERVEREVENTPARSER_H
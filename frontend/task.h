@@ -0,0 +1,511 @@
+/**
+ * Task - Lazily started C++20 coroutine with a result
+ *
+ * A function returning Task<T> is a coroutine: it runs when the task is
+ * awaited (co_await task) or started with then() / start(), suspends at
+ * each co_await and resumes the coroutine awaiting it when it finishes.
+ * A Task owns its coroutine; destroying one that is suspended destroys
+ * the coroutine with it, which is how unfinished work is cancelled.
+ *
+ * whenAll() / whenAny() start several tasks at once and wait for all of
+ * them or for the first one; whenAny() destroys the others. Cancellation
+ * tokens tell a running operation to stop early.
+ *
+ * An exception leaving a coroutine is rethrown where the task is awaited;
+ * whenAll() rethrows the first one once every task has finished, whenAny()
+ * the winner's. Nothing awaits a task run with then() / start(), so an
+ * exception escaping one terminates the program.
+ *
+ * Tasks, tokens and sources are used from one thread (the thread of the
+ * event loop that resumes them); nothing here is synchronized.
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template<typename T = void>
+class Task;
+
+namespace TaskDetail {
+
+// A finished coroutine resumes whoever awaited it (symmetric transfer,
+// so long chains of tasks do not grow the stack)
+struct FinalAwaiter
+{
+    bool await_ready() const noexcept { return false; }
+
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+    {
+        const std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase
+{
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template<typename T>
+struct Promise : PromiseBase
+{
+    std::optional<T> value;
+
+    template<typename Value>
+    void return_value(Value &&result) { value.emplace(std::forward<Value>(result)); }
+
+    T take()
+    {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template<>
+struct Promise<void> : PromiseBase
+{
+    void return_void() const noexcept {}
+
+    void take()
+    {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+// Fire-and-forget coroutine: starts at once and frees itself when done
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }  // Nobody to rethrow to
+    };
+};
+
+template<typename T, typename Callback>
+Detached runDetached(Task<T> task, Callback callback);
+
+} // namespace TaskDetail
+
+template<typename T>
+class Task
+{
+public:
+    struct promise_type : TaskDetail::Promise<T>
+    {
+        Task get_return_object() noexcept
+        {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+    };
+
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() { reset(); }
+
+    bool isValid() const { return bool(m_handle); }
+    bool isDone() const { return m_handle && m_handle.done(); }
+
+    // Start the task and wait for its result (once)
+    auto operator co_await() & noexcept { return Awaiter{ m_handle }; }
+    auto operator co_await() && noexcept { return Awaiter{ m_handle }; }
+
+    // Run the task without awaiting it; callback gets the result (nothing
+    // for Task<void>). The coroutine frees itself once finished.
+    template<typename Callback>
+    void then(Callback callback) &&
+    {
+        TaskDetail::runDetached(std::move(*this), std::move(callback));
+    }
+    void start() &&
+    {
+        if constexpr (std::is_void_v<T>) {
+            std::move(*this).then([]() {});
+        } else {
+            std::move(*this).then([](T) {});
+        }
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    struct Awaiter
+    {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return handle.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+        {
+            handle.promise().continuation = awaiting;
+            return handle;  // Start (or continue) the task
+        }
+        T await_resume() const { return handle.promise().take(); }
+    };
+
+    void reset()
+    {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace TaskDetail {
+
+template<typename T, typename Callback>
+Detached runDetached(Task<T> task, Callback callback)
+{
+    if constexpr (std::is_void_v<T>) {
+        co_await std::move(task);
+        callback();
+    } else {
+        callback(co_await std::move(task));
+    }
+}
+
+// Shared by the tasks of one whenAll() / whenAny()
+struct WhenState
+{
+    std::size_t remaining = 0;           // whenAll: unfinished tasks, +1 until all are started
+    std::size_t winner = SIZE_MAX;       // whenAny: index of the first task to finish
+    bool any = false;
+    bool suspended = false;              // whenAny: the awaiting coroutine is suspended
+    std::exception_ptr exception;        // First task to fail; it still counts as finished
+    std::coroutine_handle<> parent;
+};
+
+// Awaits one task, stores its result and tells the parent at final suspend
+struct Notifier
+{
+    struct promise_type
+    {
+        WhenState *state = nullptr;
+        std::size_t index = 0;
+
+        Notifier get_return_object() noexcept
+        {
+            return Notifier(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        auto final_suspend() const noexcept
+        {
+            struct Final
+            {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+                {
+                    WhenState &state = *handle.promise().state;
+                    if (state.any) {
+                        if (state.winner == SIZE_MAX) {
+                            state.winner = handle.promise().index;
+                            if (state.suspended) {
+                                return state.parent;
+                            }
+                        }
+                        return std::noop_coroutine();
+                    }
+                    return --state.remaining == 0 ? state.parent : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return Final{};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept
+        {
+            if (!state->exception) {
+                state->exception = std::current_exception();
+            }
+        }
+    };
+
+    explicit Notifier(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Notifier(Notifier &&other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Notifier(const Notifier &) = delete;
+    Notifier &operator=(const Notifier &) = delete;
+    Notifier &operator=(Notifier &&) = delete;
+    ~Notifier()
+    {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T>
+Notifier notify(Task<T> &task, std::optional<T> &result)
+{
+    result.emplace(co_await task);
+}
+
+// Starts every notifier, then suspends unless they all finished already
+struct WhenAwaiter
+{
+    WhenState &state;
+    std::vector<Notifier> &notifiers;
+
+    bool await_ready() const noexcept { return notifiers.empty(); }
+    bool await_suspend(std::coroutine_handle<> parent) const
+    {
+        state.parent = parent;
+        for (std::size_t i = 0; i < notifiers.size(); ++i) {
+            notifiers[i].handle.promise().state = &state;
+            notifiers[i].handle.promise().index = i;
+        }
+        for (Notifier &notifier : notifiers) {
+            if (state.any && state.winner != SIZE_MAX) {
+                return false;  // Finished while starting; later tasks never run
+            }
+            notifier.handle.resume();
+        }
+        if (state.any) {
+            state.suspended = state.winner == SIZE_MAX;
+            return state.suspended;
+        }
+        return --state.remaining != 0;
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace TaskDetail
+
+/**
+ * Run tasks concurrently and wait for all of them
+ * They start in order within one call, so requests they make in their
+ * first step go out together
+ *
+ * @return Task - Results in the order of the tasks
+ */
+template<typename T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks)
+{
+    std::vector<std::optional<T>> results(tasks.size());
+    std::vector<TaskDetail::Notifier> notifiers;
+    notifiers.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        notifiers.push_back(TaskDetail::notify(tasks[i], results[i]));
+    }
+
+    TaskDetail::WhenState state;
+    state.remaining = tasks.size() + 1;
+    co_await TaskDetail::WhenAwaiter{ state, notifiers };
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+
+    std::vector<T> values;
+    values.reserve(results.size());
+    for (std::optional<T> &result : results) {
+        values.push_back(std::move(*result));
+    }
+    co_return values;
+}
+
+template<typename... Ts>
+Task<std::tuple<Ts...>> whenAll(Task<Ts>... tasks)
+{
+    std::tuple<std::optional<Ts>...> results;
+    std::vector<TaskDetail::Notifier> notifiers;
+    notifiers.reserve(sizeof...(Ts));
+    std::apply([&](auto &...result) {
+        (notifiers.push_back(TaskDetail::notify(tasks, result)), ...);
+    }, results);
+
+    TaskDetail::WhenState state;
+    state.remaining = sizeof...(Ts) + 1;
+    co_await TaskDetail::WhenAwaiter{ state, notifiers };
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+
+    co_return std::apply([](auto &...result) {
+        return std::tuple<Ts...>(std::move(*result)...);
+    }, results);
+}
+
+/**
+ * Run tasks concurrently until the first one finishes
+ * The others are destroyed (and so cancelled) before this returns
+ *
+ * @param tasks - At least one task
+ * @return Task - Index of the first task to finish and its result
+ */
+template<typename T>
+Task<std::pair<std::size_t, T>> whenAny(std::vector<Task<T>> tasks)
+{
+    assert(!tasks.empty());
+
+    std::vector<std::optional<T>> results(tasks.size());
+    std::vector<TaskDetail::Notifier> notifiers;
+    notifiers.reserve(tasks.size());
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        notifiers.push_back(TaskDetail::notify(tasks[i], results[i]));
+    }
+
+    TaskDetail::WhenState state;
+    state.any = true;
+    co_await TaskDetail::WhenAwaiter{ state, notifiers };
+    if (state.exception) {
+        tasks.clear();
+        std::rethrow_exception(state.exception);  // Only the winner can have failed
+    }
+
+    const std::size_t winner = state.winner;
+    T value = std::move(*results[winner]);
+    tasks.clear();
+    co_return std::pair<std::size_t, T>(winner, std::move(value));
+}
+
+/**
+ * CancellationToken - Read side of a CancellationSource
+ * A default-constructed token is never cancelled
+ */
+class CancellationToken
+{
+    struct State;
+
+public:
+    CancellationToken() = default;
+
+    bool isCancelled() const { return m_state && m_state->cancelled; }
+    bool canBeCancelled() const { return bool(m_state); }
+
+    // Keeps a callback registered until destroyed (or reset)
+    class Registration
+    {
+    public:
+        Registration() = default;
+        Registration(Registration &&other) noexcept
+            : m_state(std::move(other.m_state)), m_id(other.m_id) {}
+        Registration &operator=(Registration &&other) noexcept
+        {
+            if (this != &other) {
+                reset();
+                m_state = std::move(other.m_state);
+                m_id = other.m_id;
+            }
+            return *this;
+        }
+        Registration(const Registration &) = delete;
+        Registration &operator=(const Registration &) = delete;
+        ~Registration() { reset(); }
+
+        void reset()
+        {
+            if (const std::shared_ptr<State> state = m_state.lock()) {
+                std::erase_if(state->callbacks, [this](const auto &entry) { return entry.first == m_id; });
+            }
+            m_state.reset();
+        }
+
+    private:
+        friend class CancellationToken;
+        std::weak_ptr<State> m_state;
+        std::size_t m_id = 0;
+    };
+
+    // Call callback when the source is cancelled (right away if it
+    // already is)
+    Registration onCancel(std::function<void()> callback) const
+    {
+        Registration registration;
+        if (!m_state) {
+            return registration;
+        }
+        if (m_state->cancelled) {
+            callback();
+            return registration;
+        }
+        registration.m_state = m_state;
+        registration.m_id = ++m_state->nextId;
+        m_state->callbacks.emplace_back(registration.m_id, std::move(callback));
+        return registration;
+    }
+
+private:
+    friend class CancellationSource;
+    struct State
+    {
+        bool cancelled = false;
+        std::size_t nextId = 0;
+        std::vector<std::pair<std::size_t, std::function<void()>>> callbacks;
+    };
+
+    explicit CancellationToken(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+
+    std::shared_ptr<State> m_state;
+};
+
+/**
+ * CancellationSource - Cancels the tokens it hands out
+ */
+class CancellationSource
+{
+public:
+    CancellationSource() : m_state(std::make_shared<CancellationToken::State>()) {}
+
+    CancellationToken token() const { return CancellationToken(m_state); }
+    bool isCancelled() const { return m_state->cancelled; }
+
+    // Callbacks run in registration order; one may unregister others
+    void cancel()
+    {
+        if (m_state->cancelled) {
+            return;
+        }
+        m_state->cancelled = true;
+        const std::shared_ptr<CancellationToken::State> state = m_state;
+        while (!state->callbacks.empty()) {
+            std::function<void()> callback = std::move(state->callbacks.front().second);
+            state->callbacks.erase(state->callbacks.begin());
+            callback();
+        }
+    }
+
+private:
+    std::shared_ptr<CancellationToken::State> m_state;
+};
+
+#endif // TASK_H
@@ -0,0 +1,142 @@
+/**
+ * tst_apiclient.cpp - ApiClient request handling against MockBackend
+ *
+ * The mock answers after a fixed latency, so a request is still in
+ * flight when the test cancels or aborts it.
+ */
+
+#include <QtTest>
+#include <QSignalSpy>
+#include <optional>
+#include "apiclient.h"
+#include "mockbackend.h"
+
+namespace {
+
+const int LatencyMs = 300;
+
+} // namespace
+
+class ApiClientTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void abortRequestAbortsGet();
+    void cancelledTaskAbortsRequest();
+    void cancelledTaskKeepsSharedRequest();
+    void cancelledTokenSendsNothing();
+
+private:
+    MockBackend *m_backend = nullptr;
+    ApiClient *m_client = nullptr;
+};
+
+void ApiClientTest::init()
+{
+    m_backend = new MockBackend(this);
+    m_backend->seedCustomers(10);
+    MockBackend::Options options;
+    options.latencyMs = LatencyMs;
+    m_backend->setOptions(options);
+    QVERIFY2(m_backend->listen(), qPrintable(m_backend->errorString()));
+
+    m_client = new ApiClient(this);
+    m_client->setPrewarmEnabled(false);
+    m_client->setLookupBatchingEnabled(false);  // One GET /api/customers/{id} per lookup
+    m_client->setBaseUrl(m_backend->baseUrl());
+}
+
+void ApiClientTest::cleanup()
+{
+    delete m_client;
+    m_client = nullptr;
+    delete m_backend;
+    m_backend = nullptr;
+}
+
+void ApiClientTest::abortRequestAbortsGet()
+{
+    QSignalSpy finished(m_client, &ApiClient::requestFinished);
+    QSignalSpy received(m_client, &ApiClient::customerReceived);
+
+    m_client->getCustomerById(1);
+    const quint64 requestId = m_client->lastRequestId();
+    m_client->abortRequest(requestId);
+
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(0).toULongLong(), requestId);
+    QCOMPARE(finished.at(0).at(2).value<QNetworkReply::NetworkError>(), QNetworkReply::OperationCanceledError);
+
+    QTest::qWait(2 * LatencyMs);
+    QCOMPARE(received.count(), 0);
+    QCOMPARE(finished.count(), 1);
+}
+
+void ApiClientTest::cancelledTaskAbortsRequest()
+{
+    QSignalSpy finished(m_client, &ApiClient::requestFinished);
+    QSignalSpy received(m_client, &ApiClient::customerReceived);
+
+    CancellationSource source;
+    std::optional<ApiResult<Customer>> result;
+    m_client->fetchCustomer(1, source.token()).then([&](ApiResult<Customer> value) { result = value; });
+    const quint64 requestId = m_client->lastRequestId();
+    QVERIFY(!result);
+
+    source.cancel();
+    QVERIFY(result);
+    QVERIFY(result->error().isCancelled());
+
+    // The reply itself was aborted, not just left unanswered
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(0).toULongLong(), requestId);
+    QCOMPARE(finished.at(0).at(2).value<QNetworkReply::NetworkError>(), QNetworkReply::OperationCanceledError);
+
+    QTest::qWait(2 * LatencyMs);
+    QCOMPARE(received.count(), 0);
+    QCOMPARE(finished.count(), 1);
+}
+
+void ApiClientTest::cancelledTaskKeepsSharedRequest()
+{
+    QSignalSpy finished(m_client, &ApiClient::requestFinished);
+
+    CancellationSource first;
+    CancellationSource second;
+    std::optional<ApiResult<Customer>> firstResult;
+    std::optional<ApiResult<Customer>> secondResult;
+    m_client->fetchCustomer(2, first.token()).then([&](ApiResult<Customer> value) { firstResult = value; });
+    m_client->fetchCustomer(2, second.token()).then([&](ApiResult<Customer> value) { secondResult = value; });
+
+    first.cancel();
+    QVERIFY(firstResult);
+    QVERIFY(firstResult->error().isCancelled());
+    QCOMPARE(finished.count(), 0);  // The coalesced GET keeps going
+
+    QTRY_VERIFY(secondResult);
+    QVERIFY2(secondResult->isOk(), qPrintable(secondResult->error().message));
+    QCOMPARE(secondResult->value().getId(), 2);
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.at(0).at(2).value<QNetworkReply::NetworkError>(), QNetworkReply::NoError);
+}
+
+void ApiClientTest::cancelledTokenSendsNothing()
+{
+    CancellationSource source;
+    source.cancel();
+
+    std::optional<ApiResult<Customer>> result;
+    m_client->fetchCustomer(3, source.token()).then([&](ApiResult<Customer> value) { result = value; });
+    QVERIFY(result);
+    QVERIFY(result->error().isCancelled());
+
+    QTest::qWait(2 * LatencyMs);
+    QCOMPARE(m_backend->requestCount(), quint64(0));
+}
+
+QTEST_GUILESS_MAIN(ApiClientTest)
+
+#include "tst_apiclient.moc"
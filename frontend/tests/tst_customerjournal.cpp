@@ -0,0 +1,303 @@
+/**
+ * tst_customerjournal.cpp - CustomerJournal replay, recovery, compaction and coalescing
+ *
+ * Each test works on its own file in a temporary directory. Damaged files
+ * are made by editing the bytes the journal wrote, measured from the file
+ * size after each append (every record is flushed to the OS right away).
+ */
+
+#include <QtTest>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include "customerjournal.h"
+
+namespace {
+
+// Mirror the constants in customerjournal.cpp
+const qint64 HeaderSize = 8;
+const qint64 CompactSize = 4 * 1024 * 1024;
+
+Customer makeCustomer(const QString &firstName, const QString &lastName, const QString &address = "Isokatu 1")
+{
+    Customer customer;
+    customer.setFirstName(firstName);
+    customer.setLastName(lastName);
+    customer.setAddress(address);
+    return customer;
+}
+
+qint64 fileSize(const QString &path)
+{
+    return QFileInfo(path).size();
+}
+
+void rewriteFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(data), data.size());
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+} // namespace
+
+class CustomerJournalTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void pendingSurvivesReopen();
+    void tornRecordIsCutOff();
+    void corruptRecordStopsReplay();
+    void unreadableFileIsMovedAside();
+    void acknowledgeTruncates();
+    void assignedIdSurvivesReopen();
+    void compactionKeepsPendingRecords();
+    void coalesceFoldsPerCustomer();
+
+private:
+    QString journalPath() const;
+
+    QTemporaryDir m_dir;
+};
+
+void CustomerJournalTest::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+}
+
+QString CustomerJournalTest::journalPath() const
+{
+    return m_dir.filePath(QString::fromLatin1(QTest::currentTestFunction()) + ".log");
+}
+
+void CustomerJournalTest::pendingSurvivesReopen()
+{
+    const QString path = journalPath();
+    quint64 update = 0;
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        journal.append(CustomerJournal::CreateOperation, -1, makeCustomer("Aino", "Virtanen"));
+        update = journal.append(CustomerJournal::UpdateOperation, 7, makeCustomer("Eero", "Korhonen"));
+        QVERIFY(journal.needsSync());
+        QVERIFY(journal.sync());
+        QVERIFY(!journal.needsSync());
+    }
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 2);
+    QCOMPARE(journal.lowestProvisionalId(), -1);
+    QCOMPARE(journal.pendingSequences(7), QList<quint64>({ update }));
+    QVERIFY(journal.append(CustomerJournal::DeleteOperation, 8) > update);  // Sequences carry on
+
+    const QList<CustomerJournal::Mutation> mutations = journal.coalesce();
+    QCOMPARE(mutations.count(), 3);
+    QCOMPARE(mutations.at(0).operation, CustomerJournal::CreateOperation);
+    QCOMPARE(mutations.at(0).customer.getLastName(), QString("Virtanen"));
+    QCOMPARE(mutations.at(1).customer.getFirstName(), QString("Eero"));
+    QCOMPARE(mutations.at(1).customer.getId(), 7);
+}
+
+void CustomerJournalTest::tornRecordIsCutOff()
+{
+    const QString path = journalPath();
+    qint64 intactSize = 0;
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        journal.append(CustomerJournal::UpdateOperation, 1, makeCustomer("Aino", "Virtanen"));
+        intactSize = fileSize(path);
+        journal.append(CustomerJournal::UpdateOperation, 2, makeCustomer("Eero", "Korhonen"));
+    }
+
+    // Crash halfway through writing the second record
+    QFile::resize(path, fileSize(path) - 5);
+
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        QCOMPARE(journal.pendingCount(), 1);
+        QCOMPARE(journal.pendingSequences(2), QList<quint64>());
+        QCOMPARE(fileSize(path), intactSize);
+
+        // New records follow the intact ones, not the torn bytes
+        journal.append(CustomerJournal::DeleteOperation, 3);
+    }
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 2);
+    QCOMPARE(journal.pendingSequences(3).count(), 1);
+}
+
+void CustomerJournalTest::corruptRecordStopsReplay()
+{
+    const QString path = journalPath();
+    qint64 intactSize = 0;
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        journal.append(CustomerJournal::UpdateOperation, 1, makeCustomer("Aino", "Virtanen"));
+        intactSize = fileSize(path);
+        journal.append(CustomerJournal::UpdateOperation, 2, makeCustomer("Eero", "Korhonen"));
+        journal.append(CustomerJournal::UpdateOperation, 3, makeCustomer("Helmi", "Mäkinen"));
+    }
+
+    // Flip a bit in the second record's payload so its checksum fails
+    QByteArray data = readFile(path);
+    data[intactSize + 6 + 10] = char(data.at(intactSize + 6 + 10) ^ 0x01);
+    rewriteFile(path, data);
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 1);  // Nothing after the bad record is trusted
+    QCOMPARE(journal.pendingSequences(1).count(), 1);
+    QCOMPARE(journal.pendingSequences(3).count(), 0);
+    QCOMPARE(fileSize(path), intactSize);
+}
+
+void CustomerJournalTest::unreadableFileIsMovedAside()
+{
+    const QString path = journalPath();
+    rewriteFile(path, QByteArray("not a journal at all"));
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 0);
+    QCOMPARE(readFile(path + ".bad"), QByteArray("not a journal at all"));
+    QCOMPARE(readFile(path).left(4), QByteArray("PKCJ"));
+    QCOMPARE(fileSize(path), HeaderSize);
+}
+
+void CustomerJournalTest::acknowledgeTruncates()
+{
+    const QString path = journalPath();
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+
+    const quint64 first = journal.append(CustomerJournal::UpdateOperation, 1, makeCustomer("Aino", "Virtanen"));
+    const quint64 second = journal.append(CustomerJournal::DeleteOperation, 2);
+    journal.acknowledge({ first });
+    QCOMPARE(journal.pendingCount(), 1);
+    QVERIFY(fileSize(path) > HeaderSize);  // Acknowledgement appended
+
+    journal.acknowledge({ second, 12345 });  // Unknown sequences are ignored
+    QCOMPARE(journal.pendingCount(), 0);
+    QCOMPARE(fileSize(path), HeaderSize);
+
+    journal.close();
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 0);
+}
+
+void CustomerJournalTest::assignedIdSurvivesReopen()
+{
+    const QString path = journalPath();
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        const quint64 create = journal.append(CustomerJournal::CreateOperation, -1, makeCustomer("Aino", "Virtanen"));
+        journal.append(CustomerJournal::UpdateOperation, -1, makeCustomer("Aino", "Korhonen"));
+        journal.acknowledge({ create }, 42);
+        QCOMPARE(journal.resolveId(-1), 42);
+    }
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 1);
+    QCOMPARE(journal.resolveId(-1), 42);
+    QCOMPARE(journal.lowestProvisionalId(), -1);  // Not handed out again
+
+    const QList<CustomerJournal::Mutation> mutations = journal.coalesce();
+    QCOMPARE(mutations.count(), 1);
+    QCOMPARE(mutations.at(0).operation, CustomerJournal::UpdateOperation);
+    QCOMPARE(mutations.at(0).id, 42);
+    QCOMPARE(mutations.at(0).customer.getId(), 42);
+}
+
+void CustomerJournalTest::compactionKeepsPendingRecords()
+{
+    const QString path = journalPath();
+    const Customer large = makeCustomer("Aino", "Virtanen", QString(60000, QLatin1Char('x')));
+    {
+        CustomerJournal journal(path);
+        QVERIFY(journal.open());
+        const quint64 create = journal.append(CustomerJournal::CreateOperation, -1, makeCustomer("Eero", "Korhonen"));
+        journal.append(CustomerJournal::UpdateOperation, -1, makeCustomer("Eero", "Heikkinen"));
+        journal.acknowledge({ create }, 42);
+        journal.append(CustomerJournal::DeleteOperation, 7);
+
+        // Acknowledged records pile up until the file passes the limit
+        qint64 largest = 0;
+        for (int i = 0; i < 80; ++i) {
+            journal.acknowledge({ journal.append(CustomerJournal::UpdateOperation, 8, large) });
+            largest = qMax(largest, fileSize(path));
+        }
+        QVERIFY(largest > CompactSize - 2 * 60000);
+        QVERIFY(fileSize(path) < CompactSize / 2);
+        QCOMPARE(journal.pendingCount(), 2);
+
+        // Still appendable after the file was replaced
+        journal.append(CustomerJournal::UpdateOperation, 9, makeCustomer("Helmi", "Mäkinen"));
+    }
+
+    CustomerJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.pendingCount(), 3);
+    QCOMPARE(journal.resolveId(-1), 42);  // Mapping rewritten with the pending update
+    QCOMPARE(journal.pendingSequences(42).count(), 1);
+    QCOMPARE(journal.pendingSequences(7).count(), 1);
+    QCOMPARE(journal.pendingSequences(8).count(), 0);
+    QCOMPARE(journal.pendingSequences(9).count(), 1);
+}
+
+void CustomerJournalTest::coalesceFoldsPerCustomer()
+{
+    CustomerJournal journal(journalPath());
+    QVERIFY(journal.open());
+
+    const quint64 create = journal.append(CustomerJournal::CreateOperation, -1, makeCustomer("Aino", "Virtanen"));
+    journal.append(CustomerJournal::UpdateOperation, 3, makeCustomer("Eero", "Korhonen"));
+    journal.append(CustomerJournal::UpdateOperation, -1, makeCustomer("Aino", "Laine"));
+    journal.append(CustomerJournal::UpdateOperation, 4, makeCustomer("Helmi", "Mäkinen"));
+    journal.append(CustomerJournal::CreateOperation, -2, makeCustomer("Onni", "Laine"));
+    journal.append(CustomerJournal::DeleteOperation, 3);
+    const quint64 last = journal.append(CustomerJournal::UpdateOperation, 4, makeCustomer("Helmi", "Heikkinen"));
+    journal.append(CustomerJournal::DeleteOperation, -2);
+
+    const QList<CustomerJournal::Mutation> mutations = journal.coalesce();
+    QCOMPARE(mutations.count(), 4);  // In order of each customer's first record
+
+    QCOMPARE(mutations.at(0).operation, CustomerJournal::CreateOperation);  // Create with the last fields
+    QCOMPARE(mutations.at(0).id, -1);
+    QCOMPARE(mutations.at(0).customer.getLastName(), QString("Laine"));
+    QCOMPARE(mutations.at(0).sequences.count(), 2);
+
+    QCOMPARE(mutations.at(1).operation, CustomerJournal::DeleteOperation);  // Update then delete
+    QCOMPARE(mutations.at(1).id, 3);
+
+    QCOMPARE(mutations.at(2).operation, CustomerJournal::UpdateOperation);  // Last update wins
+    QCOMPARE(mutations.at(2).customer.getLastName(), QString("Heikkinen"));
+
+    QCOMPARE(mutations.at(3).operation, CustomerJournal::NoOperation);  // Never reached the server
+    QCOMPARE(mutations.at(3).sequences.count(), 2);
+
+    // Records in flight are left out
+    const QList<CustomerJournal::Mutation> remaining = journal.coalesce({ create, last });
+    QCOMPARE(remaining.at(0).id, -1);
+    QCOMPARE(remaining.at(0).operation, CustomerJournal::UpdateOperation);
+    QCOMPARE(remaining.at(2).customer.getLastName(), QString("Mäkinen"));
+}
+
+QTEST_APPLESS_MAIN(CustomerJournalTest)
+
+#include "tst_customerjournal.moc"
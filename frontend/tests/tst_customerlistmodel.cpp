@@ -0,0 +1,229 @@
+/**
+ * tst_customerlistmodel.cpp - CustomerListModel sorting, row merging and deletes
+ *
+ * Rows are loaded directly (setCustomers/appendCustomers) or through the
+ * API client's signals, so the client is never asked for anything. QAbstractItemModelTester checks
+ * that every change is announced with consistent signals.
+ */
+
+#include <QtTest>
+#include <QAbstractItemModelTester>
+#include <QSignalSpy>
+#include "apiclient.h"
+#include "customerlistmodel.h"
+
+namespace {
+
+Customer makeCustomer(int id, const QString &firstName, const QString &lastName)
+{
+    Customer customer;
+    customer.setId(id);
+    customer.setFirstName(firstName);
+    customer.setLastName(lastName);
+    customer.setAddress(QString("Isokatu %1, 90100 Oulu").arg(id));
+    customer.setCreatedAt(QDateTime::fromMSecsSinceEpoch(1700000000000LL + id, QTimeZone::UTC));
+    customer.setUpdatedAt(customer.getCreatedAt());
+    return customer;
+}
+
+// Delta sync rows, as ApiClient delivers them
+QList<CustomerView> syncViews(const QList<Customer> &customers)
+{
+    QJsonArray data;
+    for (const Customer &customer : customers) {
+        data.append(customer.toJson());
+    }
+    const QByteArray body = QJsonDocument(QJsonObject{ { "success", true }, { "data", data } }).toJson();
+    return CustomerView::parseList(body).customers;
+}
+
+QList<int> viewIds(const CustomerListModel &model)
+{
+    QList<int> ids;
+    for (int row = 0; row < model.rowCount(); ++row) {
+        ids.append(model.customerAt(row).getId());
+    }
+    return ids;
+}
+
+} // namespace
+
+class CustomerListModelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void sortKeepsPersistentIndexes();
+    void appendMergesIntoSortOrder();
+    void appendUnsortedKeepsStorageOrder();
+    void updateMovesRowInSortOrder();
+    void deltaSyncMergesChanges();
+    void deletesCompactTheStore();
+
+private:
+    ApiClient *m_client = nullptr;
+    CustomerListModel *m_model = nullptr;
+    QAbstractItemModelTester *m_tester = nullptr;
+};
+
+void CustomerListModelTest::init()
+{
+    m_client = new ApiClient(this);
+    m_client->setPrewarmEnabled(false);
+    m_model = new CustomerListModel(m_client, this);
+    m_tester = new QAbstractItemModelTester(m_model, QAbstractItemModelTester::FailureReportingMode::QtTest, this);
+}
+
+void CustomerListModelTest::cleanup()
+{
+    delete m_tester;
+    m_tester = nullptr;
+    delete m_model;
+    m_model = nullptr;
+    delete m_client;
+    m_client = nullptr;
+}
+
+void CustomerListModelTest::sortKeepsPersistentIndexes()
+{
+    m_model->setCustomers(QList<Customer>{
+        makeCustomer(1, "Aino", "Virtanen"),
+        makeCustomer(2, "Eero", "Korhonen"),
+        makeCustomer(3, "Helmi", "Äijälä"),
+        makeCustomer(4, "Onni", "Mäkinen")
+    });
+
+    const QPersistentModelIndex current = m_model->index(1, CustomerListModel::LastNameColumn);
+    const QPersistentModelIndex other = m_model->index(3, CustomerListModel::IdColumn);
+    QCOMPARE(current.data().toString(), QString("Korhonen"));
+
+    m_model->sort(CustomerListModel::LastNameColumn, Qt::DescendingOrder);
+
+    QVERIFY(current.isValid());
+    QCOMPARE(current.data().toString(), QString("Korhonen"));
+    QCOMPARE(current.column(), int(CustomerListModel::LastNameColumn));
+    QCOMPARE(m_model->customerAt(current.row()).getId(), 2);
+    QCOMPARE(m_model->customerAt(other.row()).getId(), 4);
+    QCOMPARE(other.column(), int(CustomerListModel::IdColumn));
+}
+
+void CustomerListModelTest::appendMergesIntoSortOrder()
+{
+    m_model->setCustomers(QList<Customer>{
+        makeCustomer(1, "Bertta", "A"),
+        makeCustomer(2, "Eino", "B"),
+        makeCustomer(3, "Kalle", "C")
+    });
+    m_model->sort(CustomerListModel::FirstNameColumn, Qt::AscendingOrder);
+    const QPersistentModelIndex eino = m_model->index(1, 0);
+
+    QSignalSpy layoutChanged(m_model, &QAbstractItemModel::layoutChanged);
+    QSignalSpy rowsInserted(m_model, &QAbstractItemModel::rowsInserted);
+    m_model->appendCustomers(QList<Customer>{
+        makeCustomer(4, "Matti", "D"),
+        makeCustomer(5, "Aada", "E"),
+        makeCustomer(6, "Daniel", "F"),
+        makeCustomer(7, "Cecilia", "G")
+    });
+
+    QCOMPARE(viewIds(*m_model), QList<int>({ 5, 1, 7, 6, 2, 3, 4 }));
+    QCOMPARE(layoutChanged.count(), 0);  // Merged, not sorted again
+    QCOMPARE(rowsInserted.count(), 3);   // Before Bertta, before Eino, after Kalle
+    QCOMPARE(m_model->customerAt(eino.row()).getId(), 2);
+}
+
+void CustomerListModelTest::appendUnsortedKeepsStorageOrder()
+{
+    m_model->setCustomers(QList<Customer>{ makeCustomer(1, "Kalle", "A") });
+
+    QSignalSpy rowsInserted(m_model, &QAbstractItemModel::rowsInserted);
+    m_model->appendCustomers(QList<Customer>{ makeCustomer(2, "Aada", "B"), makeCustomer(3, "Bertta", "C") });
+
+    QCOMPARE(viewIds(*m_model), QList<int>({ 1, 2, 3 }));
+    QCOMPARE(rowsInserted.count(), 1);
+}
+
+void CustomerListModelTest::updateMovesRowInSortOrder()
+{
+    m_model->setCustomers(QList<Customer>{
+        makeCustomer(1, "Aada", "A"),
+        makeCustomer(2, "Bertta", "B"),
+        makeCustomer(3, "Cecilia", "C"),
+        makeCustomer(4, "Daniel", "D")
+    });
+    m_model->sort(CustomerListModel::FirstNameColumn, Qt::AscendingOrder);
+    const QPersistentModelIndex bertta = m_model->index(1, 0);
+
+    QSignalSpy rowsMoved(m_model, &QAbstractItemModel::rowsMoved);
+    QSignalSpy dataChanged(m_model, &QAbstractItemModel::dataChanged);
+    emit m_client->customerUpdated(makeCustomer(2, "Eveliina", "B"));
+
+    QCOMPARE(viewIds(*m_model), QList<int>({ 1, 3, 4, 2 }));
+    QCOMPARE(rowsMoved.count(), 1);
+    QCOMPARE(dataChanged.count(), 1);
+    QCOMPARE(bertta.row(), 3);
+
+    // Back to the top, and an edit that keeps its place only changes data
+    emit m_client->customerUpdated(makeCustomer(2, "Aabel", "B"));
+    QCOMPARE(viewIds(*m_model), QList<int>({ 2, 1, 3, 4 }));
+    emit m_client->customerUpdated(makeCustomer(3, "Cecilia", "X"));
+    QCOMPARE(viewIds(*m_model), QList<int>({ 2, 1, 3, 4 }));
+    QCOMPARE(rowsMoved.count(), 2);
+    QCOMPARE(dataChanged.count(), 3);
+    QCOMPARE(bertta.row(), 0);
+}
+
+void CustomerListModelTest::deltaSyncMergesChanges()
+{
+    QList<Customer> customers;
+    const QStringList names = { "Aada", "Bertta", "Cecilia", "Daniel", "Eino", "Fanni" };
+    for (int i = 0; i < names.count(); ++i) {
+        customers.append(makeCustomer(i + 1, names.at(i), "A"));
+    }
+    m_model->setCustomers(customers);
+    m_model->sort(CustomerListModel::FirstNameColumn, Qt::DescendingOrder);
+    const QPersistentModelIndex daniel = m_model->index(2, 0);
+
+    QSignalSpy reset(m_model, &QAbstractItemModel::modelReset);
+    QSignalSpy layoutChanged(m_model, &QAbstractItemModel::layoutChanged);
+    QSignalSpy rowsRemoved(m_model, &QAbstractItemModel::rowsRemoved);
+    Customer renamed = makeCustomer(1, "Gabriel", "A");
+    renamed.setUpdatedAt(renamed.getUpdatedAt().addSecs(60));
+    emit m_client->customersSynced(syncViews({ renamed, makeCustomer(7, "Bruno", "A") }), { 3, 5, 42 }, false);
+
+    QCOMPARE(viewIds(*m_model), QList<int>({ 1, 6, 4, 7, 2 }));
+    QCOMPARE(reset.count(), 0);
+    QCOMPARE(layoutChanged.count(), 0);
+    QCOMPARE(rowsRemoved.count(), 2);  // Eino and Cecilia are not adjacent
+    QCOMPARE(m_model->customerAt(daniel.row()).getId(), 4);
+    QCOMPARE(m_model->store().indexOfId(3), -1);
+    QCOMPARE(m_model->store().indexOfId(5), -1);
+}
+
+void CustomerListModelTest::deletesCompactTheStore()
+{
+    QList<Customer> customers;
+    for (int id = 1; id <= 10; ++id) {
+        customers.append(makeCustomer(id, QString("Name%1").arg(id), "A"));
+    }
+    m_model->setCustomers(customers);
+
+    for (int id : { 2, 4, 6, 8 }) {
+        emit m_client->customerDeleted(id);
+    }
+    QCOMPARE(m_model->store().removedCount(), 4);  // Tombstones, nothing renumbered
+    QCOMPARE(m_model->store().indexOfId(9), 8);
+
+    emit m_client->customerDeleted(10);
+    emit m_client->customerDeleted(1);
+    QCOMPARE(m_model->store().removedCount(), 0);  // Over half: compacted
+    QCOMPARE(m_model->store().count(), 4);
+    QCOMPARE(viewIds(*m_model), QList<int>({ 3, 5, 7, 9 }));
+    QCOMPARE(m_model->index(3, CustomerListModel::FirstNameColumn).data().toString(), QString("Name9"));
+}
+
+QTEST_GUILESS_MAIN(CustomerListModelTest)
+
+#include "tst_customerlistmodel.moc"
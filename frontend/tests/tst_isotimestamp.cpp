@@ -0,0 +1,162 @@
+/**
+ * tst_isotimestamp.cpp - IsoTimestamp fast path and QDateTime fallback
+ *
+ * Timestamps the fast path takes are checked against known instants;
+ * every input, fast or not, valid or not, must give the same result as
+ * QDateTime::fromString(text, Qt::ISODate), time spec included.
+ */
+
+#include <QtTest>
+#include <QTimeZone>
+#include "isotimestamp.h"
+
+namespace {
+
+QDateTime utc(int year, int month, int day, int hour, int minute, int second, int msec = 0)
+{
+    return QDateTime(QDate(year, month, day), QTime(hour, minute, second, msec), QTimeZone::UTC);
+}
+
+QDateTime offset(int seconds, int year, int month, int day, int hour, int minute, int second, int msec = 0)
+{
+    return QDateTime(QDate(year, month, day), QTime(hour, minute, second, msec),
+                     QTimeZone::fromSecondsAheadOfUtc(seconds));
+}
+
+} // namespace
+
+class IsoTimestampTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fastPath_data();
+    void fastPath();
+    void matchesQt_data();
+    void matchesQt();
+    void rejectsInvalid_data();
+    void rejectsInvalid();
+};
+
+void IsoTimestampTest::fastPath_data()
+{
+    QTest::addColumn<QByteArray>("text");
+    QTest::addColumn<QDateTime>("expected");
+
+    QTest::newRow("toISOString") << QByteArray("2025-01-02T08:00:00.000Z") << utc(2025, 1, 2, 8, 0, 0);
+    QTest::newRow("no fraction") << QByteArray("2025-01-02T08:00:00Z") << utc(2025, 1, 2, 8, 0, 0);
+    QTest::newRow("tenths") << QByteArray("2025-01-02T08:00:00.5Z") << utc(2025, 1, 2, 8, 0, 0, 500);
+    QTest::newRow("hundredths") << QByteArray("2025-01-02T08:00:00.05Z") << utc(2025, 1, 2, 8, 0, 0, 50);
+    QTest::newRow("leap day") << QByteArray("2024-02-29T23:59:59.999Z") << utc(2024, 2, 29, 23, 59, 59, 999);
+    QTest::newRow("before epoch") << QByteArray("1969-12-31T23:59:59.999Z") << utc(1969, 12, 31, 23, 59, 59, 999);
+    QTest::newRow("year 1") << QByteArray("0001-01-01T00:00:00Z") << utc(1, 1, 1, 0, 0, 0);
+    QTest::newRow("east") << QByteArray("2025-01-02T08:00:00+02:00") << offset(7200, 2025, 1, 2, 8, 0, 0);
+    QTest::newRow("west, half hour") << QByteArray("2025-01-02T08:00:00.250-05:30")
+                                     << offset(-19800, 2025, 1, 2, 8, 0, 0, 250);
+    QTest::newRow("widest offset") << QByteArray("2025-01-02T00:30:00+14:00") << offset(50400, 2025, 1, 2, 0, 30, 0);
+}
+
+void IsoTimestampTest::fastPath()
+{
+    QFETCH(QByteArray, text);
+    QFETCH(QDateTime, expected);
+    const QString string = QString::fromLatin1(text);
+
+    qint64 msecs = 0;
+    QVERIFY(IsoTimestamp::parse(QByteArrayView(text), &msecs));
+    QCOMPARE(msecs, expected.toMSecsSinceEpoch());
+    msecs = 0;
+    QVERIFY(IsoTimestamp::parse(QStringView(string), &msecs));
+    QCOMPARE(msecs, expected.toMSecsSinceEpoch());
+
+    const QDateTime dateTime = IsoTimestamp::toDateTime(QByteArrayView(text));
+    QCOMPARE(dateTime, expected);
+    QCOMPARE(dateTime.timeSpec(), expected.timeSpec());
+    QCOMPARE(dateTime.offsetFromUtc(), expected.offsetFromUtc());
+    QCOMPARE(IsoTimestamp::toDateTime(QStringView(string)), expected);
+}
+
+void IsoTimestampTest::matchesQt_data()
+{
+    QTest::addColumn<QByteArray>("text");
+
+    // Fast path
+    QTest::newRow("toISOString") << QByteArray("2025-01-02T08:00:00.000Z");
+    QTest::newRow("tenths") << QByteArray("2025-01-02T08:00:00.5Z");
+    QTest::newRow("offset") << QByteArray("2025-06-30T23:59:59.123+05:45");
+    QTest::newRow("negative offset") << QByteArray("2025-03-01T00:00:00-10:00");
+
+    // Handed to QDateTime
+    QTest::newRow("no zone") << QByteArray("2025-01-02T08:00:00");
+    QTest::newRow("no seconds") << QByteArray("2025-01-02T08:00Z");
+    QTest::newRow("comma fraction") << QByteArray("2025-01-02T08:00:00,5Z");
+    QTest::newRow("microseconds") << QByteArray("2025-01-02T08:00:00.123456Z");
+    QTest::newRow("empty fraction") << QByteArray("2025-01-02T08:00:00.Z");
+    QTest::newRow("end of day") << QByteArray("2025-01-02T24:00:00Z");
+    QTest::newRow("basic offset") << QByteArray("2025-01-02T08:00:00+0200");
+    QTest::newRow("hour offset") << QByteArray("2025-01-02T08:00:00+02");
+    QTest::newRow("offset past 14h") << QByteArray("2025-01-02T08:00:00+15:00");
+    QTest::newRow("space separator") << QByteArray("2025-01-02 08:00:00Z");
+    QTest::newRow("date only") << QByteArray("2025-01-02");
+
+    // Rejected by the fast path's range checks or layout
+    QTest::newRow("february 29") << QByteArray("2025-02-29T00:00:00Z");
+    QTest::newRow("trailing junk") << QByteArray("2025-01-02T08:00:00Zjunk");
+}
+
+void IsoTimestampTest::matchesQt()
+{
+    QFETCH(QByteArray, text);
+    const QString string = QString::fromLatin1(text);
+    const QDateTime expected = QDateTime::fromString(string, Qt::ISODate);
+
+    const QDateTime fromBytes = IsoTimestamp::toDateTime(QByteArrayView(text));
+    const QDateTime fromString = IsoTimestamp::toDateTime(QStringView(string));
+    QCOMPARE(fromBytes.isValid(), expected.isValid());
+    QCOMPARE(fromString.isValid(), expected.isValid());
+
+    qint64 msecs = 0;
+    QCOMPARE(IsoTimestamp::parse(QByteArrayView(text), &msecs), expected.isValid());
+    QCOMPARE(IsoTimestamp::parse(QStringView(string), &msecs), expected.isValid());
+    if (!expected.isValid()) {
+        return;
+    }
+
+    QCOMPARE(msecs, expected.toMSecsSinceEpoch());
+    QCOMPARE(fromBytes, expected);
+    QCOMPARE(fromBytes.timeSpec(), expected.timeSpec());
+    QCOMPARE(fromBytes.offsetFromUtc(), expected.offsetFromUtc());
+    QCOMPARE(fromString, expected);
+    QCOMPARE(fromString.timeSpec(), expected.timeSpec());
+}
+
+void IsoTimestampTest::rejectsInvalid_data()
+{
+    QTest::addColumn<QByteArray>("text");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("garbage") << QByteArray("not a timestamp at all");
+    QTest::newRow("month 13") << QByteArray("2025-13-01T00:00:00Z");
+    QTest::newRow("month 0") << QByteArray("2025-00-01T00:00:00Z");
+    QTest::newRow("february 29") << QByteArray("2025-02-29T00:00:00Z");
+    QTest::newRow("april 31") << QByteArray("2025-04-31T00:00:00Z");
+    QTest::newRow("hour 25") << QByteArray("2025-01-02T25:00:00Z");
+    QTest::newRow("minute 60") << QByteArray("2025-01-02T08:60:00Z");
+    QTest::newRow("letter in year") << QByteArray("20x5-01-02T08:00:00Z");
+}
+
+void IsoTimestampTest::rejectsInvalid()
+{
+    QFETCH(QByteArray, text);
+    const QString string = QString::fromLatin1(text);
+
+    qint64 msecs = 42;
+    QVERIFY(!IsoTimestamp::parse(QByteArrayView(text), &msecs));
+    QVERIFY(!IsoTimestamp::parse(QStringView(string), &msecs));
+    QVERIFY(!IsoTimestamp::toDateTime(QByteArrayView(text)).isValid());
+    QVERIFY(!IsoTimestamp::toDateTime(QStringView(string)).isValid());
+}
+
+QTEST_APPLESS_MAIN(IsoTimestampTest)
+
+#include "tst_isotimestamp.moc"
@@ -0,0 +1,176 @@
+/**
+ * tst_servereventparser.cpp - ServerEventParser framing and field rules
+ *
+ * Streams are fed whole, byte by byte and split at every offset; the
+ * events must not depend on where the network cut the body.
+ */
+
+#include <QtTest>
+#include "servereventparser.h"
+
+namespace {
+
+using Event = ServerEventParser::Event;
+
+QList<Event> parse(const QList<QByteArray> &chunks)
+{
+    ServerEventParser parser;
+    for (const QByteArray &chunk : chunks) {
+        parser.feed(chunk);
+    }
+    return parser.takeEvents();
+}
+
+QList<QByteArray> bytes(const QByteArray &stream)
+{
+    QList<QByteArray> chunks;
+    for (char c : stream) {
+        chunks.append(QByteArray(1, c));
+    }
+    return chunks;
+}
+
+// "type|id|data" per event, so whole lists compare at once
+QList<QByteArray> describe(const QList<Event> &events)
+{
+    QList<QByteArray> described;
+    for (const Event &event : events) {
+        described.append(event.type + '|' + event.id + '|' + event.data);
+    }
+    return described;
+}
+
+} // namespace
+
+class ServerEventParserTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitChunks();
+    void lineEndings_data();
+    void lineEndings();
+    void crlfSplitAcrossFeeds();
+    void multiLineData();
+    void commentsAndUnknownFields();
+    void idAndRetryPersist();
+};
+
+void ServerEventParserTest::splitChunks()
+{
+    const QByteArray stream = "event: customer-updated\nid: 41\ndata: {\"id\":7}\n\n"
+                              ": ping\n\n"
+                              "event: customer-deleted\nid: 42\ndata: {\"id\":8}\n\n";
+    const QList<QByteArray> expected = {
+        "customer-updated|41|{\"id\":7}",
+        "customer-deleted|42|{\"id\":8}"
+    };
+
+    QCOMPARE(describe(parse({ stream })), expected);
+    QCOMPARE(describe(parse(bytes(stream))), expected);
+    for (qsizetype cut = 1; cut < stream.size(); ++cut) {
+        QCOMPARE(describe(parse({ stream.left(cut), stream.mid(cut) })), expected);
+    }
+
+    // Nothing is dispatched before the blank line arrives
+    ServerEventParser parser;
+    parser.feed("data: {\"id\":7}\n");
+    QVERIFY(parser.takeEvents().isEmpty());
+    parser.feed("\n");
+    QCOMPARE(parser.takeEvents().count(), 1);
+    QVERIFY(parser.takeEvents().isEmpty());  // Taken once
+}
+
+void ServerEventParserTest::lineEndings_data()
+{
+    QTest::addColumn<QByteArray>("newline");
+
+    QTest::newRow("LF") << QByteArray("\n");
+    QTest::newRow("CR") << QByteArray("\r");
+    QTest::newRow("CRLF") << QByteArray("\r\n");
+}
+
+void ServerEventParserTest::lineEndings()
+{
+    QFETCH(QByteArray, newline);
+    const QByteArray stream = "id: 1" + newline + "data: first" + newline + "data: second" + newline + newline
+                              + "data: third" + newline + newline;
+    const QList<QByteArray> expected = { "message|1|first\nsecond", "message|1|third" };
+
+    QCOMPARE(describe(parse({ stream })), expected);
+    QCOMPARE(describe(parse(bytes(stream))), expected);
+    for (qsizetype cut = 1; cut < stream.size(); ++cut) {
+        QCOMPARE(describe(parse({ stream.left(cut), stream.mid(cut) })), expected);
+    }
+}
+
+void ServerEventParserTest::crlfSplitAcrossFeeds()
+{
+    // The LF after a CR that ended a feed is not a second (blank) line
+    QCOMPARE(describe(parse({ "data: a\r", "\ndata: b\r", "\n\r", "\n" })), QList<QByteArray>({ "message||a\nb" }));
+
+    // A CR ending a feed is a line end even when the next feed has no LF
+    QCOMPARE(describe(parse({ "data: a\r", "data: b\r\r" })), QList<QByteArray>({ "message||a\nb" }));
+}
+
+void ServerEventParserTest::multiLineData()
+{
+    const QList<Event> events = parse({
+        "data: line one\ndata:line two\ndata:  indented\ndata\ndata: \n\n"
+    });
+
+    QCOMPARE(events.count(), 1);
+    QCOMPARE(events.at(0).data, QByteArray("line one\nline two\n indented\n\n"));  // Only one space is stripped
+    QCOMPARE(events.at(0).type, QByteArray("message"));
+
+    // An empty data: line still makes an event
+    QCOMPARE(describe(parse({ "data\n\n" })), QList<QByteArray>({ "message||" }));
+
+    // Colons in the value are kept
+    QCOMPARE(parse({ "data: {\"a\":\"b:c\"}\n\n" }).at(0).data, QByteArray("{\"a\":\"b:c\"}"));
+}
+
+void ServerEventParserTest::commentsAndUnknownFields()
+{
+    const QList<Event> events = parse({
+        ": keep-alive\n\n"                                // Comment only: no event
+        "event: customer-created\n: ping\nfoo: bar\n\n"  // No data: dropped, type reset
+        "data: after\n:comment between\nretry\ndata: fields\n\n"
+    });
+
+    QCOMPARE(describe(events), QList<QByteArray>({ "message||after\nfields" }));
+}
+
+void ServerEventParserTest::idAndRetryPersist()
+{
+    ServerEventParser parser;
+    QCOMPARE(parser.retryMs(), -1);
+    QVERIFY(parser.lastEventId().isEmpty());
+
+    parser.feed("retry: 5000\nid: 10\ndata: a\n\n");
+    parser.feed("data: b\n\n");
+    QCOMPARE(describe(parser.takeEvents()), QList<QByteArray>({ "message|10|a", "message|10|b" }));
+    QCOMPARE(parser.retryMs(), 5000);
+
+    // Invalid retry values are ignored
+    parser.feed("retry: soon\nretry: -1\nretry\n\n");
+    QCOMPARE(parser.retryMs(), 5000);
+    parser.feed("retry:250\n\n");
+    QCOMPARE(parser.retryMs(), 250);
+
+    // An id with a NUL is ignored; an empty id clears it
+    parser.feed(QByteArray("id: 1") + '\0' + "1\ndata: c\n\n");
+    QCOMPARE(parser.lastEventId(), QByteArray("10"));
+    parser.feed("id\ndata: d\n\n");
+    QCOMPARE(describe(parser.takeEvents()), QList<QByteArray>({ "message|10|c", "message||d" }));
+    QVERIFY(parser.lastEventId().isEmpty());
+
+    // An id without data is kept for the next event
+    parser.feed("id: 12\n\ndata: e\n");
+    QCOMPARE(parser.lastEventId(), QByteArray("12"));
+    QVERIFY(parser.takeEvents().isEmpty());  // Unterminated event is not dispatched
+}
+
+QTEST_APPLESS_MAIN(ServerEventParserTest)
+
+#include "tst_servereventparser.moc"
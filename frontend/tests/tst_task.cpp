@@ -0,0 +1,360 @@
+/**
+ * tst_task.cpp - Unit tests for Task, whenAll / whenAny and cancellation
+ *
+ * A Gate stands in for a request: coroutines suspend on it until the test
+ * opens it or their token is cancelled, so completion order is chosen by
+ * the test and no event loop is needed.
+ */
+
+#include <QtTest>
+#include <stdexcept>
+#include <string>
+#include "task.h"
+
+namespace {
+
+// Suspends coroutines until opened; a cancelled token resumes one early
+class Gate
+{
+public:
+    class Awaiter
+    {
+    public:
+        Awaiter(Gate *gate, CancellationToken token) : m_gate(gate), m_token(std::move(token)) {}
+        Awaiter(const Awaiter &) = delete;
+        Awaiter &operator=(const Awaiter &) = delete;
+        ~Awaiter() { m_gate->remove(this); }  // Destroyed while suspended
+
+        bool await_ready() const { return m_gate->m_open || m_token.isCancelled(); }
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            m_gate->m_waiting.push_back(this);
+            m_registration = m_token.onCancel([this]() {
+                m_gate->remove(this);
+                m_handle.resume();
+            });
+        }
+        bool await_resume() const { return !m_token.isCancelled(); }  // false = cancelled
+
+    private:
+        friend class Gate;
+        Gate *m_gate;
+        CancellationToken m_token;
+        CancellationToken::Registration m_registration;
+        std::coroutine_handle<> m_handle;
+    };
+
+    Awaiter wait(CancellationToken token = {}) { return Awaiter(this, std::move(token)); }
+    std::size_t waiting() const { return m_waiting.size(); }
+
+    void open()
+    {
+        m_open = true;
+        while (!m_waiting.empty()) {
+            Awaiter *awaiter = m_waiting.front();
+            m_waiting.erase(m_waiting.begin());
+            awaiter->m_registration.reset();
+            awaiter->m_handle.resume();
+        }
+    }
+
+private:
+    void remove(Awaiter *awaiter) { std::erase(m_waiting, awaiter); }
+
+    bool m_open = false;
+    std::vector<Awaiter*> m_waiting;
+};
+
+// Counts its destructions (coroutine frames going away)
+struct FrameProbe
+{
+    int *destroyed;
+    explicit FrameProbe(int *counter) : destroyed(counter) {}
+    FrameProbe(FrameProbe &&other) noexcept : destroyed(std::exchange(other.destroyed, nullptr)) {}
+    ~FrameProbe()
+    {
+        if (destroyed) {
+            ++*destroyed;
+        }
+    }
+};
+
+Task<int> valueAfter(Gate &gate, int value, std::vector<int> *finished = nullptr)
+{
+    Gate::Awaiter wait = gate.wait();
+    co_await wait;
+    if (finished) {
+        finished->push_back(value);
+    }
+    co_return value;
+}
+
+Task<int> throwAfter(Gate &gate, std::vector<int> *finished = nullptr)
+{
+    Gate::Awaiter wait = gate.wait();
+    co_await wait;
+    if (finished) {
+        finished->push_back(-1);
+    }
+    throw std::runtime_error("failed");
+}
+
+Task<int> sum(Gate &gate, int a, int b)
+{
+    Task<int> first = valueAfter(gate, a);
+    Task<int> second = valueAfter(gate, b);
+    const int x = co_await first;
+    const int y = co_await second;
+    co_return x + y;
+}
+
+Task<bool> waitFor(Gate &gate, CancellationToken token, int *destroyed)
+{
+    FrameProbe probe(destroyed);
+    Gate::Awaiter wait = gate.wait(token);
+    co_return co_await wait;
+}
+
+Task<int> untouched(bool *ran, FrameProbe probe)
+{
+    *ran = true;
+    co_return 0;
+}
+
+// Catches what an awaited task throws
+template<typename T>
+Task<std::string> errorOf(Task<T> task)
+{
+    try {
+        co_await task;
+    } catch (const std::exception &error) {
+        co_return error.what();
+    }
+    co_return std::string();
+}
+
+} // namespace
+
+class TaskTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void startsWhenAwaited();
+    void exceptionReachesAwaiter();
+    void whenAllKeepsTaskOrder();
+    void whenAllRethrowsAfterEveryTask();
+    void whenAnyDestroysTheOthers();
+    void whenAnyRethrowsWinnersException();
+    void cancelBeforeSuspension();
+    void cancelAfterSuspension();
+    void cancellationCallbacks();
+    void destroyUnstartedTask();
+    void destroySuspendedTask();
+};
+
+void TaskTest::startsWhenAwaited()
+{
+    Gate gate;
+    std::optional<int> result;
+    Task<int> task = sum(gate, 2, 3);
+    QCOMPARE(gate.waiting(), std::size_t(0));  // Lazy: nothing ran yet
+
+    std::move(task).then([&](int value) { result = value; });
+    QCOMPARE(gate.waiting(), std::size_t(1));  // The second lookup has not started
+    QVERIFY(!result);
+
+    gate.open();
+    QCOMPARE(result, std::optional<int>(5));
+}
+
+void TaskTest::exceptionReachesAwaiter()
+{
+    Gate gate;
+    std::optional<std::string> message;
+    errorOf(throwAfter(gate)).then([&](std::string what) { message = what; });
+    QVERIFY(!message);
+
+    gate.open();
+    QCOMPARE(message, std::optional<std::string>("failed"));
+}
+
+void TaskTest::whenAllKeepsTaskOrder()
+{
+    Gate gates[3];
+    std::vector<int> finished;
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 3; ++i) {
+        tasks.push_back(valueAfter(gates[i], 10 + i, &finished));
+    }
+
+    std::optional<std::vector<int>> results;
+    whenAll(std::move(tasks)).then([&](std::vector<int> values) { results = values; });
+    for (const Gate &gate : gates) {
+        QCOMPARE(gate.waiting(), std::size_t(1));  // All started together
+    }
+
+    gates[2].open();
+    gates[0].open();
+    QVERIFY(!results);
+    gates[1].open();
+
+    QCOMPARE(finished, std::vector<int>({ 12, 10, 11 }));
+    QCOMPARE(results, std::optional<std::vector<int>>({ 10, 11, 12 }));
+}
+
+void TaskTest::whenAllRethrowsAfterEveryTask()
+{
+    Gate gates[2];
+    std::vector<int> finished;
+    std::vector<Task<int>> tasks;
+    tasks.push_back(throwAfter(gates[0], &finished));
+    tasks.push_back(valueAfter(gates[1], 1, &finished));
+
+    std::optional<std::string> message;
+    errorOf(whenAll(std::move(tasks))).then([&](std::string what) { message = what; });
+
+    gates[0].open();
+    QVERIFY(!message);  // Still waits for the other task
+    gates[1].open();
+
+    QCOMPARE(finished, std::vector<int>({ -1, 1 }));
+    QCOMPARE(message, std::optional<std::string>("failed"));
+}
+
+void TaskTest::whenAnyDestroysTheOthers()
+{
+    Gate gates[3];
+    std::vector<Task<int>> tasks;
+    for (int i = 0; i < 3; ++i) {
+        tasks.push_back(valueAfter(gates[i], 10 + i));
+    }
+
+    std::optional<std::pair<std::size_t, int>> result;
+    whenAny(std::move(tasks)).then([&](std::pair<std::size_t, int> first) { result = first; });
+    gates[1].open();
+
+    QCOMPARE(result, (std::optional<std::pair<std::size_t, int>>({ 1, 11 })));
+    QCOMPARE(gates[0].waiting(), std::size_t(0));
+    QCOMPARE(gates[2].waiting(), std::size_t(0));
+}
+
+void TaskTest::whenAnyRethrowsWinnersException()
+{
+    Gate gates[2];
+    std::vector<Task<int>> tasks;
+    tasks.push_back(valueAfter(gates[0], 1));
+    tasks.push_back(throwAfter(gates[1]));
+
+    std::optional<std::string> message;
+    errorOf(whenAny(std::move(tasks))).then([&](std::string what) { message = what; });
+    gates[1].open();
+
+    QCOMPARE(message, std::optional<std::string>("failed"));
+    QCOMPARE(gates[0].waiting(), std::size_t(0));
+}
+
+void TaskTest::cancelBeforeSuspension()
+{
+    Gate gate;
+    CancellationSource source;
+    source.cancel();
+
+    int destroyed = 0;
+    std::optional<bool> opened;
+    waitFor(gate, source.token(), &destroyed).then([&](bool value) { opened = value; });
+
+    QCOMPARE(opened, std::optional<bool>(false));
+    QCOMPARE(gate.waiting(), std::size_t(0));
+    QCOMPARE(destroyed, 1);
+}
+
+void TaskTest::cancelAfterSuspension()
+{
+    Gate gate;
+    CancellationSource source;
+    int destroyed = 0;
+    std::optional<bool> opened;
+    waitFor(gate, source.token(), &destroyed).then([&](bool value) { opened = value; });
+    QCOMPARE(gate.waiting(), std::size_t(1));
+
+    source.cancel();
+    QCOMPARE(opened, std::optional<bool>(false));
+    QCOMPARE(gate.waiting(), std::size_t(0));
+    QCOMPARE(destroyed, 1);
+
+    gate.open();  // Too late: nothing left to resume
+    QCOMPARE(opened, std::optional<bool>(false));
+}
+
+void TaskTest::cancellationCallbacks()
+{
+    CancellationToken none;
+    QVERIFY(!none.canBeCancelled());
+    QVERIFY(!none.isCancelled());
+
+    CancellationSource source;
+    CancellationToken token = source.token();
+    std::vector<int> calls;
+    CancellationToken::Registration second;
+    CancellationToken::Registration first = token.onCancel([&]() {
+        calls.push_back(1);
+        second.reset();  // Unregisters a later callback
+    });
+    second = token.onCancel([&]() { calls.push_back(2); });
+    CancellationToken::Registration third = token.onCancel([&]() { calls.push_back(3); });
+    {
+        CancellationToken::Registration dropped = token.onCancel([&]() { calls.push_back(4); });
+    }
+
+    source.cancel();
+    source.cancel();
+    QVERIFY(token.isCancelled());
+    QCOMPARE(calls, std::vector<int>({ 1, 3 }));
+
+    // Registered after cancellation: runs at once
+    CancellationToken::Registration late = token.onCancel([&]() { calls.push_back(5); });
+    QCOMPARE(calls, std::vector<int>({ 1, 3, 5 }));
+}
+
+void TaskTest::destroyUnstartedTask()
+{
+    bool ran = false;
+    int destroyed = 0;
+    {
+        Task<int> task = untouched(&ran, FrameProbe(&destroyed));
+        QVERIFY(task.isValid());
+        QVERIFY(!task.isDone());
+    }
+    QVERIFY(!ran);
+    QCOMPARE(destroyed, 1);  // The frame's copy of the parameter
+}
+
+void TaskTest::destroySuspendedTask()
+{
+    Gate gates[2];
+    CancellationSource source;
+    int destroyed = 0;
+    std::vector<Task<bool>> tasks;
+    tasks.push_back(waitFor(gates[0], source.token(), &destroyed));
+    tasks.push_back(waitFor(gates[1], CancellationToken(), &destroyed));
+
+    // whenAny() drops the loser while it is suspended on its gate
+    std::optional<std::size_t> winner;
+    whenAny(std::move(tasks)).then([&](std::pair<std::size_t, bool> first) { winner = first.first; });
+    gates[1].open();
+
+    QCOMPARE(winner, std::optional<std::size_t>(1));
+    QCOMPARE(destroyed, 2);
+    QCOMPARE(gates[0].waiting(), std::size_t(0));
+
+    // Neither the gate nor the token reaches the destroyed frame
+    source.cancel();
+    gates[0].open();
+    QCOMPARE(destroyed, 2);
+}
+
+QTEST_APPLESS_MAIN(TaskTest)
+
+#include "tst_task.moc"